@@ -11,10 +11,23 @@ extern "C" cublasStatus_t cuMpSGEMM_destroy(cuMpSGEMM_handle_t handle);
 extern "C" cublasStatus_t cuMpSGEMM_set_stream(cuMpSGEMM_handle_t handle,
                                                const cudaStream_t cuda_stream);
 
+// CUBLAS_POINTER_MODE_HOST (default) or CUBLAS_POINTER_MODE_DEVICE.
+// In the device mode, alpha and beta are read by the kernels.
+extern "C" cublasStatus_t
+cuMpSGEMM_set_pointer_mode(cuMpSGEMM_handle_t handle,
+                           const cublasPointerMode_t pointer_mode);
+
+extern "C" cublasStatus_t
+cuMpSGEMM_get_pointer_mode(cuMpSGEMM_handle_t handle,
+                           cublasPointerMode_t *const pointer_mode);
+
 extern "C" const char *
 cuMpSGEMM_get_compute_mode_string(const cuMpSGEMM_compute_mode_t mode);
 
 // User defined function
+// `cublas_handle` is nullptr for cublasLtMatmul
+// The result is cached for the same arguments unless the compute mode cache is
+// disabled.
 extern "C" cuMpSGEMM_compute_mode_t cuMpSGEMM_get_compute_mode(
     const char *const func_name, cublasHandle_t const cublas_handle,
     const cublasOperation_t op_A, const cublasOperation_t op_B,
@@ -56,4 +69,24 @@ extern "C" cublasStatus_t cuMpSGEMM_cgemm_strided_batch(
     const uint64_t ldc, const uint64_t stridec, const uint64_t batch_count,
     const cuMpSGEMM_compute_mode_t compute_mode);
 
+// The pointer lists are in the device memory
+extern "C" cublasStatus_t cuMpSGEMM_sgemm_batched(
+    cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const float *alpha,
+    const float *const *const a_dmem_ptr_list, const uint64_t lda,
+    const float *const *const b_dmem_ptr_list, const uint64_t ldb,
+    const float *beta, float *const *const c_dmem_ptr_list, const uint64_t ldc,
+    const uint64_t batch_count, const cuMpSGEMM_compute_mode_t compute_mode);
+
+extern "C" cublasStatus_t cuMpSGEMM_cgemm_batched(
+    cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const cuComplex *alpha,
+    const cuComplex *const *const a_dmem_ptr_list, const uint64_t lda,
+    const cuComplex *const *const b_dmem_ptr_list, const uint64_t ldb,
+    const cuComplex *beta, cuComplex *const *const c_dmem_ptr_list,
+    const uint64_t ldc, const uint64_t batch_count,
+    const cuMpSGEMM_compute_mode_t compute_mode);
+
 #endif
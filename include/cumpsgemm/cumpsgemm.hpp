@@ -12,6 +12,10 @@ inline void destroy(handle_t handle) { cuMpSGEMM_destroy(handle); }
 inline void set_stream(handle_t &handle, cudaStream_t cuda_stream) {
   cuMpSGEMM_set_stream(handle, cuda_stream);
 }
+inline void set_pointer_mode(handle_t &handle,
+                             const cublasPointerMode_t pointer_mode) {
+  cuMpSGEMM_set_pointer_mode(handle, pointer_mode);
+}
 
 template <class T>
 cublasStatus_t gemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
@@ -34,6 +38,17 @@ cublasStatus_t gemm_stridedBatch(
     const uint64_t batch_count, const cuMpSGEMM_compute_mode_t compute_mode,
     unsigned *const used_kernel_module_id = nullptr);
 
+template <class T>
+cublasStatus_t gemm_batchPtr(
+    cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const T *alpha, const T *const *const a_dmem_ptr_list,
+    const uint64_t lda, const T *const *const b_dmem_ptr_list,
+    const uint64_t ldb, const T *beta, T *const *const c_dmem_ptr_list,
+    const uint64_t ldc, const uint64_t batch_count,
+    const cuMpSGEMM_compute_mode_t compute_mode,
+    unsigned *const used_kernel_module_id = nullptr);
+
 template <class T>
 unsigned exp_stats_ext(cuMpSGEMM_handle_t handle, const unsigned m,
                        const unsigned n, const T *const ptr, const unsigned ld,
@@ -103,6 +118,22 @@ float get_max_exp(cuMpSGEMM_handle_t handle,
 
 unsigned get_current_dynamic_launch_buffer_id(cuMpSGEMM_handle_t handle);
 unsigned get_next_dynamic_launch_buffer_id(cuMpSGEMM_handle_t handle);
+// The mode used by AUTO when FP16TCEC(_SCALING) is not enough.
+// CUMPSGEMM_TF32TCEC (default) or CUMPSGEMM_BF16TCEC.
+void set_auto_fallback_mode(cuMpSGEMM_handle_t handle,
+                            const cuMpSGEMM_compute_mode_t mode);
+cuMpSGEMM_compute_mode_t get_auto_fallback_mode(cuMpSGEMM_handle_t handle);
+// In the deterministic mode, the results of the GEMMs are bitwise reproducible
+// across runs and GPUs of the same model: the kernels are selected only by the
+// shape and the device, and the online tuning cache is not used. Disabled by
+// default.
+void set_deterministic_mode(cuMpSGEMM_handle_t handle, const bool enabled);
+bool get_deterministic_mode(cuMpSGEMM_handle_t handle);
+// The kernels compute the tiles of C column by column in groups of `width`
+// tile rows, so that the tiles of A and B are reused in L2. 0 makes all the
+// tile rows a group, which is the column-major order. 8 by default.
+void set_raster_group_width(cuMpSGEMM_handle_t handle, const unsigned width);
+unsigned get_raster_group_width(cuMpSGEMM_handle_t handle);
 cuMpSGEMM_compute_mode_t
 get_dynamic_launch_gemm_compute_mode(cuMpSGEMM_handle_t handle,
                                      const unsigned buffer_id);
@@ -17,5 +17,6 @@ enum cuMpSGEMM_compute_mode_t {
   CUMPSGEMM_UNDEFINED = 10,
   CUMPSGEMM_FP16TCEC_SCALING = 11,
   CUMPSGEMM_FP32_SIMT = 12,
+  CUMPSGEMM_BF16TCEC = 13,
 };
 #endif
@@ -2,6 +2,7 @@
 #include "detail/common.h"
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace cumpsgemm {
@@ -12,6 +13,10 @@ void set_compute_mode(const cuMpSGEMM_compute_mode_t mode);
 void unset_compute_mode();
 void enable_custom_gemm_Mx2x2();
 void disable_custom_gemm_Mx2x2();
+// Bitwise reproducible GEMMs (See `cumpsgemm::set_deterministic_mode`). Also
+// enabled by CUMPSGEMM_DETERMINISTIC=1.
+void enable_deterministic_mode();
+void disable_deterministic_mode();
 
 void reset_exp_stats_buffer_id();
 void set_exp_stats_params(const float ignore_threshold,
@@ -30,5 +35,33 @@ using control_function_t = std::function<cuMpSGEMM_compute_mode_t(
     const int, const int, const unsigned, const unsigned, const unsigned)>;
 void set_control_function(const control_function_t control_function);
 void unset_control_function();
+// The control function is called once for each (op_A, op_B, m, n, k), and the
+// selected modes are looked up from a native table shared among threads.
+// Unset by `unset_control_function`.
+void set_memoized_control_function(const control_function_t control_function);
+
+// Rules in the rule file format (See README), compiled into a native decision
+// table. The calls not matched fall back to the control function and the rule.
+// Throws std::runtime_error when the rules are invalid.
+void set_control_rules(const std::string rules);
+void unset_control_rules();
+
+// Cache of the compute modes selected by the control function or the rule
+// for each cuBLAS handle and shape.
+// The cache is cleared when the compute mode or the control function is
+// changed. Call `clear_compute_mode_cache` when the selection depends on
+// other states.
+void enable_compute_mode_cache();
+void disable_compute_mode_cache();
+void clear_compute_mode_cache();
+// Returns {num_hits, num_misses}
+std::pair<std::size_t, std::size_t> get_compute_mode_cache_stats();
+
+// Reloads the environment variables and the control file specified by
+// CUMPSGEMM_CONFIG_FILE
+void reload_config();
+// CUMPSGEMM_COMPUTE_MODE in the current config, or CUMPSGEMM_UNDEFINED if not
+// set or invalid. The rule library reads the config through this function.
+cuMpSGEMM_compute_mode_t get_config_compute_mode();
 } // namespace hijack_control
 } // namespace cumpsgemm
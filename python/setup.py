@@ -1,4 +1,4 @@
-from glob import glob
+import os
 from setuptools import setup, Extension
 
 __version__ = "0.0.1"
@@ -17,10 +17,14 @@ class get_pybind_include(object):
         import pybind11
         return pybind11.get_include(self.user)
 
+cuda_home = os.environ.get("CUDA_HOME", "/usr/local/cuda")
+# The directory of libcumpsgemm.so
+cumpsgemm_lib_dir = os.environ.get("CUMPSGEMM_LIB_DIR", "../build")
+
 ext_modules = [
     Extension(
         "cumpsgemm_hijack_control",
-        sorted(glob("src/*.cpp")),
+        ["src/main.cpp"],
         include_dirs = [
             "../include/",
             get_pybind_include(),
@@ -28,6 +32,26 @@ ext_modules = [
             ],
         language='c++'
     ),
+    Extension(
+        "cumpsgemm",
+        ["src/gemm.cpp"],
+        include_dirs = [
+            "../include/",
+            os.path.join(cuda_home, "include"),
+            get_pybind_include(),
+            get_pybind_include(user=True)
+            ],
+        library_dirs = [
+            cumpsgemm_lib_dir,
+            os.path.join(cuda_home, "lib64"),
+            ],
+        runtime_library_dirs = [
+            os.path.abspath(cumpsgemm_lib_dir),
+            ],
+        libraries = ["cumpsgemm", "cublas", "cudart"],
+        extra_compile_args = ["-std=c++17"],
+        language='c++'
+    ),
 ]
 
 setup(
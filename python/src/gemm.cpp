@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cuComplex.h>
+#include <cuda_runtime.h>
+#include <cumpsgemm/cumpsgemm.hpp>
+#include <memory>
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+// DLPack ABI (https://github.com/dmlc/dlpack)
+struct DLDevice {
+  std::int32_t device_type;
+  std::int32_t device_id;
+};
+struct DLDataType {
+  std::uint8_t code;
+  std::uint8_t bits;
+  std::uint16_t lanes;
+};
+struct DLTensor {
+  void *data;
+  DLDevice device;
+  std::int32_t ndim;
+  DLDataType dtype;
+  std::int64_t *shape;
+  std::int64_t *strides;
+  std::uint64_t byte_offset;
+};
+struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void *manager_ctx;
+  void (*deleter)(DLManagedTensor *);
+};
+constexpr std::int32_t kDLCUDA = 2;
+constexpr std::int32_t kDLCUDAManaged = 13;
+constexpr std::uint8_t kDLFloat = 2;
+constexpr std::uint8_t kDLComplex = 5;
+
+// Makes the consumer stream wait for the work enqueued on the producer stream
+bool wait_for_stream(const cudaStream_t consumer_stream,
+                     const cudaStream_t producer_stream) {
+  cudaEvent_t event;
+  if (cudaEventCreateWithFlags(&event, cudaEventDisableTiming) != cudaSuccess) {
+    return false;
+  }
+  const auto result =
+      cudaEventRecord(event, producer_stream) == cudaSuccess &&
+      cudaStreamWaitEvent(consumer_stream, event, 0) == cudaSuccess;
+  // The event can be destroyed before the wait completes
+  cudaEventDestroy(event);
+  return result;
+}
+
+struct handle_t {
+  cumpsgemm::handle_t handle;
+  std::uintptr_t stream = 0;
+
+  handle_t() { cumpsgemm::create(handle); }
+  handle_t(const handle_t &) = delete;
+  ~handle_t() { cumpsgemm::destroy(handle); }
+
+  // The work on the new stream is ordered after the work on the previous one,
+  // since the GEMMs share the working memory of the handle.
+  void set_stream(const std::uintptr_t s) {
+    if (s == stream) {
+      return;
+    }
+    if (!wait_for_stream(reinterpret_cast<cudaStream_t>(s),
+                         reinterpret_cast<cudaStream_t>(stream))) {
+      throw std::runtime_error("Failed to wait for the previous stream");
+    }
+    stream = s;
+    cumpsgemm::set_stream(handle, reinterpret_cast<cudaStream_t>(s));
+  }
+};
+
+// A device array given by __cuda_array_interface__ or __dlpack__ without copy
+struct array_t {
+  void *ptr;
+  bool is_complex;
+  std::vector<std::int64_t> shape;
+  // In elements
+  std::vector<std::int64_t> strides;
+  // The DLPack tensor is released after the GEMM is enqueued
+  std::shared_ptr<DLManagedTensor> dl_tensor;
+};
+
+void set_compact_strides(array_t &array) {
+  array.strides.resize(array.shape.size());
+  std::int64_t stride = 1;
+  for (std::size_t i = array.shape.size(); i > 0; i--) {
+    array.strides[i - 1] = stride;
+    stride *= array.shape[i - 1];
+  }
+}
+
+// Makes the launch stream wait for the work enqueued on the stream given by the
+// "stream" entry of __cuda_array_interface__ (v3). None or no entry means that
+// the producer has already synchronized the array.
+void wait_for_cai_stream(const pybind11::dict cai,
+                         const std::uintptr_t launch_stream) {
+  if (!cai.contains("stream") || cai["stream"].is_none()) {
+    return;
+  }
+  const auto cai_stream = cai["stream"].cast<std::uintptr_t>();
+  if (cai_stream == 0) {
+    throw std::invalid_argument(
+        "0 is not allowed for the stream of __cuda_array_interface__");
+  }
+  // 1 and 2 are the legacy and per-thread default streams
+  const auto producer_stream =
+      cai_stream == 1   ? cudaStreamLegacy
+      : cai_stream == 2 ? cudaStreamPerThread
+                        : reinterpret_cast<cudaStream_t>(cai_stream);
+  const auto consumer_stream = reinterpret_cast<cudaStream_t>(launch_stream);
+  if (producer_stream == consumer_stream ||
+      (cai_stream == 1 && launch_stream == 0)) {
+    return;
+  }
+
+  if (!wait_for_stream(consumer_stream, producer_stream)) {
+    throw std::runtime_error(
+        "Failed to wait for the stream of __cuda_array_interface__");
+  }
+}
+
+array_t get_array_from_cai(const pybind11::dict cai,
+                           const std::uintptr_t stream) {
+  wait_for_cai_stream(cai, stream);
+
+  array_t array;
+  const auto typestr = cai["typestr"].cast<std::string>();
+  if (typestr == "<f4") {
+    array.is_complex = false;
+  } else if (typestr == "<c8") {
+    array.is_complex = true;
+  } else {
+    throw std::invalid_argument("Unsupported dtype " + typestr +
+                                ". float32 or complex64 is expected");
+  }
+  const auto itemsize = array.is_complex ? 8 : 4;
+
+  array.ptr = reinterpret_cast<void *>(
+      cai["data"].cast<pybind11::tuple>()[0].cast<std::uintptr_t>());
+  array.shape = cai["shape"].cast<std::vector<std::int64_t>>();
+  if (!cai.contains("strides") || cai["strides"].is_none()) {
+    set_compact_strides(array);
+  } else {
+    for (const auto s : cai["strides"].cast<std::vector<std::int64_t>>()) {
+      if (s % itemsize != 0) {
+        throw std::invalid_argument("Unaligned strides are not supported");
+      }
+      array.strides.push_back(s / itemsize);
+    }
+  }
+  return array;
+}
+
+array_t get_array_from_dlpack(const pybind11::object obj,
+                              const std::uintptr_t stream) {
+  // 0 is not allowed for the CUDA stream in the DLPack protocol
+  const auto capsule_obj = obj.attr("__dlpack__")(
+      pybind11::arg("stream") = (stream == 0 ? 1 : stream));
+  auto capsule = capsule_obj.ptr();
+  auto managed = static_cast<DLManagedTensor *>(
+      PyCapsule_GetPointer(capsule, "dltensor"));
+  if (managed == nullptr) {
+    throw pybind11::error_already_set();
+  }
+  // The consumer owns the tensor once the capsule is renamed
+  PyCapsule_SetName(capsule, "used_dltensor");
+
+  array_t array;
+  array.dl_tensor = std::shared_ptr<DLManagedTensor>(
+      managed, [](DLManagedTensor *const t) {
+        if (t->deleter != nullptr) {
+          t->deleter(t);
+        }
+      });
+
+  const auto &t = managed->dl_tensor;
+  if (t.device.device_type != kDLCUDA &&
+      t.device.device_type != kDLCUDAManaged) {
+    throw std::invalid_argument("The array is not on a CUDA device");
+  }
+  if (t.dtype.code == kDLFloat && t.dtype.bits == 32 && t.dtype.lanes == 1) {
+    array.is_complex = false;
+  } else if (t.dtype.code == kDLComplex && t.dtype.bits == 64 &&
+             t.dtype.lanes == 1) {
+    array.is_complex = true;
+  } else {
+    throw std::invalid_argument(
+        "Unsupported dtype. float32 or complex64 is expected");
+  }
+
+  array.ptr = static_cast<std::uint8_t *>(t.data) + t.byte_offset;
+  array.shape = std::vector<std::int64_t>(t.shape, t.shape + t.ndim);
+  if (t.strides == nullptr) {
+    set_compact_strides(array);
+  } else {
+    array.strides = std::vector<std::int64_t>(t.strides, t.strides + t.ndim);
+  }
+  return array;
+}
+
+array_t get_array(const pybind11::object obj, const std::uintptr_t stream) {
+  if (pybind11::hasattr(obj, "__cuda_array_interface__")) {
+    return get_array_from_cai(obj.attr("__cuda_array_interface__"), stream);
+  }
+  if (pybind11::hasattr(obj, "__dlpack__")) {
+    return get_array_from_dlpack(obj, stream);
+  }
+  throw std::invalid_argument(
+      "The array must support __cuda_array_interface__ or __dlpack__");
+}
+
+// The last two dimensions as a column-major matrix.
+// A row-major matrix is regarded as the transpose of a column-major matrix.
+struct matrix_t {
+  std::uint64_t rows, cols;
+  std::uint64_t ld;
+  bool row_major;
+  std::uint64_t batch_count;
+  std::uint64_t batch_stride;
+};
+
+matrix_t get_matrix(const array_t &array, const bool batched,
+                    const std::string name) {
+  const auto ndim = array.shape.size();
+  if (ndim != (batched ? 3u : 2u)) {
+    throw std::invalid_argument(name + " must be a " +
+                                (batched ? "3" : "2") + "-D array");
+  }
+  matrix_t matrix;
+  matrix.rows = array.shape[ndim - 2];
+  matrix.cols = array.shape[ndim - 1];
+  matrix.batch_count = batched ? array.shape[0] : 1;
+  if (batched && array.strides[0] < 0) {
+    throw std::invalid_argument("The batch stride of " + name +
+                                " must not be negative");
+  }
+  matrix.batch_stride = batched ? array.strides[0] : 0;
+
+  const auto row_stride = array.strides[ndim - 2];
+  const auto col_stride = array.strides[ndim - 1];
+  if ((row_stride == 1 || matrix.rows <= 1) &&
+      (col_stride >= static_cast<std::int64_t>(matrix.rows) ||
+       matrix.cols <= 1)) {
+    matrix.row_major = false;
+    matrix.ld = std::max<std::int64_t>(
+        matrix.cols <= 1 ? matrix.rows : col_stride, 1);
+  } else if ((col_stride == 1 || matrix.cols <= 1) &&
+             (row_stride >= static_cast<std::int64_t>(matrix.cols) ||
+              matrix.rows <= 1)) {
+    matrix.row_major = true;
+    matrix.ld = std::max<std::int64_t>(
+        matrix.rows <= 1 ? matrix.cols : row_stride, 1);
+  } else {
+    throw std::invalid_argument(name + " must be row-major or column-major");
+  }
+  return matrix;
+}
+
+void check_compute_mode(const cuMpSGEMM_compute_mode_t compute_mode) {
+  switch (compute_mode) {
+  case CUMPSGEMM_FP16TCEC:
+  case CUMPSGEMM_TF32TCEC:
+  case CUMPSGEMM_FP16TC:
+  case CUMPSGEMM_TF32TC:
+  case CUMPSGEMM_BF16TCEC:
+    return;
+  default:
+    break;
+  }
+  throw std::invalid_argument(
+      std::string("Unsupported compute mode ") +
+      cuMpSGEMM_get_compute_mode_string(compute_mode) +
+      ". AUTO and the scaling modes are only for the cuBLAS hijacking");
+}
+
+template <class T> T to_scalar(const std::complex<double> v);
+template <> float to_scalar<float>(const std::complex<double> v) {
+  return v.real();
+}
+template <> cuComplex to_scalar<cuComplex>(const std::complex<double> v) {
+  return make_cuComplex(v.real(), v.imag());
+}
+
+// C = alpha * A @ B + beta * C.
+// A row-major C is computed as C^T = B^T @ A^T in column-major.
+template <class T>
+void run_gemm(handle_t &handle, const array_t &a_array, const array_t &b_array,
+              const array_t &c_array, const std::complex<double> alpha,
+              const std::complex<double> beta,
+              const cuMpSGEMM_compute_mode_t compute_mode, const bool batched) {
+  const auto a = get_matrix(a_array, batched, "a");
+  const auto b = get_matrix(b_array, batched, "b");
+  const auto c = get_matrix(c_array, batched, "c");
+  if (a.rows != c.rows || b.cols != c.cols || a.cols != b.rows) {
+    throw std::invalid_argument("The shapes of a, b and c mismatch");
+  }
+  if (a.batch_count != c.batch_count || b.batch_count != c.batch_count) {
+    throw std::invalid_argument("The batch counts of a, b and c mismatch");
+  }
+  // The batches of c would overwrite each other
+  if (batched && c.batch_count > 1 && c.batch_stride == 0) {
+    throw std::invalid_argument("The batch stride of c must not be 0");
+  }
+
+  const auto get_op = [](const matrix_t &m, const bool transposed) {
+    return (m.row_major != transposed) ? CUBLAS_OP_T : CUBLAS_OP_N;
+  };
+  const auto &first = c.row_major ? b : a;
+  const auto &second = c.row_major ? a : b;
+  const auto first_ptr =
+      static_cast<const T *>(c.row_major ? b_array.ptr : a_array.ptr);
+  const auto second_ptr =
+      static_cast<const T *>(c.row_major ? a_array.ptr : b_array.ptr);
+  const auto op_first = get_op(first, c.row_major);
+  const auto op_second = get_op(second, c.row_major);
+  const auto m = c.row_major ? c.cols : c.rows;
+  const auto n = c.row_major ? c.rows : c.cols;
+  const auto k = a.cols;
+
+  const auto alpha_v = to_scalar<T>(alpha);
+  const auto beta_v = to_scalar<T>(beta);
+  cumpsgemm::set_pointer_mode(handle.handle, CUBLAS_POINTER_MODE_HOST);
+
+  cublasStatus_t status;
+  if (batched) {
+    status = cumpsgemm::gemm_stridedBatch<T>(
+        handle.handle, op_first, op_second, m, n, k, &alpha_v, first_ptr,
+        first.ld, first.batch_stride, second_ptr, second.ld,
+        second.batch_stride, &beta_v, static_cast<T *>(c_array.ptr), c.ld,
+        c.batch_stride, c.batch_count, compute_mode);
+  } else {
+    status = cumpsgemm::gemm<T>(handle.handle, op_first, op_second, m, n, k,
+                                &alpha_v, first_ptr, first.ld, second_ptr,
+                                second.ld, &beta_v,
+                                static_cast<T *>(c_array.ptr), c.ld,
+                                compute_mode);
+  }
+  if (status != CUBLAS_STATUS_SUCCESS) {
+    throw std::runtime_error("cuMpSGEMM failed with status " +
+                             std::to_string(status));
+  }
+}
+
+void gemm_core(handle_t &handle, const pybind11::object a_obj,
+               const pybind11::object b_obj, const pybind11::object c_obj,
+               const cuMpSGEMM_compute_mode_t compute_mode,
+               const std::complex<double> alpha,
+               const std::complex<double> beta, const pybind11::object stream,
+               const bool batched) {
+  check_compute_mode(compute_mode);
+  if (!stream.is_none()) {
+    handle.set_stream(stream.cast<std::uintptr_t>());
+  }
+  const auto a = get_array(a_obj, handle.stream);
+  const auto b = get_array(b_obj, handle.stream);
+  const auto c = get_array(c_obj, handle.stream);
+  if (a.is_complex != c.is_complex || b.is_complex != c.is_complex) {
+    throw std::invalid_argument("The dtypes of a, b and c mismatch");
+  }
+
+  if (c.is_complex) {
+    run_gemm<cuComplex>(handle, a, b, c, alpha, beta, compute_mode, batched);
+  } else {
+    run_gemm<float>(handle, a, b, c, alpha, beta, compute_mode, batched);
+  }
+}
+
+void gemm(handle_t &handle, const pybind11::object a,
+          const pybind11::object b, const pybind11::object c,
+          const cuMpSGEMM_compute_mode_t compute_mode,
+          const std::complex<double> alpha, const std::complex<double> beta,
+          const pybind11::object stream) {
+  gemm_core(handle, a, b, c, compute_mode, alpha, beta, stream, false);
+}
+
+void gemm_stridedBatch(handle_t &handle, const pybind11::object a,
+                       const pybind11::object b, const pybind11::object c,
+                       const cuMpSGEMM_compute_mode_t compute_mode,
+                       const std::complex<double> alpha,
+                       const std::complex<double> beta,
+                       const pybind11::object stream) {
+  gemm_core(handle, a, b, c, compute_mode, alpha, beta, stream, true);
+}
+
+// The element order does not matter, so a row-major matrix is counted as its
+// transpose.
+unsigned exp_stats_ext(handle_t &handle, const pybind11::object a_obj,
+                       const pybind11::object stream) {
+  if (!stream.is_none()) {
+    handle.set_stream(stream.cast<std::uintptr_t>());
+  }
+  const auto array = get_array(a_obj, handle.stream);
+  const auto batched = array.shape.size() == 3;
+  const auto a = get_matrix(array, batched, "a");
+  const auto m = a.row_major ? a.cols : a.rows;
+  const auto n = a.row_major ? a.rows : a.cols;
+  if (array.is_complex) {
+    return cumpsgemm::exp_stats_ext<cuComplex>(
+        handle.handle, m, n, static_cast<const cuComplex *>(array.ptr), a.ld,
+        a.batch_count, a.batch_stride);
+  }
+  return cumpsgemm::exp_stats_ext<float>(
+      handle.handle, m, n, static_cast<const float *>(array.ptr), a.ld,
+      a.batch_count, a.batch_stride);
+}
+
+std::pair<std::size_t, std::size_t> get_exp_stats(handle_t &handle,
+                                                  const unsigned buffer_id) {
+  return cumpsgemm::get_exp_stats(handle.handle, buffer_id);
+}
+
+void set_exp_stats_params(handle_t &handle, const float ignore_threshold,
+                          const float underflow_threshold,
+                          const float underflow_tolerance_rate) {
+  cumpsgemm::set_exp_stats_params(handle.handle, ignore_threshold,
+                                  underflow_threshold,
+                                  underflow_tolerance_rate);
+}
+} // namespace
+
+PYBIND11_MODULE(cumpsgemm, m) {
+  m.doc() = "cuMpSGEMM GEMM API";
+
+  pybind11::class_<handle_t>(m, "Handle")
+      .def(pybind11::init<>())
+      .def("set_stream", &handle_t::set_stream, "set_stream",
+           pybind11::arg("stream"));
+
+  m.def("gemm", &gemm,
+        "c = alpha * a @ b + beta * c on the handle stream unless stream is "
+        "given",
+        pybind11::arg("handle"), pybind11::arg("a"), pybind11::arg("b"),
+        pybind11::arg("c"), pybind11::arg("compute_mode"),
+        pybind11::arg("alpha") = 1., pybind11::arg("beta") = 0.,
+        pybind11::arg("stream") = pybind11::none());
+  m.def("gemm_stridedBatch", &gemm_stridedBatch,
+        "c[i] = alpha * a[i] @ b[i] + beta * c[i] on the handle stream unless "
+        "stream is given",
+        pybind11::arg("handle"), pybind11::arg("a"), pybind11::arg("b"),
+        pybind11::arg("c"), pybind11::arg("compute_mode"),
+        pybind11::arg("alpha") = 1., pybind11::arg("beta") = 0.,
+        pybind11::arg("stream") = pybind11::none());
+
+  m.def("exp_stats_ext", &exp_stats_ext, "exp_stats_ext",
+        pybind11::arg("handle"), pybind11::arg("a"),
+        pybind11::arg("stream") = pybind11::none());
+  m.def("get_exp_stats", &get_exp_stats, "get_exp_stats",
+        pybind11::arg("handle"), pybind11::arg("buffer_id"));
+  m.def("set_exp_stats_params", &set_exp_stats_params, "set_exp_stats_params",
+        pybind11::arg("handle"), pybind11::arg("ignore_threshold"),
+        pybind11::arg("underflow_threshold"),
+        pybind11::arg("underflow_tolerance_rate"));
+
+  // module_local since cumpsgemm_hijack_control registers the same enum
+  pybind11::enum_<cuMpSGEMM_compute_mode_t>(m, "compute_mode",
+                                            pybind11::module_local())
+      .value("CUMPSGEMM_FP16TCEC", CUMPSGEMM_FP16TCEC)
+      .value("CUMPSGEMM_TF32TCEC", CUMPSGEMM_TF32TCEC)
+      .value("CUMPSGEMM_FP16TC", CUMPSGEMM_FP16TC)
+      .value("CUMPSGEMM_TF32TC", CUMPSGEMM_TF32TC)
+      .value("CUMPSGEMM_BF16TCEC", CUMPSGEMM_BF16TCEC)
+      .export_values();
+}
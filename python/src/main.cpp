@@ -1,6 +1,8 @@
 #include <cumpsgemm/hijack_control.hpp>
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
@@ -30,6 +32,21 @@ bool is_library_loaded() { return false; }
 
 void set_control_function(const control_function_t){};
 void unset_control_function(){};
+void set_memoized_control_function(const control_function_t){};
+void set_control_rules(const std::string){};
+void unset_control_rules(){};
+
+void enable_compute_mode_cache(){};
+void disable_compute_mode_cache(){};
+void clear_compute_mode_cache(){};
+std::pair<std::size_t, std::size_t> get_compute_mode_cache_stats() {
+  return std::make_pair(0, 0);
+};
+
+void reload_config(){};
+cuMpSGEMM_compute_mode_t get_config_compute_mode() {
+  return CUMPSGEMM_UNDEFINED;
+}
 } // namespace hijack_control
 } // namespace cumpsgemm
 
@@ -86,23 +103,104 @@ void unset_control_function() {
   cumpsgemm::hijack_control::unset_control_function();
 }
 
+void set_memoized_control_function(
+    const cumpsgemm::hijack_control::control_function_t control_func) {
+  cumpsgemm::hijack_control::set_memoized_control_function(control_func);
+}
+
+// A field of a rule dict: a value, an inclusive range (min, max) where None
+// is unbounded, or a wildcard when the key is missing or None
+std::string get_rule_field(const pybind11::dict rule, const char *const name) {
+  if (!rule.contains(name) || rule[name].is_none()) {
+    return "*";
+  }
+  const pybind11::object value = rule[name];
+  if (pybind11::isinstance<pybind11::tuple>(value)) {
+    const auto range = value.cast<pybind11::tuple>();
+    if (range.size() != 2) {
+      throw std::invalid_argument(std::string(name) +
+                                  " range must be (min, max)");
+    }
+    const auto bound_str = [](const pybind11::handle v) {
+      return v.is_none() ? std::string("")
+                         : pybind11::str(v).cast<std::string>();
+    };
+    return bound_str(range[0]) + ":" + bound_str(range[1]);
+  }
+  return pybind11::str(value);
+}
+
+// The rules are given as a rule file text or a list of dicts such as
+//   {"func": "cublasSgemm_v2", "op": "NT", "m": (None, 1024),
+//    "mode": CUMPSGEMM_FP16TCEC}
+void set_control_rules(const pybind11::object rules) {
+  if (pybind11::isinstance<pybind11::str>(rules)) {
+    cumpsgemm::hijack_control::set_control_rules(rules.cast<std::string>());
+    return;
+  }
+  std::string rules_str;
+  for (const auto item : rules) {
+    const auto rule = item.cast<pybind11::dict>();
+    if (!rule.contains("mode")) {
+      throw std::invalid_argument("A rule must have a mode");
+    }
+    const pybind11::object mode = rule["mode"];
+    std::string mode_str = pybind11::str(mode);
+    if (pybind11::hasattr(mode, "name")) {
+      // "CUMPSGEMM_FP16TCEC" -> "FP16TCEC"
+      mode_str = mode.attr("name").cast<std::string>().substr(10);
+    }
+    for (const auto name : {"func", "op", "m", "n", "k", "batch_count"}) {
+      rules_str += get_rule_field(rule, name) + " ";
+    }
+    rules_str += mode_str + "\n";
+  }
+  cumpsgemm::hijack_control::set_control_rules(rules_str);
+}
+
+void unset_control_rules() { cumpsgemm::hijack_control::unset_control_rules(); }
+
+void enable_compute_mode_cache() {
+  cumpsgemm::hijack_control::enable_compute_mode_cache();
+}
+
+void disable_compute_mode_cache() {
+  cumpsgemm::hijack_control::disable_compute_mode_cache();
+}
+
+void clear_compute_mode_cache() {
+  cumpsgemm::hijack_control::clear_compute_mode_cache();
+}
+
+std::pair<std::size_t, std::size_t> get_compute_mode_cache_stats() {
+  return cumpsgemm::hijack_control::get_compute_mode_cache_stats();
+}
+
+void reload_config() { cumpsgemm::hijack_control::reload_config(); }
+
+// The following parameters may be used in control functions, so the cached
+// compute modes are cleared when they are changed.
 void enable_auto_kernel_selection() {
   global_auto_kernel_selection_enabled = true;
+  clear_compute_mode_cache();
 }
 void disable_auto_kernel_selection() {
   global_auto_kernel_selection_enabled = false;
+  clear_compute_mode_cache();
 }
 bool is_auto_kernel_selection_enabled() {
   return global_auto_kernel_selection_enabled;
 }
 void set_global_cublas_dim_mn_threshold(const unsigned dim) {
   global_cublas_dim_mn_threshold = dim;
+  clear_compute_mode_cache();
 }
 unsigned get_global_cublas_dim_mn_threshold() {
   return global_cublas_dim_mn_threshold;
 }
 void set_global_cublas_dim_k_threshold(const unsigned dim) {
   global_cublas_dim_k_threshold = dim;
+  clear_compute_mode_cache();
 }
 unsigned get_global_cublas_dim_k_threshold() {
   return global_cublas_dim_k_threshold;
@@ -139,6 +237,22 @@ PYBIND11_MODULE(cumpsgemm_hijack_control, m) {
         pybind11::arg("control_func"));
   m.def("unset_control_function", &unset_control_function,
         "unset_control_function");
+  m.def("set_memoized_control_function", &set_memoized_control_function,
+        "set_memoized_control_function", pybind11::arg("control_func"));
+  m.def("set_control_rules", &set_control_rules, "set_control_rules",
+        pybind11::arg("rules"));
+  m.def("unset_control_rules", &unset_control_rules, "unset_control_rules");
+
+  m.def("enable_compute_mode_cache", &enable_compute_mode_cache,
+        "enable_compute_mode_cache");
+  m.def("disable_compute_mode_cache", &disable_compute_mode_cache,
+        "disable_compute_mode_cache");
+  m.def("clear_compute_mode_cache", &clear_compute_mode_cache,
+        "clear_compute_mode_cache");
+  m.def("get_compute_mode_cache_stats", &get_compute_mode_cache_stats,
+        "get_compute_mode_cache_stats");
+
+  m.def("reload_config", &reload_config, "reload_config");
 
   pybind11::enum_<cuMpSGEMM_compute_mode_t>(m, "compute_mode")
       .value("CUMPSGEMM_CUBLAS", CUMPSGEMM_CUBLAS)
@@ -151,6 +265,7 @@ PYBIND11_MODULE(cumpsgemm_hijack_control, m) {
       .value("CUMPSGEMM_CUBLAS_TF32TC", CUMPSGEMM_CUBLAS_TF32TC)
       .value("CUMPSGEMM_DRY_RUN", CUMPSGEMM_DRY_RUN)
       .value("CUMPSGEMM_AUTO", CUMPSGEMM_AUTO)
+      .value("CUMPSGEMM_BF16TCEC", CUMPSGEMM_BF16TCEC)
       .export_values();
 
   m.def("enable_auto_kernel_selection", &enable_auto_kernel_selection,
@@ -0,0 +1,52 @@
+import cumpsgemm
+import cupy
+
+handle = cumpsgemm.Handle()
+handle.set_stream(cupy.cuda.get_current_stream().ptr)
+
+compute_mode_list = [
+        cumpsgemm.CUMPSGEMM_FP16TCEC,
+        cumpsgemm.CUMPSGEMM_TF32TCEC,
+        cumpsgemm.CUMPSGEMM_BF16TCEC,
+        ]
+
+# An array exposing only __dlpack__
+class DLPackArray:
+    def __init__(self, array):
+        self.array = array
+
+    def __dlpack__(self, stream=None):
+        return self.array.__dlpack__(stream=stream)
+
+def relative_error(c, ref):
+    return float(cupy.linalg.norm(c - ref) / cupy.linalg.norm(ref))
+
+m, n, k = 300, 200, 100
+for dtype in ['f', 'F']:
+    a = cupy.random.rand(m, k).astype(dtype)
+    b = cupy.random.rand(k, n).astype(dtype)
+    # Compute the reference in double precision
+    ref = cupy.matmul(a.astype('D'), b.astype('D'))
+    for compute_mode in compute_mode_list:
+        # Row-major, column-major and transposed views
+        for (a_, b_) in [(a, b), (cupy.asfortranarray(a), b), (a, b.T.copy().T)]:
+            c = cupy.zeros((m, n), dtype=dtype)
+            cumpsgemm.gemm(handle, a_, b_, c, compute_mode=compute_mode)
+            print(dtype, compute_mode, relative_error(c, ref))
+
+        c = cupy.zeros((m, n), dtype=dtype)
+        cumpsgemm.gemm(handle, DLPackArray(a), DLPackArray(b), DLPackArray(c),
+                       compute_mode=compute_mode)
+        print(dtype, compute_mode, 'DLPack', relative_error(c, ref))
+
+    batch_count = 4
+    a = cupy.random.rand(batch_count, m, k).astype(dtype)
+    b = cupy.random.rand(batch_count, k, n).astype(dtype)
+    c = cupy.zeros((batch_count, m, n), dtype=dtype)
+    ref = cupy.matmul(a.astype('D'), b.astype('D'))
+    cumpsgemm.gemm_stridedBatch(handle, a, b, c,
+                                compute_mode=cumpsgemm.CUMPSGEMM_TF32TCEC)
+    print(dtype, 'stridedBatch', relative_error(c, ref))
+
+buffer_id = cumpsgemm.exp_stats_ext(handle, cupy.random.rand(m, k).astype('f'))
+print('exp_stats (underflow, total) =', cumpsgemm.get_exp_stats(handle, buffer_id))
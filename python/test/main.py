@@ -10,6 +10,7 @@ compute_mode_list = [
         chc.CUMPSGEMM_TF32TCEC,
         chc.CUMPSGEMM_FP16TC,
         chc.CUMPSGEMM_TF32TC,
+        chc.CUMPSGEMM_BF16TCEC,
         chc.CUMPSGEMM_AUTO,
         ]
 
@@ -18,6 +19,7 @@ compute_mode_name_table = {
         chc.CUMPSGEMM_TF32TCEC : 'CUMPSGEMM_TF32TCEC',
         chc.CUMPSGEMM_FP16TC   : 'CUMPSGEMM_FP16TC',
         chc.CUMPSGEMM_TF32TC   : 'CUMPSGEMM_TF32TC',
+        chc.CUMPSGEMM_BF16TCEC : 'CUMPSGEMM_BF16TCEC',
         chc.CUMPSGEMM_CUBLAS   : 'CUMPSGEMM_CUBLAS',
         }
 
@@ -25,3 +27,19 @@ for compute_mode in compute_mode_list:
     print(compute_mode_name_table[compute_mode])
     chc.set_control_function(lambda op_A, op_B, m, n, k : compute_mode)
     cupy.matmul(a, b)
+chc.unset_control_function()
+
+for compute_mode in compute_mode_list:
+    print(compute_mode_name_table[compute_mode] + ' (memoized)')
+    chc.set_memoized_control_function(lambda op_A, op_B, m, n, k : compute_mode)
+    cupy.matmul(a, b)
+chc.unset_control_function()
+
+for compute_mode in compute_mode_list:
+    print(compute_mode_name_table[compute_mode] + ' (rules)')
+    chc.set_control_rules([
+        {"m": (1000, None), "n": 1000, "mode": compute_mode},
+        {"mode": chc.CUMPSGEMM_CUBLAS},
+        ])
+    cupy.matmul(a, b)
+chc.unset_control_rules()
@@ -0,0 +1,136 @@
+#include "capture.hpp"
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+const std::string capture_env_name = "CUMPSGEMM_CAPTURE";
+
+// The calls are buffered and written in the order of the calls. The buffer is
+// written when it has `flush_num_calls` calls or `flush_interval_ns` has passed
+// since the last write, so a crash loses only the last calls.
+constexpr std::size_t flush_num_calls = 256;
+constexpr std::uint64_t flush_interval_ns = 100'000'000lu;
+
+class writer_t {
+  std::mutex mutex;
+  int fd = -1;
+  std::map<cudaStream_t, std::uint32_t> stream_id_map;
+  std::vector<cumpsgemm::capture::call_t> buffer;
+  std::uint64_t last_flush_ns = 0;
+
+  // A call is not split by a partial write unless the process is killed in it
+  void flush() {
+    const auto ptr = reinterpret_cast<const char *>(buffer.data());
+    const auto size = sizeof(cumpsgemm::capture::call_t) * buffer.size();
+    for (std::size_t offset = 0; offset < size;) {
+      const auto written = ::write(fd, ptr + offset, size - offset);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+      offset += written;
+    }
+    buffer.clear();
+    last_flush_ns = cumpsgemm::trace::get_timestamp_ns();
+  }
+
+public:
+  writer_t() {
+    const auto path_env = getenv(capture_env_name.c_str());
+    if (path_env == nullptr) {
+      return;
+    }
+    fd = open(path_env, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return;
+    }
+    buffer.reserve(flush_num_calls);
+    cumpsgemm::capture::file_header_t header{};
+    header.magic = cumpsgemm::capture::magic;
+    header.version = cumpsgemm::capture::version;
+    header.call_size = sizeof(cumpsgemm::capture::call_t);
+    if (::write(fd, &header, sizeof(header)) !=
+        static_cast<ssize_t>(sizeof(header))) {
+      close(fd);
+      fd = -1;
+      return;
+    }
+    last_flush_ns = cumpsgemm::trace::get_timestamp_ns();
+  }
+
+  ~writer_t() {
+    if (fd >= 0) {
+      flush();
+      close(fd);
+    }
+  }
+
+  void write(cumpsgemm::capture::call_t &call, cudaStream_t const cuda_stream) {
+    if (fd < 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    // Taken under the lock, so that the timestamps increase in the file order
+    // and are not older than last_flush_ns
+    call.timestamp_ns = cumpsgemm::trace::get_timestamp_ns();
+    const auto stream_id = stream_id_map.insert(std::make_pair(
+        cuda_stream, static_cast<std::uint32_t>(stream_id_map.size())));
+    call.stream_id = stream_id.first->second;
+    buffer.push_back(call);
+    if (buffer.size() >= flush_num_calls ||
+        call.timestamp_ns - last_flush_ns >= flush_interval_ns) {
+      flush();
+    }
+  }
+};
+
+writer_t &get_writer() {
+  static writer_t writer;
+  return writer;
+}
+
+std::atomic<std::uint32_t> num_threads{0};
+} // namespace
+
+bool cumpsgemm::capture::is_enabled() {
+  static const bool enabled = getenv(capture_env_name.c_str()) != nullptr;
+  return enabled;
+}
+
+void cumpsgemm::capture::write(call_t call, cudaStream_t const cuda_stream) {
+  thread_local const std::uint32_t thread_id = num_threads++;
+  call.thread_id = thread_id;
+  get_writer().write(call, cuda_stream);
+}
+
+std::vector<cumpsgemm::capture::call_t>
+cumpsgemm::capture::load(const std::string file_path) {
+  std::ifstream ifs(file_path, std::ios::binary);
+  if (!ifs) {
+    throw std::runtime_error("failed to open " + file_path);
+  }
+
+  file_header_t header;
+  if (!ifs.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      header.magic != magic || header.version != version ||
+      header.call_size != sizeof(call_t)) {
+    throw std::runtime_error(file_path + ": invalid capture header");
+  }
+
+  std::vector<call_t> calls;
+  call_t call;
+  while (ifs.read(reinterpret_cast<char *>(&call), sizeof(call))) {
+    calls.push_back(call);
+  }
+  // A partial call at the end is the one being written at a crash, and is
+  // ignored
+  return calls;
+}
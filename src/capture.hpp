@@ -0,0 +1,119 @@
+#pragma once
+#include "trace.hpp"
+#include <cstdint>
+#include <cuComplex.h>
+#include <cumpsgemm/cumpsgemm.h>
+#include <string>
+#include <vector>
+
+namespace cumpsgemm {
+namespace capture {
+enum scalar_class_t : std::uint8_t {
+  scalar_zero = 0,
+  scalar_one = 1,
+  scalar_other = 2,
+  // The value is in the device memory and unknown on the host
+  scalar_device = 3,
+};
+
+// A hijacked call with the parameters needed to replay it.
+// The function id is the one of trace::func_name_list.
+struct call_t {
+  // CLOCK_MONOTONIC at the call
+  std::uint64_t timestamp_ns;
+  std::uint64_t m, n, k;
+  std::uint64_t lda, ldb, ldc;
+  std::uint64_t stridea, strideb, stridec;
+  std::uint64_t batch_count;
+  std::uint32_t func_id;
+  // Sequential ids assigned in the order of the first call
+  std::uint32_t thread_id;
+  std::uint32_t stream_id;
+  std::uint8_t op_A;
+  std::uint8_t op_B;
+  std::uint8_t compute_mode;
+  std::uint8_t is_complex;
+  std::uint8_t alpha_class;
+  std::uint8_t beta_class;
+  std::uint8_t reserved[6];
+};
+static_assert(sizeof(call_t) == 112, "The call size must be 112 bytes");
+
+// A capture file is a header followed by the calls in the order of writing
+struct file_header_t {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t call_size;
+  std::uint8_t reserved[48];
+};
+static_assert(sizeof(file_header_t) == 64, "The header size must be 64 bytes");
+
+constexpr std::uint64_t magic = 0x5450414353504d43lu;
+constexpr std::uint32_t version = 1;
+
+// Enabled by CUMPSGEMM_CAPTURE=/path/to/output
+bool is_enabled();
+
+// Sets the timestamp, thread id and stream id and appends the call to the file
+void write(call_t call, cudaStream_t const cuda_stream);
+
+// Throws std::runtime_error when the file is invalid
+std::vector<call_t> load(const std::string file_path);
+
+inline std::uint8_t get_scalar_class(const void *const ptr,
+                                     const bool is_complex,
+                                     const cublasPointerMode_t pointer_mode) {
+  if (pointer_mode == CUBLAS_POINTER_MODE_DEVICE) {
+    return scalar_device;
+  }
+  float re = *static_cast<const float *>(ptr), im = 0;
+  if (is_complex) {
+    const auto v = *static_cast<const cuComplex *>(ptr);
+    re = v.x;
+    im = v.y;
+  }
+  if (re == 0 && im == 0) {
+    return scalar_zero;
+  }
+  if (re == 1 && im == 0) {
+    return scalar_one;
+  }
+  return scalar_other;
+}
+
+inline void capture_call(
+    const char *const func_name, cudaStream_t const cuda_stream,
+    const bool is_complex, const cublasPointerMode_t pointer_mode,
+    const cublasOperation_t op_A, const cublasOperation_t op_B,
+    const std::uint64_t m, const std::uint64_t n, const std::uint64_t k,
+    const void *const alpha, const std::uint64_t lda,
+    const std::uint64_t stridea, const std::uint64_t ldb,
+    const std::uint64_t strideb, const void *const beta,
+    const std::uint64_t ldc, const std::uint64_t stridec,
+    const std::uint64_t batch_count,
+    const cuMpSGEMM_compute_mode_t compute_mode) {
+  if (!is_enabled()) {
+    return;
+  }
+  call_t call{};
+  call.m = m;
+  call.n = n;
+  call.k = k;
+  call.lda = lda;
+  call.ldb = ldb;
+  call.ldc = ldc;
+  call.stridea = stridea;
+  call.strideb = strideb;
+  call.stridec = stridec;
+  call.batch_count = batch_count;
+  call.func_id = trace::get_func_id(func_name);
+  call.op_A = op_A;
+  call.op_B = op_B;
+  call.compute_mode = compute_mode;
+  call.is_complex = is_complex;
+  call.alpha_class = get_scalar_class(alpha, is_complex, pointer_mode);
+  call.beta_class = get_scalar_class(beta, is_complex, pointer_mode);
+  write(call, cuda_stream);
+}
+} // namespace capture
+} // namespace cumpsgemm
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cumpsgemm/cumpsgemm.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cumpsgemm {
+namespace compute_mode_cache {
+// The func_name is compared by its address since it is `__func__` of the
+// hijacking function.
+// The cuBLAS handle is a part of the key since the rule library may select
+// the mode by the handle.
+struct key_t {
+  std::uint64_t epoch;
+  const char *func_name;
+  const void *cublas_handle;
+  cublasOperation_t op_A;
+  cublasOperation_t op_B;
+  unsigned m, n, k;
+  std::uint64_t batch_count;
+
+  bool operator==(const key_t &key) const {
+    return epoch == key.epoch && func_name == key.func_name &&
+           cublas_handle == key.cublas_handle && op_A == key.op_A &&
+           op_B == key.op_B && m == key.m && n == key.n && k == key.k &&
+           batch_count == key.batch_count;
+  }
+};
+
+inline std::uint64_t get_hash(const key_t &key) {
+  // FNV-1a
+  std::uint64_t hash = 0xcbf29ce484222325lu;
+  const auto mix = [&](const std::uint64_t v) {
+    hash = (hash ^ v) * 0x100000001b3lu;
+  };
+  mix(key.epoch);
+  mix(reinterpret_cast<std::uintptr_t>(key.func_name));
+  mix(reinterpret_cast<std::uintptr_t>(key.cublas_handle));
+  mix((static_cast<std::uint64_t>(key.op_A) << 4) | key.op_B);
+  mix(key.m);
+  mix(key.n);
+  mix(key.k);
+  mix(key.batch_count);
+  return hash ^ (hash >> 32);
+}
+
+// Open addressing hash table with linear probing.
+// An entry of an old epoch is never hit and is overwritten by a new one.
+class table_t {
+  static constexpr unsigned num_entries = 256;
+  static constexpr unsigned max_num_probes = 8;
+
+  struct entry_t {
+    key_t key;
+    cuMpSGEMM_compute_mode_t compute_mode;
+    bool valid = false;
+  };
+  entry_t entries[num_entries];
+
+public:
+  bool find(const key_t &key, cuMpSGEMM_compute_mode_t &compute_mode) const {
+    const auto hash = get_hash(key);
+    for (unsigned i = 0; i < max_num_probes; i++) {
+      const auto &entry = entries[(hash + i) & (num_entries - 1)];
+      if (!entry.valid) {
+        return false;
+      }
+      if (entry.key == key) {
+        compute_mode = entry.compute_mode;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void insert(const key_t &key, const cuMpSGEMM_compute_mode_t compute_mode) {
+    const auto hash = get_hash(key);
+    for (unsigned i = 0; i < max_num_probes; i++) {
+      auto &entry = entries[(hash + i) & (num_entries - 1)];
+      if (!entry.valid || entry.key.epoch != key.epoch) {
+        entry = entry_t{key, compute_mode, true};
+        return;
+      }
+    }
+    // Replace the home entry when all probed entries are in use
+    entries[hash & (num_entries - 1)] = entry_t{key, compute_mode, true};
+  }
+};
+
+// Hit/miss counters.
+// Each thread counts on its own counter, and they are summed up on query.
+struct counter_t {
+  std::atomic<std::uint64_t> num_hits{0};
+  std::atomic<std::uint64_t> num_misses{0};
+};
+
+inline std::mutex counter_list_mutex;
+inline std::vector<std::shared_ptr<counter_t>> counter_list;
+
+inline std::shared_ptr<counter_t> register_counter() {
+  auto counter = std::make_shared<counter_t>();
+  std::lock_guard<std::mutex> lock(counter_list_mutex);
+  counter_list.push_back(counter);
+  return counter;
+}
+
+inline void increment(std::atomic<std::uint64_t> &count) {
+  count.store(count.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+}
+
+// Returns {num_hits, num_misses}
+inline std::pair<std::size_t, std::size_t> get_stats() {
+  std::size_t num_hits = 0, num_misses = 0;
+  std::lock_guard<std::mutex> lock(counter_list_mutex);
+  for (const auto &counter : counter_list) {
+    num_hits += counter->num_hits.load(std::memory_order_relaxed);
+    num_misses += counter->num_misses.load(std::memory_order_relaxed);
+  }
+  return std::make_pair(num_hits, num_misses);
+}
+} // namespace compute_mode_cache
+} // namespace cumpsgemm
@@ -0,0 +1,249 @@
+#include "config.hpp"
+#include "snapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+const std::string config_file_env_name = "CUMPSGEMM_CONFIG_FILE";
+const std::string reload_signal_env_name = "CUMPSGEMM_CONFIG_RELOAD_SIGNAL";
+constexpr auto watch_interval = std::chrono::milliseconds(500);
+
+const std::vector<std::string> config_env_name_list = {
+    "CUMPSGEMM_INFO",
+    "CUMPSGEMM_ERROR_LOG",
+    "CUMPSGEMM_ENABLE_CULIP_PROFILING",
+    "CUMPSGEMM_CUSTOM_GEMM_MX2X2",
+    "CUMPSGEMM_DETERMINISTIC",
+    "CUMPSGEMM_RASTER_GROUP_WIDTH",
+    "CUMPSGEMM_COMPUTE_MODE",
+    "CUMPSGEMM_RULE_FILE",
+};
+
+const std::map<std::string, cuMpSGEMM_compute_mode_t> compute_mode_list = {
+    {"CUBLAS", CUMPSGEMM_CUBLAS},
+    {"FP16TCEC", CUMPSGEMM_FP16TCEC},
+    {"TF32TCEC", CUMPSGEMM_TF32TCEC},
+    {"FP16TC", CUMPSGEMM_FP16TC},
+    {"TF32TC", CUMPSGEMM_TF32TC},
+    {"CUBLAS_SIMT", CUMPSGEMM_CUBLAS_SIMT},
+    {"CUBLAS_FP16TC", CUMPSGEMM_CUBLAS_FP16TC},
+    {"CUBLAS_TF32TC", CUMPSGEMM_CUBLAS_TF32TC},
+    {"DRY_RUN", CUMPSGEMM_DRY_RUN},
+    {"AUTO", CUMPSGEMM_AUTO},
+    {"FP16TCEC_SCALING", CUMPSGEMM_FP16TCEC_SCALING},
+    {"BF16TCEC", CUMPSGEMM_BF16TCEC},
+};
+
+// The logging functions in utils.hpp read the snapshot, so the messages while
+// building a snapshot are printed directly.
+void print_error(const cumpsgemm::config::config_t &config,
+                 const std::string str) {
+  if (config.error_log_enabled) {
+    std::fprintf(stdout, "[cuMpSGEMM ERROR] %s\n", str.c_str());
+    std::fflush(stdout);
+  }
+}
+
+std::string trim(const std::string str) {
+  const auto begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  const auto end = str.find_last_not_of(" \t\r");
+  return str.substr(begin, end - begin + 1);
+}
+
+bool is_flag_set(const std::map<std::string, std::string> &values,
+                 const std::string name, const bool default_value) {
+  const auto it = values.find(name);
+  if (it == values.end()) {
+    return default_value;
+  }
+  return it->second != "0";
+}
+
+cumpsgemm::config::config_t build_config(const std::uint64_t generation) {
+  std::map<std::string, std::string> values;
+  for (const auto &name : config_env_name_list) {
+    const auto env = getenv(name.c_str());
+    if (env != nullptr) {
+      values[name] = env;
+    }
+  }
+
+  // Lines with an unknown name are reported after the error log flag is known
+  std::vector<std::string> invalid_lines;
+  const auto config_file_path = getenv(config_file_env_name.c_str());
+  if (config_file_path != nullptr) {
+    std::ifstream ifs(config_file_path);
+    std::string line;
+    while (std::getline(ifs, line)) {
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty()) {
+        continue;
+      }
+      const auto pos = line.find('=');
+      const auto name = trim(line.substr(0, pos));
+      bool known = false;
+      for (const auto &env_name : config_env_name_list) {
+        known |= env_name == name;
+      }
+      if (pos == std::string::npos || !known) {
+        invalid_lines.push_back(line);
+        continue;
+      }
+      values[name] = trim(line.substr(pos + 1));
+    }
+  }
+
+  cumpsgemm::config::config_t config;
+  config.generation = generation;
+  config.info_enabled = is_flag_set(values, "CUMPSGEMM_INFO", false);
+  config.error_log_enabled = is_flag_set(values, "CUMPSGEMM_ERROR_LOG", true);
+  config.warning_log_enabled =
+      is_flag_set(values, "CUMPSGEMM_ERROR_LOG", false);
+  config.culip_profiling_enabled =
+      is_flag_set(values, "CUMPSGEMM_ENABLE_CULIP_PROFILING", false);
+  config.custom_gemm_Mx2x2_enabled =
+      is_flag_set(values, "CUMPSGEMM_CUSTOM_GEMM_MX2X2", false);
+  config.deterministic_enabled =
+      is_flag_set(values, "CUMPSGEMM_DETERMINISTIC", false);
+
+  const auto raster_group_width_it =
+      values.find("CUMPSGEMM_RASTER_GROUP_WIDTH");
+  if (raster_group_width_it != values.end()) {
+    const auto &str = raster_group_width_it->second;
+    char *end;
+    const auto width = std::strtol(str.c_str(), &end, 10);
+    if (!str.empty() && *end == '\0' && 0 <= width && width <= 0xffff) {
+      config.raster_group_width = width;
+    } else {
+      print_error(config,
+                  "Invalid CUMPSGEMM_RASTER_GROUP_WIDTH = " + str + ". Ignored");
+    }
+  }
+
+  const auto compute_mode_it = values.find("CUMPSGEMM_COMPUTE_MODE");
+  if (compute_mode_it != values.end()) {
+    const auto mode = compute_mode_list.find(compute_mode_it->second);
+    if (mode != compute_mode_list.end()) {
+      config.compute_mode = mode->second;
+    } else {
+      print_error(config, "Unknown CUMPSGEMM_COMPUTE_MODE = " +
+                              compute_mode_it->second + ". Ignored");
+    }
+  }
+
+  const auto rule_file_it = values.find("CUMPSGEMM_RULE_FILE");
+  if (rule_file_it != values.end()) {
+    config.rule_file_path = rule_file_it->second;
+  }
+
+  for (const auto &line : invalid_lines) {
+    print_error(config, std::string(config_file_path) + ": invalid line \"" +
+                            line + "\". Ignored");
+  }
+
+  return config;
+}
+
+cumpsgemm::snapshot_t<cumpsgemm::config::config_t> current_config;
+
+void publish_config() {
+  current_config.update([](const cumpsgemm::config::config_t *const current) {
+    return build_config(current == nullptr ? 0 : current->generation + 1);
+  });
+}
+
+std::atomic<bool> reload_signal_received(false);
+void reload_signal_handler(int) {
+  reload_signal_received.store(true, std::memory_order_relaxed);
+}
+
+// Polls the modification time of the control file and the signal flag
+class watcher_t {
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stop = false;
+
+  static struct timespec get_mtime(const char *const path) {
+    struct stat st;
+    if (path == nullptr || stat(path, &st) != 0) {
+      return timespec{0, 0};
+    }
+    return st.st_mtim;
+  }
+
+public:
+  watcher_t() {
+    const auto config_file_path = getenv(config_file_env_name.c_str());
+    const auto signal_env = getenv(reload_signal_env_name.c_str());
+    if (signal_env != nullptr) {
+      struct sigaction sa = {};
+      sa.sa_handler = reload_signal_handler;
+      sa.sa_flags = SA_RESTART;
+      sigemptyset(&sa.sa_mask);
+      sigaction(std::atoi(signal_env), &sa, nullptr);
+    }
+    if (config_file_path == nullptr && signal_env == nullptr) {
+      return;
+    }
+
+    thread = std::thread([this, config_file_path]() {
+      auto last_mtime = get_mtime(config_file_path);
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!cv.wait_for(lock, watch_interval, [this]() { return stop; })) {
+        const auto mtime = get_mtime(config_file_path);
+        const auto modified = mtime.tv_sec != last_mtime.tv_sec ||
+                              mtime.tv_nsec != last_mtime.tv_nsec;
+        last_mtime = mtime;
+        if (reload_signal_received.exchange(false) || modified) {
+          publish_config();
+        }
+      }
+    });
+  }
+
+  ~watcher_t() {
+    if (thread.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      cv.notify_all();
+      thread.join();
+    }
+  }
+};
+
+bool initialize() {
+  publish_config();
+  static watcher_t watcher;
+  return true;
+}
+} // namespace
+
+std::shared_ptr<const cumpsgemm::config::config_t>
+cumpsgemm::config::get() {
+  // The initialization of a function-local static is thread-safe
+  static const auto initialized = initialize();
+  static_cast<void>(initialized);
+  return current_config.load();
+}
+
+void cumpsgemm::config::reload() {
+  get();
+  publish_config();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <cumpsgemm/cumpsgemm.h>
+#include <memory>
+#include <string>
+
+namespace cumpsgemm {
+namespace config {
+// The environment variables and the control file parsed into an immutable
+// snapshot. The snapshot is published through snapshot_t, so that a lookup is
+// a single load while the snapshot is not replaced. A replaced snapshot is
+// freed when no one refers to it.
+//
+// The control file specified by CUMPSGEMM_CONFIG_FILE has the same
+// `NAME=VALUE` lines as the environment variables and overrides them.
+// The snapshot is rebuilt when the file is modified, when the signal specified
+// by CUMPSGEMM_CONFIG_RELOAD_SIGNAL is received, or when `reload` is called.
+struct config_t {
+  // Incremented on every reload
+  std::uint64_t generation = 0;
+
+  // CUMPSGEMM_INFO
+  bool info_enabled = false;
+  // CUMPSGEMM_ERROR_LOG. The warnings are printed only if it is set explicitly.
+  bool error_log_enabled = true;
+  bool warning_log_enabled = false;
+  // CUMPSGEMM_ENABLE_CULIP_PROFILING
+  bool culip_profiling_enabled = false;
+  // CUMPSGEMM_CUSTOM_GEMM_MX2X2
+  bool custom_gemm_Mx2x2_enabled = false;
+  // CUMPSGEMM_DETERMINISTIC
+  bool deterministic_enabled = false;
+  // CUMPSGEMM_RASTER_GROUP_WIDTH, or -1 if not set or invalid
+  int raster_group_width = -1;
+  // CUMPSGEMM_COMPUTE_MODE, or CUMPSGEMM_UNDEFINED if not set or invalid
+  cuMpSGEMM_compute_mode_t compute_mode = CUMPSGEMM_UNDEFINED;
+  // CUMPSGEMM_RULE_FILE, or empty if not set
+  std::string rule_file_path;
+};
+
+std::shared_ptr<const config_t> get();
+
+// Rebuilds the snapshot from the environment variables and the control file
+void reload();
+} // namespace config
+} // namespace cumpsgemm
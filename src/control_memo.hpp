@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cumpsgemm/hijack_control.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cumpsgemm {
+namespace control_memo {
+struct key_t {
+  int op_A, op_B;
+  unsigned m, n, k;
+
+  bool operator==(const key_t &key) const {
+    return op_A == key.op_A && op_B == key.op_B && m == key.m && n == key.n &&
+           k == key.k;
+  }
+};
+
+inline std::uint64_t get_hash(const key_t &key) {
+  // FNV-1a
+  std::uint64_t hash = 0xcbf29ce484222325lu;
+  const auto mix = [&](const std::uint64_t v) {
+    hash = (hash ^ v) * 0x100000001b3lu;
+  };
+  mix((static_cast<std::uint64_t>(key.op_A) << 4) | key.op_B);
+  mix(key.m);
+  mix(key.n);
+  mix(key.k);
+  return hash ^ (hash >> 32);
+}
+
+// The compute modes selected by a control function, shared among threads.
+// A hit is lock-free: the entries are never modified after they are published,
+// and a full table is replaced by a copy of twice the size. The replaced tables
+// are kept alive since other threads may still be reading them.
+// The control function is called without holding the lock, since it may wait
+// for a lock of the caller (e.g. the Python GIL). It may be called more than
+// once for a key when threads miss at the same time.
+class memo_t {
+  struct entry_t {
+    key_t key;
+    cuMpSGEMM_compute_mode_t compute_mode;
+    std::atomic<bool> valid{false};
+  };
+  struct table_t {
+    std::unique_ptr<entry_t[]> entries;
+    std::size_t num_entries;
+    std::size_t num_used = 0;
+
+    table_t(const std::size_t num_entries)
+        : entries(new entry_t[num_entries]), num_entries(num_entries) {}
+  };
+
+  const cumpsgemm::hijack_control::control_function_t control_func;
+  std::atomic<table_t *> current_table;
+  std::vector<std::unique_ptr<table_t>> table_list;
+  std::mutex mutex;
+  std::atomic<std::uint64_t> num_calls{0};
+
+  static bool find(const table_t &table, const key_t &key,
+                   cuMpSGEMM_compute_mode_t &compute_mode) {
+    const auto mask = table.num_entries - 1;
+    for (auto i = get_hash(key) & mask;; i = (i + 1) & mask) {
+      const auto &entry = table.entries[i];
+      if (!entry.valid.load(std::memory_order_acquire)) {
+        return false;
+      }
+      if (entry.key == key) {
+        compute_mode = entry.compute_mode;
+        return true;
+      }
+    }
+  }
+
+  // The load factor is kept at most 1/2, so an empty entry always exists
+  static void insert(table_t &table, const key_t &key,
+                     const cuMpSGEMM_compute_mode_t compute_mode) {
+    const auto mask = table.num_entries - 1;
+    for (auto i = get_hash(key) & mask;; i = (i + 1) & mask) {
+      auto &entry = table.entries[i];
+      if (!entry.valid.load(std::memory_order_relaxed)) {
+        entry.key = key;
+        entry.compute_mode = compute_mode;
+        entry.valid.store(true, std::memory_order_release);
+        table.num_used++;
+        return;
+      }
+    }
+  }
+
+public:
+  static constexpr std::size_t initial_num_entries = 256;
+
+  memo_t(const cumpsgemm::hijack_control::control_function_t control_func)
+      : control_func(control_func) {
+    table_list.push_back(std::make_unique<table_t>(initial_num_entries));
+    current_table.store(table_list.back().get(), std::memory_order_release);
+  }
+
+  cuMpSGEMM_compute_mode_t get(const int op_A, const int op_B,
+                               const unsigned m, const unsigned n,
+                               const unsigned k) {
+    const key_t key{op_A, op_B, m, n, k};
+    cuMpSGEMM_compute_mode_t compute_mode;
+    if (find(*current_table.load(std::memory_order_acquire), key,
+             compute_mode)) {
+      return compute_mode;
+    }
+
+    const auto new_compute_mode = control_func(op_A, op_B, m, n, k);
+    num_calls.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto table = current_table.load(std::memory_order_relaxed);
+    // Another thread may have inserted it
+    if (find(*table, key, compute_mode)) {
+      return compute_mode;
+    }
+    if ((table->num_used + 1) * 2 > table->num_entries) {
+      auto new_table = std::make_unique<table_t>(table->num_entries * 2);
+      for (std::size_t i = 0; i < table->num_entries; i++) {
+        const auto &entry = table->entries[i];
+        if (entry.valid.load(std::memory_order_relaxed)) {
+          insert(*new_table, entry.key, entry.compute_mode);
+        }
+      }
+      table = new_table.get();
+      table_list.push_back(std::move(new_table));
+    }
+    insert(*table, key, new_compute_mode);
+    current_table.store(table, std::memory_order_release);
+    return new_compute_mode;
+  }
+
+  // The number of the control function calls
+  std::uint64_t get_num_calls() const {
+    return num_calls.load(std::memory_order_relaxed);
+  }
+};
+} // namespace control_memo
+} // namespace cumpsgemm
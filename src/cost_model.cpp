@@ -0,0 +1,260 @@
+#include "cost_model.hpp"
+#include <algorithm>
+
+namespace {
+std::uint64_t ceil_div(const std::uint64_t a, const std::uint64_t b) {
+  return (a + b - 1) / b;
+}
+
+// The cycles of a wave in which the busiest SM runs `num_resident_blocks`
+// blocks of `num_k_steps` k-steps
+double get_wave_cycles(const cumpsgemm::gemm_module &gemm_module,
+                       const cumpsgemm::cost_model::device_t &device,
+                       const std::uint64_t num_resident_blocks,
+                       const std::uint64_t num_k_steps, const bool is_complex,
+                       const double store_bytes_per_block) {
+  const double element_size = is_complex ? 8 : 4;
+  const double macs_per_mac = is_complex ? 4 : 1;
+  const auto num_warps = num_resident_blocks * gemm_module.block_size / 32;
+  const auto utilization =
+      std::min(1.0, static_cast<double>(num_warps) /
+                        std::max(1u, device.num_saturating_warps));
+
+  const double macs_per_k_step = static_cast<double>(gemm_module.smem_m) *
+                                 gemm_module.smem_n * gemm_module.smem_k *
+                                 macs_per_mac;
+  const double bytes_per_k_step =
+      static_cast<double>(gemm_module.smem_m + gemm_module.smem_n) *
+      gemm_module.smem_k * element_size;
+
+  const auto compute_cycles = num_resident_blocks * num_k_steps *
+                              macs_per_k_step /
+                              (device.macs_per_cycle * utilization);
+  const auto load_cycles = num_resident_blocks * num_k_steps *
+                           bytes_per_k_step / device.bytes_per_cycle;
+  const auto store_cycles =
+      num_resident_blocks * store_bytes_per_block / device.bytes_per_cycle;
+  return std::max(compute_cycles, load_cycles) + store_cycles +
+         num_k_steps * device.k_step_cycles;
+}
+
+cumpsgemm::cost_model::estimate_t
+estimate_blocks(const cumpsgemm::gemm_module &gemm_module,
+                const cumpsgemm::cost_model::device_t &device,
+                const std::uint64_t num_blocks, const std::uint64_t num_k_steps,
+                const bool is_complex, const double store_bytes_per_block) {
+  const std::uint64_t num_active_blocks =
+      std::max(1u, gemm_module.num_active_blocks);
+  const auto num_slots = std::max(1u, device.num_sms) * num_active_blocks;
+  const auto num_full_waves = num_blocks / num_slots;
+  const auto num_tail_blocks = num_blocks % num_slots;
+
+  cumpsgemm::cost_model::estimate_t estimate;
+  estimate.num_blocks = num_blocks;
+  estimate.num_waves = num_full_waves + (num_tail_blocks != 0 ? 1 : 0);
+  estimate.tail_efficiency =
+      estimate.num_waves == 0
+          ? 1.
+          : static_cast<double>(num_blocks) / (estimate.num_waves * num_slots);
+
+  estimate.cycles = device.launch_cycles;
+  if (num_full_waves != 0) {
+    estimate.cycles +=
+        num_full_waves * get_wave_cycles(gemm_module, device, num_active_blocks,
+                                         num_k_steps, is_complex,
+                                         store_bytes_per_block);
+  }
+  if (num_tail_blocks != 0) {
+    estimate.cycles += get_wave_cycles(
+        gemm_module, device, ceil_div(num_tail_blocks, device.num_sms),
+        num_k_steps, is_complex, store_bytes_per_block);
+  }
+  return estimate;
+}
+} // unnamed namespace
+
+cumpsgemm::cost_model::estimate_t cumpsgemm::cost_model::estimate(
+    const cumpsgemm::gemm_module &gemm_module, const device_t &device,
+    const std::uint64_t m, const std::uint64_t n, const std::uint64_t k,
+    const std::uint64_t batch_count, const bool is_complex,
+    const bool beta_nonzero) {
+  const double element_size = is_complex ? 8 : 4;
+  const auto num_blocks = ceil_div(m, gemm_module.smem_m) *
+                          ceil_div(n, gemm_module.smem_n) * batch_count;
+  // C is read only when beta is non-zero
+  const auto store_bytes_per_block = static_cast<double>(gemm_module.smem_m) *
+                                     gemm_module.smem_n * element_size *
+                                     (beta_nonzero ? 2 : 1);
+  return estimate_blocks(gemm_module, device, num_blocks,
+                         ceil_div(k, gemm_module.smem_k), is_complex,
+                         store_bytes_per_block);
+}
+
+cumpsgemm::cost_model::split_k_plan_t cumpsgemm::cost_model::plan_split_k(
+    const cumpsgemm::gemm_module &gemm_module, const device_t &device,
+    const std::uint64_t m, const std::uint64_t n, const std::uint64_t k,
+    const std::uint64_t workspace_size, const std::uint64_t max_num_tiles) {
+  split_k_plan_t plan;
+  // The modules of the unsupported codes are zero
+  if (gemm_module.smem_m * gemm_module.smem_n * gemm_module.smem_k == 0 ||
+      m * n * k == 0) {
+    return plan;
+  }
+  const auto num_tiles =
+      ceil_div(m, gemm_module.smem_m) * ceil_div(n, gemm_module.smem_n);
+  const auto tile_size =
+      static_cast<std::uint64_t>(gemm_module.smem_m) * gemm_module.smem_n;
+  if (num_tiles > max_num_tiles || num_tiles * tile_size > workspace_size) {
+    return plan;
+  }
+
+  const auto num_slots = static_cast<std::uint64_t>(
+                             std::max(1u, device.num_sms)) *
+                         std::max(1u, gemm_module.num_active_blocks);
+  const auto num_k_steps = ceil_div(k, gemm_module.smem_k);
+  const auto min_k_steps =
+      std::max<std::uint64_t>(1, gemm_module.k_per_mn / gemm_module.smem_k);
+  const auto num_splits = std::max<std::uint64_t>(
+      1, std::min({ceil_div(num_slots, num_tiles),
+                   ceil_div(num_k_steps, min_k_steps),
+                   workspace_size / (num_tiles * tile_size)}));
+
+  // The last slice is not empty
+  plan.k_per_split = ceil_div(num_k_steps, num_splits) * gemm_module.smem_k;
+  plan.num_splits = ceil_div(k, plan.k_per_split);
+  return plan;
+}
+
+cumpsgemm::cost_model::estimate_t cumpsgemm::cost_model::estimate_split_k(
+    const cumpsgemm::gemm_module &gemm_module, const split_k_plan_t &plan,
+    const device_t &device, const std::uint64_t m, const std::uint64_t n,
+    const bool is_complex, const bool beta_nonzero) {
+  const double element_size = is_complex ? 8 : 4;
+  const auto num_blocks = ceil_div(m, gemm_module.smem_m) *
+                          ceil_div(n, gemm_module.smem_n) * plan.num_splits;
+  // A block writes its partial tile, and the last block of a tile reads all
+  // the partial tiles and writes C
+  const auto tile_bytes =
+      static_cast<double>(gemm_module.smem_m) * gemm_module.smem_n *
+      element_size;
+  const auto store_bytes_per_block =
+      tile_bytes *
+      (1 + static_cast<double>(plan.num_splits + (beta_nonzero ? 2 : 1)) /
+               plan.num_splits);
+  return estimate_blocks(gemm_module, device, num_blocks,
+                         ceil_div(plan.k_per_split, gemm_module.smem_k),
+                         is_complex, store_bytes_per_block);
+}
+
+cumpsgemm::cost_model::stream_k_plan_t cumpsgemm::cost_model::plan_stream_k(
+    const cumpsgemm::gemm_module &gemm_module, const device_t &device,
+    const std::uint64_t m, const std::uint64_t n, const std::uint64_t k,
+    const std::uint64_t workspace_size, const std::uint64_t max_num_tiles) {
+  stream_k_plan_t plan;
+  if (gemm_module.schedule != cumpsgemm::gemm_schedule_t::stream_k ||
+      gemm_module.smem_m * gemm_module.smem_n * gemm_module.smem_k == 0 ||
+      m * n * k == 0) {
+    return plan;
+  }
+  const auto num_tiles =
+      ceil_div(m, gemm_module.smem_m) * ceil_div(n, gemm_module.smem_n);
+  const auto tile_size =
+      static_cast<std::uint64_t>(gemm_module.smem_m) * gemm_module.smem_n;
+  const std::uint64_t num_sms = std::max(1u, device.num_sms);
+  const auto num_active_blocks =
+      std::min<std::uint64_t>(std::max(1u, gemm_module.num_active_blocks),
+                              workspace_size / (2 * tile_size * num_sms));
+  if (num_tiles > max_num_tiles || num_active_blocks == 0) {
+    return plan;
+  }
+
+  const auto num_k_steps = num_tiles * ceil_div(k, gemm_module.smem_k);
+  plan.k_steps_per_block =
+      ceil_div(num_k_steps, std::min(num_sms * num_active_blocks, num_k_steps));
+  if (plan.k_steps_per_block > 0xffffffffu) {
+    plan.k_steps_per_block = 0;
+    return plan;
+  }
+  plan.num_blocks = ceil_div(num_k_steps, plan.k_steps_per_block);
+  return plan;
+}
+
+cumpsgemm::cost_model::estimate_t cumpsgemm::cost_model::estimate_stream_k(
+    const cumpsgemm::gemm_module &gemm_module, const stream_k_plan_t &plan,
+    const device_t &device, const std::uint64_t m, const std::uint64_t n,
+    const std::uint64_t k, const bool is_complex, const bool beta_nonzero) {
+  const double element_size = is_complex ? 8 : 4;
+  const auto num_tiles =
+      ceil_div(m, gemm_module.smem_m) * ceil_div(n, gemm_module.smem_n);
+  const auto num_k_steps = num_tiles * ceil_div(k, gemm_module.smem_k);
+  // A block writes its share of C and at most two partial tiles, which are
+  // read back by the fixup
+  const auto tile_bytes =
+      static_cast<double>(gemm_module.smem_m) * gemm_module.smem_n *
+      element_size;
+  const auto store_bytes_per_block =
+      tile_bytes * (static_cast<double>(num_tiles) * (beta_nonzero ? 2 : 1) /
+                        plan.num_blocks +
+                    4);
+
+  estimate_t estimate;
+  estimate.num_blocks = plan.num_blocks;
+  estimate.num_waves = 1;
+  estimate.tail_efficiency =
+      static_cast<double>(num_k_steps) /
+      (plan.num_blocks * plan.k_steps_per_block);
+  estimate.cycles =
+      device.launch_cycles +
+      get_wave_cycles(gemm_module, device,
+                      ceil_div(plan.num_blocks, std::max(1u, device.num_sms)),
+                      plan.k_steps_per_block, is_complex,
+                      store_bytes_per_block);
+  return estimate;
+}
+
+unsigned cumpsgemm::cost_model::select(
+    const cumpsgemm::gemm_module *const module_list,
+    const std::uint16_t *const id_list, const unsigned num_candidates,
+    const cumpsgemm::gemm_module *const split_k_module,
+    const split_k_plan_t &split_k_plan, const std::uint64_t workspace_size,
+    const std::uint64_t max_num_tiles, const device_t &device,
+    const std::uint64_t m, const std::uint64_t n, const std::uint64_t k,
+    const std::uint64_t batch_count, const bool is_complex,
+    const bool beta_nonzero) {
+  unsigned best_id = num_candidates;
+  double best_cycles = 0;
+  for (unsigned i = 0; i < num_candidates; i++) {
+    const auto &gemm_module = module_list[id_list[i]];
+    double cycles;
+    if (gemm_module.schedule == cumpsgemm::gemm_schedule_t::stream_k) {
+      const auto plan = plan_stream_k(gemm_module, device, m, n, k,
+                                      workspace_size, max_num_tiles);
+      if (plan.num_blocks == 0 || batch_count != 1) {
+        continue;
+      }
+      cycles = estimate_stream_k(gemm_module, plan, device, m, n, k,
+                                 is_complex, beta_nonzero)
+                   .cycles;
+    } else {
+      cycles = estimate(gemm_module, device, m, n, k, batch_count, is_complex,
+                        beta_nonzero)
+                   .cycles;
+    }
+    // The smaller id is taken for a tie, which is tuned for larger sizes
+    if (best_id == num_candidates || cycles < best_cycles) {
+      best_id = i;
+      best_cycles = cycles;
+    }
+  }
+  if (split_k_module != nullptr && split_k_plan.num_splits != 0 &&
+      batch_count == 1) {
+    const auto cycles =
+        estimate_split_k(*split_k_module, split_k_plan, device, m, n,
+                         is_complex, beta_nonzero)
+            .cycles;
+    if (best_id == num_candidates || cycles < best_cycles) {
+      best_id = num_candidates;
+    }
+  }
+  return best_id;
+}
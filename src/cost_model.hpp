@@ -0,0 +1,107 @@
+#pragma once
+#include "instance.hpp"
+#include <cstdint>
+
+namespace cumpsgemm {
+namespace cost_model {
+// The throughput of an SM in cycles. Only the ratios matter since the
+// estimates are compared among the modules of the same compute mode.
+struct device_t {
+  unsigned num_sms;
+  // MACs of a real GEMM per cycle
+  double macs_per_cycle = 512;
+  // Bytes loaded per cycle, which are mostly L2 hits
+  double bytes_per_cycle = 64;
+  // The number of warps to hide the latency of the loads and the MMAs
+  unsigned num_saturating_warps = 4;
+  // The overhead of a k-step (block sync and pipeline) and a kernel launch
+  double k_step_cycles = 128;
+  double launch_cycles = 4096;
+};
+
+struct estimate_t {
+  std::uint64_t num_blocks;
+  std::uint64_t num_waves;
+  // num_blocks / (num_waves * concurrent blocks)
+  double tail_efficiency;
+  double cycles;
+};
+
+// The cycles of a kernel launch of `gemm_module` for (m, n, k, batch_count).
+// The blocks are issued in waves of `num_sms * num_active_blocks`, and a block
+// in the tail wave runs faster only if its SM is not saturated.
+estimate_t estimate(const cumpsgemm::gemm_module &gemm_module,
+                    const device_t &device, const std::uint64_t m,
+                    const std::uint64_t n, const std::uint64_t k,
+                    const std::uint64_t batch_count, const bool is_complex,
+                    const bool beta_nonzero);
+
+// The K slices of a split-K GEMM
+struct split_k_plan_t {
+  // 0 if the split-K cannot run
+  unsigned num_splits = 0;
+  std::uint64_t k_per_split = 0;
+};
+
+// Splits K so that the blocks of all the slices fill a wave. A slice has at
+// least `k_per_mn` of the module, and the partial tiles of the slices must fit
+// in `workspace_size` elements. The split-K is not available if the number of
+// the tiles of C exceeds `max_num_tiles`.
+split_k_plan_t plan_split_k(const cumpsgemm::gemm_module &gemm_module,
+                            const device_t &device, const std::uint64_t m,
+                            const std::uint64_t n, const std::uint64_t k,
+                            const std::uint64_t workspace_size,
+                            const std::uint64_t max_num_tiles);
+
+// The split-K module, in which the last block of a tile sums the partial tiles
+// and applies alpha and beta
+estimate_t estimate_split_k(const cumpsgemm::gemm_module &gemm_module,
+                            const split_k_plan_t &plan, const device_t &device,
+                            const std::uint64_t m, const std::uint64_t n,
+                            const bool is_complex, const bool beta_nonzero);
+
+// The k-steps of the persistent blocks of a stream-K GEMM
+struct stream_k_plan_t {
+  // 0 if the stream-K cannot run
+  unsigned num_blocks = 0;
+  std::uint64_t k_steps_per_block = 0;
+};
+
+// Splits the k-steps of all the tiles evenly among the resident blocks of a
+// wave. A block has at most two partial tiles, and those of all the blocks must
+// fit in `workspace_size` elements, otherwise fewer blocks are resident on an
+// SM. The stream-K is not available if the number of the tiles of C exceeds
+// `max_num_tiles`.
+stream_k_plan_t plan_stream_k(const cumpsgemm::gemm_module &gemm_module,
+                              const device_t &device, const std::uint64_t m,
+                              const std::uint64_t n, const std::uint64_t k,
+                              const std::uint64_t workspace_size,
+                              const std::uint64_t max_num_tiles);
+
+// The stream-K module, which runs a single wave. The last block arriving at a
+// split tile sums the partial tiles and applies alpha and beta.
+estimate_t estimate_stream_k(const cumpsgemm::gemm_module &gemm_module,
+                             const stream_k_plan_t &plan,
+                             const device_t &device, const std::uint64_t m,
+                             const std::uint64_t n, const std::uint64_t k,
+                             const bool is_complex, const bool beta_nonzero);
+
+// Returns the position in `id_list` of the candidate with the smallest
+// estimate, or `num_candidates` for the split-K module.
+// The split-K is not available if `split_k_module` is nullptr or
+// `split_k_plan.num_splits` is 0. The stream-K candidates are planned with
+// `workspace_size` and `max_num_tiles` and skipped if not available, so a
+// candidate list must have a data-parallel module.
+unsigned select(const cumpsgemm::gemm_module *const module_list,
+                const std::uint16_t *const id_list,
+                const unsigned num_candidates,
+                const cumpsgemm::gemm_module *const split_k_module,
+                const split_k_plan_t &split_k_plan,
+                const std::uint64_t workspace_size,
+                const std::uint64_t max_num_tiles,
+                const device_t &device, const std::uint64_t m,
+                const std::uint64_t n, const std::uint64_t k,
+                const std::uint64_t batch_count, const bool is_complex,
+                const bool beta_nonzero);
+} // namespace cost_model
+} // namespace cumpsgemm
@@ -1,52 +1,164 @@
+#include <condition_variable>
+#include <cstdlib>
 #include <cuda.h>
+#include <deque>
 #include <dlfcn.h>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <string.h>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
+#include "config.hpp"
 #include "culip.hpp"
 
 const std::string CULIP_RESULT_PREFIX = "CULiP Result";
 const std::string CULIP_EXP_STATS_PREFIX = "CULiP ExpStats";
-const std::string CUMPSGEMM_ENABLE_CULIP_PROFILING_ENV_NAME =
-    "CUMPSGEMM_ENABLE_CULIP_PROFILING";
 
-void cumpsgemm::CULiP::record_timestamp(void *tm_timestamp) {
-  struct timespec *tm_ptr = (struct timespec *)tm_timestamp;
-  clock_gettime(CLOCK_MONOTONIC, tm_ptr);
+namespace {
+// Prints the profile results in the order of submission.
+// The remaining results are printed by an atexit handler, since the CUDA
+// runtime may have been unloaded when the static harvester is destroyed.
+class harvester_t {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<cumpsgemm::CULiP::profile_result> queue;
+  std::map<int, std::vector<cudaEvent_t>> event_pool;
+  bool stop = false;
+  // Started after the other members are initialized
+  std::thread thread;
+
+  // Runs on the harvester thread, so an error drops the result instead of
+  // throwing. Returns false in that case.
+  bool print(const cumpsgemm::CULiP::profile_result &result) {
+    float elapsed_time_ms;
+    if (cudaSetDevice(result.device_id) != cudaSuccess ||
+        cudaEventSynchronize(result.end_event) != cudaSuccess ||
+        cudaEventElapsedTime(&elapsed_time_ms, result.start_event,
+                             result.end_event) != cudaSuccess) {
+      return false;
+    }
+    const unsigned long elapsed_time_ns = elapsed_time_ms * 1e6;
+    printf("[%s][%s] %luns\n", CULIP_RESULT_PREFIX.c_str(),
+           result.function_name, elapsed_time_ns);
+    fflush(stdout);
+    return true;
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cv.wait(lock, [&]() { return stop || !queue.empty(); });
+      // The remaining results are printed before stopping
+      if (queue.empty()) {
+        return;
+      }
+      const auto result = queue.front();
+      queue.pop_front();
+
+      lock.unlock();
+      const auto printed = print(result);
+      lock.lock();
+
+      // The events of a failed result may be in an error state
+      if (!printed) {
+        continue;
+      }
+      auto &events = event_pool[result.device_id];
+      events.push_back(result.start_event);
+      events.push_back(result.end_event);
+    }
+  }
+
+public:
+  harvester_t() : thread([this]() { run(); }) {}
+  // The pending results are discarded without calling CUDA if they have not
+  // been flushed.
+  ~harvester_t() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.clear();
+    }
+    flush();
+  }
+
+  // Prints the pending results and stops the harvester thread
+  void flush() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_one();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  cudaEvent_t acquire_event(const int device_id) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto &events = event_pool[device_id];
+      if (!events.empty()) {
+        const auto event = events.back();
+        events.pop_back();
+        return event;
+      }
+    }
+    // The harvester thread waits for the events without spinning
+    cudaEvent_t event;
+    CUTF_CHECK_ERROR(cudaEventCreateWithFlags(&event, cudaEventBlockingSync));
+    return event;
+  }
+
+  void push(const cumpsgemm::CULiP::profile_result &result) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(result);
+    }
+    cv.notify_one();
+  }
+};
+
+harvester_t &get_harvester() {
+  static harvester_t harvester;
+  // Registered after the harvester is constructed, so that the handler is
+  // called before the harvester is destroyed
+  static const bool flush_registered =
+      std::atexit([]() { get_harvester().flush(); }) == 0;
+  (void)flush_registered;
+  return harvester;
 }
+} // namespace
 
-void cumpsgemm::CULiP::print_profile_result(void *profile_result_ptr) {
-  const auto profile_result =
-      *((cumpsgemm::CULiP::profile_result *)profile_result_ptr);
-
-  const unsigned long elapsed_time_us =
-      ((long)profile_result.end_timestamp.tv_sec -
-       (long)profile_result.start_timestamp.tv_sec) *
-          (long)1000000000 +
-      ((long)profile_result.end_timestamp.tv_nsec -
-       (long)profile_result.start_timestamp.tv_nsec);
-  printf("[%s][%s] %luns\n", CULIP_RESULT_PREFIX.c_str(),
-         profile_result.function_name, elapsed_time_us);
-  fflush(stdout);
+void cumpsgemm::CULiP::record_start(cudaStream_t cuda_stream,
+                                    profile_result &result) {
+  // The events recorded in a CUDA Graph capture cannot be waited for
+  cudaStreamCaptureStatus capture_status;
+  CUTF_CHECK_ERROR(cudaStreamIsCapturing(cuda_stream, &capture_status));
+  if (capture_status != cudaStreamCaptureStatusNone) {
+    return;
+  }
+
+  auto &harvester = get_harvester();
+  CUTF_CHECK_ERROR(cudaGetDevice(&result.device_id));
+  result.start_event = harvester.acquire_event(result.device_id);
+  result.end_event = harvester.acquire_event(result.device_id);
+  CUTF_CHECK_ERROR(cudaEventRecord(result.start_event, cuda_stream));
 }
 
-void cumpsgemm::CULiP::launch_function(cudaStream_t cuda_stream,
-                                       void (*fn)(void *), void *const arg) {
-  cudaStreamSynchronize(cuda_stream);
-  fn(arg);
-  cudaStreamSynchronize(cuda_stream);
+void cumpsgemm::CULiP::record_end(cudaStream_t cuda_stream,
+                                  profile_result &result) {
+  if (result.start_event == nullptr) {
+    return;
+  }
+  CUTF_CHECK_ERROR(cudaEventRecord(result.end_event, cuda_stream));
+  get_harvester().push(result);
 }
 
 bool cumpsgemm::CULiP::is_profiling_enabled() {
-  const char *value = getenv(CUMPSGEMM_ENABLE_CULIP_PROFILING_ENV_NAME.c_str());
-  if (value == NULL) {
-    return false;
-  }
-  if (std::string(value) == "0") {
-    return false;
-  }
-  return true;
+  return cumpsgemm::config::get()->culip_profiling_enabled;
 }
 
 #define CULiP_CUBLAS_COMPUTE_T_CASE_STRING(compute_type)                       \
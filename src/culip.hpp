@@ -1,5 +1,4 @@
 #pragma once
-#include <ctime>
 #include <cutf/cublas.hpp>
 
 namespace cumpsgemm {
@@ -10,15 +9,18 @@ struct profile_result {
   enum { function_name_length = 128 };
   char function_name[function_name_length] = {0};
 
-  // tm
-  struct timespec start_timestamp;
-  struct timespec end_timestamp;
+  // Events taken from the event pool of the device
+  int device_id;
+  cudaEvent_t start_event = nullptr;
+  cudaEvent_t end_event = nullptr;
 };
 
-void record_timestamp(void *tm_timestamp);
-void print_profile_result(void *profile_result_ptr);
-void launch_function(cudaStream_t cuda_stream, void (*fn)(void *),
-                     void *const arg);
+// The events are recorded on the stream without synchronization.
+// `record_end` passes the result to the harvester thread, which prints the
+// elapsed time after the end event is completed.
+// Nothing is recorded while the stream is captured into a CUDA Graph.
+void record_start(cudaStream_t cuda_stream, profile_result &result);
+void record_end(cudaStream_t cuda_stream, profile_result &result);
 
 bool is_profiling_enabled();
 
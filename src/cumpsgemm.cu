@@ -1,16 +1,21 @@
+#include <algorithm>
 #include <cassert>
 #include <cumpsgemm/cumpsgemm.hpp>
 #include <cutf/cuda.hpp>
 #include <cutf/memory.hpp>
 #include <iostream>
 #include <type_traits>
+#include <vector>
 
+#include "cost_model.hpp"
 #include "device_common.hpp"
 #include "dynamic_launch.hpp"
 #include "dynamic_launch_utils.hpp"
 #include "dynamic_scaling.hpp"
 #include "exp_stats.hpp"
 #include "handle.hpp"
+#include "tuning_cache.hpp"
+#include "utils.hpp"
 
 // For debug
 // #define CUMPSGEMM_CHECK_KERNEL_ERROR
@@ -42,6 +47,16 @@ gen_module_code(const cublasOperation_t op_A, const cublasOperation_t op_B,
     code |= cumpsgemm::kernel_module_code::simt |
             cumpsgemm::kernel_module_code::without_ec;
     break;
+  case CUMPSGEMM_BF16TCEC:
+    // The BF16x3 kernels are instantiated only for the real GEMMs
+    if (std::is_same<T, cuComplex>::value) {
+      code |= cumpsgemm::kernel_module_code::tf32 |
+              cumpsgemm::kernel_module_code::with_ec;
+    } else {
+      code |= cumpsgemm::kernel_module_code::bf16 |
+              cumpsgemm::kernel_module_code::with_ec;
+    }
+    break;
   default:
     break;
   }
@@ -92,10 +107,12 @@ template <class T>
 void launch_kernel(const cumpsgemm::gemm_module gemm_module,
                    const int *const dynamic_launch_buffer_ptr,
                    const std::size_t m, const std::size_t n,
-                   const std::size_t k, const T alpha, const T *const a_ptr,
-                   const std::size_t lda, const T *const b_ptr,
-                   const std::size_t ldb, const T beta, T *const c_ptr,
-                   const std::size_t ldc, cudaStream_t cuda_stream) {
+                   const std::size_t k, const cumpsgemm::scalar_t<T> alpha,
+                   const T *const a_ptr, const std::size_t lda,
+                   const T *const b_ptr, const std::size_t ldb,
+                   const cumpsgemm::scalar_t<T> beta, T *const c_ptr,
+                   const std::size_t ldc, const unsigned group_width,
+                   cudaStream_t cuda_stream) {
   const auto kernel_ptr = reinterpret_cast<cumpsgemm::gemm_kernel_func_t<T>>(
       gemm_module.kernel_func);
   const dim3 block_size(gemm_module.block_size);
@@ -104,31 +121,61 @@ void launch_kernel(const cumpsgemm::gemm_module gemm_module,
 
   kernel_ptr<<<grid_size, block_size, gemm_module.smem_size, cuda_stream>>>(
       dynamic_launch_buffer_ptr, m, n, k, alpha, a_ptr, lda, b_ptr, ldb, beta,
-      c_ptr, ldc);
+      c_ptr, ldc, group_width);
 #ifdef CUMPSGEMM_CHECK_KERNEL_ERROR
   CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
 #endif
 }
 
 template <class T>
-void launch_atomic_kernel(const cumpsgemm::gemm_module gemm_module,
-                          const int *const dynamic_launch_buffer_ptr,
-                          const std::size_t m, const std::size_t n,
-                          const std::size_t k, const T alpha,
-                          const T *const a_ptr, const std::size_t lda,
-                          const T *const b_ptr, const std::size_t ldb,
-                          const T beta, T *const c_ptr, const std::size_t ldc,
-                          cudaStream_t cuda_stream) {
-  const auto kernel_ptr = reinterpret_cast<cumpsgemm::gemm_kernel_func_t<T>>(
-      gemm_module.kernel_func);
+void launch_split_k_kernel(
+    const cumpsgemm::gemm_module gemm_module,
+    const cumpsgemm::cost_model::split_k_plan_t plan,
+    const int *const dynamic_launch_buffer_ptr, const std::size_t m,
+    const std::size_t n, const std::size_t k,
+    const cumpsgemm::scalar_t<T> alpha, const T *const a_ptr,
+    const std::size_t lda, const T *const b_ptr, const std::size_t ldb,
+    const cumpsgemm::scalar_t<T> beta, T *const c_ptr, const std::size_t ldc,
+    T *const workspace_ptr, unsigned *const counter_ptr,
+    const unsigned group_width, cudaStream_t cuda_stream) {
+  const auto kernel_ptr =
+      reinterpret_cast<cumpsgemm::gemm_split_k_kernel_func_t<T>>(
+          gemm_module.kernel_func);
   const dim3 block_size(gemm_module.block_size);
   const dim3 grid_size(((m + gemm_module.smem_m - 1) / gemm_module.smem_m) *
                        ((n + gemm_module.smem_n - 1) / gemm_module.smem_n) *
-                       ((k + gemm_module.k_per_mn - 1) / gemm_module.k_per_mn));
+                       plan.num_splits);
+
+  kernel_ptr<<<grid_size, block_size, gemm_module.smem_size, cuda_stream>>>(
+      dynamic_launch_buffer_ptr, m, n, k, alpha, a_ptr, lda, b_ptr, ldb, beta,
+      c_ptr, ldc, plan.k_per_split, workspace_ptr, counter_ptr,
+      group_width);
+#ifdef CUMPSGEMM_CHECK_KERNEL_ERROR
+  CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
+#endif
+}
+
+template <class T>
+void launch_stream_k_kernel(
+    const cumpsgemm::gemm_module gemm_module,
+    const cumpsgemm::cost_model::stream_k_plan_t plan,
+    const int *const dynamic_launch_buffer_ptr, const std::size_t m,
+    const std::size_t n, const std::size_t k,
+    const cumpsgemm::scalar_t<T> alpha, const T *const a_ptr,
+    const std::size_t lda, const T *const b_ptr, const std::size_t ldb,
+    const cumpsgemm::scalar_t<T> beta, T *const c_ptr, const std::size_t ldc,
+    T *const workspace_ptr, unsigned *const counter_ptr,
+    const unsigned group_width, cudaStream_t cuda_stream) {
+  const auto kernel_ptr =
+      reinterpret_cast<cumpsgemm::gemm_stream_k_kernel_func_t<T>>(
+          gemm_module.kernel_func);
+  const dim3 block_size(gemm_module.block_size);
+  const dim3 grid_size(plan.num_blocks);
 
   kernel_ptr<<<grid_size, block_size, gemm_module.smem_size, cuda_stream>>>(
       dynamic_launch_buffer_ptr, m, n, k, alpha, a_ptr, lda, b_ptr, ldb, beta,
-      c_ptr, ldc);
+      c_ptr, ldc, plan.k_steps_per_block, workspace_ptr, counter_ptr,
+      group_width);
 #ifdef CUMPSGEMM_CHECK_KERNEL_ERROR
   CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
 #endif
@@ -138,80 +185,319 @@ template <class T>
 void launch_kernel(const cumpsgemm::gemm_module gemm_module,
                    const int *const dynamic_launch_buffer_ptr,
                    const std::size_t m, const std::size_t n,
-                   const std::size_t k, const T alpha, const T *const a_ptr,
-                   const std::size_t lda, const uint64_t stridea,
-                   const T *const b_ptr, const std::size_t ldb,
-                   const uint64_t strideb, const T beta, T *const c_ptr,
+                   const std::size_t k, const cumpsgemm::scalar_t<T> alpha,
+                   const T *const a_ptr, const std::size_t lda,
+                   const uint64_t stridea, const T *const b_ptr,
+                   const std::size_t ldb, const uint64_t strideb,
+                   const cumpsgemm::scalar_t<T> beta, T *const c_ptr,
                    const std::size_t ldc, const uint64_t stridec,
-                   const uint64_t batch_count, cudaStream_t cuda_stream) {
+                   const uint64_t batch_count, const unsigned group_width,
+                   cudaStream_t cuda_stream) {
   const auto kernel_ptr =
       reinterpret_cast<cumpsgemm::gemm_stridedBatch_kernel_func_t<T>>(
           gemm_module.kernel_func);
   const dim3 block_size(gemm_module.block_size);
-  const auto num_blocks_per_gemm =
-      (m + gemm_module.smem_m - 1) / gemm_module.smem_m *
-      (n + gemm_module.smem_n - 1) / gemm_module.smem_n;
-  const dim3 grid_size(num_blocks_per_gemm * batch_count);
+  const auto num_tiles = ((m + gemm_module.smem_m - 1) / gemm_module.smem_m) *
+                         ((n + gemm_module.smem_n - 1) / gemm_module.smem_n);
+  const auto grid_size = cumpsgemm::get_batch_grid_size(num_tiles, batch_count);
 
   kernel_ptr<<<grid_size, block_size, gemm_module.smem_size, cuda_stream>>>(
       dynamic_launch_buffer_ptr, m, n, k, alpha, a_ptr, lda, stridea, b_ptr,
-      ldb, strideb, beta, c_ptr, ldc, stridec, num_blocks_per_gemm);
+      ldb, strideb, beta, c_ptr, ldc, stridec, batch_count, group_width);
 #ifdef CUMPSGEMM_CHECK_KERNEL_ERROR
   CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
 #endif
 }
 
 template <class T>
-__global__ void fill_zero_kernel(T *const ptr, const unsigned m,
-                                 const unsigned n, const std::uint64_t ld) {
-  const auto tid = threadIdx.x + blockIdx.x * blockDim.x;
-  if (tid >= m * n) {
-    return;
+void launch_kernel(const cumpsgemm::gemm_module gemm_module,
+                   const int *const dynamic_launch_buffer_ptr,
+                   const std::size_t m, const std::size_t n,
+                   const std::size_t k, const cumpsgemm::scalar_t<T> alpha,
+                   const T *const *const a_ptr_list, const std::size_t lda,
+                   const T *const *const b_ptr_list, const std::size_t ldb,
+                   const cumpsgemm::scalar_t<T> beta,
+                   T *const *const c_ptr_list, const std::size_t ldc,
+                   const uint64_t batch_count, cudaStream_t cuda_stream) {
+  const auto kernel_ptr =
+      reinterpret_cast<cumpsgemm::gemm_batchPtr_kernel_func_t<T>>(
+          gemm_module.kernel_func);
+  const dim3 block_size(gemm_module.block_size);
+  const auto num_tiles = ((m + gemm_module.smem_m - 1) / gemm_module.smem_m) *
+                         ((n + gemm_module.smem_n - 1) / gemm_module.smem_n);
+  const auto grid_size = cumpsgemm::get_batch_grid_size(num_tiles, batch_count);
+
+  kernel_ptr<<<grid_size, block_size, gemm_module.smem_size, cuda_stream>>>(
+      dynamic_launch_buffer_ptr, m, n, k, alpha, a_ptr_list, lda, b_ptr_list,
+      ldb, beta, c_ptr_list, ldc, batch_count);
+#ifdef CUMPSGEMM_CHECK_KERNEL_ERROR
+  CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
+#endif
+}
+
+// In the device pointer mode, alpha and beta are read by the kernels so that
+// the host does not wait for them.
+template <class T>
+cumpsgemm::scalar_t<T> get_scalar(const cuMpSGEMM_handle_t handle,
+                                  const T *const ptr) {
+  if (handle->pointer_mode == CUBLAS_POINTER_MODE_DEVICE) {
+    return {T{}, ptr};
   }
-  const auto im = tid % m;
-  const auto in = tid / m;
-  const auto index = im + in * ld;
+  return {*ptr, nullptr};
+}
 
-  ptr[index] = cumpsgemm::device::zero<T>();
+// Whether C has to be read, which is unknown on the host in the device pointer
+// mode
+template <class T>
+bool is_beta_nonzero(const cuMpSGEMM_handle_t handle,
+                     const cumpsgemm::scalar_t<T> beta) {
+  return handle->pointer_mode == CUBLAS_POINTER_MODE_DEVICE ||
+         !cumpsgemm::device::is_zero(beta.value);
+}
+
+cumpsgemm::cost_model::device_t get_device(const cuMpSGEMM_handle_t handle) {
+  cumpsgemm::cost_model::device_t device;
+  device.num_sms = handle->num_sms;
+  return device;
 }
 
+// The partial tiles are held in the working memory, and a tile takes a counter
 template <class T>
-void fill_zero(T *const ptr, const unsigned m, const unsigned n,
-               const std::uint64_t ld, cudaStream_t cuda_stream) {
-  const auto block_size = 256;
-  const auto grid_size = (m * n + block_size - 1) / block_size;
+cumpsgemm::cost_model::split_k_plan_t
+get_split_k_plan(const cuMpSGEMM_handle_t handle,
+                 const cumpsgemm::gemm_module &split_k_module,
+                 const std::uint64_t m, const std::uint64_t n,
+                 const std::uint64_t k) {
+  return cumpsgemm::cost_model::plan_split_k(
+      split_k_module, get_device(handle), m, n, k,
+      handle->temp_working_memory_float_count * sizeof(float) / sizeof(T),
+      handle->split_k_counter_count);
+}
 
-  fill_zero_kernel<T><<<grid_size, block_size, 0, cuda_stream>>>(ptr, m, n, ld);
+// The stream-K shares the working memory and the counters with the split-K
+template <class T>
+cumpsgemm::cost_model::stream_k_plan_t
+get_stream_k_plan(const cuMpSGEMM_handle_t handle,
+                  const cumpsgemm::gemm_module &stream_k_module,
+                  const std::uint64_t m, const std::uint64_t n,
+                  const std::uint64_t k) {
+  return cumpsgemm::cost_model::plan_stream_k(
+      stream_k_module, get_device(handle), m, n, k,
+      handle->temp_working_memory_float_count * sizeof(float) / sizeof(T),
+      handle->split_k_counter_count);
 }
 
+// Runs a GEMM with a module of the gemm registry in its schedule. A stream-K
+// module must be available for the shape.
 template <class T>
-__global__ void post_atomic_kernel(T *const c_ptr, const T *const tmp_ptr,
-                                   const unsigned m, const unsigned n,
-                                   const std::uint64_t ldc,
-                                   const std::uint64_t ldt, const T beta) {
-  const auto tid = threadIdx.x + blockIdx.x * blockDim.x;
-  if (tid >= m * n) {
+void launch_registry_kernel(
+    const cuMpSGEMM_handle_t handle, const cumpsgemm::gemm_module gemm_module,
+    const int *const dynamic_launch_buffer_ptr, const std::size_t m,
+    const std::size_t n, const std::size_t k,
+    const cumpsgemm::scalar_t<T> alpha, const T *const a_ptr,
+    const std::size_t lda, const T *const b_ptr, const std::size_t ldb,
+    const cumpsgemm::scalar_t<T> beta, T *const c_ptr, const std::size_t ldc) {
+  if (gemm_module.schedule != cumpsgemm::gemm_schedule_t::stream_k) {
+    launch_kernel<T>(gemm_module, dynamic_launch_buffer_ptr, m, n, k, alpha,
+                     a_ptr, lda, b_ptr, ldb, beta, c_ptr, ldc,
+                     handle->raster_group_width, handle->cuda_stream);
     return;
   }
-  const auto im = tid % m;
-  const auto in = tid / m;
-  const auto c_index = im + in * ldc;
-  const auto t_index = im + in * ldt;
+  const auto plan = get_stream_k_plan<T>(handle, gemm_module, m, n, k);
+  assert(plan.num_blocks != 0);
+  launch_stream_k_kernel<T>(
+      gemm_module, plan, dynamic_launch_buffer_ptr, m, n, k, alpha, a_ptr, lda,
+      b_ptr, ldb, beta, c_ptr, ldc,
+      reinterpret_cast<T *>(handle->temp_working_memory),
+      handle->split_k_counter, handle->raster_group_width, handle->cuda_stream);
+}
+
+// Returns the id in the registry of the candidate for the shape, or
+// split_k_module_id for the split-K module. The registry must not be empty.
+template <class T>
+unsigned
+select_kernel_module(const cuMpSGEMM_handle_t handle,
+                     const cumpsgemm::kernel_registry::registry_t &registry,
+                     const cumpsgemm::gemm_module *const split_k_module,
+                     const cumpsgemm::cost_model::split_k_plan_t &split_k_plan,
+                     const std::uint64_t m, const std::uint64_t n,
+                     const std::uint64_t k, const std::uint64_t batch_count,
+                     const cumpsgemm::scalar_t<T> beta) {
+  const auto &candidate_list = registry.get_candidates(m, n, k);
+  const auto i = cumpsgemm::cost_model::select(
+      registry.data(), candidate_list.data(), candidate_list.size(),
+      split_k_module, split_k_plan,
+      handle->temp_working_memory_float_count * sizeof(float) / sizeof(T),
+      handle->split_k_counter_count, get_device(handle), m, n, k, batch_count,
+      std::is_same<T, cuComplex>::value, is_beta_nonzero(handle, beta));
+  if (i == candidate_list.size()) {
+    return cumpsgemm::kernel_registry::split_k_module_id;
+  }
+  return candidate_list[i];
+}
+
+template <class T>
+unsigned
+select_kernel_module(const cuMpSGEMM_handle_t handle,
+                     const cumpsgemm::kernel_registry::registry_t &registry,
+                     const std::uint64_t m, const std::uint64_t n,
+                     const std::uint64_t k, const std::uint64_t batch_count,
+                     const cumpsgemm::scalar_t<T> beta) {
+  return select_kernel_module(handle, registry, nullptr, {}, m, n, k,
+                              batch_count, beta);
+}
 
-  c_ptr[c_index] =
-      cumpsgemm::device::mad(c_ptr[c_index], beta, tmp_ptr[t_index]);
+// The candidates of the shape, followed by the split-K module if available.
+// The stream-K modules which cannot run for the shape are excluded.
+template <class T>
+std::vector<unsigned>
+get_tuning_candidates(const cuMpSGEMM_handle_t handle,
+                      const cumpsgemm::kernel_registry::registry_t &registry,
+                      const bool split_k_available, const std::uint64_t m,
+                      const std::uint64_t n, const std::uint64_t k) {
+  std::vector<unsigned> id_list;
+  for (const auto id : registry.get_candidates(m, n, k)) {
+    if (registry[id].schedule != cumpsgemm::gemm_schedule_t::stream_k ||
+        get_stream_k_plan<T>(handle, registry[id], m, n, k).num_blocks != 0) {
+      id_list.push_back(id);
+    }
+  }
+  if (split_k_available) {
+    id_list.push_back(cumpsgemm::kernel_registry::split_k_module_id);
+  }
+  return id_list;
 }
 
+// Runs a non-AUTO GEMM with a module of the registry, or with the split-K
+// module for `split_k_module_id`
 template <class T>
-void post_atomic(T *const c_ptr, const T *const tmp_ptr, const unsigned m,
-                 const unsigned n, const std::uint64_t ldc,
-                 const std::uint64_t ldt, const T beta,
-                 cudaStream_t cuda_stream) {
-  const auto block_size = 256;
-  const auto grid_size = (m * n + block_size - 1) / block_size;
+void launch_gemm_module(
+    const cuMpSGEMM_handle_t handle,
+    const cumpsgemm::kernel_module_code::code_t code, const unsigned module_id,
+    const std::size_t m, const std::size_t n, const std::size_t k,
+    const cumpsgemm::scalar_t<T> alpha, const T *const a_ptr,
+    const std::size_t lda, const T *const b_ptr, const std::size_t ldb,
+    const cumpsgemm::scalar_t<T> beta, T *const c_ptr, const std::size_t ldc) {
+  if (module_id != cumpsgemm::kernel_registry::split_k_module_id) {
+    launch_registry_kernel<T>(handle, handle->gemm_module[code][module_id],
+                              nullptr, m, n, k, alpha, a_ptr, lda, b_ptr, ldb,
+                              beta, c_ptr, ldc);
+    return;
+  }
+
+  const auto &split_k_module = handle->gemm_atomic_module[code];
+  launch_split_k_kernel<T>(
+      split_k_module, get_split_k_plan<T>(handle, split_k_module, m, n, k),
+      nullptr, m, n, k, alpha, a_ptr, lda, b_ptr, ldb, beta, c_ptr, ldc,
+      reinterpret_cast<T *>(handle->temp_working_memory),
+      handle->split_k_counter, handle->raster_group_width, handle->cuda_stream);
+}
+
+constexpr unsigned num_tuning_runs = 3;
+
+// Times the candidates with events on a scratch copy of C and returns the
+// fastest one, or `id_list.size()` if they cannot be timed.
+// `launch(module_id, c_ptr)` runs the GEMM.
+template <class T, class Launch>
+unsigned tune_kernel_module(const cuMpSGEMM_handle_t handle,
+                            const std::vector<unsigned> &id_list,
+                            const T *const c_ptr, const std::size_t c_size,
+                            const Launch launch) {
+  const unsigned num_candidates = id_list.size();
+  T *scratch_ptr;
+  if (cudaMalloc(&scratch_ptr, sizeof(T) * c_size) != cudaSuccess) {
+    // Clear the error
+    cudaGetLastError();
+    return num_candidates;
+  }
+  CUTF_CHECK_ERROR(cudaMemcpyAsync(scratch_ptr, c_ptr, sizeof(T) * c_size,
+                                   cudaMemcpyDeviceToDevice,
+                                   handle->cuda_stream));
+
+  cudaEvent_t start_event, stop_event;
+  CUTF_CHECK_ERROR(cudaEventCreate(&start_event));
+  CUTF_CHECK_ERROR(cudaEventCreate(&stop_event));
+
+  unsigned best_id = num_candidates;
+  float best_time = 0;
+  for (unsigned i = 0; i < num_candidates; i++) {
+    // Warm up
+    launch(id_list[i], scratch_ptr);
+
+    CUTF_CHECK_ERROR(cudaEventRecord(start_event, handle->cuda_stream));
+    for (unsigned r = 0; r < num_tuning_runs; r++) {
+      launch(id_list[i], scratch_ptr);
+    }
+    CUTF_CHECK_ERROR(cudaEventRecord(stop_event, handle->cuda_stream));
+    CUTF_CHECK_ERROR(cudaEventSynchronize(stop_event));
+
+    float time;
+    CUTF_CHECK_ERROR(cudaEventElapsedTime(&time, start_event, stop_event));
+    if (best_id == num_candidates || time < best_time) {
+      best_id = i;
+      best_time = time;
+    }
+  }
 
-  post_atomic_kernel<T><<<grid_size, block_size, 0, cuda_stream>>>(
-      c_ptr, tmp_ptr, m, n, ldc, ldt, beta);
+  CUTF_CHECK_ERROR(cudaEventDestroy(start_event));
+  CUTF_CHECK_ERROR(cudaEventDestroy(stop_event));
+  CUTF_CHECK_ERROR(cudaFree(scratch_ptr));
+  return best_id;
+}
+
+// Looks up the shape bucket in the tuning cache and tunes it among `id_list` on
+// the first use. Returns `default_id` if the online tuning is disabled.
+template <class T, class Launch>
+unsigned select_tuned_kernel_module(
+    const cuMpSGEMM_handle_t handle,
+    const cumpsgemm::tuning_cache::kind_t kind,
+    const cumpsgemm::kernel_module_code::code_t code,
+    const std::vector<unsigned> &id_list, const unsigned default_id,
+    const std::uint64_t m, const std::uint64_t n, const std::uint64_t k,
+    const std::uint64_t batch_count, const cumpsgemm::scalar_t<T> beta,
+    const T *const c_ptr, const std::size_t c_size, const Launch launch) {
+  const auto cache = cumpsgemm::tuning_cache::get();
+  // The timing synchronizes the stream, which is not allowed in a capture.
+  // The winners depend on the timing, so they are not used in the
+  // deterministic mode.
+  if (cache == nullptr || m * n * batch_count == 0 ||
+      cumpsgemm::is_capturing(handle) || handle->deterministic) {
+    return default_id;
+  }
+
+  const auto key = cumpsgemm::tuning_cache::get_key(
+      handle->tuning_identity, kind, code, m, n, k, batch_count,
+      is_beta_nonzero(handle, beta));
+  std::uint32_t module_id;
+  if (cache->find(key, module_id)) {
+    // The winner may not be a candidate for this shape of the bucket
+    return std::find(id_list.begin(), id_list.end(), module_id) !=
+                   id_list.end()
+               ? module_id
+               : default_id;
+  }
+
+  // Not tuned on every call when the winner cannot be stored
+  if (cache->is_full()) {
+    return default_id;
+  }
+  const auto best_id =
+      tune_kernel_module(handle, id_list, c_ptr, c_size, launch);
+  if (best_id == id_list.size()) {
+    return default_id;
+  }
+  module_id = id_list[best_id];
+  if (!cache->insert(key, module_id)) {
+    cuMpSGEMM_warning("The tuning cache is full");
+  }
+  if (cuMpSGEMM_is_log_enabled()) {
+    cuMpSGEMM_log("Tuned (m, n, k, batch_count) = (" + std::to_string(m) +
+                  ", " + std::to_string(n) + ", " + std::to_string(k) + ", " +
+                  std::to_string(batch_count) +
+                  "), module_id = " + std::to_string(module_id) +
+                  " (cost model: " + std::to_string(default_id) + ")");
+  }
+  return module_id;
 }
 } // unnamed namespace
 
@@ -219,10 +505,19 @@ void init_temp_working_memory(cuMpSGEMM_handle *handle) {
   const auto float_count = (1lu << 22);
   handle->temp_working_memory_float_count = float_count;
   handle->temp_working_memory = cutf::memory::malloc<float>(float_count);
+
+  // The split-K resets a counter after the reduction of the tile
+  const auto counter_count = (1lu << 14);
+  handle->split_k_counter_count = counter_count;
+  handle->split_k_counter = cutf::memory::malloc<unsigned>(counter_count);
+  CUTF_CHECK_ERROR(cudaMemsetAsync(handle->split_k_counter, 0,
+                                   sizeof(unsigned) * counter_count,
+                                   handle->cuda_stream));
 }
 
 void destroy_temp_working_memory(cuMpSGEMM_handle *handle) {
   cutf::memory::free(handle->temp_working_memory);
+  cutf::memory::free(handle->split_k_counter);
 }
 
 template <class T>
@@ -235,72 +530,45 @@ cumpsgemm::gemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
                 T *const c_dmem_ptr, const uint64_t ldc,
                 const cuMpSGEMM_compute_mode_t compute_mode,
                 unsigned *const used_kernel_modeule_id) {
-
+  const auto alpha_scalar = get_scalar(handle, alpha);
+  const auto beta_scalar = get_scalar(handle, beta);
   if (compute_mode != CUMPSGEMM_AUTO) {
     const auto code = gen_module_code<T>(op_A, op_B, compute_mode);
+    if (handle->gemm_module[code].empty()) {
+      return CUBLAS_STATUS_NOT_SUPPORTED;
+    }
 
-    if (m * n >=
-        (handle->temp_working_memory_float_count * sizeof(T) / sizeof(float))) {
-      const auto kernel_module_candidate_list = handle->gemm_module[code];
-
-      unsigned module_id;
-      auto gemm_module =
-          kernel_module_candidate_list[cumpsgemm::num_kernel_candidates - 1];
-      for (module_id = 0; module_id < cumpsgemm::num_kernel_candidates - 1;
-           module_id++) {
-        const auto module = kernel_module_candidate_list[module_id];
-        if (m * n / (module.smem_m * module.smem_n) >
-            handle->num_sms * 2 /*A magic number :) */) {
-          gemm_module = module;
-          break;
-        }
-      }
-
-      if (used_kernel_modeule_id != nullptr) {
-        *used_kernel_modeule_id = module_id;
-      }
-
-      if (handle->exp_stats_handle->profiling_enabled) {
-        handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel");
-      }
-      launch_kernel<T>(gemm_module, nullptr, m, n, k, *alpha, a_dmem_ptr, lda,
-                       b_dmem_ptr, ldb, *beta, c_dmem_ptr, ldc,
-                       handle->cuda_stream);
-      if (handle->exp_stats_handle->profiling_enabled) {
-        handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel");
-      }
-    } else {
-      T *r_c_dmem_ptr = c_dmem_ptr;
-      uint64_t r_ldc = ldc;
-      if (!cumpsgemm::device::is_zero(*beta)) {
-        r_c_dmem_ptr = reinterpret_cast<T *>(handle->temp_working_memory);
-        r_ldc = m;
-      }
-      // Initialize working memory
-      fill_zero(r_c_dmem_ptr, m, n, r_ldc, handle->cuda_stream);
+    const auto split_k_plan =
+        get_split_k_plan<T>(handle, handle->gemm_atomic_module[code], m, n, k);
+    auto module_id = select_kernel_module(
+        handle, handle->gemm_module[code], &handle->gemm_atomic_module[code],
+        split_k_plan, m, n, k, 1, beta_scalar);
+    module_id = select_tuned_kernel_module(
+        handle, cumpsgemm::tuning_cache::gemm, code,
+        get_tuning_candidates<T>(handle, handle->gemm_module[code],
+                                 split_k_plan.num_splits != 0, m, n, k),
+        module_id, m, n, k, 1, beta_scalar, c_dmem_ptr, ldc * (n - 1) + m,
+        [&](const unsigned id, T *const c_ptr) {
+          launch_gemm_module<T>(handle, code, id, m, n, k, alpha_scalar,
+                                a_dmem_ptr, lda, b_dmem_ptr, ldb, beta_scalar,
+                                c_ptr, ldc);
+        });
 
-      // Main GEMM
-      if (used_kernel_modeule_id != nullptr) {
-        *used_kernel_modeule_id = 100;
-      }
-      const auto gemm_module = handle->gemm_atomic_module[code];
+    if (used_kernel_modeule_id != nullptr) {
+      *used_kernel_modeule_id =
+          module_id != cumpsgemm::kernel_registry::split_k_module_id
+              ? module_id
+              : 100;
+    }
 
-      if (handle->exp_stats_handle->profiling_enabled) {
-        handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel");
-      }
-      launch_atomic_kernel<T>(gemm_module, nullptr, m, n, k, *alpha, a_dmem_ptr,
-                              lda, b_dmem_ptr, ldb, *beta, r_c_dmem_ptr, r_ldc,
-                              handle->cuda_stream);
-
-      // post process if needed
-      if (!cumpsgemm::device::is_zero(*beta)) {
-        post_atomic(c_dmem_ptr,
-                    reinterpret_cast<T *>(handle->temp_working_memory), m, n,
-                    ldc, m, *beta, handle->cuda_stream);
-      }
-      if (handle->exp_stats_handle->profiling_enabled) {
-        handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel");
-      }
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel");
+    }
+    launch_gemm_module<T>(handle, code, module_id, m, n, k, alpha_scalar,
+                          a_dmem_ptr, lda, b_dmem_ptr, ldb, beta_scalar,
+                          c_dmem_ptr, ldc);
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel");
     }
   } else {
     const auto code_A =
@@ -308,36 +576,22 @@ cumpsgemm::gemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
     const auto code_B =
         gen_module_code<T>(op_A, op_B, handle->dynamic_launch_handle->mode_B);
 
-    if (m * n >=
-        (handle->temp_working_memory_float_count * sizeof(T) / sizeof(float))) {
-      const auto kernel_module_candidate_list_A = handle->gemm_module[code_A];
-      const auto kernel_module_candidate_list_B = handle->gemm_module[code_B];
-
-      unsigned module_id;
-      auto gemm_module_A =
-          kernel_module_candidate_list_A[cumpsgemm::num_kernel_candidates - 1];
-      auto gemm_module_B =
-          kernel_module_candidate_list_B[cumpsgemm::num_kernel_candidates - 1];
-
-      for (module_id = 0; module_id < cumpsgemm::num_kernel_candidates - 1;
-           module_id++) {
-        const auto module = kernel_module_candidate_list_A[module_id];
-        if (m * n / (module.smem_m * module.smem_n) >
-            handle->num_sms * 2 /*A magic number :) */) {
-          gemm_module_A = module;
-          break;
-        }
-      }
+    if (handle->gemm_module[code_A].empty() ||
+        handle->gemm_module[code_B].empty()) {
+      return CUBLAS_STATUS_NOT_SUPPORTED;
+    }
 
-      for (module_id = 0; module_id < cumpsgemm::num_kernel_candidates - 1;
-           module_id++) {
-        const auto module = kernel_module_candidate_list_B[module_id];
-        if (m * n / (module.smem_m * module.smem_n) >
-            handle->num_sms * 2 /*A magic number :) */) {
-          gemm_module_B = module;
-          break;
-        }
-      }
+    // Both modes take the split-K path if it is selected for mode_B
+    const auto module_id_A = select_kernel_module(
+        handle, handle->gemm_module[code_A], m, n, k, 1, beta_scalar);
+    const auto &split_k_module_B = handle->gemm_atomic_module[code_B];
+    const auto module_id_B = select_kernel_module(
+        handle, handle->gemm_module[code_B], &split_k_module_B,
+        get_split_k_plan<T>(handle, split_k_module_B, m, n, k), m, n, k, 1,
+        beta_scalar);
+    if (module_id_B != cumpsgemm::kernel_registry::split_k_module_id) {
+      const auto gemm_module_A = handle->gemm_module[code_A][module_id_A];
+      const auto gemm_module_B = handle->gemm_module[code_B][module_id_B];
 
       if (used_kernel_modeule_id != nullptr) {
         *used_kernel_modeule_id = 100;
@@ -346,11 +600,12 @@ cumpsgemm::gemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel_A");
       }
-      launch_kernel<T>(gemm_module_A,
-                       handle->dynamic_launch_handle->flag_buffer +
-                           handle->dynamic_launch_handle->enabled_id,
-                       m, n, k, *alpha, a_dmem_ptr, lda, b_dmem_ptr, ldb, *beta,
-                       c_dmem_ptr, ldc, handle->cuda_stream);
+      launch_registry_kernel<T>(
+          handle, gemm_module_A,
+          handle->dynamic_launch_handle->flag_buffer +
+              handle->dynamic_launch_handle->enabled_id,
+          m, n, k, alpha_scalar, a_dmem_ptr, lda, b_dmem_ptr, ldb, beta_scalar,
+          c_dmem_ptr, ldc);
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel_A");
       }
@@ -358,27 +613,21 @@ cumpsgemm::gemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel_B");
       }
-      launch_kernel<T>(gemm_module_B,
-                       handle->dynamic_launch_handle->flag_buffer +
-                           handle->dynamic_launch_handle->enabled_id,
-                       m, n, k, *alpha, a_dmem_ptr, lda, b_dmem_ptr, ldb, *beta,
-                       c_dmem_ptr, ldc, handle->cuda_stream);
+      launch_registry_kernel<T>(
+          handle, gemm_module_B,
+          handle->dynamic_launch_handle->flag_buffer +
+              handle->dynamic_launch_handle->enabled_id,
+          m, n, k, alpha_scalar, a_dmem_ptr, lda, b_dmem_ptr, ldb, beta_scalar,
+          c_dmem_ptr, ldc);
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel_B");
       }
     } else {
-      T *r_c_dmem_ptr = c_dmem_ptr;
-      uint64_t r_ldc = ldc;
-      if (!cumpsgemm::device::is_zero(*beta)) {
-        r_c_dmem_ptr = reinterpret_cast<T *>(handle->temp_working_memory);
-        r_ldc = m;
-      }
-      // Initialize working memory
-      fill_zero(r_c_dmem_ptr, m, n, r_ldc, handle->cuda_stream);
-
-      // Main GEMM
+      // The kernel of the other mode returns without touching the counters
       const auto gemm_module_A = handle->gemm_atomic_module[code_A];
       const auto gemm_module_B = handle->gemm_atomic_module[code_B];
+      const auto plan_A = get_split_k_plan<T>(handle, gemm_module_A, m, n, k);
+      const auto plan_B = get_split_k_plan<T>(handle, gemm_module_B, m, n, k);
 
       if (used_kernel_modeule_id != nullptr) {
         *used_kernel_modeule_id = ~0u;
@@ -387,31 +636,41 @@ cumpsgemm::gemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel_A");
       }
-      launch_kernel<T>(gemm_module_A,
-                       handle->dynamic_launch_handle->flag_buffer +
-                           handle->dynamic_launch_handle->enabled_id,
-                       m, n, k, *alpha, a_dmem_ptr, lda, b_dmem_ptr, ldb, *beta,
-                       r_c_dmem_ptr, r_ldc, handle->cuda_stream);
+      if (plan_A.num_splits != 0) {
+        launch_split_k_kernel<T>(
+            gemm_module_A, plan_A,
+            handle->dynamic_launch_handle->flag_buffer +
+                handle->dynamic_launch_handle->enabled_id,
+            m, n, k, alpha_scalar, a_dmem_ptr, lda, b_dmem_ptr, ldb,
+            beta_scalar, c_dmem_ptr, ldc,
+            reinterpret_cast<T *>(handle->temp_working_memory),
+            handle->split_k_counter, handle->raster_group_width,
+            handle->cuda_stream);
+      } else {
+        launch_registry_kernel<T>(
+            handle, handle->gemm_module[code_A][module_id_A],
+            handle->dynamic_launch_handle->flag_buffer +
+                handle->dynamic_launch_handle->enabled_id,
+            m, n, k, alpha_scalar, a_dmem_ptr, lda, b_dmem_ptr, ldb,
+            beta_scalar, c_dmem_ptr, ldc);
+      }
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel_A");
       }
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.start_timer_sync("gemm_kernel_B");
       }
-      launch_kernel<T>(gemm_module_B,
-                       handle->dynamic_launch_handle->flag_buffer +
-                           handle->dynamic_launch_handle->enabled_id,
-                       m, n, k, *alpha, a_dmem_ptr, lda, b_dmem_ptr, ldb, *beta,
-                       r_c_dmem_ptr, r_ldc, handle->cuda_stream);
+      launch_split_k_kernel<T>(
+          gemm_module_B, plan_B,
+          handle->dynamic_launch_handle->flag_buffer +
+              handle->dynamic_launch_handle->enabled_id,
+          m, n, k, alpha_scalar, a_dmem_ptr, lda, b_dmem_ptr, ldb, beta_scalar,
+          c_dmem_ptr, ldc, reinterpret_cast<T *>(handle->temp_working_memory),
+          handle->split_k_counter, handle->raster_group_width,
+          handle->cuda_stream);
       if (handle->exp_stats_handle->profiling_enabled) {
         handle->exp_stats_handle->profiler.stop_timer_sync("gemm_kernel_B");
       }
-      // post process if needed
-      if (!cumpsgemm::device::is_zero(*beta)) {
-        post_atomic(c_dmem_ptr,
-                    reinterpret_cast<T *>(handle->temp_working_memory), m, n,
-                    ldc, m, *beta, handle->cuda_stream);
-      }
     }
   }
 
@@ -428,35 +687,36 @@ cublasStatus_t cumpsgemm::gemm_stridedBatch(
     T *const c_dmem_ptr, const uint64_t ldc, const uint64_t stridec,
     const uint64_t batch_count, const cuMpSGEMM_compute_mode_t compute_mode,
     unsigned *const used_kernel_modeule_id) {
-  if (m * n > (1lu << 24)) {
-    for (std::uint64_t i = 0; i < batch_count; i++) {
-      cumpsgemm::gemm(handle, op_A, op_B, m, n, k, alpha,
-                      a_dmem_ptr + i * stridea, lda, b_dmem_ptr + i * strideb,
-                      ldb, beta, c_dmem_ptr + i * stridec, ldc, compute_mode,
-                      used_kernel_modeule_id);
-    }
-    return CUBLAS_STATUS_SUCCESS;
-  }
+  const auto alpha_scalar = get_scalar(handle, alpha);
+  const auto beta_scalar = get_scalar(handle, beta);
 
   if (compute_mode != CUMPSGEMM_AUTO) {
     const auto code = gen_module_code<T>(op_A, op_B, compute_mode);
 
-    const auto kernel_module_candidate_list =
+    const auto &kernel_module_candidate_list =
         handle->gemm_stridedBatch_module[code];
-
-    unsigned module_id;
-    auto gemm_module =
-        kernel_module_candidate_list[cumpsgemm::num_kernel_candidates - 1];
-    for (module_id = 0; module_id < cumpsgemm::num_kernel_candidates - 1;
-         module_id++) {
-      const auto module = kernel_module_candidate_list[module_id];
-      if (m * n / (module.smem_m * module.smem_n) * batch_count >
-          handle->num_sms * 32 /*A magic number :) */) {
-        gemm_module = module;
-        break;
-      }
+    if (kernel_module_candidate_list.empty()) {
+      return CUBLAS_STATUS_NOT_SUPPORTED;
     }
 
+    auto module_id =
+        select_kernel_module(handle, kernel_module_candidate_list, m, n, k,
+                             batch_count, beta_scalar);
+    module_id = select_tuned_kernel_module(
+        handle, cumpsgemm::tuning_cache::stridedBatch, code,
+        get_tuning_candidates<T>(handle, kernel_module_candidate_list, false, m,
+                                 n, k),
+        module_id, m, n, k, batch_count, beta_scalar, c_dmem_ptr,
+        stridec * (batch_count - 1) + ldc * (n - 1) + m,
+        [&](const unsigned id, T *const c_ptr) {
+          launch_kernel<T>(kernel_module_candidate_list[id], nullptr, m, n, k,
+                           alpha_scalar, a_dmem_ptr, lda, stridea, b_dmem_ptr,
+                           ldb, strideb, beta_scalar, c_ptr, ldc, stridec,
+                           batch_count, handle->raster_group_width,
+                           handle->cuda_stream);
+        });
+    const auto gemm_module = kernel_module_candidate_list[module_id];
+
     if (used_kernel_modeule_id != nullptr) {
       *used_kernel_modeule_id = module_id;
     }
@@ -465,9 +725,10 @@ cublasStatus_t cumpsgemm::gemm_stridedBatch(
       handle->exp_stats_handle->profiler.start_timer_sync(
           "batched_gemm_kernel");
     }
-    launch_kernel<T>(gemm_module, nullptr, m, n, k, *alpha, a_dmem_ptr, lda,
-                     stridea, b_dmem_ptr, ldb, strideb, *beta, c_dmem_ptr, ldc,
-                     stridec, batch_count, handle->cuda_stream);
+    launch_kernel<T>(gemm_module, nullptr, m, n, k, alpha_scalar, a_dmem_ptr,
+                     lda, stridea, b_dmem_ptr, ldb, strideb, beta_scalar,
+                     c_dmem_ptr, ldc, stridec, batch_count,
+                     handle->raster_group_width, handle->cuda_stream);
     if (handle->exp_stats_handle->profiling_enabled) {
       handle->exp_stats_handle->profiler.stop_timer_sync("batched_gemm_kernel");
     }
@@ -477,36 +738,23 @@ cublasStatus_t cumpsgemm::gemm_stridedBatch(
     const auto code_B =
         gen_module_code<T>(op_A, op_B, handle->dynamic_launch_handle->mode_B);
 
-    const auto kernel_module_candidate_list_A =
+    const auto &kernel_module_candidate_list_A =
         handle->gemm_stridedBatch_module[code_A];
-    const auto kernel_module_candidate_list_B =
+    const auto &kernel_module_candidate_list_B =
         handle->gemm_stridedBatch_module[code_B];
-
-    unsigned module_id;
-    auto gemm_module_A =
-        kernel_module_candidate_list_A[cumpsgemm::num_kernel_candidates - 1];
-    auto gemm_module_B =
-        kernel_module_candidate_list_B[cumpsgemm::num_kernel_candidates - 1];
-
-    for (module_id = 0; module_id < cumpsgemm::num_kernel_candidates - 1;
-         module_id++) {
-      const auto module = kernel_module_candidate_list_A[module_id];
-      if (m * n / (module.smem_m * module.smem_n) * batch_count >
-          handle->num_sms * 32 /*A magic number :) */) {
-        gemm_module_A = module;
-        break;
-      }
+    if (kernel_module_candidate_list_A.empty() ||
+        kernel_module_candidate_list_B.empty()) {
+      return CUBLAS_STATUS_NOT_SUPPORTED;
     }
 
-    for (module_id = 0; module_id < cumpsgemm::num_kernel_candidates - 1;
-         module_id++) {
-      const auto module = kernel_module_candidate_list_B[module_id];
-      if (m * n / (module.smem_m * module.smem_n) * batch_count >
-          handle->num_sms * 32 /*A magic number :) */) {
-        gemm_module_B = module;
-        break;
-      }
-    }
+    const auto gemm_module_A =
+        kernel_module_candidate_list_A[select_kernel_module(
+            handle, kernel_module_candidate_list_A, m, n, k, batch_count,
+            beta_scalar)];
+    const auto gemm_module_B =
+        kernel_module_candidate_list_B[select_kernel_module(
+            handle, kernel_module_candidate_list_B, m, n, k, batch_count,
+            beta_scalar)];
 
     if (used_kernel_modeule_id != nullptr) {
       *used_kernel_modeule_id = ~0u;
@@ -519,8 +767,9 @@ cublasStatus_t cumpsgemm::gemm_stridedBatch(
     launch_kernel<T>(gemm_module_A,
                      handle->dynamic_launch_handle->flag_buffer +
                          handle->dynamic_launch_handle->enabled_id,
-                     m, n, k, *alpha, a_dmem_ptr, lda, stridea, b_dmem_ptr, ldb,
-                     strideb, *beta, c_dmem_ptr, ldc, stridec, batch_count,
+                     m, n, k, alpha_scalar, a_dmem_ptr, lda, stridea,
+                     b_dmem_ptr, ldb, strideb, beta_scalar, c_dmem_ptr, ldc,
+                     stridec, batch_count, handle->raster_group_width,
                      handle->cuda_stream);
     if (handle->exp_stats_handle->profiling_enabled) {
       handle->exp_stats_handle->profiler.stop_timer_sync(
@@ -534,8 +783,9 @@ cublasStatus_t cumpsgemm::gemm_stridedBatch(
     launch_kernel<T>(gemm_module_B,
                      handle->dynamic_launch_handle->flag_buffer +
                          handle->dynamic_launch_handle->enabled_id,
-                     m, n, k, *alpha, a_dmem_ptr, lda, stridea, b_dmem_ptr, ldb,
-                     strideb, *beta, c_dmem_ptr, ldc, stridec, batch_count,
+                     m, n, k, alpha_scalar, a_dmem_ptr, lda, stridea,
+                     b_dmem_ptr, ldb, strideb, beta_scalar, c_dmem_ptr, ldc,
+                     stridec, batch_count, handle->raster_group_width,
                      handle->cuda_stream);
     if (handle->exp_stats_handle->profiling_enabled) {
       handle->exp_stats_handle->profiler.stop_timer_sync(
@@ -546,6 +796,109 @@ cublasStatus_t cumpsgemm::gemm_stridedBatch(
   return CUBLAS_STATUS_SUCCESS;
 }
 
+template <class T>
+cublasStatus_t cumpsgemm::gemm_batchPtr(
+    cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const T *alpha, const T *const *const a_dmem_ptr_list,
+    const uint64_t lda, const T *const *const b_dmem_ptr_list,
+    const uint64_t ldb, const T *beta, T *const *const c_dmem_ptr_list,
+    const uint64_t ldc, const uint64_t batch_count,
+    const cuMpSGEMM_compute_mode_t compute_mode,
+    unsigned *const used_kernel_modeule_id) {
+  const auto alpha_scalar = get_scalar(handle, alpha);
+  const auto beta_scalar = get_scalar(handle, beta);
+
+  if (compute_mode != CUMPSGEMM_AUTO) {
+    const auto code = gen_module_code<T>(op_A, op_B, compute_mode);
+
+    const auto &kernel_module_candidate_list =
+        handle->gemm_batchPtr_module[code];
+    if (kernel_module_candidate_list.empty()) {
+      return CUBLAS_STATUS_NOT_SUPPORTED;
+    }
+
+    const auto module_id =
+        select_kernel_module(handle, kernel_module_candidate_list, m, n, k,
+                             batch_count, beta_scalar);
+    const auto gemm_module = kernel_module_candidate_list[module_id];
+
+    if (used_kernel_modeule_id != nullptr) {
+      *used_kernel_modeule_id = module_id;
+    }
+
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.start_timer_sync(
+          "batched_gemm_kernel");
+    }
+    launch_kernel<T>(gemm_module, nullptr, m, n, k, alpha_scalar,
+                     a_dmem_ptr_list, lda, b_dmem_ptr_list, ldb, beta_scalar,
+                     c_dmem_ptr_list, ldc, batch_count, handle->cuda_stream);
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.stop_timer_sync("batched_gemm_kernel");
+    }
+  } else {
+    const auto code_A =
+        gen_module_code<T>(op_A, op_B, handle->dynamic_launch_handle->mode_A);
+    const auto code_B =
+        gen_module_code<T>(op_A, op_B, handle->dynamic_launch_handle->mode_B);
+
+    const auto &kernel_module_candidate_list_A =
+        handle->gemm_batchPtr_module[code_A];
+    const auto &kernel_module_candidate_list_B =
+        handle->gemm_batchPtr_module[code_B];
+    if (kernel_module_candidate_list_A.empty() ||
+        kernel_module_candidate_list_B.empty()) {
+      return CUBLAS_STATUS_NOT_SUPPORTED;
+    }
+
+    const auto gemm_module_A =
+        kernel_module_candidate_list_A[select_kernel_module(
+            handle, kernel_module_candidate_list_A, m, n, k, batch_count,
+            beta_scalar)];
+    const auto gemm_module_B =
+        kernel_module_candidate_list_B[select_kernel_module(
+            handle, kernel_module_candidate_list_B, m, n, k, batch_count,
+            beta_scalar)];
+
+    if (used_kernel_modeule_id != nullptr) {
+      *used_kernel_modeule_id = ~0u;
+    }
+
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.start_timer_sync(
+          "batched_gemm_kernel_A");
+    }
+    launch_kernel<T>(gemm_module_A,
+                     handle->dynamic_launch_handle->flag_buffer +
+                         handle->dynamic_launch_handle->enabled_id,
+                     m, n, k, alpha_scalar, a_dmem_ptr_list, lda,
+                     b_dmem_ptr_list, ldb, beta_scalar, c_dmem_ptr_list, ldc,
+                     batch_count, handle->cuda_stream);
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.stop_timer_sync(
+          "batched_gemm_kernel_A");
+    }
+
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.start_timer_sync(
+          "batched_gemm_kernel_B");
+    }
+    launch_kernel<T>(gemm_module_B,
+                     handle->dynamic_launch_handle->flag_buffer +
+                         handle->dynamic_launch_handle->enabled_id,
+                     m, n, k, alpha_scalar, a_dmem_ptr_list, lda,
+                     b_dmem_ptr_list, ldb, beta_scalar, c_dmem_ptr_list, ldc,
+                     batch_count, handle->cuda_stream);
+    if (handle->exp_stats_handle->profiling_enabled) {
+      handle->exp_stats_handle->profiler.stop_timer_sync(
+          "batched_gemm_kernel_B");
+    }
+  }
+
+  return CUBLAS_STATUS_SUCCESS;
+}
+
 extern "C" {
 cublasStatus_t
 cuMpSGEMM_sgemm(cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
@@ -602,6 +955,37 @@ cublasStatus_t cuMpSGEMM_cgemm_strided_batch(
       handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr, lda, stridea, b_dmem_ptr,
       ldb, strideb, beta, c_dmem_ptr, ldc, stridec, batch_count, compute_mode);
 }
+
+cublasStatus_t cuMpSGEMM_sgemm_batched(
+    cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const float *alpha,
+    const float *const *const a_dmem_ptr_list, const uint64_t lda,
+    const float *const *const b_dmem_ptr_list, const uint64_t ldb,
+    const float *beta, float *const *const c_dmem_ptr_list, const uint64_t ldc,
+    const uint64_t batch_count, const cuMpSGEMM_compute_mode_t compute_mode) {
+  assert(op_A != CUBLAS_OP_C);
+  assert(op_B != CUBLAS_OP_C);
+  return cumpsgemm::gemm_batchPtr<float>(
+      handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr_list, lda,
+      b_dmem_ptr_list, ldb, beta, c_dmem_ptr_list, ldc, batch_count,
+      compute_mode);
+}
+
+cublasStatus_t cuMpSGEMM_cgemm_batched(
+    cuMpSGEMM_handle_t handle, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const cuComplex *alpha,
+    const cuComplex *const *const a_dmem_ptr_list, const uint64_t lda,
+    const cuComplex *const *const b_dmem_ptr_list, const uint64_t ldb,
+    const cuComplex *beta, cuComplex *const *const c_dmem_ptr_list,
+    const uint64_t ldc, const uint64_t batch_count,
+    const cuMpSGEMM_compute_mode_t compute_mode) {
+  return cumpsgemm::gemm_batchPtr<cuComplex>(
+      handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr_list, lda,
+      b_dmem_ptr_list, ldb, beta, c_dmem_ptr_list, ldc, batch_count,
+      compute_mode);
+}
 } // extern "C"
 
 std::pair<std::size_t, std::size_t>
@@ -781,6 +1165,34 @@ cumpsgemm::get_next_dynamic_launch_buffer_id(cuMpSGEMM_handle_t handle) {
       handle);
 }
 
+void cumpsgemm::set_auto_fallback_mode(cuMpSGEMM_handle_t handle,
+                                       const cuMpSGEMM_compute_mode_t mode) {
+  cumpsgemm::dynamic_launch::set_fallback_mode(handle, mode);
+}
+
+cuMpSGEMM_compute_mode_t
+cumpsgemm::get_auto_fallback_mode(cuMpSGEMM_handle_t handle) {
+  return handle->dynamic_launch_handle->mode_A;
+}
+
+void cumpsgemm::set_deterministic_mode(cuMpSGEMM_handle_t handle,
+                                       const bool enabled) {
+  handle->deterministic = enabled;
+}
+
+bool cumpsgemm::get_deterministic_mode(cuMpSGEMM_handle_t handle) {
+  return handle->deterministic;
+}
+
+void cumpsgemm::set_raster_group_width(cuMpSGEMM_handle_t handle,
+                                       const unsigned width) {
+  handle->raster_group_width = width;
+}
+
+unsigned cumpsgemm::get_raster_group_width(cuMpSGEMM_handle_t handle) {
+  return handle->raster_group_width;
+}
+
 cuMpSGEMM_compute_mode_t
 cumpsgemm::get_dynamic_launch_gemm_compute_mode(cuMpSGEMM_handle_t handle,
                                                 const unsigned buffer_id) {
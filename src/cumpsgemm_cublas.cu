@@ -1,19 +1,33 @@
+#include "capture.hpp"
+#include "compute_mode_cache.hpp"
+#include "config.hpp"
+#include "control_memo.hpp"
 #include "culip.hpp"
 #include "dynamic_launch.hpp"
 #include "dynamic_launch_utils.hpp"
 #include "dynamic_scaling.hpp"
 #include "exp_stats.hpp"
 #include "handle.hpp"
+#include "rule_file.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 #include <cugemm_Mx2x2.hpp>
 #include <cumpsgemm/cumpsgemm.hpp>
 #include <cumpsgemm/hijack_control.hpp>
+#include <atomic>
+#include <cublasLt.h>
 #include <cutf/memory.hpp>
 #include <dlfcn.h>
 #include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <unistd.h>
+#include <vector>
 
 #ifndef CUBLASAPI
 #define CUBLASAPI
@@ -28,13 +42,90 @@ std::string get_XeY_format_string(const double a) {
   return ss.str();
 }
 cuMpSGEMM_handle_t internal_global_cuMpSGEMM_handle = nullptr;
-std::string internal_global_last_called_function_str = "";
-bool global_internal_gemm_Mx2x2_enabled = false;
-bool restore_AB = true;
-cumpsgemm::hijack_control::control_function_t internal_global_control_func;
+std::once_flag internal_global_cuMpSGEMM_handle_flag;
+// The last hijacked call of the thread. The hijacked calls only store the
+// fields, and the string is built when it is read.
+struct last_called_function_t {
+  // nullptr if the string set by set_last_called_function_str is used
+  const char *func_name = nullptr;
+  cublasOperation_t op_A;
+  cublasOperation_t op_B;
+  std::uint64_t m, n, k;
+  std::uint64_t batch_count;
+  cuMpSGEMM_compute_mode_t compute_mode;
+  std::string str;
+};
+thread_local last_called_function_t internal_global_last_called_function;
+
+// func_name must be a string with static storage duration such as __func__
+void set_last_called_function(const char *const func_name,
+                              const cublasOperation_t op_A,
+                              const cublasOperation_t op_B,
+                              const std::uint64_t m, const std::uint64_t n,
+                              const std::uint64_t k,
+                              const std::uint64_t batch_count,
+                              const cuMpSGEMM_compute_mode_t compute_mode) {
+  auto &last = internal_global_last_called_function;
+  last.func_name = func_name;
+  last.op_A = op_A;
+  last.op_B = op_B;
+  last.m = m;
+  last.n = n;
+  last.k = k;
+  last.batch_count = batch_count;
+  last.compute_mode = compute_mode;
+}
+std::atomic<bool> global_internal_gemm_Mx2x2_enabled(false);
+std::atomic<bool> global_internal_deterministic_enabled(false);
+std::atomic<bool> restore_AB(true);
+
+enum hijack_control_t { static_mode, dynamic_mode };
+
+// The compute mode selection config is an immutable snapshot.
+// A writer publishes a new snapshot and the hijacking functions read it without
+// locking.
+struct hijack_config_t {
+  hijack_control_t hijack_mode = dynamic_mode;
+  cuMpSGEMM_compute_mode_t compute_mode = CUMPSGEMM_CUBLAS;
+  cumpsgemm::hijack_control::control_function_t control_func;
+  // Set by set_control_rules and looked up before the control function
+  std::shared_ptr<const cumpsgemm::rule_file::decision_table_t> control_table;
+
+  // Cached compute mode decisions are valid only in the same epoch
+  bool compute_mode_cache_enabled = true;
+  std::uint64_t epoch = 0;
+};
+
+const std::string compute_mode_cache_env_name = "CUMPSGEMM_COMPUTE_MODE_CACHE";
+hijack_config_t get_default_hijack_config() {
+  hijack_config_t config;
+  const auto env = getenv(compute_mode_cache_env_name.c_str());
+  if (env != nullptr && std::string(env) == "0") {
+    config.compute_mode_cache_enabled = false;
+  }
+  return config;
+}
+cumpsgemm::snapshot_t<hijack_config_t> internal_global_hijack_config(
+    std::make_shared<const hijack_config_t>(get_default_hijack_config()));
+
+std::shared_ptr<const hijack_config_t> load_hijack_config() {
+  return internal_global_hijack_config.load();
+}
+
+const char *get_hijack_mode_str() {
+  return load_hijack_config()->hijack_mode == dynamic_mode ? "dynamic"
+                                                           : "static";
+}
 
-enum hijack_control_t { static_mode, dynamic_mode } hijack_mode = dynamic_mode;
-cuMpSGEMM_compute_mode_t internal_global_compute_mode = CUMPSGEMM_CUBLAS;
+template <class Func> void update_hijack_config(const Func func) {
+  internal_global_hijack_config.update(
+      [&](const hijack_config_t *const current) {
+        auto new_config = *current;
+        func(new_config);
+        new_config.epoch++;
+        return new_config;
+      });
+}
 
 void *cuMpSGEMM_get_function_pointer(const std::string function_name,
                                      const std::string library_name = "") {
@@ -84,22 +175,23 @@ template <> inline cudaDataType_t get_cuda_data_type<cuComplex>() {
   return CUDA_C_32F;
 }
 
-const std::string gemm_Mx2x2_env_name = "CUMPSGEMM_CUSTOM_GEMM_MX2X2";
 bool is_gemm_Mx2x2_enabled() {
-  if (global_internal_gemm_Mx2x2_enabled) {
-    return true;
-  }
+  return global_internal_gemm_Mx2x2_enabled ||
+         cumpsgemm::config::get()->custom_gemm_Mx2x2_enabled;
+}
 
-  const auto env = getenv(gemm_Mx2x2_env_name.c_str());
-  if (env == nullptr || std::string(env) == "0") {
-    return false;
-  }
+bool is_deterministic_enabled() {
+  return global_internal_deterministic_enabled ||
+         cumpsgemm::config::get()->deterministic_enabled;
+}
 
-  return true;
+unsigned get_raster_group_width() {
+  const auto width = cumpsgemm::config::get()->raster_group_width;
+  return width < 0 ? cumpsgemm::default_raster_group_width : width;
 }
 
 cuMpSGEMM_handle_t cuMpSGEMM_get_internal_global_handle() {
-  if (internal_global_cuMpSGEMM_handle == nullptr) {
+  std::call_once(internal_global_cuMpSGEMM_handle_flag, [&]() {
     cuMpSGEMM_log("Initialize cuMpSGEMM handle...");
     if (cuMpSGEMM_create(&internal_global_cuMpSGEMM_handle) !=
         CUBLAS_STATUS_SUCCESS) {
@@ -133,6 +225,17 @@ cuMpSGEMM_handle_t cuMpSGEMM_get_internal_global_handle() {
         init_float_by_env("CUMPSGEMM_AUTO_UNDERFLOW_TOLERANCE_RATE", 0);
     const auto restore_AB_scaling =
         init_int_by_env("CUMPSGEMM_AUTO_RESTORE_AB_SCALING", 1);
+    const auto fallback_mode_env = getenv("CUMPSGEMM_AUTO_FALLBACK_MODE");
+    if (fallback_mode_env != nullptr) {
+      const std::string fallback_mode_str = fallback_mode_env;
+      if (fallback_mode_str == "BF16TCEC") {
+        cumpsgemm::set_auto_fallback_mode(internal_global_cuMpSGEMM_handle,
+                                          CUMPSGEMM_BF16TCEC);
+      } else if (fallback_mode_str != "TF32TCEC") {
+        cuMpSGEMM_error("Unknown CUMPSGEMM_AUTO_FALLBACK_MODE = " +
+                        fallback_mode_str + ". Ignored");
+      }
+    }
 
     cuMpSGEMM_log("AUTO config: ignore_threshold=" +
                   get_XeY_format_string(ignore_threshold) + " @Init");
@@ -142,22 +245,381 @@ cuMpSGEMM_handle_t cuMpSGEMM_get_internal_global_handle() {
                   get_XeY_format_string(underflow_tolerance_rate) + " @Init");
     cuMpSGEMM_log("AUTO config: restore_AB_scaling=" +
                   std::to_string(restore_AB_scaling) + " @Init");
+    cuMpSGEMM_log("AUTO config: fallback_mode=" +
+                  std::string(cuMpSGEMM_get_compute_mode_string(
+                      cumpsgemm::get_auto_fallback_mode(
+                          internal_global_cuMpSGEMM_handle))) +
+                  " @Init");
     cuMpSGEMM_log(
         "CUSTOM_GEMM_MX2X2: " +
         std::string(is_gemm_Mx2x2_enabled() ? "enabled" : "disabled") +
         " @Init");
+    cuMpSGEMM_log(
+        "DETERMINISTIC: " +
+        std::string(is_deterministic_enabled() ? "enabled" : "disabled") +
+        " @Init");
+    cuMpSGEMM_log("RASTER_GROUP_WIDTH: " +
+                  std::to_string(get_raster_group_width()) + " @Init");
 
-    cumpsgemm::set_exp_stats_params(cuMpSGEMM_get_internal_global_handle(),
+    cumpsgemm::set_exp_stats_params(internal_global_cuMpSGEMM_handle,
                                     ignore_threshold, underflow_threshold,
                                     underflow_tolerance_rate);
     restore_AB = restore_AB_scaling;
-  }
+  });
 
   return internal_global_cuMpSGEMM_handle;
 }
 
 const std::string rule_lib_name = "libcumpsgemm_rule.so";
 const std::string cublas_lib_name = "libcublas.so";
+
+using rule_func_t = cuMpSGEMM_compute_mode_t (*)(
+    const char *const, cublasHandle_t const, const cublasOperation_t,
+    const cublasOperation_t, const unsigned, const unsigned, const unsigned);
+using cublasGemmEx_func_t = cublasStatus_t (*)(
+    cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
+    const void *, const void *, cudaDataType_t, int, const void *,
+    cudaDataType_t, int, const void *, void *, cudaDataType_t, int,
+    cublasComputeType_t, cublasGemmAlgo_t);
+using cublasGemmStridedBatchedEx_func_t = cublasStatus_t (*)(
+    cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
+    const void *, const void *, cudaDataType_t, int, long long int,
+    const void *, cudaDataType_t, int, long long int, const void *, void *,
+    cudaDataType_t, int, long long int, int, cublasComputeType_t,
+    cublasGemmAlgo_t);
+using cublasGemmBatchedEx_func_t = cublasStatus_t (*)(
+    cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
+    const void *, const void *const *, cudaDataType_t, int,
+    const void *const *, cudaDataType_t, int, const void *, void *const *,
+    cudaDataType_t, int, int, cublasComputeType_t, cublasGemmAlgo_t);
+using cublasDestroy_func_t = cublasStatus_t (*)(cublasHandle_t);
+using cublasLtMatmul_func_t = cublasStatus_t (*)(
+    cublasLtHandle_t, cublasLtMatmulDesc_t, const void *, const void *,
+    cublasLtMatrixLayout_t, const void *, cublasLtMatrixLayout_t, const void *,
+    const void *, cublasLtMatrixLayout_t, void *, cublasLtMatrixLayout_t,
+    const cublasLtMatmulAlgo_t *, void *, size_t, cudaStream_t);
+using cublasLtMatmulDescGetAttribute_func_t = cublasStatus_t (*)(
+    cublasLtMatmulDesc_t, cublasLtMatmulDescAttributes_t, void *, size_t,
+    size_t *);
+using cublasLtMatrixLayoutGetAttribute_func_t = cublasStatus_t (*)(
+    cublasLtMatrixLayout_t, cublasLtMatrixLayoutAttribute_t, void *, size_t,
+    size_t *);
+using cublasLtDestroy_func_t = cublasStatus_t (*)(cublasLtHandle_t);
+
+// Function pointers resolved once on the first hijacked call
+struct dispatch_table_t {
+  rule_func_t rule_func = nullptr;
+  cublasGemmEx_func_t cublasGemmEx = nullptr;
+  cublasGemmStridedBatchedEx_func_t cublasGemmStridedBatchedEx = nullptr;
+  cublasGemmBatchedEx_func_t cublasGemmBatchedEx = nullptr;
+  cublasDestroy_func_t cublasDestroy_v2 = nullptr;
+  cublasLtMatmul_func_t cublasLtMatmul = nullptr;
+  cublasLtMatmulDescGetAttribute_func_t cublasLtMatmulDescGetAttribute =
+      nullptr;
+  cublasLtMatrixLayoutGetAttribute_func_t cublasLtMatrixLayoutGetAttribute =
+      nullptr;
+  cublasLtDestroy_func_t cublasLtDestroy = nullptr;
+};
+
+dispatch_table_t build_dispatch_table() {
+  dispatch_table_t table;
+
+  *(void **)(&table.rule_func) = cuMpSGEMM_get_function_pointer(
+      "cuMpSGEMM_get_compute_mode", rule_lib_name);
+  if (table.rule_func == nullptr) {
+    table.rule_func = &cuMpSGEMM_get_compute_mode;
+  }
+
+  *(void **)(&table.cublasGemmEx) =
+      cuMpSGEMM_get_function_pointer("cublasGemmEx");
+  *(void **)(&table.cublasGemmStridedBatchedEx) =
+      cuMpSGEMM_get_function_pointer("cublasGemmStridedBatchedEx");
+  *(void **)(&table.cublasGemmBatchedEx) =
+      cuMpSGEMM_get_function_pointer("cublasGemmBatchedEx");
+  *(void **)(&table.cublasDestroy_v2) =
+      cuMpSGEMM_get_function_pointer("cublasDestroy_v2");
+  *(void **)(&table.cublasLtMatmul) =
+      cuMpSGEMM_get_function_pointer("cublasLtMatmul");
+  *(void **)(&table.cublasLtMatmulDescGetAttribute) =
+      cuMpSGEMM_get_function_pointer("cublasLtMatmulDescGetAttribute");
+  *(void **)(&table.cublasLtMatrixLayoutGetAttribute) =
+      cuMpSGEMM_get_function_pointer("cublasLtMatrixLayoutGetAttribute");
+  *(void **)(&table.cublasLtDestroy) =
+      cuMpSGEMM_get_function_pointer("cublasLtDestroy");
+
+  return table;
+}
+
+const dispatch_table_t &get_dispatch_table() {
+  // The initialization of a function-local static is thread-safe
+  static const dispatch_table_t table = build_dispatch_table();
+  return table;
+}
+
+// The rules compiled from CUMPSGEMM_RULE_FILE.
+// The file is loaded again when the config is reloaded.
+struct rule_table_snapshot_t {
+  std::uint64_t config_generation;
+  cumpsgemm::rule_file::decision_table_t table;
+};
+cumpsgemm::snapshot_t<rule_table_snapshot_t> internal_global_rule_table;
+
+// The returned table is kept alive by the pointer
+std::shared_ptr<const cumpsgemm::rule_file::decision_table_t>
+get_rule_table(const cumpsgemm::config::config_t &config) {
+  auto snapshot = internal_global_rule_table.load();
+  if (snapshot == nullptr ||
+      snapshot->config_generation != config.generation) {
+    internal_global_rule_table.update(
+        [&](const rule_table_snapshot_t *const current) {
+          // Another thread may have loaded the file in the meantime
+          if (current != nullptr &&
+              current->config_generation == config.generation) {
+            return *current;
+          }
+          rule_table_snapshot_t new_snapshot;
+          new_snapshot.config_generation = config.generation;
+          if (!config.rule_file_path.empty()) {
+            try {
+              new_snapshot.table =
+                  cumpsgemm::rule_file::load(config.rule_file_path);
+              cuMpSGEMM_log(
+                  "Rule file: " + config.rule_file_path + " (" +
+                  std::to_string(new_snapshot.table.get_num_nodes()) +
+                  " nodes) @Load");
+            } catch (const std::runtime_error &e) {
+              cuMpSGEMM_error(std::string(e.what()) +
+                              ". The rule file is ignored.");
+            }
+          }
+          return new_snapshot;
+        });
+    snapshot = internal_global_rule_table.load();
+  }
+  return std::shared_ptr<const cumpsgemm::rule_file::decision_table_t>(
+      snapshot, &snapshot->table);
+}
+
+// cuMpSGEMM handles used in the hijacking functions.
+// One handle is created for each pair of a cuBLAS (or cuBLASLt) handle and its
+// stream so that all kernels are launched on the stream set by the application.
+// The internal global handle holds the configuration.
+// Each thread caches the last used handle, which is valid until the registry
+// epoch is changed by releasing handles.
+//
+// A handle is released when its cuBLAS handle is destroyed, or when more than
+// max_num_hijack_handles handles are registered and it is the least recently
+// used one that no thread caches, so that short-lived streams do not keep
+// their handles. A released handle is destroyed once no thread caches it and
+// the CUDA Graphs captured with it are destroyed.
+constexpr std::size_t max_num_hijack_handles = 16;
+
+struct hijack_handle_t {
+  cuMpSGEMM_handle_t handle;
+  // The captured graphs which may still be replayed
+  std::shared_ptr<std::atomic<std::uint64_t>> num_graph_leases;
+  // Updated when a thread starts or stops caching the handle
+  std::uint64_t last_used;
+};
+
+// Never destroyed, so that no CUDA call is made at exit and the threads exiting
+// later can still release their cached handles
+struct hijack_handle_registry_t {
+  std::mutex mutex;
+  std::map<std::pair<const void *, cudaStream_t>,
+           std::shared_ptr<hijack_handle_t>>
+      handles;
+  std::uint64_t tick = 0;
+
+  // The released handles not destroyed yet. A handle is moved here by the
+  // deleter of its shared_ptr, which may run at thread exit.
+  std::mutex retired_mutex;
+  std::vector<hijack_handle_t *> retired;
+};
+hijack_handle_registry_t &get_hijack_handle_registry() {
+  static const auto registry = new hijack_handle_registry_t;
+  return *registry;
+}
+std::atomic<std::uint64_t> internal_handle_registry_epoch(0);
+
+void retire_hijack_handle(hijack_handle_t *const hijack_handle) {
+  auto &registry = get_hijack_handle_registry();
+  std::lock_guard<std::mutex> lock(registry.retired_mutex);
+  registry.retired.push_back(hijack_handle);
+}
+
+// Destroys the retired handles not used by any graph
+void destroy_retired_hijack_handles() {
+  auto &registry = get_hijack_handle_registry();
+  std::vector<hijack_handle_t *> retired;
+  {
+    std::lock_guard<std::mutex> lock(registry.retired_mutex);
+    retired.swap(registry.retired);
+  }
+  if (retired.empty()) {
+    return;
+  }
+  // cudaFree is not allowed in this thread while another thread captures a
+  // stream in the global mode unless the mode of this thread is relaxed
+  auto capture_mode = cudaStreamCaptureModeRelaxed;
+  cudaThreadExchangeStreamCaptureMode(&capture_mode);
+  for (const auto hijack_handle : retired) {
+    if (hijack_handle->num_graph_leases->load(std::memory_order_acquire) != 0) {
+      retire_hijack_handle(hijack_handle);
+      continue;
+    }
+    cuMpSGEMM_destroy(hijack_handle->handle);
+    delete hijack_handle;
+  }
+  cudaThreadExchangeStreamCaptureMode(&capture_mode);
+}
+
+// Releases the least recently used handles that no thread caches while more
+// than max_num_hijack_handles handles are registered.
+// Called with the registry lock held.
+void evict_hijack_handles() {
+  auto &handles = get_hijack_handle_registry().handles;
+  while (handles.size() > max_num_hijack_handles) {
+    auto lru = handles.end();
+    for (auto it = handles.begin(); it != handles.end(); it++) {
+      if (it->second.use_count() == 1 &&
+          (lru == handles.end() ||
+           it->second->last_used < lru->second->last_used)) {
+        lru = it;
+      }
+    }
+    if (lru == handles.end()) {
+      return;
+    }
+    handles.erase(lru);
+  }
+}
+
+struct hijack_handle_cache_t {
+  const void *owner = nullptr;
+  cudaStream_t cuda_stream = nullptr;
+  std::shared_ptr<hijack_handle_t> hijack_handle;
+  std::uint64_t epoch = 0;
+};
+thread_local hijack_handle_cache_t hijack_handle_cache;
+
+// Keeps the handle alive until the graph being captured is destroyed
+void lease_hijack_handle_to_graph(const hijack_handle_t &hijack_handle) {
+  const auto num_graph_leases = hijack_handle.num_graph_leases;
+  num_graph_leases->fetch_add(1, std::memory_order_relaxed);
+  // The lease is kept forever if the graph cannot tell its destruction
+  cumpsgemm::call_on_graph_destroy(
+      hijack_handle.handle->cuda_stream, [num_graph_leases]() {
+        num_graph_leases->fetch_sub(1, std::memory_order_release);
+      });
+}
+
+// Returns nullptr if a new handle is needed while the stream is captured or if
+// the initialization fails
+cuMpSGEMM_handle_t
+cuMpSGEMM_get_hijack_handle(const void *const owner,
+                            cudaStream_t const cuda_stream,
+                            const cublasPointerMode_t pointer_mode) {
+  const auto epoch =
+      internal_handle_registry_epoch.load(std::memory_order_acquire);
+  if (hijack_handle_cache.hijack_handle == nullptr ||
+      hijack_handle_cache.owner != owner ||
+      hijack_handle_cache.cuda_stream != cuda_stream ||
+      hijack_handle_cache.epoch != epoch) {
+    auto &registry = get_hijack_handle_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    cudaStreamCaptureStatus capture_status;
+    const auto capturing =
+        cudaStreamIsCapturing(cuda_stream, &capture_status) != cudaSuccess ||
+        capture_status != cudaStreamCaptureStatusNone;
+    if (!capturing) {
+      destroy_retired_hijack_handles();
+    }
+    const auto key = std::make_pair(owner, cuda_stream);
+    auto it = registry.handles.find(key);
+    if (it == registry.handles.end()) {
+      cuMpSGEMM_log(
+          "Initialize cuMpSGEMM handle for a new cuBLAS handle/stream");
+      if (capturing) {
+        cuMpSGEMM_error("A cuMpSGEMM handle cannot be initialized in CUDA "
+                        "Graph capture. Call the GEMM once before the capture");
+        return nullptr;
+      }
+      cuMpSGEMM_handle_t new_handle;
+      // The buffers are initialized on the stream of the handle
+      if (cumpsgemm::create_handle(&new_handle, cuda_stream) !=
+              CUBLAS_STATUS_SUCCESS ||
+          cudaStreamSynchronize(cuda_stream) != cudaSuccess) {
+        cuMpSGEMM_error("Initialization failed.");
+        return nullptr;
+      }
+      cumpsgemm::set_auto_fallback_mode(
+          new_handle, cumpsgemm::get_auto_fallback_mode(
+                          cuMpSGEMM_get_internal_global_handle()));
+      const auto hijack_handle = std::shared_ptr<hijack_handle_t>(
+          new hijack_handle_t{
+              new_handle, std::make_shared<std::atomic<std::uint64_t>>(0), 0},
+          retire_hijack_handle);
+      it = registry.handles.emplace(key, hijack_handle).first;
+    }
+    const auto tick = ++registry.tick;
+    it->second->last_used = tick;
+    if (hijack_handle_cache.hijack_handle != nullptr) {
+      hijack_handle_cache.hijack_handle->last_used = tick;
+    }
+    hijack_handle_cache = {owner, cuda_stream, it->second, epoch};
+    evict_hijack_handles();
+  }
+  const auto &hijack_handle = *hijack_handle_cache.hijack_handle;
+  const auto handle = hijack_handle.handle;
+  if (cumpsgemm::is_capturing(handle)) {
+    lease_hijack_handle_to_graph(hijack_handle);
+  }
+
+  // The global handle is created together with the first handle, which is not
+  // in a capture
+  const auto global_handle = cuMpSGEMM_get_internal_global_handle();
+
+  handle->exp_stats_handle->enabled = global_handle->exp_stats_handle->enabled;
+  cumpsgemm::set_exp_stats_params(
+      handle, global_handle->exp_stats_handle->ignore_threshold,
+      global_handle->exp_stats_handle->underflow_threshold,
+      global_handle->exp_stats_handle->underflow_tolerance_rate);
+
+  cuMpSGEMM_set_pointer_mode(handle, pointer_mode);
+  cumpsgemm::set_deterministic_mode(handle, is_deterministic_enabled());
+  cumpsgemm::set_raster_group_width(handle, get_raster_group_width());
+
+  return handle;
+}
+
+cuMpSGEMM_handle_t
+cuMpSGEMM_get_hijack_handle(cublasHandle_t const cublas_handle,
+                            cudaStream_t const cuda_stream) {
+  cublasPointerMode_t pointer_mode;
+  CUTF_CHECK_ERROR(cublasGetPointerMode(cublas_handle, &pointer_mode));
+  return cuMpSGEMM_get_hijack_handle(static_cast<const void *>(cublas_handle),
+                                     cuda_stream, pointer_mode);
+}
+
+void cuMpSGEMM_destroy_hijack_handles(const void *const owner) {
+  auto &registry = get_hijack_handle_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto it = registry.handles.begin(); it != registry.handles.end();) {
+    if (it->first.first == owner) {
+      it = registry.handles.erase(it);
+    } else {
+      it++;
+    }
+  }
+  internal_handle_registry_epoch.fetch_add(1, std::memory_order_acq_rel);
+  // The handle cached by this thread is released here, and the ones cached
+  // by the other threads are released when they call the next GEMM
+  if (hijack_handle_cache.owner == owner) {
+    hijack_handle_cache = hijack_handle_cache_t();
+  }
+  destroy_retired_hijack_handles();
+}
 } // namespace
 
 extern "C" const char *
@@ -189,6 +651,8 @@ cuMpSGEMM_get_compute_mode_string(const cuMpSGEMM_compute_mode_t mode) {
     return "FP16TCEC_SCALING";
   case CUMPSGEMM_FP32_SIMT:
     return "FP32_SIMT";
+  case CUMPSGEMM_BF16TCEC:
+    return "BF16TCEC";
   default:
     break;
   }
@@ -198,25 +662,444 @@ cuMpSGEMM_get_compute_mode_string(const cuMpSGEMM_compute_mode_t mode) {
 extern "C" cuMpSGEMM_compute_mode_t cuMpSGEMM_get_compute_mode_internal(
     const char *const func_name, cublasHandle_t const cublas_handle,
     const cublasOperation_t op_A, const cublasOperation_t op_B,
-    const unsigned m, const unsigned n, const unsigned k) {
-  if (hijack_mode == dynamic_mode) {
-    if (internal_global_control_func) {
-      return internal_global_control_func(op_A, op_B, m, n, k);
+    const unsigned m, const unsigned n, const unsigned k,
+    const uint64_t batch_count) {
+  const auto config = load_hijack_config();
+  if (config->hijack_mode == static_mode) {
+    return config->compute_mode;
+  }
+
+  const auto env_config = cumpsgemm::config::get();
+  const auto select_compute_mode = [&]() {
+    if (config->control_table != nullptr) {
+      const auto compute_mode = config->control_table->lookup(
+          func_name, op_A, op_B, m, n, k, batch_count);
+      if (compute_mode != CUMPSGEMM_UNDEFINED) {
+        return compute_mode;
+      }
+    }
+    if (config->control_func) {
+      return config->control_func(op_A, op_B, m, n, k);
+    }
+    // The rules not in the rule file fall back to the rule library
+    const auto compute_mode = get_rule_table(*env_config)->lookup(
+        func_name, op_A, op_B, m, n, k, batch_count);
+    if (compute_mode != CUMPSGEMM_UNDEFINED) {
+      return compute_mode;
+    }
+    return get_dispatch_table().rule_func(func_name, cublas_handle, op_A, op_B,
+                                          m, n, k);
+  };
+  if (!config->compute_mode_cache_enabled) {
+    return select_compute_mode();
+  }
+
+  thread_local std::unique_ptr<cumpsgemm::compute_mode_cache::table_t>
+      cache_table;
+  thread_local std::shared_ptr<cumpsgemm::compute_mode_cache::counter_t>
+      cache_counter;
+  if (cache_table == nullptr) {
+    cache_table = std::make_unique<cumpsgemm::compute_mode_cache::table_t>();
+    cache_counter = cumpsgemm::compute_mode_cache::register_counter();
+  }
+
+  // The rule depends on the env config as well. Both the epoch and the
+  // generation only increase, so their sum changes when either is changed.
+  const cumpsgemm::compute_mode_cache::key_t key{
+      config->epoch + env_config->generation,
+      func_name,
+      cublas_handle,
+      op_A,
+      op_B,
+      m,
+      n,
+      k,
+      batch_count};
+  cuMpSGEMM_compute_mode_t compute_mode;
+  if (cache_table->find(key, compute_mode)) {
+    cumpsgemm::compute_mode_cache::increment(cache_counter->num_hits);
+    return compute_mode;
+  }
+  cumpsgemm::compute_mode_cache::increment(cache_counter->num_misses);
+
+  compute_mode = select_compute_mode();
+  cache_table->insert(key, compute_mode);
+  return compute_mode;
+}
+
+namespace {
+// An AUTO or FP16TCEC_SCALING GEMM takes two exp_stats slots and a dynamic
+// launch slot for each call captured in a CUDA Graph. The slots are not
+// reused, so the capture fails when they run out.
+bool has_graph_slots(cuMpSGEMM_handle_t const handle) {
+  if (!cumpsgemm::is_capturing(handle) ||
+      (cumpsgemm::exp_stats::get_num_free_graph_slots(handle) >= 2 &&
+       cumpsgemm::dynamic_launch::get_num_free_graph_slots(handle) >= 1)) {
+    return true;
+  }
+  cuMpSGEMM_error("All slots for CUDA Graph capture are used. Capture the "
+                  "AUTO and FP16TCEC_SCALING GEMMs on another stream");
+  return false;
+}
+} // namespace
+
+// Runs a GEMM on cuMpSGEMM including the exp_stats and scaling of AUTO and
+// FP16TCEC_SCALING
+template <class T>
+cublasStatus_t cuMpSGEMM_launch(
+    cuMpSGEMM_handle_t const handle, cudaStream_t const cuda_stream,
+    const cuMpSGEMM_compute_mode_t compute_mode, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const T *alpha, const T *const a_dmem_ptr,
+    const uint64_t lda, const T *const b_dmem_ptr, const uint64_t ldb,
+    const T *beta, T *const c_dmem_ptr, const uint64_t ldc,
+    unsigned *const used_kernel_module_id = nullptr) {
+  cumpsgemm::CULiP::profile_result profile_result;
+  const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
+  cublasStatus_t res;
+
+  if ((compute_mode == CUMPSGEMM_AUTO ||
+       compute_mode == CUMPSGEMM_FP16TCEC_SCALING) &&
+      !has_graph_slots(handle)) {
+    return CUBLAS_STATUS_ALLOC_FAILED;
+  }
+
+  if (profiling_flag) {
+    const std::string func_name =
+        std::string(std::is_same<T, float>::value ? "s" : "c") + "gemm_" +
+        std::string(cuMpSGEMM_get_compute_mode_string(compute_mode));
+    snprintf(profile_result.function_name,
+             profile_result.function_name_length - 1,
+             "%s-%s%s-m%lu-n%lu-k%lu", func_name.c_str(),
+             cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
+             cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k);
+    cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
+  }
+
+  unsigned A_exp_stats_id, B_exp_stats_id, dynamic_launch_id;
+  if (compute_mode == CUMPSGEMM_AUTO) {
+    // Exp stats
+    cumpsgemm::exp_stats::exp_stats_ext(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                        (op_A == CUBLAS_OP_N ? k : m),
+                                        a_dmem_ptr, lda, 1, 0);
+    A_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+    cumpsgemm::exp_stats::exp_stats_ext(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                        (op_B == CUBLAS_OP_N ? n : k),
+                                        b_dmem_ptr, ldb, 1, 0);
+    B_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+
+    // Kernel decision
+    dynamic_launch_id =
+        cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
+            handle);
+    cumpsgemm::dynamic_scaling::set_dynamic_launch_buffer_by_exp_stats(
+        handle, dynamic_launch_id, A_exp_stats_id, B_exp_stats_id);
+
+    // The device memory cannot be read back in CUDA Graph capture
+    if (cuMpSGEMM_is_log_enabled() && !cumpsgemm::is_capturing(handle)) {
+      int flag;
+      cutf::memory::copy(
+          &flag,
+          handle->dynamic_launch_handle->flag_buffer + dynamic_launch_id, 1);
+      const auto gemm_mode =
+          cumpsgemm::dynamic_launch::utils::get_gemm_flag(flag);
+      const auto scale_A =
+          cumpsgemm::dynamic_launch::utils::get_scale_A_flag(flag);
+      const auto scale_B =
+          cumpsgemm::dynamic_launch::utils::get_scale_B_flag(flag);
+      const auto loss_rate_A =
+          cumpsgemm::get_exp_stats(handle, A_exp_stats_id);
+      const auto loss_rate_B =
+          cumpsgemm::get_exp_stats(handle, B_exp_stats_id);
+      cuMpSGEMM_log(
+          std::string("AUTO[ignore<") +
+          get_XeY_format_string(handle->exp_stats_handle->ignore_threshold) +
+          ", uf<" +
+          get_XeY_format_string(
+              handle->exp_stats_handle->underflow_threshold) +
+          ", tolerance=" +
+          get_XeY_format_string(
+              handle->exp_stats_handle->underflow_tolerance_rate) +
+          "]: GEMM_MODE=" +
+          cuMpSGEMM_get_compute_mode_string(
+              (cuMpSGEMM_compute_mode_t)gemm_mode) +
+          ", loss_A=" + std::to_string(loss_rate_A.first) + "/" +
+          std::to_string(loss_rate_A.second) + "(" +
+          std::to_string(static_cast<double>(loss_rate_A.first) /
+                         loss_rate_A.second) +
+          "), scale_A=" + std::to_string(scale_A) +
+          ", loss_B=" + std::to_string(loss_rate_B.first) + "/" +
+          std::to_string(loss_rate_B.second) + "(" +
+          std::to_string(static_cast<double>(loss_rate_B.first) /
+                         loss_rate_B.second) +
+          "), scale_B=" + std::to_string(scale_B));
+    }
+
+    // Scaling
+    cumpsgemm::dynamic_scaling::scale_A(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                        (op_A == CUBLAS_OP_N ? k : m),
+                                        const_cast<T *>(a_dmem_ptr), lda, 0,
+                                        1, A_exp_stats_id, dynamic_launch_id);
+    cumpsgemm::dynamic_scaling::scale_B(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                        (op_B == CUBLAS_OP_N ? n : k),
+                                        const_cast<T *>(b_dmem_ptr), ldb, 0,
+                                        1, B_exp_stats_id, dynamic_launch_id);
+
+    // Enable dynamic launch
+    cumpsgemm::dynamic_launch::set_dynamic_launch_flag_buffer_id(
+        handle, dynamic_launch_id);
+  } else if (compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
+    // Force FP16TCEC with the scaling of A and B
+    dynamic_launch_id =
+        cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
+            handle);
+    int flag = 0;
+    cumpsgemm::dynamic_launch::utils::set_gemm_flag(flag, CUMPSGEMM_FP16TCEC);
+    cumpsgemm::dynamic_launch::utils::set_scale_A_flag(flag, true);
+    cumpsgemm::dynamic_launch::utils::set_scale_B_flag(flag, true);
+    cumpsgemm::dynamic_launch::set_dynamic_launch_flag(handle,
+                                                      dynamic_launch_id, flag);
+
+    cumpsgemm::exp_stats::exp_max_ext(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                      (op_A == CUBLAS_OP_N ? k : m),
+                                      a_dmem_ptr, lda, 1, 0);
+    A_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+    cumpsgemm::exp_stats::exp_max_ext(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                      (op_B == CUBLAS_OP_N ? n : k),
+                                      b_dmem_ptr, ldb, 1, 0);
+    B_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+
+    // Scaling
+    cumpsgemm::dynamic_scaling::scale_A(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                        (op_A == CUBLAS_OP_N ? k : m),
+                                        const_cast<T *>(a_dmem_ptr), lda, 0,
+                                        1, A_exp_stats_id, dynamic_launch_id);
+    cumpsgemm::dynamic_scaling::scale_B(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                        (op_B == CUBLAS_OP_N ? n : k),
+                                        const_cast<T *>(b_dmem_ptr), ldb, 0,
+                                        1, B_exp_stats_id, dynamic_launch_id);
+  }
+
+  res = cumpsgemm::gemm<T>(
+      handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr, lda, b_dmem_ptr, ldb,
+      beta, c_dmem_ptr, ldc,
+      compute_mode == CUMPSGEMM_FP16TCEC_SCALING ? CUMPSGEMM_FP16TCEC
+                                                 : compute_mode,
+      used_kernel_module_id);
+
+  if (compute_mode == CUMPSGEMM_AUTO ||
+      compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
+    cumpsgemm::dynamic_scaling::scale_C(handle, m, n, c_dmem_ptr, ldc, 0, 1,
+                                        A_exp_stats_id, B_exp_stats_id,
+                                        dynamic_launch_id);
+
+    // restore A and B
+    if (restore_AB) {
+      cumpsgemm::dynamic_scaling::reset_scale_A(
+          handle, (op_A == CUBLAS_OP_N ? m : k),
+          (op_A == CUBLAS_OP_N ? k : m), const_cast<T *>(a_dmem_ptr), lda, 0,
+          1, A_exp_stats_id, dynamic_launch_id);
+      cumpsgemm::dynamic_scaling::reset_scale_B(
+          handle, (op_B == CUBLAS_OP_N ? k : n),
+          (op_B == CUBLAS_OP_N ? n : k), const_cast<T *>(b_dmem_ptr), ldb, 0,
+          1, B_exp_stats_id, dynamic_launch_id);
+    }
+
+    cumpsgemm::dynamic_launch::unset_dynamic_launch_flag_buffer_id(handle);
+  }
+
+  if (profiling_flag) {
+    cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
+  }
+
+  return res;
+}
+
+template <class T>
+cublasStatus_t cuMpSGEMM_stridedBatched_launch(
+    cuMpSGEMM_handle_t const handle, cudaStream_t const cuda_stream,
+    const cuMpSGEMM_compute_mode_t compute_mode, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const uint64_t m, const uint64_t n,
+    const uint64_t k, const T *alpha, const T *const a_dmem_ptr,
+    const uint64_t lda, const uint64_t stridea, const T *const b_dmem_ptr,
+    const uint64_t ldb, const uint64_t strideb, const T *beta,
+    T *const c_dmem_ptr, const uint64_t ldc, const uint64_t stridec,
+    const uint64_t batch_count,
+    unsigned *const used_kernel_module_id = nullptr) {
+  cumpsgemm::CULiP::profile_result profile_result;
+  const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
+  cublasStatus_t res;
+
+  if ((compute_mode == CUMPSGEMM_AUTO ||
+       compute_mode == CUMPSGEMM_FP16TCEC_SCALING) &&
+      !has_graph_slots(handle)) {
+    return CUBLAS_STATUS_ALLOC_FAILED;
+  }
+
+  if (profiling_flag) {
+    const std::string func_name =
+        std::string(std::is_same<T, float>::value ? "s" : "c") +
+        "gemm_stridedBatch_" +
+        std::string(cuMpSGEMM_get_compute_mode_string(compute_mode));
+    snprintf(profile_result.function_name,
+             profile_result.function_name_length - 1,
+             "%s-%s%s-m%lu-n%lu-k%lu-batchCount%lu", func_name.c_str(),
+             cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
+             cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k,
+             batch_count);
+    cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
+  }
+
+  unsigned A_exp_stats_id, B_exp_stats_id, dynamic_launch_id;
+  if (compute_mode == CUMPSGEMM_AUTO) {
+    // Exp stats
+    cumpsgemm::exp_stats::exp_stats_ext(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                        (op_A == CUBLAS_OP_N ? k : m),
+                                        a_dmem_ptr, lda, batch_count,
+                                        stridea);
+    A_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+    cumpsgemm::exp_stats::exp_stats_ext(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                        (op_B == CUBLAS_OP_N ? n : k),
+                                        b_dmem_ptr, ldb, batch_count,
+                                        strideb);
+    B_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+
+    // Kernel decision
+    dynamic_launch_id =
+        cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
+            handle);
+    cumpsgemm::dynamic_scaling::set_dynamic_launch_buffer_by_exp_stats(
+        handle, dynamic_launch_id, A_exp_stats_id, B_exp_stats_id);
+
+    // The device memory cannot be read back in CUDA Graph capture
+    if (cuMpSGEMM_is_log_enabled() && !cumpsgemm::is_capturing(handle)) {
+      int flag;
+      cutf::memory::copy(
+          &flag,
+          handle->dynamic_launch_handle->flag_buffer + dynamic_launch_id, 1);
+      const auto gemm_mode =
+          cumpsgemm::dynamic_launch::utils::get_gemm_flag(flag);
+      const auto scale_A =
+          cumpsgemm::dynamic_launch::utils::get_scale_A_flag(flag);
+      const auto scale_B =
+          cumpsgemm::dynamic_launch::utils::get_scale_B_flag(flag);
+      const auto loss_rate_A =
+          cumpsgemm::get_exp_stats(handle, A_exp_stats_id);
+      const auto loss_rate_B =
+          cumpsgemm::get_exp_stats(handle, B_exp_stats_id);
+      cuMpSGEMM_log(
+          std::string("AUTO[ignore<") +
+          get_XeY_format_string(handle->exp_stats_handle->ignore_threshold) +
+          ", uf<" +
+          get_XeY_format_string(
+              handle->exp_stats_handle->underflow_threshold) +
+          ", tolerance=" +
+          get_XeY_format_string(
+              handle->exp_stats_handle->underflow_tolerance_rate) +
+          "]: GEMM_MODE=" +
+          cuMpSGEMM_get_compute_mode_string(
+              (cuMpSGEMM_compute_mode_t)gemm_mode) +
+          ", loss_A=" + std::to_string(loss_rate_A.first) + "/" +
+          std::to_string(loss_rate_A.second) + "(" +
+          std::to_string(static_cast<double>(loss_rate_A.first) /
+                         loss_rate_A.second) +
+          "), scale_A=" + std::to_string(scale_A) +
+          ", loss_B=" + std::to_string(loss_rate_B.first) + "/" +
+          std::to_string(loss_rate_B.second) + "(" +
+          std::to_string(static_cast<double>(loss_rate_B.first) /
+                         loss_rate_B.second) +
+          "), scale_B=" + std::to_string(scale_B));
     }
-    cuMpSGEMM_compute_mode_t (*func)(
-        const char *const func_name, cublasHandle_t const cublas_handle,
-        const cublasOperation_t op_A, const cublasOperation_t op_B,
-        const unsigned m, const unsigned n, const unsigned k);
-    *(void **)(&func) = cuMpSGEMM_get_function_pointer(__func__, rule_lib_name);
-
-    if (func == nullptr) {
-      return cuMpSGEMM_get_compute_mode(func_name, cublas_handle, op_A, op_B, m,
-                                        n, k);
+
+    // Scaling
+    cumpsgemm::dynamic_scaling::scale_A(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                        (op_A == CUBLAS_OP_N ? k : m),
+                                        const_cast<T *>(a_dmem_ptr), lda,
+                                        stridea, batch_count, A_exp_stats_id,
+                                        dynamic_launch_id);
+    cumpsgemm::dynamic_scaling::scale_B(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                        (op_B == CUBLAS_OP_N ? n : k),
+                                        const_cast<T *>(b_dmem_ptr), ldb,
+                                        strideb, batch_count, B_exp_stats_id,
+                                        dynamic_launch_id);
+
+    // Enable dynamic launch
+    cumpsgemm::dynamic_launch::set_dynamic_launch_flag_buffer_id(
+        handle, dynamic_launch_id);
+  } else if (compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
+    // Force FP16TCEC with the scaling of A and B
+    dynamic_launch_id =
+        cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
+            handle);
+    int flag = 0;
+    cumpsgemm::dynamic_launch::utils::set_gemm_flag(flag, CUMPSGEMM_FP16TCEC);
+    cumpsgemm::dynamic_launch::utils::set_scale_A_flag(flag, true);
+    cumpsgemm::dynamic_launch::utils::set_scale_B_flag(flag, true);
+    cumpsgemm::dynamic_launch::set_dynamic_launch_flag(handle,
+                                                      dynamic_launch_id, flag);
+
+    // Exp stats
+    cumpsgemm::exp_stats::exp_max_ext(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                      (op_A == CUBLAS_OP_N ? k : m),
+                                      a_dmem_ptr, lda, batch_count, stridea);
+    A_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+    cumpsgemm::exp_stats::exp_max_ext(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                      (op_B == CUBLAS_OP_N ? n : k),
+                                      b_dmem_ptr, ldb, batch_count, strideb);
+    B_exp_stats_id =
+        cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
+
+    // Scaling
+    cumpsgemm::dynamic_scaling::scale_A(handle, (op_A == CUBLAS_OP_N ? m : k),
+                                        (op_A == CUBLAS_OP_N ? k : m),
+                                        const_cast<T *>(a_dmem_ptr), lda,
+                                        stridea, batch_count, A_exp_stats_id,
+                                        dynamic_launch_id);
+    cumpsgemm::dynamic_scaling::scale_B(handle, (op_B == CUBLAS_OP_N ? k : n),
+                                        (op_B == CUBLAS_OP_N ? n : k),
+                                        const_cast<T *>(b_dmem_ptr), ldb,
+                                        strideb, batch_count, B_exp_stats_id,
+                                        dynamic_launch_id);
+  }
+
+  res = cumpsgemm::gemm_stridedBatch<T>(
+      handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr, lda, stridea,
+      b_dmem_ptr, ldb, strideb, beta, c_dmem_ptr, ldc, stridec, batch_count,
+      compute_mode == CUMPSGEMM_FP16TCEC_SCALING ? CUMPSGEMM_FP16TCEC
+                                                 : compute_mode,
+      used_kernel_module_id);
+
+  if (compute_mode == CUMPSGEMM_AUTO ||
+      compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
+    cumpsgemm::dynamic_scaling::scale_C(handle, m, n, c_dmem_ptr, ldc,
+                                        stridec, batch_count, A_exp_stats_id,
+                                        B_exp_stats_id, dynamic_launch_id);
+
+    // restore A and B
+    if (restore_AB) {
+      cumpsgemm::dynamic_scaling::reset_scale_A(
+          handle, (op_A == CUBLAS_OP_N ? m : k),
+          (op_A == CUBLAS_OP_N ? k : m), const_cast<T *>(a_dmem_ptr), lda,
+          stridea, batch_count, A_exp_stats_id, dynamic_launch_id);
+      cumpsgemm::dynamic_scaling::reset_scale_B(
+          handle, (op_B == CUBLAS_OP_N ? k : n),
+          (op_B == CUBLAS_OP_N ? n : k), const_cast<T *>(b_dmem_ptr), ldb,
+          strideb, batch_count, B_exp_stats_id, dynamic_launch_id);
     }
+  }
 
-    return func(func_name, cublas_handle, op_A, op_B, m, n, k);
+  if (profiling_flag) {
+    cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
   }
-  return internal_global_compute_mode;
+
+  return res;
 }
 
 template <class T>
@@ -227,8 +1110,14 @@ cublasStatus_t cuMpSGEMM_hijack_core(
     const T *const a_dmem_ptr, const uint64_t lda, const T *const b_dmem_ptr,
     const uint64_t ldb, const T *beta, T *const c_dmem_ptr,
     const uint64_t ldc) {
+  cumpsgemm::trace::scoped_record_t trace_record(func_name, op_A, op_B, m, n, k,
+                                                 1);
   cudaStream_t cuda_stream;
   cublasGetStream(cublas_handle, &cuda_stream);
+  const auto handle = cuMpSGEMM_get_hijack_handle(cublas_handle, cuda_stream);
+  if (handle == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
 
   if (m == 0 || n == 0 || k == 0 || lda == 0 || ldb == 0 || ldc == 0) {
     return CUBLAS_STATUS_INVALID_VALUE;
@@ -238,24 +1127,23 @@ cublasStatus_t cuMpSGEMM_hijack_core(
   const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
 
   cuMpSGEMM_compute_mode_t compute_mode = cuMpSGEMM_get_compute_mode_internal(
-      func_name, cublas_handle, op_A, op_B, m, n, k);
-
-  cuMpSGEMM_log(
-      std::string(func_name) + " op=(" + get_cublas_op_str(op_A) + ", " +
-      get_cublas_op_str(op_B) + "), shape=(" + std::to_string(m) + ", " +
-      std::to_string(n) + ", " + std::to_string(k) +
-      "), mode=" + cuMpSGEMM_get_compute_mode_string(compute_mode) + "[" +
-      (hijack_mode == dynamic_mode ? "dynamic" : "static") + "][exp_stats:" +
-      (cumpsgemm::hijack_control::get_internal_global_handle()
-               ->exp_stats_handle->enabled
-           ? "1"
-           : "0") +
-      "]");
-  cumpsgemm::hijack_control::set_last_called_function_str(
-      std::string(func_name) + "," + get_cublas_op_str(op_A) + "," +
-      get_cublas_op_str(op_B) + "," + std::to_string(m) + "," +
-      std::to_string(n) + "," + std::to_string(k) + "," + "1," + // batch_size
-      cuMpSGEMM_get_compute_mode_string(compute_mode));
+      func_name, cublas_handle, op_A, op_B, m, n, k, 1);
+  trace_record.record.compute_mode = compute_mode;
+  cumpsgemm::capture::capture_call(
+      func_name, cuda_stream, std::is_same<T, cuComplex>::value,
+      handle->pointer_mode, op_A, op_B, m, n, k, alpha, lda, 0, ldb, 0, beta,
+      ldc, 0, 1, compute_mode);
+
+  if (cuMpSGEMM_is_log_enabled()) {
+    cuMpSGEMM_log(
+        std::string(func_name) + " op=(" + get_cublas_op_str(op_A) + ", " +
+        get_cublas_op_str(op_B) + "), shape=(" + std::to_string(m) + ", " +
+        std::to_string(n) + ", " + std::to_string(k) +
+        "), mode=" + cuMpSGEMM_get_compute_mode_string(compute_mode) + "[" +
+        get_hijack_mode_str() + "][exp_stats:" +
+        (handle->exp_stats_handle->enabled ? "1" : "0") + "]");
+  }
+  set_last_called_function(func_name, op_A, op_B, m, n, k, 1, compute_mode);
 
   if (compute_mode == CUMPSGEMM_DRY_RUN) {
     return CUBLAS_STATUS_SUCCESS;
@@ -266,7 +1154,8 @@ cublasStatus_t cuMpSGEMM_hijack_core(
   // -----------------------------------
   // gemm_Mx2x2
   // -----------------------------------
-  if (((m & (m - 1)) == 0) && n == 2 && k == 2 && is_gemm_Mx2x2_enabled()) {
+  if (((m & (m - 1)) == 0) && n == 2 && k == 2 && is_gemm_Mx2x2_enabled() &&
+      handle->pointer_mode == CUBLAS_POINTER_MODE_HOST) {
 
     if (profiling_flag) {
       const std::string func_name =
@@ -276,9 +1165,7 @@ cublasStatus_t cuMpSGEMM_hijack_core(
                "%s-%s%s-m%lu-n%lu-k%lu", func_name.c_str(),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
     cuMpSGEMM_log(" +---> gemm_Mx2x2");
 
@@ -286,15 +1173,7 @@ cublasStatus_t cuMpSGEMM_hijack_core(
                             ldb, *beta, c_dmem_ptr, ldc, cuda_stream);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
 
     return CUBLAS_STATUS_SUCCESS;
@@ -303,7 +1182,8 @@ cublasStatus_t cuMpSGEMM_hijack_core(
   // -----------------------------------
   // gemm_2xNx2
   // -----------------------------------
-  if (((n & (n - 1)) == 0) && m == 2 && k == 2 && is_gemm_Mx2x2_enabled()) {
+  if (((n & (n - 1)) == 0) && m == 2 && k == 2 && is_gemm_Mx2x2_enabled() &&
+      handle->pointer_mode == CUBLAS_POINTER_MODE_HOST) {
 
     if (profiling_flag) {
       const std::string func_name =
@@ -313,9 +1193,7 @@ cublasStatus_t cuMpSGEMM_hijack_core(
                "%s-%s%s-m%lu-n%lu-k%lu", func_name.c_str(),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
     cuMpSGEMM_log(" +---> gemm_2xNx2");
 
@@ -323,15 +1201,7 @@ cublasStatus_t cuMpSGEMM_hijack_core(
                             ldb, *beta, c_dmem_ptr, ldc, cuda_stream);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
 
     return CUBLAS_STATUS_SUCCESS;
@@ -379,15 +1249,11 @@ cublasStatus_t cuMpSGEMM_hijack_core(
       }
     }
 
-    cublasStatus_t (*func_ptr)(
-        cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
-        const void *, const void *, cudaDataType, int, const void *,
-        cudaDataType, int, const void *, void *, cudaDataType, int,
-        cublasComputeType_t, cublasGemmAlgo_t);
-    *(void **)(&func_ptr) = cuMpSGEMM_get_function_pointer("cublasGemmEx");
+    const auto func_ptr = get_dispatch_table().cublasGemmEx;
     if (func_ptr == nullptr) {
       cuMpSGEMM_error(std::string("Could not load the cuBLAS function \"") +
                       func_name + "\"");
+      return CUBLAS_STATUS_NOT_INITIALIZED;
     }
 
     if (profiling_flag) {
@@ -396,9 +1262,7 @@ cublasStatus_t cuMpSGEMM_hijack_core(
                "%s-%s%s-m%lu-n%lu-k%lu", func_name,
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
 
     res = (*func_ptr)(cublas_handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr,
@@ -406,187 +1270,21 @@ cublasStatus_t cuMpSGEMM_hijack_core(
                       c_dmem_ptr, io_datat_type, ldc, compute_type, gemm_algo);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
 
-    if (cumpsgemm::hijack_control::get_internal_global_handle()
-            ->exp_stats_handle->enabled) {
-      cumpsgemm::exp_stats::exp_stats_ext(
-          cumpsgemm::hijack_control::get_internal_global_handle(), m, n,
-          c_dmem_ptr, ldc, 1, 0);
+    if (handle->exp_stats_handle->enabled) {
+      cumpsgemm::exp_stats::exp_stats_ext(handle, m, n, c_dmem_ptr, ldc, 1, 0);
     }
 
   } else {
     // -----------------------------------
     // cuMpSGEMM
     // -----------------------------------
-    if (profiling_flag) {
-      const std::string func_name =
-          std::string(std::is_same<T, float>::value ? "s" : "c") + "gemm_" +
-          std::string(cuMpSGEMM_get_compute_mode_string(compute_mode));
-      snprintf(profile_result.function_name,
-               profile_result.function_name_length - 1,
-               "%s-%s%s-m%lu-n%lu-k%lu", func_name.c_str(),
-               cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
-               cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
-    }
-
-    unsigned A_exp_stats_id, B_exp_stats_id, dynamic_launch_id;
-    if (compute_mode == CUMPSGEMM_AUTO) {
-      // Exp stats
-      cumpsgemm::exp_stats::exp_stats_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), a_dmem_ptr, lda, 1, 0);
-      A_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-      cumpsgemm::exp_stats::exp_stats_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), b_dmem_ptr, ldb, 1, 0);
-      B_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-
-      // Kernel decision
-      dynamic_launch_id =
-          cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
-              cuMpSGEMM_get_internal_global_handle());
-      cumpsgemm::dynamic_scaling::set_dynamic_launch_buffer_by_exp_stats(
-          cuMpSGEMM_get_internal_global_handle(), dynamic_launch_id,
-          A_exp_stats_id, B_exp_stats_id);
-
-      cuMpSGEMM_run_if_env_defined(cumpsgemm::info_env_name, [&]() {
-        int flag;
-        cutf::memory::copy(&flag,
-                           cuMpSGEMM_get_internal_global_handle()
-                                   ->dynamic_launch_handle->flag_buffer +
-                               dynamic_launch_id,
-                           1);
-        const auto gemm_mode =
-            cumpsgemm::dynamic_launch::utils::get_gemm_flag(flag);
-        const auto scale_A =
-            cumpsgemm::dynamic_launch::utils::get_scale_A_flag(flag);
-        const auto scale_B =
-            cumpsgemm::dynamic_launch::utils::get_scale_B_flag(flag);
-        const auto loss_rate_A = cumpsgemm::get_exp_stats(
-            cuMpSGEMM_get_internal_global_handle(), A_exp_stats_id);
-        const auto loss_rate_B = cumpsgemm::get_exp_stats(
-            cuMpSGEMM_get_internal_global_handle(), B_exp_stats_id);
-        cuMpSGEMM_log(
-            std::string("AUTO[ignore<") +
-            get_XeY_format_string(cuMpSGEMM_get_internal_global_handle()
-                                      ->exp_stats_handle->ignore_threshold) +
-            ", uf<" +
-            get_XeY_format_string(cuMpSGEMM_get_internal_global_handle()
-                                      ->exp_stats_handle->underflow_threshold) +
-            ", tolerance=" +
-            get_XeY_format_string(
-                cuMpSGEMM_get_internal_global_handle()
-                    ->exp_stats_handle->underflow_tolerance_rate) +
-            "]: GEMM_MODE=" +
-            cuMpSGEMM_get_compute_mode_string(
-                (cuMpSGEMM_compute_mode_t)gemm_mode) +
-            ", loss_A=" + std::to_string(loss_rate_A.first) + "/" +
-            std::to_string(loss_rate_A.second) + "(" +
-            std::to_string(static_cast<double>(loss_rate_A.first) /
-                           loss_rate_A.second) +
-            "), scale_A=" + std::to_string(scale_A) +
-            ", loss_B=" + std::to_string(loss_rate_B.first) + "/" +
-            std::to_string(loss_rate_B.second) + "(" +
-            std::to_string(static_cast<double>(loss_rate_B.first) /
-                           loss_rate_B.second) +
-            "), scale_B=" + std::to_string(scale_B));
-      });
-
-      // Scaling
-      cumpsgemm::dynamic_scaling::scale_A(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), const_cast<T *>(a_dmem_ptr), lda, 0, 1,
-          A_exp_stats_id, dynamic_launch_id);
-      cumpsgemm::dynamic_scaling::scale_B(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), const_cast<T *>(b_dmem_ptr), ldb, 0, 1,
-          B_exp_stats_id, dynamic_launch_id);
-
-      // Enable dynamic launch
-      cumpsgemm::dynamic_launch::set_dynamic_launch_flag_buffer_id(
-          cuMpSGEMM_get_internal_global_handle(), dynamic_launch_id);
-    } else if (compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
-      // Force execution mode
-      dynamic_launch_id = 1;
-
-      cumpsgemm::exp_stats::exp_max_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), a_dmem_ptr, lda, 1, 0);
-      A_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-      cumpsgemm::exp_stats::exp_max_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), b_dmem_ptr, ldb, 1, 0);
-      B_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-
-      // Scaling
-      cumpsgemm::dynamic_scaling::scale_A(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), const_cast<T *>(a_dmem_ptr), lda, 0, 1,
-          A_exp_stats_id, dynamic_launch_id);
-      cumpsgemm::dynamic_scaling::scale_B(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), const_cast<T *>(b_dmem_ptr), ldb, 0, 1,
-          B_exp_stats_id, dynamic_launch_id);
-    }
-
-    res = cumpsgemm::gemm<T>(
-        cuMpSGEMM_get_internal_global_handle(), op_A, op_B, m, n, k, alpha,
-        a_dmem_ptr, lda, b_dmem_ptr, ldb, beta, c_dmem_ptr, ldc,
-        compute_mode == CUMPSGEMM_FP16TCEC_SCALING ? CUMPSGEMM_FP16TCEC
-                                                   : compute_mode);
-
-    if (compute_mode == CUMPSGEMM_AUTO ||
-        compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
-      cumpsgemm::dynamic_scaling::scale_C(
-          cuMpSGEMM_get_internal_global_handle(), m, n, c_dmem_ptr, ldc, 0, 1,
-          A_exp_stats_id, B_exp_stats_id, dynamic_launch_id);
-
-      // restore A and B
-      if (restore_AB) {
-        cumpsgemm::dynamic_scaling::reset_scale_A(
-            cuMpSGEMM_get_internal_global_handle(),
-            (op_A == CUBLAS_OP_N ? m : k), (op_A == CUBLAS_OP_N ? k : m),
-            const_cast<T *>(a_dmem_ptr), lda, 0, 1, A_exp_stats_id,
-            dynamic_launch_id);
-        cumpsgemm::dynamic_scaling::reset_scale_B(
-            cuMpSGEMM_get_internal_global_handle(),
-            (op_B == CUBLAS_OP_N ? k : n), (op_B == CUBLAS_OP_N ? n : k),
-            const_cast<T *>(b_dmem_ptr), ldb, 0, 1, B_exp_stats_id,
-            dynamic_launch_id);
-      }
-
-      cumpsgemm::dynamic_launch::unset_dynamic_launch_flag_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-    }
-
-    if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
-    }
+    res = cuMpSGEMM_launch<T>(handle, cuda_stream, compute_mode, op_A, op_B,
+                              m, n, k, alpha, a_dmem_ptr, lda, b_dmem_ptr,
+                              ldb, beta, c_dmem_ptr, ldc,
+                              &trace_record.record.kernel_module_id);
   }
 
   return res;
@@ -601,8 +1299,14 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
     const T *const b_dmem_ptr, const uint64_t ldb, const uint64_t strideb,
     const T *beta, T *const c_dmem_ptr, const uint64_t ldc,
     const uint64_t stridec, const uint64_t batch_count) {
+  cumpsgemm::trace::scoped_record_t trace_record(func_name, op_A, op_B, m, n, k,
+                                                 batch_count);
   cudaStream_t cuda_stream;
   cublasGetStream(cublas_handle, &cuda_stream);
+  const auto handle = cuMpSGEMM_get_hijack_handle(cublas_handle, cuda_stream);
+  if (handle == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
 
   if (m == 0 || n == 0 || k == 0 || lda == 0 || ldb == 0 || ldc == 0 ||
       batch_count == 0) {
@@ -613,27 +1317,26 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
   const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
 
   cuMpSGEMM_compute_mode_t compute_mode = cuMpSGEMM_get_compute_mode_internal(
-      func_name, cublas_handle, op_A, op_B, m, n, k);
-
-  cuMpSGEMM_log(std::string(func_name) + " op=(" + get_cublas_op_str(op_A) +
-                ", " + get_cublas_op_str(op_B) + "), shape=(" +
-                std::to_string(m) + ", " + std::to_string(n) + ", " +
-                std::to_string(k) + "), batch=" + std::to_string(batch_count) +
-                ", mode=" + cuMpSGEMM_get_compute_mode_string(compute_mode) +
-                "[" + (hijack_mode == dynamic_mode ? "dynamic" : "static") +
-                "][exp_stats:" +
-                (cumpsgemm::hijack_control::get_internal_global_handle()
-                         ->exp_stats_handle->enabled
-                     ? "1"
-                     : "0") +
-                "]");
-
-  cumpsgemm::hijack_control::set_last_called_function_str(
-      std::string(func_name) + "," + get_cublas_op_str(op_A) + "," +
-      get_cublas_op_str(op_B) + "," + std::to_string(m) + "," +
-      std::to_string(n) + "," + std::to_string(k) + "," +
-      std::to_string(batch_count) + "," +
-      cuMpSGEMM_get_compute_mode_string(compute_mode));
+      func_name, cublas_handle, op_A, op_B, m, n, k, batch_count);
+  trace_record.record.compute_mode = compute_mode;
+  cumpsgemm::capture::capture_call(
+      func_name, cuda_stream, std::is_same<T, cuComplex>::value,
+      handle->pointer_mode, op_A, op_B, m, n, k, alpha, lda, stridea, ldb,
+      strideb, beta, ldc, stridec, batch_count, compute_mode);
+
+  if (cuMpSGEMM_is_log_enabled()) {
+    cuMpSGEMM_log(
+        std::string(func_name) + " op=(" + get_cublas_op_str(op_A) + ", " +
+        get_cublas_op_str(op_B) + "), shape=(" + std::to_string(m) + ", " +
+        std::to_string(n) + ", " + std::to_string(k) +
+        "), batch=" + std::to_string(batch_count) +
+        ", mode=" + cuMpSGEMM_get_compute_mode_string(compute_mode) + "[" +
+        get_hijack_mode_str() + "][exp_stats:" +
+        (handle->exp_stats_handle->enabled ? "1" : "0") + "]");
+  }
+
+  set_last_called_function(func_name, op_A, op_B, m, n, k, batch_count,
+                           compute_mode);
 
   if (compute_mode == CUMPSGEMM_DRY_RUN) {
     return CUBLAS_STATUS_SUCCESS;
@@ -644,7 +1347,8 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
   // -----------------------------------
   // gemm_Mx2x2
   // -----------------------------------
-  if (((m & (m - 1)) == 0) && n == 2 && k == 2 && is_gemm_Mx2x2_enabled()) {
+  if (((m & (m - 1)) == 0) && n == 2 && k == 2 && is_gemm_Mx2x2_enabled() &&
+      handle->pointer_mode == CUBLAS_POINTER_MODE_HOST) {
 
     if (profiling_flag) {
       const std::string func_name =
@@ -656,9 +1360,7 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k,
                batch_count);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
     cuMpSGEMM_log(" +---> gemm_Mx2x2");
 
@@ -667,15 +1369,7 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
         strideb, *beta, c_dmem_ptr, ldc, stridec, batch_count, cuda_stream);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
 
     return CUBLAS_STATUS_SUCCESS;
@@ -684,7 +1378,8 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
   // -----------------------------------
   // gemm_2xNx2
   // -----------------------------------
-  if (((n & (n - 1)) == 0) && m == 2 && k == 2 && is_gemm_Mx2x2_enabled()) {
+  if (((n & (n - 1)) == 0) && m == 2 && k == 2 && is_gemm_Mx2x2_enabled() &&
+      handle->pointer_mode == CUBLAS_POINTER_MODE_HOST) {
 
     if (profiling_flag) {
       const std::string func_name =
@@ -696,9 +1391,7 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k,
                batch_count);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
     cuMpSGEMM_log(" +---> gemm_2xNx2");
 
@@ -707,15 +1400,7 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
         strideb, *beta, c_dmem_ptr, ldc, stridec, batch_count, cuda_stream);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
 
     return CUBLAS_STATUS_SUCCESS;
@@ -764,18 +1449,11 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
       }
     }
 
-    cublasStatus_t (*func_ptr)(
-        cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
-        const void *, const void *, cudaDataType, int, long long int,
-        const void *, cudaDataType, int, long long int, const void *, void *,
-        cudaDataType, int, long long int, int, cublasComputeType_t,
-        cublasGemmAlgo_t);
-
-    *(void **)(&func_ptr) =
-        cuMpSGEMM_get_function_pointer("cublasGemmStridedBatchedEx");
+    const auto func_ptr = get_dispatch_table().cublasGemmStridedBatchedEx;
     if (func_ptr == nullptr) {
       cuMpSGEMM_error(std::string("Could not load the cuBLAS function \"") +
                       func_name + "\"");
+      return CUBLAS_STATUS_NOT_INITIALIZED;
     }
 
     if (profiling_flag) {
@@ -785,9 +1463,7 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k,
                batch_count);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
 
     res = (*func_ptr)(cublas_handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr,
@@ -796,15 +1472,156 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
                       stridec, batch_count, compute_type, gemm_algo);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
+    }
+  } else {
+    // -----------------------------------
+    // cuMpSGEMM
+    // -----------------------------------
+    res = cuMpSGEMM_stridedBatched_launch<T>(
+        handle, cuda_stream, compute_mode, op_A, op_B, m, n, k, alpha,
+        a_dmem_ptr, lda, stridea, b_dmem_ptr, ldb, strideb, beta, c_dmem_ptr,
+        ldc, stridec, batch_count, &trace_record.record.kernel_module_id);
+  }
+  return res;
+}
+
+// The matrices of a pointer-array batched GEMM may share the memory, so they
+// are not scaled in place. FP16TCEC_SCALING is run as AUTO, which uses TF32TCEC
+// when FP16TCEC needs scaling.
+template <class T>
+cublasStatus_t cuMpSGEMM_batched_hijack_core(
+    const char *const func_name, cublasHandle_t const cublas_handle,
+    const cublasOperation_t op_A, const cublasOperation_t op_B,
+    const uint64_t m, const uint64_t n, const uint64_t k, const T *alpha,
+    const T *const *const a_dmem_ptr_list, const uint64_t lda,
+    const T *const *const b_dmem_ptr_list, const uint64_t ldb, const T *beta,
+    T *const *const c_dmem_ptr_list, const uint64_t ldc,
+    const uint64_t batch_count) {
+  cumpsgemm::trace::scoped_record_t trace_record(func_name, op_A, op_B, m, n, k,
+                                                 batch_count);
+  cudaStream_t cuda_stream;
+  cublasGetStream(cublas_handle, &cuda_stream);
+  const auto handle = cuMpSGEMM_get_hijack_handle(cublas_handle, cuda_stream);
+  if (handle == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
+
+  if (m == 0 || n == 0 || k == 0 || lda == 0 || ldb == 0 || ldc == 0 ||
+      batch_count == 0) {
+    return CUBLAS_STATUS_INVALID_VALUE;
+  }
+
+  cumpsgemm::CULiP::profile_result profile_result;
+  const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
+
+  cuMpSGEMM_compute_mode_t compute_mode = cuMpSGEMM_get_compute_mode_internal(
+      func_name, cublas_handle, op_A, op_B, m, n, k, batch_count);
+  trace_record.record.compute_mode = compute_mode;
+  cumpsgemm::capture::capture_call(
+      func_name, cuda_stream, std::is_same<T, cuComplex>::value,
+      handle->pointer_mode, op_A, op_B, m, n, k, alpha, lda, 0, ldb, 0, beta,
+      ldc, 0, batch_count, compute_mode);
+
+  if (cuMpSGEMM_is_log_enabled()) {
+    cuMpSGEMM_log(
+        std::string(func_name) + " op=(" + get_cublas_op_str(op_A) + ", " +
+        get_cublas_op_str(op_B) + "), shape=(" + std::to_string(m) + ", " +
+        std::to_string(n) + ", " + std::to_string(k) +
+        "), batch=" + std::to_string(batch_count) +
+        ", mode=" + cuMpSGEMM_get_compute_mode_string(compute_mode) + "[" +
+        get_hijack_mode_str() + "][exp_stats:" +
+        (handle->exp_stats_handle->enabled ? "1" : "0") + "]");
+  }
+
+  set_last_called_function(func_name, op_A, op_B, m, n, k, batch_count,
+                           compute_mode);
+
+  if (compute_mode == CUMPSGEMM_DRY_RUN) {
+    return CUBLAS_STATUS_SUCCESS;
+  }
+
+  if (compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
+    cuMpSGEMM_log(" +---> AUTO (no in-place scaling for pointer arrays)");
+    compute_mode = CUMPSGEMM_AUTO;
+  }
+
+  if (compute_mode == CUMPSGEMM_AUTO && !has_graph_slots(handle)) {
+    return CUBLAS_STATUS_ALLOC_FAILED;
+  }
+
+  cublasStatus_t res;
+
+  if (compute_mode == CUMPSGEMM_CUBLAS ||
+      compute_mode == CUMPSGEMM_CUBLAS_FP16TC ||
+      compute_mode == CUMPSGEMM_CUBLAS_TF32TC ||
+      compute_mode == CUMPSGEMM_CUBLAS_SIMT) {
+    // -----------------------------------
+    // cuBLAS
+    // -----------------------------------
+    cublasGemmAlgo_t gemm_algo = CUBLAS_GEMM_DEFAULT;
+    cublasComputeType_t compute_type = CUBLAS_COMPUTE_32F;
+    const cudaDataType_t io_datat_type = get_cuda_data_type<T>();
+    if (compute_mode == CUMPSGEMM_CUBLAS_TF32TC) {
+      gemm_algo = CUBLAS_GEMM_DEFAULT_TENSOR_OP;
+      compute_type = CUBLAS_COMPUTE_32F_FAST_TF32;
+    } else if (compute_mode == CUMPSGEMM_CUBLAS_FP16TC) {
+      gemm_algo = CUBLAS_GEMM_DEFAULT_TENSOR_OP;
+      compute_type = CUBLAS_COMPUTE_32F_FAST_16F;
+    } else if (compute_mode == CUMPSGEMM_CUBLAS_SIMT) {
+      // Do nothing
+    } else {
+      const std::string func_name_str(func_name);
+      if (func_name_str == "cublasSgemmBatched" ||
+          func_name_str == "cublasCgemmBatched") {
+        cublasMath_t math_mode;
+        cublasGetMathMode(cublas_handle, &math_mode);
+        switch (math_mode) {
+        case CUBLAS_DEFAULT_MATH:
+        case CUBLAS_MATH_DISALLOW_REDUCED_PRECISION_REDUCTION:
+          // Do nothing
+          break;
+        case CUBLAS_TF32_TENSOR_OP_MATH:
+          gemm_algo = CUBLAS_GEMM_DEFAULT_TENSOR_OP;
+          compute_type = CUBLAS_COMPUTE_32F_FAST_TF32;
+          break;
+        case CUBLAS_TENSOR_OP_MATH:
+          gemm_algo = CUBLAS_GEMM_DEFAULT_TENSOR_OP;
+          compute_type = CUBLAS_COMPUTE_32F_FAST_16F;
+          break;
+        default:
+          break;
+        }
+      }
+    }
+
+    const auto func_ptr = get_dispatch_table().cublasGemmBatchedEx;
+    if (func_ptr == nullptr) {
+      cuMpSGEMM_error(std::string("Could not load the cuBLAS function \"") +
+                      func_name + "\"");
+      return CUBLAS_STATUS_NOT_INITIALIZED;
+    }
+
+    if (profiling_flag) {
+      snprintf(profile_result.function_name,
+               profile_result.function_name_length - 1,
+               "%s-%s%s-m%lu-n%lu-k%lu-batchCount%lu", func_name,
+               cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
+               cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k,
+               batch_count);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
+    }
+
+    res = (*func_ptr)(cublas_handle, op_A, op_B, m, n, k, alpha,
+                      reinterpret_cast<const void *const *>(a_dmem_ptr_list),
+                      io_datat_type, lda,
+                      reinterpret_cast<const void *const *>(b_dmem_ptr_list),
+                      io_datat_type, ldb, beta,
+                      reinterpret_cast<void *const *>(c_dmem_ptr_list),
+                      io_datat_type, ldc, batch_count, compute_type, gemm_algo);
+
+    if (profiling_flag) {
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
   } else {
     // -----------------------------------
@@ -813,7 +1630,7 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
     if (profiling_flag) {
       const std::string func_name =
           std::string(std::is_same<T, float>::value ? "s" : "c") +
-          "gemm_stridedBatch_" +
+          "gemm_batchPtr_" +
           std::string(cuMpSGEMM_get_compute_mode_string(compute_mode));
       snprintf(profile_result.function_name,
                profile_result.function_name_length - 1,
@@ -821,61 +1638,50 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_A),
                cumpsgemm::CULiP::get_cublasOperation_t_string(op_B), m, n, k,
                batch_count);
-      cumpsgemm::CULiP::launch_function(
-          cuda_stream, &cumpsgemm::CULiP::record_timestamp,
-          (void *)&profile_result.start_timestamp);
+      cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
     }
 
-    unsigned A_exp_stats_id, B_exp_stats_id, dynamic_launch_id;
     if (compute_mode == CUMPSGEMM_AUTO) {
       // Exp stats
       cumpsgemm::exp_stats::exp_stats_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), a_dmem_ptr, lda, batch_count, stridea);
-      A_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
+          handle, (op_A == CUBLAS_OP_N ? m : k), (op_A == CUBLAS_OP_N ? k : m),
+          a_dmem_ptr_list, lda, batch_count);
+      const auto A_exp_stats_id =
+          cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
       cumpsgemm::exp_stats::exp_stats_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), b_dmem_ptr, ldb, batch_count, strideb);
-      B_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
+          handle, (op_B == CUBLAS_OP_N ? k : n), (op_B == CUBLAS_OP_N ? n : k),
+          b_dmem_ptr_list, ldb, batch_count);
+      const auto B_exp_stats_id =
+          cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(handle);
 
       // Kernel decision
-      dynamic_launch_id =
+      const auto dynamic_launch_id =
           cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
-              cuMpSGEMM_get_internal_global_handle());
+              handle);
       cumpsgemm::dynamic_scaling::set_dynamic_launch_buffer_by_exp_stats(
-          cuMpSGEMM_get_internal_global_handle(), dynamic_launch_id,
-          A_exp_stats_id, B_exp_stats_id);
+          handle, dynamic_launch_id, A_exp_stats_id, B_exp_stats_id, false);
 
-      cuMpSGEMM_run_if_env_defined(cumpsgemm::info_env_name, [&]() {
+      // The device memory cannot be read back in CUDA Graph capture
+      if (cuMpSGEMM_is_log_enabled() && !cumpsgemm::is_capturing(handle)) {
         int flag;
-        cutf::memory::copy(&flag,
-                           cuMpSGEMM_get_internal_global_handle()
-                                   ->dynamic_launch_handle->flag_buffer +
-                               dynamic_launch_id,
-                           1);
+        cutf::memory::copy(
+            &flag,
+            handle->dynamic_launch_handle->flag_buffer + dynamic_launch_id, 1);
         const auto gemm_mode =
             cumpsgemm::dynamic_launch::utils::get_gemm_flag(flag);
-        const auto scale_A =
-            cumpsgemm::dynamic_launch::utils::get_scale_A_flag(flag);
-        const auto scale_B =
-            cumpsgemm::dynamic_launch::utils::get_scale_B_flag(flag);
-        const auto loss_rate_A = cumpsgemm::get_exp_stats(
-            cuMpSGEMM_get_internal_global_handle(), A_exp_stats_id);
-        const auto loss_rate_B = cumpsgemm::get_exp_stats(
-            cuMpSGEMM_get_internal_global_handle(), B_exp_stats_id);
+        const auto loss_rate_A =
+            cumpsgemm::get_exp_stats(handle, A_exp_stats_id);
+        const auto loss_rate_B =
+            cumpsgemm::get_exp_stats(handle, B_exp_stats_id);
         cuMpSGEMM_log(
             std::string("AUTO[ignore<") +
-            get_XeY_format_string(cuMpSGEMM_get_internal_global_handle()
-                                      ->exp_stats_handle->ignore_threshold) +
+            get_XeY_format_string(handle->exp_stats_handle->ignore_threshold) +
             ", uf<" +
-            get_XeY_format_string(cuMpSGEMM_get_internal_global_handle()
-                                      ->exp_stats_handle->underflow_threshold) +
+            get_XeY_format_string(
+                handle->exp_stats_handle->underflow_threshold) +
             ", tolerance=" +
             get_XeY_format_string(
-                cuMpSGEMM_get_internal_global_handle()
-                    ->exp_stats_handle->underflow_tolerance_rate) +
+                handle->exp_stats_handle->underflow_tolerance_rate) +
             "]: GEMM_MODE=" +
             cuMpSGEMM_get_compute_mode_string(
                 (cuMpSGEMM_compute_mode_t)gemm_mode) +
@@ -883,99 +1689,301 @@ cublasStatus_t cuMpSGEMM_stridedBatched_hijack_core(
             std::to_string(loss_rate_A.second) + "(" +
             std::to_string(static_cast<double>(loss_rate_A.first) /
                            loss_rate_A.second) +
-            "), scale_A=" + std::to_string(scale_A) +
-            ", loss_B=" + std::to_string(loss_rate_B.first) + "/" +
+            "), loss_B=" + std::to_string(loss_rate_B.first) + "/" +
             std::to_string(loss_rate_B.second) + "(" +
             std::to_string(static_cast<double>(loss_rate_B.first) /
                            loss_rate_B.second) +
-            "), scale_B=" + std::to_string(scale_B));
-      });
-
-      // Scaling
-      cumpsgemm::dynamic_scaling::scale_A(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), const_cast<T *>(a_dmem_ptr), lda,
-          stridea, batch_count, A_exp_stats_id, dynamic_launch_id);
-      cumpsgemm::dynamic_scaling::scale_B(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), const_cast<T *>(b_dmem_ptr), ldb,
-          strideb, batch_count, B_exp_stats_id, dynamic_launch_id);
+            ")");
+      }
 
       // Enable dynamic launch
       cumpsgemm::dynamic_launch::set_dynamic_launch_flag_buffer_id(
-          cuMpSGEMM_get_internal_global_handle(), dynamic_launch_id);
-    } else if (compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
-      // Force execution mode
-      dynamic_launch_id = 1;
-
-      // Exp stats
-      cumpsgemm::exp_stats::exp_max_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), a_dmem_ptr, lda, batch_count, stridea);
-      A_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-      cumpsgemm::exp_stats::exp_max_ext(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), b_dmem_ptr, ldb, batch_count, strideb);
-      B_exp_stats_id = cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
-          cuMpSGEMM_get_internal_global_handle());
-
-      // Scaling
-      cumpsgemm::dynamic_scaling::scale_A(
-          cuMpSGEMM_get_internal_global_handle(), (op_A == CUBLAS_OP_N ? m : k),
-          (op_A == CUBLAS_OP_N ? k : m), const_cast<T *>(a_dmem_ptr), lda,
-          stridea, batch_count, A_exp_stats_id, dynamic_launch_id);
-      cumpsgemm::dynamic_scaling::scale_B(
-          cuMpSGEMM_get_internal_global_handle(), (op_B == CUBLAS_OP_N ? k : n),
-          (op_B == CUBLAS_OP_N ? n : k), const_cast<T *>(b_dmem_ptr), ldb,
-          strideb, batch_count, B_exp_stats_id, dynamic_launch_id);
+          handle, dynamic_launch_id);
     }
 
-    res = cumpsgemm::gemm_stridedBatch<T>(
-        cuMpSGEMM_get_internal_global_handle(), op_A, op_B, m, n, k, alpha,
-        a_dmem_ptr, lda, stridea, b_dmem_ptr, ldb, strideb, beta, c_dmem_ptr,
-        ldc, stridec, batch_count,
-        compute_mode == CUMPSGEMM_FP16TCEC_SCALING ? CUMPSGEMM_FP16TCEC
-                                                   : compute_mode);
-
-    if (compute_mode == CUMPSGEMM_AUTO ||
-        compute_mode == CUMPSGEMM_FP16TCEC_SCALING) {
-      cumpsgemm::dynamic_scaling::scale_C(
-          cuMpSGEMM_get_internal_global_handle(), m, n, c_dmem_ptr, ldc,
-          stridec, batch_count, A_exp_stats_id, B_exp_stats_id,
-          dynamic_launch_id);
-
-      // restore A and B
-      if (restore_AB) {
-        cumpsgemm::dynamic_scaling::reset_scale_A(
-            cuMpSGEMM_get_internal_global_handle(),
-            (op_A == CUBLAS_OP_N ? m : k), (op_A == CUBLAS_OP_N ? k : m),
-            const_cast<T *>(a_dmem_ptr), lda, stridea, batch_count,
-            A_exp_stats_id, dynamic_launch_id);
-        cumpsgemm::dynamic_scaling::reset_scale_B(
-            cuMpSGEMM_get_internal_global_handle(),
-            (op_B == CUBLAS_OP_N ? k : n), (op_B == CUBLAS_OP_N ? n : k),
-            const_cast<T *>(b_dmem_ptr), ldb, strideb, batch_count,
-            B_exp_stats_id, dynamic_launch_id);
-      }
-    }
+    res = cumpsgemm::gemm_batchPtr<T>(handle, op_A, op_B, m, n, k, alpha,
+                                      a_dmem_ptr_list, lda, b_dmem_ptr_list,
+                                      ldb, beta, c_dmem_ptr_list, ldc,
+                                      batch_count, compute_mode,
+                                      &trace_record.record.kernel_module_id);
 
     if (profiling_flag) {
-      // Record end rimestamp
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::record_timestamp,
-                                        (void *)&profile_result.end_timestamp);
-
-      // Print result
-      cumpsgemm::CULiP::launch_function(cuda_stream,
-                                        &cumpsgemm::CULiP::print_profile_result,
-                                        (void *)&profile_result);
+      cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
     }
   }
   return res;
 }
 
 // cuBLAS functions
+namespace {
+// A cublasLtMatmul call decoded into the parameters of a (strided batched)
+// GEMM. C is read from and written to D.
+struct lt_matmul_t {
+  cudaDataType_t data_type;
+  cublasPointerMode_t pointer_mode;
+  cublasOperation_t op_A, op_B;
+  uint64_t m, n, k;
+  uint64_t lda, ldb, ldd;
+  uint64_t stridea, strideb, strided;
+  uint64_t batch_count;
+};
+
+struct lt_layout_t {
+  std::uint32_t type;
+  std::int32_t order;
+  std::uint64_t rows, cols;
+  std::int64_t ld;
+  std::int32_t batch_count;
+  std::int64_t stride;
+  std::int64_t plane_offset;
+};
+
+template <class T>
+bool get_lt_attribute(const cublasLtMatmulDesc_t desc,
+                      const cublasLtMatmulDescAttributes_t attr, T &value) {
+  size_t size_written;
+  return get_dispatch_table().cublasLtMatmulDescGetAttribute(
+             desc, attr, &value, sizeof(T), &size_written) ==
+         CUBLAS_STATUS_SUCCESS;
+}
+
+template <class T>
+bool get_lt_attribute(const cublasLtMatrixLayout_t desc,
+                      const cublasLtMatrixLayoutAttribute_t attr, T &value) {
+  size_t size_written;
+  return get_dispatch_table().cublasLtMatrixLayoutGetAttribute(
+             desc, attr, &value, sizeof(T), &size_written) ==
+         CUBLAS_STATUS_SUCCESS;
+}
+
+bool get_lt_layout(const cublasLtMatrixLayout_t desc, lt_layout_t &layout) {
+  return get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_TYPE, layout.type) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_ORDER, layout.order) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_ROWS, layout.rows) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_COLS, layout.cols) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_LD, layout.ld) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_BATCH_COUNT,
+                          layout.batch_count) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_STRIDED_BATCH_OFFSET,
+                          layout.stride) &&
+         get_lt_attribute(desc, CUBLASLT_MATRIX_LAYOUT_PLANE_OFFSET,
+                          layout.plane_offset);
+}
+
+bool is_zero_scalar(const void *const ptr, const std::int32_t scale_type) {
+  if (scale_type == CUDA_R_32F) {
+    return *static_cast<const float *>(ptr) == 0;
+  }
+  const auto v = *static_cast<const cuComplex *>(ptr);
+  return v.x == 0 && v.y == 0;
+}
+
+// Returns false if the matmul can not be run by cuMpSGEMM
+bool decode_lt_matmul(const cublasLtMatmulDesc_t desc,
+                      const cublasLtMatrixLayout_t a_desc,
+                      const cublasLtMatrixLayout_t b_desc,
+                      const cublasLtMatrixLayout_t c_desc,
+                      const cublasLtMatrixLayout_t d_desc,
+                      const void *const beta, const void *const c_dmem_ptr,
+                      const void *const d_dmem_ptr, lt_matmul_t &matmul) {
+  const auto &dispatch_table = get_dispatch_table();
+  if (dispatch_table.cublasLtMatmulDescGetAttribute == nullptr ||
+      dispatch_table.cublasLtMatrixLayoutGetAttribute == nullptr) {
+    return false;
+  }
+
+  std::int32_t compute_type, scale_type, pointer_mode, op_A, op_B, op_C;
+  std::uint32_t epilogue;
+  if (!get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_COMPUTE_TYPE,
+                        compute_type) ||
+      !get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_SCALE_TYPE, scale_type) ||
+      !get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_POINTER_MODE,
+                        pointer_mode) ||
+      !get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_TRANSA, op_A) ||
+      !get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_TRANSB, op_B) ||
+      !get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_TRANSC, op_C) ||
+      !get_lt_attribute(desc, CUBLASLT_MATMUL_DESC_EPILOGUE, epilogue)) {
+    return false;
+  }
+  if ((compute_type != CUBLAS_COMPUTE_32F &&
+       compute_type != CUBLAS_COMPUTE_32F_FAST_16F &&
+       compute_type != CUBLAS_COMPUTE_32F_FAST_16BF &&
+       compute_type != CUBLAS_COMPUTE_32F_FAST_TF32) ||
+      (scale_type != CUDA_R_32F && scale_type != CUDA_C_32F) ||
+      (pointer_mode != CUBLASLT_POINTER_MODE_HOST &&
+       pointer_mode != CUBLASLT_POINTER_MODE_DEVICE) ||
+      epilogue != CUBLASLT_EPILOGUE_DEFAULT || op_C != CUBLAS_OP_N ||
+      op_A < CUBLAS_OP_N || op_A > CUBLAS_OP_C || op_B < CUBLAS_OP_N ||
+      op_B > CUBLAS_OP_C) {
+    return false;
+  }
+
+  lt_layout_t a, b, c, d;
+  if (!get_lt_layout(a_desc, a) || !get_lt_layout(b_desc, b) ||
+      !get_lt_layout(c_desc, c) || !get_lt_layout(d_desc, d)) {
+    return false;
+  }
+  for (const auto &layout : {a, b, c, d}) {
+    if (layout.type != static_cast<std::uint32_t>(scale_type) ||
+        layout.order != CUBLASLT_ORDER_COL ||
+        layout.batch_count != a.batch_count || layout.batch_count < 1 ||
+        layout.stride < 0 || layout.plane_offset != 0 || layout.rows == 0 ||
+        layout.cols == 0 || layout.ld < 0 ||
+        static_cast<std::uint64_t>(layout.ld) < layout.rows) {
+      return false;
+    }
+  }
+
+  const auto m = d.rows;
+  const auto n = d.cols;
+  const auto k = op_A == CUBLAS_OP_N ? a.cols : a.rows;
+  if ((op_A == CUBLAS_OP_N ? a.rows : a.cols) != m ||
+      (op_B == CUBLAS_OP_N ? b.rows : b.cols) != k ||
+      (op_B == CUBLAS_OP_N ? b.cols : b.rows) != n || c.rows != m ||
+      c.cols != n) {
+    return false;
+  }
+
+  // cuMpSGEMM accumulates into the output matrix, so C is usable only if it is
+  // D or not read
+  if (c_dmem_ptr != d_dmem_ptr) {
+    if (pointer_mode != CUBLASLT_POINTER_MODE_HOST ||
+        !is_zero_scalar(beta, scale_type)) {
+      return false;
+    }
+  } else if (c.ld != d.ld || c.stride != d.stride) {
+    return false;
+  }
+
+  matmul.data_type = static_cast<cudaDataType_t>(scale_type);
+  matmul.pointer_mode = pointer_mode == CUBLASLT_POINTER_MODE_HOST
+                            ? CUBLAS_POINTER_MODE_HOST
+                            : CUBLAS_POINTER_MODE_DEVICE;
+  matmul.op_A = static_cast<cublasOperation_t>(op_A);
+  matmul.op_B = static_cast<cublasOperation_t>(op_B);
+  matmul.m = m;
+  matmul.n = n;
+  matmul.k = k;
+  matmul.lda = a.ld;
+  matmul.ldb = b.ld;
+  matmul.ldd = d.ld;
+  matmul.stridea = a.stride;
+  matmul.strideb = b.stride;
+  matmul.strided = d.stride;
+  matmul.batch_count = a.batch_count;
+  return true;
+}
+
+// cuBLAS may run its GEMMs through cublasLtMatmul, e.g. in the CUBLAS modes.
+// Such calls are forwarded to cuBLASLt as they are.
+bool is_called_from_cublas(const void *const return_address) {
+  thread_local const void *last_return_address = nullptr;
+  thread_local bool last_result = false;
+  if (return_address != last_return_address) {
+    Dl_info info;
+    last_result = dladdr(return_address, &info) != 0 &&
+                  info.dli_fname != nullptr &&
+                  std::string(info.dli_fname).find(cublas_lib_name) !=
+                      std::string::npos;
+    last_return_address = return_address;
+  }
+  return last_result;
+}
+} // namespace
+
+template <class T>
+cublasStatus_t cuMpSGEMM_lt_launch(cuMpSGEMM_handle_t const handle,
+                                   cudaStream_t const cuda_stream,
+                                   const cuMpSGEMM_compute_mode_t compute_mode,
+                                   const lt_matmul_t &mm, const void *alpha,
+                                   const void *const a_dmem_ptr,
+                                   const void *const b_dmem_ptr,
+                                   const void *beta, void *const d_dmem_ptr,
+                                   unsigned *const used_kernel_module_id) {
+  if (mm.batch_count == 1) {
+    return cuMpSGEMM_launch<T>(
+        handle, cuda_stream, compute_mode, mm.op_A, mm.op_B, mm.m, mm.n, mm.k,
+        reinterpret_cast<const T *>(alpha),
+        reinterpret_cast<const T *>(a_dmem_ptr), mm.lda,
+        reinterpret_cast<const T *>(b_dmem_ptr), mm.ldb,
+        reinterpret_cast<const T *>(beta), reinterpret_cast<T *>(d_dmem_ptr),
+        mm.ldd, used_kernel_module_id);
+  }
+  return cuMpSGEMM_stridedBatched_launch<T>(
+      handle, cuda_stream, compute_mode, mm.op_A, mm.op_B, mm.m, mm.n, mm.k,
+      reinterpret_cast<const T *>(alpha),
+      reinterpret_cast<const T *>(a_dmem_ptr), mm.lda, mm.stridea,
+      reinterpret_cast<const T *>(b_dmem_ptr), mm.ldb, mm.strideb,
+      reinterpret_cast<const T *>(beta), reinterpret_cast<T *>(d_dmem_ptr),
+      mm.ldd, mm.strided, mm.batch_count, used_kernel_module_id);
+}
+
+// Returns false if the matmul is to be run by cuBLASLt
+bool cuMpSGEMM_lt_hijack_core(const char *const func_name,
+                              cublasLtHandle_t const lt_handle,
+                              cudaStream_t const cuda_stream,
+                              const lt_matmul_t &mm, const void *alpha,
+                              const void *const a_dmem_ptr,
+                              const void *const b_dmem_ptr, const void *beta,
+                              void *const d_dmem_ptr, cublasStatus_t &res) {
+  cumpsgemm::trace::scoped_record_t trace_record(
+      func_name, mm.op_A, mm.op_B, mm.m, mm.n, mm.k, mm.batch_count);
+  const auto handle =
+      cuMpSGEMM_get_hijack_handle(lt_handle, cuda_stream, mm.pointer_mode);
+  if (handle == nullptr) {
+    return false;
+  }
+
+  // The rule function is called with a null cuBLAS handle
+  const auto compute_mode = cuMpSGEMM_get_compute_mode_internal(
+      func_name, nullptr, mm.op_A, mm.op_B, mm.m, mm.n, mm.k, mm.batch_count);
+  trace_record.record.compute_mode = compute_mode;
+  cumpsgemm::capture::capture_call(
+      func_name, cuda_stream, mm.data_type == CUDA_C_32F, mm.pointer_mode,
+      mm.op_A, mm.op_B, mm.m, mm.n, mm.k, alpha, mm.lda, mm.stridea, mm.ldb,
+      mm.strideb, beta, mm.ldd, mm.strided, mm.batch_count, compute_mode);
+
+  if (cuMpSGEMM_is_log_enabled()) {
+    cuMpSGEMM_log(
+        std::string(func_name) + "[" +
+        (mm.data_type == CUDA_R_32F ? "R_32F" : "C_32F") + "] op=(" +
+        get_cublas_op_str(mm.op_A) + ", " + get_cublas_op_str(mm.op_B) +
+        "), shape=(" + std::to_string(mm.m) + ", " + std::to_string(mm.n) +
+        ", " + std::to_string(mm.k) + "), batch=" +
+        std::to_string(mm.batch_count) +
+        ", mode=" + cuMpSGEMM_get_compute_mode_string(compute_mode) + "[" +
+        get_hijack_mode_str() + "][exp_stats:" +
+        (handle->exp_stats_handle->enabled ? "1" : "0") + "]");
+  }
+
+  set_last_called_function(func_name, mm.op_A, mm.op_B, mm.m, mm.n, mm.k,
+                           mm.batch_count, compute_mode);
+
+  if (compute_mode == CUMPSGEMM_DRY_RUN) {
+    res = CUBLAS_STATUS_SUCCESS;
+    return true;
+  }
+
+  // The compute type of the matmul descriptor is not overwritten
+  if (compute_mode == CUMPSGEMM_CUBLAS ||
+      compute_mode == CUMPSGEMM_CUBLAS_FP16TC ||
+      compute_mode == CUMPSGEMM_CUBLAS_TF32TC ||
+      compute_mode == CUMPSGEMM_CUBLAS_SIMT) {
+    return false;
+  }
+
+  if (mm.data_type == CUDA_R_32F) {
+    res = cuMpSGEMM_lt_launch<float>(
+        handle, cuda_stream, compute_mode, mm, alpha, a_dmem_ptr, b_dmem_ptr,
+        beta, d_dmem_ptr, &trace_record.record.kernel_module_id);
+  } else {
+    res = cuMpSGEMM_lt_launch<cuComplex>(
+        handle, cuda_stream, compute_mode, mm, alpha, a_dmem_ptr, b_dmem_ptr,
+        beta, d_dmem_ptr, &trace_record.record.kernel_module_id);
+  }
+  return true;
+}
+
 extern "C" {
 CUBLASAPI cublasStatus_t
 cublasSgemm_v2(cublasHandle_t cublas_handle, cublasOperation_t op_A,
@@ -1038,6 +2046,36 @@ CUBLASAPI cublasStatus_t cublasCgemmStridedBatched(
 #endif
 }
 
+CUBLASAPI cublasStatus_t cublasSgemmBatched(
+    cublasHandle_t cublas_handle, cublasOperation_t op_A,
+    cublasOperation_t op_B, int m, int n, int k, const float *alpha,
+    const float *const a_dmem_ptr_list[], int lda,
+    const float *const b_dmem_ptr_list[], int ldb, const float *beta,
+    float *const c_dmem_ptr_list[], int ldc, const int batch_count) {
+#ifdef __CUDA_ARCH__
+  return CUBLAS_STATUS_NOT_SUPPORTED;
+#else
+  return cuMpSGEMM_batched_hijack_core<float>(
+      __func__, cublas_handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr_list,
+      lda, b_dmem_ptr_list, ldb, beta, c_dmem_ptr_list, ldc, batch_count);
+#endif
+}
+
+CUBLASAPI cublasStatus_t cublasCgemmBatched(
+    cublasHandle_t cublas_handle, cublasOperation_t op_A,
+    cublasOperation_t op_B, int m, int n, int k, const cuComplex *alpha,
+    const cuComplex *const a_dmem_ptr_list[], int lda,
+    const cuComplex *const b_dmem_ptr_list[], int ldb, const cuComplex *beta,
+    cuComplex *const c_dmem_ptr_list[], int ldc, const int batch_count) {
+#ifdef __CUDA_ARCH__
+  return CUBLAS_STATUS_NOT_SUPPORTED;
+#else
+  return cuMpSGEMM_batched_hijack_core<cuComplex>(
+      __func__, cublas_handle, op_A, op_B, m, n, k, alpha, a_dmem_ptr_list,
+      lda, b_dmem_ptr_list, ldb, beta, c_dmem_ptr_list, ldc, batch_count);
+#endif
+}
+
 CUBLASAPI cublasStatus_t cublasGemmEx(
     cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb,
     int m, int n, int k, const void *alpha, const void *A, cudaDataType_t Atype,
@@ -1072,21 +2110,17 @@ CUBLASAPI cublasStatus_t cublasGemmEx(
   cumpsgemm::CULiP::profile_result profile_result;
   const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
 
-  cublasStatus_t (*func_ptr)(
-      cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
-      const void *, const void *, cudaDataType_t, int, const void *,
-      cudaDataType_t, int, const void *, void *, cudaDataType_t, int,
-      cublasComputeType_t, cublasGemmAlgo_t);
-  *(void **)(&func_ptr) = cuMpSGEMM_get_function_pointer(__func__);
+  const auto func_ptr = get_dispatch_table().cublasGemmEx;
+  if (func_ptr == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
 
   if (profiling_flag) {
     snprintf(profile_result.function_name,
              profile_result.function_name_length - 1, "%s-%s%s-m%d-n%d-k%d",
              __func__, cumpsgemm::CULiP::get_cublasOperation_t_string(transa),
              cumpsgemm::CULiP::get_cublasOperation_t_string(transb), m, n, k);
-    cumpsgemm::CULiP::launch_function(cuda_stream,
-                                      &cumpsgemm::CULiP::record_timestamp,
-                                      (void *)&profile_result.start_timestamp);
+    cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
   }
 
   const auto res =
@@ -1094,15 +2128,7 @@ CUBLASAPI cublasStatus_t cublasGemmEx(
                   Btype, ldb, beta, C, Ctype, ldc, computeType, algo);
 
   if (profiling_flag) {
-    // Record end rimestamp
-    cumpsgemm::CULiP::launch_function(cuda_stream,
-                                      &cumpsgemm::CULiP::record_timestamp,
-                                      (void *)&profile_result.end_timestamp);
-
-    // Print result
-    cumpsgemm::CULiP::launch_function(cuda_stream,
-                                      &cumpsgemm::CULiP::print_profile_result,
-                                      (void *)&profile_result);
+    cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
   }
 
   return res;
@@ -1144,13 +2170,10 @@ CUBLASAPI cublasStatus_t cublasGemmStridedBatchedEx(
   cumpsgemm::CULiP::profile_result profile_result;
   const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
 
-  cublasStatus_t (*func_ptr)(
-      cublasHandle_t, cublasOperation_t, cublasOperation_t, int, int, int,
-      const void *, const void *, cudaDataType_t, int, long long int,
-      const void *, cudaDataType_t, int, long long int, const void *, void *,
-      cudaDataType_t, int, long long int, int, cublasComputeType_t,
-      cublasGemmAlgo_t);
-  *(void **)(&func_ptr) = cuMpSGEMM_get_function_pointer(__func__);
+  const auto func_ptr = get_dispatch_table().cublasGemmStridedBatchedEx;
+  if (func_ptr == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
 
   if (profiling_flag) {
     snprintf(profile_result.function_name,
@@ -1159,9 +2182,7 @@ CUBLASAPI cublasStatus_t cublasGemmStridedBatchedEx(
              cumpsgemm::CULiP::get_cublasOperation_t_string(transa),
              cumpsgemm::CULiP::get_cublasOperation_t_string(transb), m, n, k,
              batch_count);
-    cumpsgemm::CULiP::launch_function(cuda_stream,
-                                      &cumpsgemm::CULiP::record_timestamp,
-                                      (void *)&profile_result.start_timestamp);
+    cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
   }
 
   const auto res =
@@ -1170,20 +2191,153 @@ CUBLASAPI cublasStatus_t cublasGemmStridedBatchedEx(
                   batch_count, computeType, algo);
 
   if (profiling_flag) {
-    // Record end rimestamp
-    cumpsgemm::CULiP::launch_function(cuda_stream,
-                                      &cumpsgemm::CULiP::record_timestamp,
-                                      (void *)&profile_result.end_timestamp);
+    cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
+  }
+
+  return res;
+#endif
+}
+
+CUBLASAPI cublasStatus_t cublasGemmBatchedEx(
+    cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb,
+    int m, int n, int k, const void *alpha, const void *const Aarray[],
+    cudaDataType_t Atype, int lda, const void *const Barray[],
+    cudaDataType_t Btype, int ldb, const void *beta, void *const Carray[],
+    cudaDataType_t Ctype, int ldc, int batch_count,
+    cublasComputeType_t computeType, cublasGemmAlgo_t algo) {
+#ifdef __CUDA_ARCH__
+  return CUBLAS_STATUS_NOT_SUPPORTED;
+#else
+  if (Atype == CUDA_R_32F && Btype == CUDA_R_32F && Ctype == CUDA_R_32F) {
+    return cuMpSGEMM_batched_hijack_core<float>(
+        __func__, handle, transa, transb, m, n, k,
+        reinterpret_cast<const float *>(alpha),
+        reinterpret_cast<const float *const *>(Aarray), lda,
+        reinterpret_cast<const float *const *>(Barray), ldb,
+        reinterpret_cast<const float *>(beta),
+        reinterpret_cast<float *const *>(Carray), ldc, batch_count);
+  }
+  if (Atype == CUDA_C_32F && Btype == CUDA_C_32F && Ctype == CUDA_C_32F) {
+    return cuMpSGEMM_batched_hijack_core<cuComplex>(
+        __func__, handle, transa, transb, m, n, k,
+        reinterpret_cast<const cuComplex *>(alpha),
+        reinterpret_cast<const cuComplex *const *>(Aarray), lda,
+        reinterpret_cast<const cuComplex *const *>(Barray), ldb,
+        reinterpret_cast<const cuComplex *>(beta),
+        reinterpret_cast<cuComplex *const *>(Carray), ldc, batch_count);
+  }
+
+  cudaStream_t cuda_stream;
+  cublasGetStream(handle, &cuda_stream);
+
+  cumpsgemm::CULiP::profile_result profile_result;
+  const auto profiling_flag = cumpsgemm::CULiP::is_profiling_enabled();
+
+  const auto func_ptr = get_dispatch_table().cublasGemmBatchedEx;
+  if (func_ptr == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
+
+  if (profiling_flag) {
+    snprintf(profile_result.function_name,
+             profile_result.function_name_length - 1,
+             "%s-%s%s-m%d-n%d-k%d-batch_count%d", __func__,
+             cumpsgemm::CULiP::get_cublasOperation_t_string(transa),
+             cumpsgemm::CULiP::get_cublasOperation_t_string(transb), m, n, k,
+             batch_count);
+    cumpsgemm::CULiP::record_start(cuda_stream, profile_result);
+  }
+
+  const auto res = (*func_ptr)(handle, transa, transb, m, n, k, alpha, Aarray,
+                               Atype, lda, Barray, Btype, ldb, beta, Carray,
+                               Ctype, ldc, batch_count, computeType, algo);
+
+  if (profiling_flag) {
+    cumpsgemm::CULiP::record_end(cuda_stream, profile_result);
+  }
+
+  return res;
+#endif
+}
+
+CUBLASAPI cublasStatus_t cublasDestroy_v2(cublasHandle_t handle) {
+#ifdef __CUDA_ARCH__
+  return CUBLAS_STATUS_NOT_SUPPORTED;
+#else
+  cuMpSGEMM_destroy_hijack_handles(handle);
+
+  const auto func_ptr = get_dispatch_table().cublasDestroy_v2;
+  if (func_ptr == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
+  return (*func_ptr)(handle);
+#endif
+}
+
+cublasStatus_t CUBLASWINAPI cublasLtMatmul(
+    cublasLtHandle_t lightHandle, cublasLtMatmulDesc_t computeDesc,
+    const void *alpha, const void *A, cublasLtMatrixLayout_t Adesc,
+    const void *B, cublasLtMatrixLayout_t Bdesc, const void *beta,
+    const void *C, cublasLtMatrixLayout_t Cdesc, void *D,
+    cublasLtMatrixLayout_t Ddesc, const cublasLtMatmulAlgo_t *algo,
+    void *workspace, size_t workspaceSizeInBytes, cudaStream_t stream) {
+#ifdef __CUDA_ARCH__
+  return CUBLAS_STATUS_NOT_SUPPORTED;
+#else
+  const auto called_from_cublas =
+      is_called_from_cublas(__builtin_return_address(0));
+
+  lt_matmul_t matmul;
+  if (!called_from_cublas && decode_lt_matmul(computeDesc, Adesc, Bdesc, Cdesc,
+                                              Ddesc, beta, C, D, matmul)) {
+    cublasStatus_t res;
+    if (cuMpSGEMM_lt_hijack_core(__func__, lightHandle, stream, matmul, alpha,
+                                 A, B, beta, D, res)) {
+      return res;
+    }
+  }
+
+  cumpsgemm::CULiP::profile_result profile_result;
+  const auto profiling_flag =
+      !called_from_cublas && cumpsgemm::CULiP::is_profiling_enabled();
+
+  const auto func_ptr = get_dispatch_table().cublasLtMatmul;
+  if (func_ptr == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
+
+  if (profiling_flag) {
+    snprintf(profile_result.function_name,
+             profile_result.function_name_length - 1, "%s", __func__);
+    cumpsgemm::CULiP::record_start(stream, profile_result);
+  }
+
+  const auto res =
+      (*func_ptr)(lightHandle, computeDesc, alpha, A, Adesc, B, Bdesc, beta, C,
+                  Cdesc, D, Ddesc, algo, workspace, workspaceSizeInBytes,
+                  stream);
 
-    // Print result
-    cumpsgemm::CULiP::launch_function(cuda_stream,
-                                      &cumpsgemm::CULiP::print_profile_result,
-                                      (void *)&profile_result);
+  if (profiling_flag) {
+    cumpsgemm::CULiP::record_end(stream, profile_result);
   }
 
   return res;
 #endif
 }
+
+cublasStatus_t CUBLASWINAPI cublasLtDestroy(cublasLtHandle_t lightHandle) {
+#ifdef __CUDA_ARCH__
+  return CUBLAS_STATUS_NOT_SUPPORTED;
+#else
+  cuMpSGEMM_destroy_hijack_handles(lightHandle);
+
+  const auto func_ptr = get_dispatch_table().cublasLtDestroy;
+  if (func_ptr == nullptr) {
+    return CUBLAS_STATUS_NOT_INITIALIZED;
+  }
+  return (*func_ptr)(lightHandle);
+#endif
+}
 } // extern "C"
 
 cuMpSGEMM_handle *cumpsgemm::hijack_control::get_internal_global_handle() {
@@ -1196,12 +2350,15 @@ void cumpsgemm::hijack_control::set_compute_mode(
     throw std::runtime_error(
         "CUMPSGEMM_FP32_SIMT mode is currently not supported.");
   }
-  internal_global_compute_mode = mode;
-  hijack_mode = static_mode;
+  update_hijack_config([&](hijack_config_t &config) {
+    config.compute_mode = mode;
+    config.hijack_mode = static_mode;
+  });
 }
 
 void cumpsgemm::hijack_control::unset_compute_mode() {
-  hijack_mode = dynamic_mode;
+  update_hijack_config(
+      [&](hijack_config_t &config) { config.hijack_mode = dynamic_mode; });
 }
 
 void cumpsgemm::hijack_control::set_exp_stats_params(
@@ -1224,15 +2381,31 @@ void cumpsgemm::hijack_control::set_exp_stats_params(
 
 void cumpsgemm::hijack_control::reset_exp_stats_buffer_id() {
   cumpsgemm::exp_stats::reset_exp_stats_buffer_id(get_internal_global_handle());
+
+  auto &registry = get_hijack_handle_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto &registered : registry.handles) {
+    cumpsgemm::exp_stats::reset_exp_stats_buffer_id(registered.second->handle);
+  }
 }
 
 std::string cumpsgemm::hijack_control::get_last_called_function_str() {
-  return internal_global_last_called_function_str;
+  const auto &last = internal_global_last_called_function;
+  if (last.func_name == nullptr) {
+    return last.str;
+  }
+  return std::string(last.func_name) + "," + get_cublas_op_str(last.op_A) +
+         "," + get_cublas_op_str(last.op_B) + "," + std::to_string(last.m) +
+         "," + std::to_string(last.n) + "," + std::to_string(last.k) + "," +
+         std::to_string(last.batch_count) + "," +
+         cuMpSGEMM_get_compute_mode_string(last.compute_mode);
 }
 
 void cumpsgemm::hijack_control::set_last_called_function_str(
     const std::string func_str) {
-  internal_global_last_called_function_str = func_str;
+  auto &last = internal_global_last_called_function;
+  last.func_name = nullptr;
+  last.str = func_str;
 }
 
 void cumpsgemm::hijack_control::clear_last_called_function_str() {
@@ -1247,6 +2420,14 @@ void cumpsgemm::hijack_control::disable_custom_gemm_Mx2x2() {
   global_internal_gemm_Mx2x2_enabled = false;
 }
 
+void cumpsgemm::hijack_control::enable_deterministic_mode() {
+  global_internal_deterministic_enabled = true;
+}
+
+void cumpsgemm::hijack_control::disable_deterministic_mode() {
+  global_internal_deterministic_enabled = false;
+}
+
 void cumpsgemm::hijack_control::enable_restoring_AB_after_scaling() {
   restore_AB = true;
   cuMpSGEMM_log("AUTO config: restore_AB_scaling=True @" +
@@ -1263,9 +2444,68 @@ bool cumpsgemm::hijack_control::is_library_loaded() { return true; }
 
 void cumpsgemm::hijack_control::set_control_function(
     const cumpsgemm::hijack_control::control_function_t control_func) {
-  internal_global_control_func = control_func;
+  update_hijack_config(
+      [&](hijack_config_t &config) { config.control_func = control_func; });
 }
 
 void cumpsgemm::hijack_control::unset_control_function() {
-  internal_global_control_func = 0;
+  update_hijack_config(
+      [&](hijack_config_t &config) { config.control_func = nullptr; });
+}
+
+void cumpsgemm::hijack_control::set_memoized_control_function(
+    const cumpsgemm::hijack_control::control_function_t control_func) {
+  const auto memo =
+      std::make_shared<cumpsgemm::control_memo::memo_t>(control_func);
+  update_hijack_config([&](hijack_config_t &config) {
+    config.control_func = [memo](const int op_A, const int op_B,
+                                 const unsigned m, const unsigned n,
+                                 const unsigned k) {
+      return memo->get(op_A, op_B, m, n, k);
+    };
+  });
+}
+
+void cumpsgemm::hijack_control::set_control_rules(const std::string rules) {
+  std::istringstream iss(rules);
+  const auto table =
+      std::make_shared<const cumpsgemm::rule_file::decision_table_t>(
+          cumpsgemm::rule_file::parse(iss));
+  update_hijack_config(
+      [&](hijack_config_t &config) { config.control_table = table; });
+}
+
+void cumpsgemm::hijack_control::unset_control_rules() {
+  update_hijack_config(
+      [&](hijack_config_t &config) { config.control_table = nullptr; });
+}
+
+void cumpsgemm::hijack_control::enable_compute_mode_cache() {
+  update_hijack_config([&](hijack_config_t &config) {
+    config.compute_mode_cache_enabled = true;
+  });
+}
+
+void cumpsgemm::hijack_control::disable_compute_mode_cache() {
+  update_hijack_config([&](hijack_config_t &config) {
+    config.compute_mode_cache_enabled = false;
+  });
+}
+
+void cumpsgemm::hijack_control::clear_compute_mode_cache() {
+  // Changing the epoch invalidates all cached decisions
+  update_hijack_config([&](hijack_config_t &) {});
+}
+
+std::pair<std::size_t, std::size_t>
+cumpsgemm::hijack_control::get_compute_mode_cache_stats() {
+  return cumpsgemm::compute_mode_cache::get_stats();
+}
+
+void cumpsgemm::hijack_control::reload_config() {
+  cumpsgemm::config::reload();
+}
+
+cuMpSGEMM_compute_mode_t cumpsgemm::hijack_control::get_config_compute_mode() {
+  return cumpsgemm::config::get()->compute_mode;
 }
@@ -160,6 +160,27 @@ struct mma_smem_pipeline {
   }
 };
 
+// The position of the `tile_id`-th tile of C. The tiles are visited column by
+// column in groups of `group_width` tile rows, so that the blocks running at a
+// time share the tiles of A and B in L2. 0 makes all the tile rows a group.
+struct tile_position_t {
+  unsigned x, y;
+};
+__device__ inline tile_position_t
+get_tile_position(const unsigned tile_id, const unsigned num_m_tiles,
+                  const unsigned num_n_tiles, const unsigned group_width) {
+  if (group_width == 0 || group_width >= num_m_tiles) {
+    return {tile_id % num_m_tiles, tile_id / num_m_tiles};
+  }
+  const auto num_group_tiles = group_width * num_n_tiles;
+  const auto group_id = tile_id / num_group_tiles;
+  const auto first_m = group_id * group_width;
+  // The last group may have fewer rows
+  const auto num_rows = min(group_width, num_m_tiles - first_m);
+  const auto local_id = tile_id - group_id * num_group_tiles;
+  return {first_m + local_id % num_rows, local_id / num_rows};
+}
+
 template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
           unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
           unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
@@ -472,23 +493,36 @@ template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
           class MMA_SMEM, class TC_T, class EC>
 __global__ void
 gemm_kernel(const int *const dynamic_mode, const unsigned m, const unsigned n,
-            const unsigned k, const T alpha, const T *const a_dmem_ptr,
-            const unsigned lda, const T *const b_dmem_ptr, const unsigned ldb,
-            const T beta, T *const c_dmem_ptr, const unsigned ldc) {
+            const unsigned k, const cumpsgemm::scalar_t<T> alpha_scalar,
+            const T *const a_dmem_ptr, const unsigned lda,
+            const T *const b_dmem_ptr, const unsigned ldb,
+            const cumpsgemm::scalar_t<T> beta_scalar, T *const c_dmem_ptr,
+            const unsigned ldc, const unsigned group_width) {
   if (dynamic_mode != nullptr) {
     const auto mode =
         cumpsgemm::dynamic_launch::utils::get_gemm_flag(*dynamic_mode);
+    // BF16TCEC runs the TF32TCEC kernel for the complex GEMMs
     if ((std::is_same<TC_T, nvcuda::wmma::precision::tf32>::value &&
          std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
-        (mode != CUMPSGEMM_TF32TCEC))
+        (mode != CUMPSGEMM_TF32TCEC &&
+         !(std::is_same<T, cuComplex>::value && mode == CUMPSGEMM_BF16TCEC)))
+      return;
+    if ((std::is_same<TC_T, __nv_bfloat16>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_BF16TCEC))
       return;
     if ((std::is_same<TC_T, half>::value &&
          std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
         (mode != CUMPSGEMM_FP16TCEC && mode != CUMPSGEMM_FP16TCEC_SCALING))
       return;
   }
-  const auto blockIdx_x = (blockIdx.x) % ((m + SMEM_M - 1) / SMEM_M);
-  const auto blockIdx_y = (blockIdx.x) / ((m + SMEM_M - 1) / SMEM_M);
+  const auto tile = get_tile_position(blockIdx.x, (m + SMEM_M - 1) / SMEM_M,
+                                      (n + SMEM_N - 1) / SMEM_N, group_width);
+  const auto blockIdx_x = tile.x;
+  const auto blockIdx_y = tile.y;
+
+  const auto alpha = cumpsgemm::device::load_scalar(alpha_scalar);
+  const auto beta = cumpsgemm::device::load_scalar(beta_scalar);
 
   gemm_core<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
             NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
@@ -497,51 +531,275 @@ gemm_kernel(const int *const dynamic_mode, const unsigned m, const unsigned n,
       blockIdx_x, blockIdx_y);
 }
 
+// A block computes the partial tile of a K slice into the workspace. The last
+// block of a tile sums the partial tiles in the order of the slices and
+// applies alpha and beta, so the result does not depend on the order in which
+// the blocks run.
 template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
-          unsigned K_PER_MN, unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
           unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
-          class A_DMEM_LOADER, class B_DMEM_LOADER, class C_DMEM_STORER,
-          class MMA_SMEM, class TC_T, class EC>
-__global__ void
-gemm_atomic_kernel(const int *const dynamic_mode, const unsigned m,
-                   const unsigned n, const unsigned k, const T alpha,
-                   const T *const a_dmem_ptr, const unsigned lda,
-                   const T *const b_dmem_ptr, const unsigned ldb, const T beta,
-                   T *const c_dmem_ptr, const unsigned ldc) {
+          class A_DMEM_LOADER, class B_DMEM_LOADER, class MMA_SMEM, class TC_T,
+          class EC>
+__global__ void gemm_split_k_kernel(
+    const int *const dynamic_mode, const unsigned m, const unsigned n,
+    const unsigned k, const cumpsgemm::scalar_t<T> alpha_scalar,
+    const T *const a_dmem_ptr, const unsigned lda, const T *const b_dmem_ptr,
+    const unsigned ldb, const cumpsgemm::scalar_t<T> beta_scalar,
+    T *const c_dmem_ptr, const unsigned ldc, const unsigned k_per_split,
+    T *const workspace_ptr, unsigned *const counter_ptr,
+    const unsigned group_width) {
   if (dynamic_mode != nullptr) {
     const auto mode =
         cumpsgemm::dynamic_launch::utils::get_gemm_flag(*dynamic_mode);
     if ((std::is_same<TC_T, nvcuda::wmma::precision::tf32>::value &&
          std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
-        (mode != CUMPSGEMM_TF32TCEC))
+        (mode != CUMPSGEMM_TF32TCEC &&
+         !(std::is_same<T, cuComplex>::value && mode == CUMPSGEMM_BF16TCEC)))
+      return;
+    if ((std::is_same<TC_T, __nv_bfloat16>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_BF16TCEC))
       return;
     if ((std::is_same<TC_T, half>::value &&
          std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
         (mode != CUMPSGEMM_FP16TCEC))
       return;
   }
-  const auto k_offset = (blockIdx.x / (((m + SMEM_M - 1) / SMEM_M) *
-                                       ((n + SMEM_N - 1) / SMEM_N))) *
-                        K_PER_MN;
-  const auto mn_tid =
-      blockIdx.x % (((m + SMEM_M - 1) / SMEM_M) * ((n + SMEM_N - 1) / SMEM_N));
-  const auto blockIdx_x = (mn_tid) % ((m + SMEM_M - 1) / SMEM_M);
-  const auto blockIdx_y = (mn_tid) / ((m + SMEM_M - 1) / SMEM_M);
+  constexpr unsigned tile_size = SMEM_M * SMEM_N;
+  const auto num_tiles =
+      ((m + SMEM_M - 1) / SMEM_M) * ((n + SMEM_N - 1) / SMEM_N);
+  const auto num_splits = (k + k_per_split - 1) / k_per_split;
+  const auto tile_id = blockIdx.x % num_tiles;
+  const auto split_id = blockIdx.x / num_tiles;
+  const auto k_offset = split_id * k_per_split;
+  const auto tile = get_tile_position(tile_id, (m + SMEM_M - 1) / SMEM_M,
+                                      (n + SMEM_N - 1) / SMEM_N, group_width);
+  const auto blockIdx_x = tile.x;
+  const auto blockIdx_y = tile.y;
+
+  const auto alpha = cumpsgemm::device::load_scalar(alpha_scalar);
+  const auto beta = cumpsgemm::device::load_scalar(beta_scalar);
 
   gemm_core<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
             NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
-            C_DMEM_STORER, MMA_SMEM, TC_T, EC>{}(
-      m, n, min(k - k_offset, K_PER_MN), alpha,
+            cumpsgemm::device::dmem_tile_storer<T, SMEM_M, SMEM_N, smem_C_skew,
+                                                BLOCK_SIZE>,
+            MMA_SMEM, TC_T, EC>{}(
+      m, n, min(k - k_offset, k_per_split), alpha,
       a_dmem_ptr + (std::is_same<typename A_DMEM_LOADER::Layout,
                                  cumpsgemm::col_major>::value
-                        ? lda * k_offset
+                        ? static_cast<std::size_t>(lda) * k_offset
                         : k_offset),
       lda,
       b_dmem_ptr + (std::is_same<typename B_DMEM_LOADER::Layout,
                                  cumpsgemm::col_major>::value
                         ? k_offset
-                        : ldb * k_offset),
-      ldb, beta, c_dmem_ptr, ldc, blockIdx_x, blockIdx_y);
+                        : static_cast<std::size_t>(ldb) * k_offset),
+      ldb, beta,
+      workspace_ptr +
+          (static_cast<std::size_t>(split_id) * num_tiles + tile_id) *
+              tile_size,
+      SMEM_M, blockIdx_x, blockIdx_y);
+
+  // The partial tile is visible to the other blocks before it is counted
+  __threadfence();
+  __syncthreads();
+  __shared__ bool is_last_block;
+  if (threadIdx.x == 0) {
+    is_last_block = atomicAdd(counter_ptr + tile_id, 1u) == num_splits - 1;
+  }
+  __syncthreads();
+  if (!is_last_block) {
+    return;
+  }
+  __threadfence();
+
+  const auto start_m = blockIdx_x * SMEM_M;
+  const auto start_n = blockIdx_y * SMEM_N;
+  for (unsigned index = threadIdx.x; index < tile_size; index += BLOCK_SIZE) {
+    const auto im = start_m + index % SMEM_M;
+    const auto in = start_n + index / SMEM_M;
+    if (im >= m || in >= n) {
+      continue;
+    }
+    auto sum = cumpsgemm::device::zero<T>();
+    for (unsigned s = 0; s < num_splits; s++) {
+      // Bypass L1, which may hold stale lines of the other blocks' tiles
+      sum = cumpsgemm::device::add(
+          sum, __ldcg(workspace_ptr +
+                      (static_cast<std::size_t>(s) * num_tiles + tile_id) *
+                          tile_size +
+                      index));
+    }
+    const auto c_index = im + static_cast<std::size_t>(in) * ldc;
+    // C is not read when beta is zero
+    if (cumpsgemm::device::is_zero(beta)) {
+      c_dmem_ptr[c_index] = cumpsgemm::device::mul(sum, alpha);
+    } else {
+      c_dmem_ptr[c_index] = cumpsgemm::device::mad(
+          sum, alpha, cumpsgemm::device::mul(c_dmem_ptr[c_index], beta));
+    }
+  }
+  // Ready for the next launch
+  if (threadIdx.x == 0) {
+    counter_ptr[tile_id] = 0;
+  }
+}
+
+// A wave of persistent blocks shares the k-steps of all the tiles, as in
+// Stream-K. A block takes `k_steps_per_block` consecutive k-steps of the
+// linearized (tile, k-step) space. A tile which a block computes entirely is
+// stored to C. Otherwise the block stores its partial tile to its slot in the
+// workspace, and the last block arriving at the tile sums the partial tiles in
+// the order of the blocks and applies alpha and beta.
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class A_DMEM_LOADER, class B_DMEM_LOADER, class MMA_SMEM, class TC_T,
+          class EC>
+__global__ void gemm_stream_k_kernel(
+    const int *const dynamic_mode, const unsigned m, const unsigned n,
+    const unsigned k, const cumpsgemm::scalar_t<T> alpha_scalar,
+    const T *const a_dmem_ptr, const unsigned lda, const T *const b_dmem_ptr,
+    const unsigned ldb, const cumpsgemm::scalar_t<T> beta_scalar,
+    T *const c_dmem_ptr, const unsigned ldc, const unsigned k_steps_per_block,
+    T *const workspace_ptr, unsigned *const counter_ptr,
+    const unsigned group_width) {
+  if (dynamic_mode != nullptr) {
+    const auto mode =
+        cumpsgemm::dynamic_launch::utils::get_gemm_flag(*dynamic_mode);
+    if ((std::is_same<TC_T, nvcuda::wmma::precision::tf32>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_TF32TCEC &&
+         !(std::is_same<T, cuComplex>::value && mode == CUMPSGEMM_BF16TCEC)))
+      return;
+    if ((std::is_same<TC_T, __nv_bfloat16>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_BF16TCEC))
+      return;
+    if ((std::is_same<TC_T, half>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_FP16TCEC && mode != CUMPSGEMM_FP16TCEC_SCALING))
+      return;
+  }
+  constexpr unsigned tile_size = SMEM_M * SMEM_N;
+  const auto num_m_tiles = (m + SMEM_M - 1) / SMEM_M;
+  const auto num_n_tiles = (n + SMEM_N - 1) / SMEM_N;
+  const auto num_tiles = num_m_tiles * num_n_tiles;
+  const std::uint64_t num_k_steps = (k + SMEM_K - 1) / SMEM_K;
+  const auto begin =
+      static_cast<std::uint64_t>(blockIdx.x) * k_steps_per_block;
+  const auto end = min(begin + k_steps_per_block, num_tiles * num_k_steps);
+
+  const auto alpha = cumpsgemm::device::load_scalar(alpha_scalar);
+  const auto beta = cumpsgemm::device::load_scalar(beta_scalar);
+
+  __shared__ bool is_last_block;
+  for (auto iter = begin; iter < end;) {
+    const unsigned tile_id = iter / num_k_steps;
+    const auto k_step_begin = iter - tile_id * num_k_steps;
+    const auto k_step_end = min(num_k_steps, k_step_begin + (end - iter));
+    // The first tile of a block takes the slot 0 and the last one the slot 1
+    const unsigned slot = iter == begin ? 0 : 1;
+    iter += k_step_end - k_step_begin;
+
+    const auto tile =
+        get_tile_position(tile_id, num_m_tiles, num_n_tiles, group_width);
+    const auto blockIdx_x = tile.x;
+    const auto blockIdx_y = tile.y;
+    const unsigned k_offset = k_step_begin * SMEM_K;
+    const unsigned k_size =
+        min(k_step_end * SMEM_K, static_cast<std::uint64_t>(k)) - k_offset;
+    const auto a_ptr =
+        a_dmem_ptr + (std::is_same<typename A_DMEM_LOADER::Layout,
+                                   cumpsgemm::col_major>::value
+                          ? static_cast<std::size_t>(lda) * k_offset
+                          : k_offset);
+    const auto b_ptr =
+        b_dmem_ptr + (std::is_same<typename B_DMEM_LOADER::Layout,
+                                   cumpsgemm::col_major>::value
+                          ? k_offset
+                          : static_cast<std::size_t>(ldb) * k_offset);
+
+    if (k_step_begin == 0 && k_step_end == num_k_steps) {
+      gemm_core<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+                NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+                cumpsgemm::device::dmem_storer<T, SMEM_M, SMEM_N, smem_C_skew,
+                                               BLOCK_SIZE>,
+                MMA_SMEM, TC_T, EC>{}(m, n, k_size, alpha, a_ptr, lda, b_ptr,
+                                      ldb, beta, c_dmem_ptr, ldc, blockIdx_x,
+                                      blockIdx_y);
+      // The shared memory is reused by the next tile
+      __syncthreads();
+      continue;
+    }
+
+    gemm_core<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+              NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+              cumpsgemm::device::dmem_tile_storer<T, SMEM_M, SMEM_N,
+                                                  smem_C_skew, BLOCK_SIZE>,
+              MMA_SMEM, TC_T, EC>{}(
+        m, n, k_size, alpha, a_ptr, lda, b_ptr, ldb, beta,
+        workspace_ptr +
+            (static_cast<std::size_t>(blockIdx.x) * 2 + slot) * tile_size,
+        SMEM_M, blockIdx_x, blockIdx_y);
+
+    // The blocks sharing the tile
+    const unsigned first_block = tile_id * num_k_steps / k_steps_per_block;
+    const unsigned last_block =
+        ((tile_id + 1) * num_k_steps - 1) / k_steps_per_block;
+
+    // The partial tile is visible to the other blocks before it is counted
+    __threadfence();
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      is_last_block = atomicAdd(counter_ptr + tile_id, 1u) ==
+                      last_block - first_block;
+    }
+    __syncthreads();
+    if (!is_last_block) {
+      continue;
+    }
+    __threadfence();
+
+    const auto start_m = blockIdx_x * SMEM_M;
+    const auto start_n = blockIdx_y * SMEM_N;
+    for (unsigned index = threadIdx.x; index < tile_size;
+         index += BLOCK_SIZE) {
+      const auto im = start_m + index % SMEM_M;
+      const auto in = start_n + index / SMEM_M;
+      if (im >= m || in >= n) {
+        continue;
+      }
+      auto sum = cumpsgemm::device::zero<T>();
+      for (auto b = first_block; b <= last_block; b++) {
+        // The tile is the first one of the block b unless it starts earlier
+        const unsigned b_slot =
+            static_cast<std::uint64_t>(b) * k_steps_per_block / num_k_steps ==
+                    tile_id
+                ? 0
+                : 1;
+        // Bypass L1, which may hold stale lines of the other blocks' tiles
+        sum = cumpsgemm::device::add(
+            sum, __ldcg(workspace_ptr +
+                        (static_cast<std::size_t>(b) * 2 + b_slot) * tile_size +
+                        index));
+      }
+      const auto c_index = im + static_cast<std::size_t>(in) * ldc;
+      // C is not read when beta is zero
+      if (cumpsgemm::device::is_zero(beta)) {
+        c_dmem_ptr[c_index] = cumpsgemm::device::mul(sum, alpha);
+      } else {
+        c_dmem_ptr[c_index] = cumpsgemm::device::mad(
+            sum, alpha, cumpsgemm::device::mul(c_dmem_ptr[c_index], beta));
+      }
+    }
+    // Ready for the next launch
+    if (threadIdx.x == 0) {
+      counter_ptr[tile_id] = 0;
+    }
+    __syncthreads();
+  }
 }
 
 template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
@@ -551,32 +809,95 @@ template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
           class MMA_SMEM, class TC_T, class EC>
 __global__ void gemm_batchStrided_kernel(
     const int *const dynamic_mode, const unsigned m, const unsigned n,
-    const unsigned k, const T alpha, const T *const a_ptr, const unsigned lda,
-    const uint64_t stridea, const T *const b_ptr, const unsigned ldb,
-    const uint64_t strideb, const T beta, T *const c_ptr, const unsigned ldc,
-    const uint64_t stridec, const unsigned num_blocks_per_gemm) {
+    const unsigned k, const cumpsgemm::scalar_t<T> alpha_scalar,
+    const T *const a_ptr, const unsigned lda, const uint64_t stridea,
+    const T *const b_ptr, const unsigned ldb, const uint64_t strideb,
+    const cumpsgemm::scalar_t<T> beta_scalar, T *const c_ptr,
+    const unsigned ldc, const uint64_t stridec, const unsigned batch_count,
+    const unsigned group_width) {
   if (dynamic_mode != nullptr) {
     const auto mode =
         cumpsgemm::dynamic_launch::utils::get_gemm_flag(*dynamic_mode);
     if ((std::is_same<TC_T, nvcuda::wmma::precision::tf32>::value &&
          std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
-        (mode != CUMPSGEMM_TF32TCEC))
+        (mode != CUMPSGEMM_TF32TCEC &&
+         !(std::is_same<T, cuComplex>::value && mode == CUMPSGEMM_BF16TCEC)))
+      return;
+    if ((std::is_same<TC_T, __nv_bfloat16>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_BF16TCEC))
       return;
     if ((std::is_same<TC_T, half>::value &&
          std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
         (mode != CUMPSGEMM_FP16TCEC && mode != CUMPSGEMM_FP16TCEC_SCALING))
       return;
   }
-  const auto gemm_id = blockIdx.x / num_blocks_per_gemm;
-  const auto blockIdx_x =
-      (blockIdx.x % num_blocks_per_gemm) % ((m + SMEM_M - 1) / SMEM_M);
-  const auto blockIdx_y =
-      (blockIdx.x % num_blocks_per_gemm) / ((m + SMEM_M - 1) / SMEM_M);
+  const auto gemm_id = cumpsgemm::device::get_batch_id();
+  if (gemm_id >= batch_count) {
+    return;
+  }
+  const auto tile = get_tile_position(blockIdx.x, (m + SMEM_M - 1) / SMEM_M,
+                                      (n + SMEM_N - 1) / SMEM_N, group_width);
+  const auto blockIdx_x = tile.x;
+  const auto blockIdx_y = tile.y;
 
   const T *const a_dmem_ptr = a_ptr + gemm_id * stridea;
   const T *const b_dmem_ptr = b_ptr + gemm_id * strideb;
   T *const c_dmem_ptr = c_ptr + gemm_id * stridec;
 
+  const auto alpha = cumpsgemm::device::load_scalar(alpha_scalar);
+  const auto beta = cumpsgemm::device::load_scalar(beta_scalar);
+
+  gemm_core<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+            NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+            C_DMEM_STORER, MMA_SMEM, TC_T, EC>{}(
+      m, n, k, alpha, a_dmem_ptr, lda, b_dmem_ptr, ldb, beta, c_dmem_ptr, ldc,
+      blockIdx_x, blockIdx_y);
+}
+
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class A_DMEM_LOADER, class B_DMEM_LOADER, class C_DMEM_STORER,
+          class MMA_SMEM, class TC_T, class EC>
+__global__ void gemm_batchPtr_kernel(
+    const int *const dynamic_mode, const unsigned m, const unsigned n,
+    const unsigned k, const cumpsgemm::scalar_t<T> alpha_scalar,
+    const T *const *const a_ptr_list, const unsigned lda,
+    const T *const *const b_ptr_list, const unsigned ldb,
+    const cumpsgemm::scalar_t<T> beta_scalar, T *const *const c_ptr_list,
+    const unsigned ldc, const unsigned batch_count) {
+  if (dynamic_mode != nullptr) {
+    const auto mode =
+        cumpsgemm::dynamic_launch::utils::get_gemm_flag(*dynamic_mode);
+    if ((std::is_same<TC_T, nvcuda::wmma::precision::tf32>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_TF32TCEC &&
+         !(std::is_same<T, cuComplex>::value && mode == CUMPSGEMM_BF16TCEC)))
+      return;
+    if ((std::is_same<TC_T, __nv_bfloat16>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_BF16TCEC))
+      return;
+    if ((std::is_same<TC_T, half>::value &&
+         std::is_same<EC, mtk::wmma::tcec::with_ec>::value) &&
+        (mode != CUMPSGEMM_FP16TCEC && mode != CUMPSGEMM_FP16TCEC_SCALING))
+      return;
+  }
+  const auto gemm_id = cumpsgemm::device::get_batch_id();
+  if (gemm_id >= batch_count) {
+    return;
+  }
+  const auto blockIdx_x = blockIdx.x % ((m + SMEM_M - 1) / SMEM_M);
+  const auto blockIdx_y = blockIdx.x / ((m + SMEM_M - 1) / SMEM_M);
+
+  const T *const a_dmem_ptr = a_ptr_list[gemm_id];
+  const T *const b_dmem_ptr = b_ptr_list[gemm_id];
+  T *const c_dmem_ptr = c_ptr_list[gemm_id];
+
+  const auto alpha = cumpsgemm::device::load_scalar(alpha_scalar);
+  const auto beta = cumpsgemm::device::load_scalar(beta_scalar);
+
   gemm_core<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
             NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
             C_DMEM_STORER, MMA_SMEM, TC_T, EC>{}(
@@ -646,22 +967,18 @@ cumpsgemm::gemm_kernel_func_t<T> get_kernel_pipelined_func_ptr() {
 }
 
 template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
-          unsigned K_PER_MN, unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
           unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
           class OP_A, class OP_B, class TC_T, class EC>
-cumpsgemm::gemm_kernel_func_t<T> get_kernel_atomic_func_ptr() {
+cumpsgemm::gemm_split_k_kernel_func_t<T> get_kernel_split_k_func_ptr() {
   using A_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K,
                                                        smem_A_skew, BLOCK_SIZE>;
   using B_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N,
                                                        smem_B_skew, BLOCK_SIZE>;
-  using C_DMEM_STORER =
-      cumpsgemm::device::dmem_atomic_storer<T, SMEM_M, SMEM_N, smem_C_skew,
-                                            BLOCK_SIZE>;
-  constexpr cumpsgemm::gemm_kernel_func_t<T> func_ptr =
-      &(gemm_atomic_kernel<
-          T, SMEM_M, SMEM_N, SMEM_K, K_PER_MN, FRAG_M, FRAG_N, FRAG_K,
-          BLOCK_SIZE, NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
-          C_DMEM_STORER,
+  constexpr cumpsgemm::gemm_split_k_kernel_func_t<T> func_ptr =
+      &(gemm_split_k_kernel<
+          T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+          NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
           mma_smem<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K,
                    BLOCK_SIZE, typename A_DMEM_LOADER::Layout,
                    typename B_DMEM_LOADER::Layout, TC_T, EC>,
@@ -670,27 +987,60 @@ cumpsgemm::gemm_kernel_func_t<T> get_kernel_atomic_func_ptr() {
 }
 
 template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
-          unsigned K_PER_MN, unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
           unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
           class OP_A, class OP_B, class TC_T, class EC>
-cumpsgemm::gemm_kernel_func_t<T> get_kernel_pipelined_atomic_func_ptr() {
+cumpsgemm::gemm_split_k_kernel_func_t<T>
+get_kernel_pipelined_split_k_func_ptr() {
   using A_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K,
                                                        smem_A_skew, BLOCK_SIZE>;
   using B_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N,
                                                        smem_B_skew, BLOCK_SIZE>;
-  using C_DMEM_STORER =
-      cumpsgemm::device::dmem_atomic_storer<T, SMEM_M, SMEM_N, smem_C_skew,
-                                            BLOCK_SIZE>;
-  constexpr cumpsgemm::gemm_kernel_func_t<T> func_ptr =
-      &(gemm_atomic_kernel<
-          T, SMEM_M, SMEM_N, SMEM_K, K_PER_MN, FRAG_M, FRAG_N, FRAG_K,
-          BLOCK_SIZE, NUM_UNROLLINGS, NUM_STAGES,
-          cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K, smem_A_skew,
-                                         BLOCK_SIZE>,
-          cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N, smem_B_skew,
-                                         BLOCK_SIZE>,
-          cumpsgemm::device::dmem_storer<T, SMEM_M, SMEM_N, smem_C_skew,
-                                         BLOCK_SIZE>,
+  constexpr cumpsgemm::gemm_split_k_kernel_func_t<T> func_ptr =
+      &(gemm_split_k_kernel<
+          T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+          NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+          mma_smem_pipeline<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K,
+                            BLOCK_SIZE, typename A_DMEM_LOADER::Layout,
+                            typename B_DMEM_LOADER::Layout, TC_T, EC>,
+          TC_T, EC>);
+  return func_ptr;
+}
+
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class OP_A, class OP_B, class TC_T, class EC>
+cumpsgemm::gemm_stream_k_kernel_func_t<T> get_kernel_stream_k_func_ptr() {
+  using A_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K,
+                                                       smem_A_skew, BLOCK_SIZE>;
+  using B_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N,
+                                                       smem_B_skew, BLOCK_SIZE>;
+  constexpr cumpsgemm::gemm_stream_k_kernel_func_t<T> func_ptr =
+      &(gemm_stream_k_kernel<
+          T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+          NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+          mma_smem<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K,
+                   BLOCK_SIZE, typename A_DMEM_LOADER::Layout,
+                   typename B_DMEM_LOADER::Layout, TC_T, EC>,
+          TC_T, EC>);
+  return func_ptr;
+}
+
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class OP_A, class OP_B, class TC_T, class EC>
+cumpsgemm::gemm_stream_k_kernel_func_t<T>
+get_kernel_pipelined_stream_k_func_ptr() {
+  using A_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K,
+                                                       smem_A_skew, BLOCK_SIZE>;
+  using B_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N,
+                                                       smem_B_skew, BLOCK_SIZE>;
+  constexpr cumpsgemm::gemm_stream_k_kernel_func_t<T> func_ptr =
+      &(gemm_stream_k_kernel<
+          T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+          NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
           mma_smem_pipeline<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K,
                             BLOCK_SIZE, typename A_DMEM_LOADER::Layout,
                             typename B_DMEM_LOADER::Layout, TC_T, EC>,
@@ -755,6 +1105,53 @@ get_stridedBatch_kernel_pipelined_func_ptr() {
           TC_T, EC>);
   return func_ptr;
 }
+
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class OP_A, class OP_B, class TC_T, class EC>
+cumpsgemm::gemm_batchPtr_kernel_func_t<T> get_batchPtr_kernel_func_ptr() {
+  using A_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K,
+                                                       smem_A_skew, BLOCK_SIZE>;
+  using B_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N,
+                                                       smem_B_skew, BLOCK_SIZE>;
+  using C_DMEM_STORER = cumpsgemm::device::dmem_storer<T, SMEM_M, SMEM_N,
+                                                       smem_C_skew, BLOCK_SIZE>;
+  constexpr cumpsgemm::gemm_batchPtr_kernel_func_t<T> func_ptr =
+      &(gemm_batchPtr_kernel<
+          T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+          NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+          C_DMEM_STORER,
+          mma_smem<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K,
+                   BLOCK_SIZE, typename A_DMEM_LOADER::Layout,
+                   typename B_DMEM_LOADER::Layout, TC_T, EC>,
+          TC_T, EC>);
+  return func_ptr;
+}
+
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class OP_A, class OP_B, class TC_T, class EC>
+cumpsgemm::gemm_batchPtr_kernel_func_t<T>
+get_batchPtr_kernel_pipelined_func_ptr() {
+  using A_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_A, T, SMEM_M, SMEM_K,
+                                                       smem_A_skew, BLOCK_SIZE>;
+  using B_DMEM_LOADER = cumpsgemm::device::dmem_loader<OP_B, T, SMEM_K, SMEM_N,
+                                                       smem_B_skew, BLOCK_SIZE>;
+  using C_DMEM_STORER = cumpsgemm::device::dmem_storer<T, SMEM_M, SMEM_N,
+                                                       smem_C_skew, BLOCK_SIZE>;
+  constexpr cumpsgemm::gemm_batchPtr_kernel_func_t<T> func_ptr =
+      &(gemm_batchPtr_kernel<
+          T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+          NUM_UNROLLINGS, NUM_STAGES, A_DMEM_LOADER, B_DMEM_LOADER,
+          C_DMEM_STORER,
+          mma_smem_pipeline<T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K,
+                            BLOCK_SIZE, typename A_DMEM_LOADER::Layout,
+                            typename B_DMEM_LOADER::Layout, TC_T, EC>,
+          TC_T, EC>);
+  return func_ptr;
+}
 } // namespace
 
 namespace cumpsgemm {
@@ -802,17 +1199,18 @@ template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
           unsigned K_PER_MN, unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
           unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
           class OP_A, class OP_B, class TC_T, class EC, bool PIPELINED>
+// The split-K module. The number of the slices is planned on launch, and
+// `K_PER_MN` is the minimum k of a slice.
 cumpsgemm::gemm_module generate_gemm_atomic_module() {
-  cumpsgemm::gemm_kernel_func_t<T> kernel_func;
+  cumpsgemm::gemm_split_k_kernel_func_t<T> kernel_func;
   if constexpr (PIPELINED) {
-    kernel_func = get_kernel_pipelined_atomic_func_ptr<
-        T, SMEM_M, SMEM_N, SMEM_K, K_PER_MN, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+    kernel_func = get_kernel_pipelined_split_k_func_ptr<
+        T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
         NUM_UNROLLINGS, NUM_STAGES, OP_A, OP_B, TC_T, EC>();
   } else {
-    kernel_func =
-        get_kernel_atomic_func_ptr<T, SMEM_M, SMEM_N, SMEM_K, K_PER_MN, FRAG_M,
-                                   FRAG_N, FRAG_K, BLOCK_SIZE, NUM_UNROLLINGS,
-                                   NUM_STAGES, OP_A, OP_B, TC_T, EC>();
+    kernel_func = get_kernel_split_k_func_ptr<
+        T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+        NUM_UNROLLINGS, NUM_STAGES, OP_A, OP_B, TC_T, EC>();
   }
   cumpsgemm::gemm_module mod;
   mod.kernel_func = reinterpret_cast<void *>(kernel_func);
@@ -839,6 +1237,46 @@ cumpsgemm::gemm_module generate_gemm_atomic_module() {
   return mod;
 }
 
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class OP_A, class OP_B, class TC_T, class EC, bool PIPELINED>
+cumpsgemm::gemm_module generate_gemm_stream_k_module() {
+  cumpsgemm::gemm_stream_k_kernel_func_t<T> kernel_func;
+  if constexpr (PIPELINED) {
+    kernel_func = get_kernel_pipelined_stream_k_func_ptr<
+        T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+        NUM_UNROLLINGS, NUM_STAGES, OP_A, OP_B, TC_T, EC>();
+  } else {
+    kernel_func = get_kernel_stream_k_func_ptr<
+        T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+        NUM_UNROLLINGS, NUM_STAGES, OP_A, OP_B, TC_T, EC>();
+  }
+  cumpsgemm::gemm_module mod;
+  mod.kernel_func = reinterpret_cast<void *>(kernel_func);
+  mod.block_size = BLOCK_SIZE;
+  mod.smem_size =
+      get_total_smem_size<T, SMEM_M, SMEM_N, SMEM_K, OP_A, OP_B, NUM_STAGES>();
+  mod.smem_m = SMEM_M;
+  mod.smem_n = SMEM_N;
+  mod.smem_k = SMEM_K;
+  mod.schedule = cumpsgemm::gemm_schedule_t::stream_k;
+  CUTF_CHECK_ERROR_M(
+      cudaFuncSetAttribute(kernel_func,
+                           cudaFuncAttributeMaxDynamicSharedMemorySize,
+                           mod.smem_size),
+      ("requested shared memory size = " + std::to_string(mod.smem_size) +
+       " [B]")
+          .c_str());
+
+  int num_active_blocks;
+  CUTF_CHECK_ERROR(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+      &num_active_blocks, kernel_func, BLOCK_SIZE, mod.smem_size));
+  mod.num_active_blocks = num_active_blocks;
+
+  return mod;
+}
+
 template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
           unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
           unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
@@ -877,5 +1315,44 @@ cumpsgemm::gemm_module generate_gemm_stridedBatch_module() {
 
   return mod;
 }
+
+template <class T, unsigned SMEM_M, unsigned SMEM_N, unsigned SMEM_K,
+          unsigned FRAG_M, unsigned FRAG_N, unsigned FRAG_K,
+          unsigned BLOCK_SIZE, unsigned NUM_UNROLLINGS, unsigned NUM_STAGES,
+          class OP_A, class OP_B, class TC_T, class EC, bool PIPELINED>
+cumpsgemm::gemm_module generate_gemm_batchPtr_module() {
+  cumpsgemm::gemm_batchPtr_kernel_func_t<T> kernel_func;
+  if constexpr (PIPELINED) {
+    kernel_func = get_batchPtr_kernel_pipelined_func_ptr<
+        T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+        NUM_UNROLLINGS, NUM_STAGES, OP_A, OP_B, TC_T, EC>();
+  } else {
+    kernel_func = get_batchPtr_kernel_func_ptr<
+        T, SMEM_M, SMEM_N, SMEM_K, FRAG_M, FRAG_N, FRAG_K, BLOCK_SIZE,
+        NUM_UNROLLINGS, NUM_STAGES, OP_A, OP_B, TC_T, EC>();
+  }
+  cumpsgemm::gemm_module mod;
+  mod.kernel_func = reinterpret_cast<void *>(kernel_func);
+  mod.block_size = BLOCK_SIZE;
+  mod.smem_size =
+      get_total_smem_size<T, SMEM_M, SMEM_N, SMEM_K, OP_A, OP_B, NUM_STAGES>();
+  mod.smem_m = SMEM_M;
+  mod.smem_n = SMEM_N;
+  mod.smem_k = SMEM_K;
+  CUTF_CHECK_ERROR_M(
+      cudaFuncSetAttribute(kernel_func,
+                           cudaFuncAttributeMaxDynamicSharedMemorySize,
+                           mod.smem_size),
+      ("requested shared memory size = " + std::to_string(mod.smem_size) +
+       " [B]")
+          .c_str());
+
+  int num_active_blocks;
+  CUTF_CHECK_ERROR(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+      &num_active_blocks, kernel_func, BLOCK_SIZE, mod.smem_size));
+  mod.num_active_blocks = num_active_blocks;
+
+  return mod;
+}
 } // namespace cumpsgemm
 #endif
@@ -1,5 +1,7 @@
 #ifndef __CUMPGEMM_DEVICE_COMMON_HPP__
 #define __CUMPGEMM_DEVICE_COMMON_HPP__
+#include "instance.hpp"
+#include <algorithm>
 #include <mma.h>
 
 namespace cumpsgemm {
@@ -66,6 +68,14 @@ __device__ cuComplex inline mad<cuComplex>(const cuComplex a,
                         a.y * alpha.x + a.x * alpha.y + b.y);
 }
 
+template <class T>
+__device__ inline T load_scalar(const cumpsgemm::scalar_t<T> scalar) {
+  if (scalar.dmem_ptr == nullptr) {
+    return scalar.value;
+  }
+  return *scalar.dmem_ptr;
+}
+
 template <class T> __host__ __device__ bool inline is_zero(const T &v) {
   return v == 0;
 }
@@ -73,17 +83,30 @@ template <> __host__ __device__ bool inline is_zero(const cuComplex &v) {
   return v.x == 0 && v.y == 0;
 }
 
-__device__ inline float atomic_add(float *const ptr, const float a) {
-  return atomicAdd(ptr, a);
+template <class T> __device__ inline T add(const T a, const T b) {
+  return a + b;
 }
-__device__ inline cuComplex atomic_add(cuComplex *const ptr,
-                                       const cuComplex a) {
-  float *const px = &(ptr->x);
-  float *const py = &(ptr->y);
-  const auto x = ::atomicAdd(px, a.x);
-  const auto y = ::atomicAdd(py, a.y);
-  return make_cuComplex(x, y);
+template <>
+__device__ inline cuComplex add<cuComplex>(const cuComplex a,
+                                           const cuComplex b) {
+  return make_cuComplex(a.x + b.x, a.y + b.y);
+}
+
+// The matrix of the block in a grid of `cumpsgemm::get_batch_grid_size`
+__device__ inline unsigned get_batch_id() {
+  return blockIdx.z * gridDim.y + blockIdx.y;
 }
 } // namespace device
+
+// The grid of the batched kernels. x is the block of a matrix (e.g. the tile of
+// a GEMM) and y is the matrix. The matrices exceeding the limit of y are
+// continued in z, so the blocks of the last z slice beyond the batch return.
+constexpr unsigned max_batch_grid_y = 65535;
+inline dim3 get_batch_grid_size(const std::uint64_t num_tiles,
+                                const std::uint64_t batch_count) {
+  const auto grid_y = std::min<std::uint64_t>(
+      std::max<std::uint64_t>(batch_count, 1), max_batch_grid_y);
+  return dim3(num_tiles, grid_y, (batch_count + grid_y - 1) / grid_y);
+}
 } // namespace cumpsgemm
 #endif
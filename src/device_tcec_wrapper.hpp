@@ -1,6 +1,8 @@
 #ifndef __CUMPGEMM_TCEC_HPP__
 #define __CUMPGEMM_TCEC_HPP__
+#include <cuda_bf16.h>
 #include <wmma_extension/tcec/complex.hpp>
+#include <wmma_extension/wmma_extension.hpp>
 
 #include "device_common.hpp"
 
@@ -60,6 +62,64 @@ struct tc_fragment<cuComplex, Use, M, N, K, Layout, mtk::wmma::tcec::op_simt,
   frag_t frag;
 };
 
+// BF16x3 error correction (BF16TCEC).
+// An FP32 value is split into three BF16 values, hi + lo + lo2, which hold its
+// 24-bit mantissa. BF16 has the same exponent range as FP32, so no scaling is
+// needed. The products smaller than 2^-24 of hi*hi (lo*lo2, lo2*lo, lo2*lo2)
+// are omitted, and the other five corrections are accumulated separately from
+// hi*hi. The fragments are built from 16x16x16 WMMA fragments.
+namespace detail {
+constexpr unsigned bf16_frag_dim = 16;
+
+__device__ inline void split_bf16x3(const float v, __nv_bfloat16 &hi,
+                                    __nv_bfloat16 &lo, __nv_bfloat16 &lo2) {
+  hi = __float2bfloat16(v);
+  const auto r = v - __bfloat162float(hi);
+  lo = __float2bfloat16(r);
+  lo2 = __float2bfloat16(r - __bfloat162float(lo));
+}
+
+template <class Layout>
+__device__ inline unsigned get_mem_index(const unsigned i, const unsigned j,
+                                         const uint64_t ldm) {
+  if (std::is_same<Layout, cumpsgemm::col_major>::value) {
+    return i + j * ldm;
+  }
+  return i * ldm + j;
+}
+} // namespace detail
+
+template <class Use, unsigned M, unsigned N, unsigned K, class Layout>
+struct tc_fragment<float, Use, M, N, K, Layout, __nv_bfloat16,
+                   mtk::wmma::tcec::with_ec> {
+  static constexpr unsigned num_rows =
+      (std::is_same<Use, nvcuda::wmma::matrix_b>::value ? K : M) /
+      detail::bf16_frag_dim;
+  static constexpr unsigned num_cols =
+      (std::is_same<Use, nvcuda::wmma::matrix_a>::value ? K : N) /
+      detail::bf16_frag_dim;
+  using frag_t = nvcuda::wmma::fragment<
+      Use, detail::bf16_frag_dim, detail::bf16_frag_dim, detail::bf16_frag_dim,
+      __nv_bfloat16, typename detail::use_layout_conv<Use>::type>;
+  // Column-major order of the 16x16 sub-matrices
+  frag_t hi[num_rows * num_cols];
+  frag_t lo[num_rows * num_cols];
+  frag_t lo2[num_rows * num_cols];
+};
+
+template <unsigned M, unsigned N, unsigned K>
+struct tc_fragment<float, nvcuda::wmma::accumulator, M, N, K, void,
+                   __nv_bfloat16, mtk::wmma::tcec::with_ec> {
+  static constexpr unsigned num_rows = M / detail::bf16_frag_dim;
+  static constexpr unsigned num_cols = N / detail::bf16_frag_dim;
+  using frag_t =
+      nvcuda::wmma::fragment<nvcuda::wmma::accumulator, detail::bf16_frag_dim,
+                             detail::bf16_frag_dim, detail::bf16_frag_dim,
+                             float>;
+  frag_t frag[num_rows * num_cols];
+  frag_t correction[num_rows * num_cols];
+};
+
 // fill_zero
 template <class MEM_T, class Use, unsigned M, unsigned N, unsigned K,
           class TC_T, class Layout, class EC>
@@ -105,6 +165,105 @@ mma(tc_fragment<MEM_T, nvcuda::wmma::accumulator, M, N, K, void, TC_T, EC>
   mtk::wmma::tcec::mma_sync(frag_d.frag, frag_a.frag, frag_b.frag, frag_c.frag);
 }
 
+// BF16TCEC
+template <unsigned M, unsigned N, unsigned K>
+__device__ void
+fill_zero(tc_fragment<float, nvcuda::wmma::accumulator, M, N, K, void,
+                      __nv_bfloat16, mtk::wmma::tcec::with_ec> &frag) {
+  for (unsigned i = 0; i < frag.num_rows * frag.num_cols; i++) {
+    nvcuda::wmma::fill_fragment(frag.frag[i], 0.f);
+    nvcuda::wmma::fill_fragment(frag.correction[i], 0.f);
+  }
+}
+
+template <class Use, unsigned M, unsigned N, unsigned K, class Layout>
+__device__ void load_matrix(tc_fragment<float, Use, M, N, K, Layout,
+                                        __nv_bfloat16, mtk::wmma::tcec::with_ec>
+                                &frag,
+                            const float *const ptr, const uint64_t ldm) {
+  using frag_t = typename std::remove_reference<decltype(frag)>::type::frag_t;
+  for (unsigned c = 0; c < frag.num_cols; c++) {
+    for (unsigned r = 0; r < frag.num_rows; r++) {
+      const auto sub_id = r + c * frag.num_rows;
+      const auto sub_ptr =
+          ptr + detail::get_mem_index<Layout>(r * detail::bf16_frag_dim,
+                                              c * detail::bf16_frag_dim, ldm);
+      mtk::wmma::foreach_ij<frag_t>(
+          [&](const unsigned *frag_index_list,
+              const unsigned fragment_index_count, const unsigned i,
+              const unsigned j) {
+            __nv_bfloat16 hi, lo, lo2;
+            detail::split_bf16x3(
+                sub_ptr[detail::get_mem_index<Layout>(i, j, ldm)], hi, lo,
+                lo2);
+            for (unsigned f = 0; f < fragment_index_count; f++) {
+              const auto index = frag_index_list[f];
+              frag.hi[sub_id].x[index] = hi;
+              frag.lo[sub_id].x[index] = lo;
+              frag.lo2[sub_id].x[index] = lo2;
+            }
+          });
+    }
+  }
+}
+
+template <unsigned M, unsigned N, unsigned K>
+__device__ void
+store_matrix(float *const ptr,
+             tc_fragment<float, nvcuda::wmma::accumulator, M, N, K, void,
+                         __nv_bfloat16, mtk::wmma::tcec::with_ec> &frag,
+             const uint64_t ldm) {
+  for (unsigned c = 0; c < frag.num_cols; c++) {
+    for (unsigned r = 0; r < frag.num_rows; r++) {
+      const auto sub_id = r + c * frag.num_rows;
+      auto sum = frag.frag[sub_id];
+      for (unsigned e = 0; e < sum.num_elements; e++) {
+        sum.x[e] += frag.correction[sub_id].x[e];
+      }
+      nvcuda::wmma::store_matrix_sync(
+          ptr + r * detail::bf16_frag_dim + c * detail::bf16_frag_dim * ldm,
+          sum, ldm, nvcuda::wmma::mem_col_major);
+    }
+  }
+}
+
+template <class OP_A, class OP_B, unsigned M, unsigned N, unsigned K>
+__device__ void
+mma(tc_fragment<float, nvcuda::wmma::accumulator, M, N, K, void, __nv_bfloat16,
+                mtk::wmma::tcec::with_ec> &frag_d,
+    const tc_fragment<float, nvcuda::wmma::matrix_a, M, N, K, OP_A,
+                      __nv_bfloat16, mtk::wmma::tcec::with_ec> &frag_a,
+    const tc_fragment<float, nvcuda::wmma::matrix_b, M, N, K, OP_B,
+                      __nv_bfloat16, mtk::wmma::tcec::with_ec> &frag_b,
+    const tc_fragment<float, nvcuda::wmma::accumulator, M, N, K, void,
+                      __nv_bfloat16, mtk::wmma::tcec::with_ec> &frag_c) {
+  if (&frag_d != &frag_c) {
+    frag_d = frag_c;
+  }
+  for (unsigned n = 0; n < frag_d.num_cols; n++) {
+    for (unsigned m = 0; m < frag_d.num_rows; m++) {
+      const auto d = m + n * frag_d.num_rows;
+      for (unsigned k = 0; k < frag_a.num_cols; k++) {
+        const auto a = m + k * frag_a.num_rows;
+        const auto b = k + n * frag_b.num_rows;
+        // From the smallest correction term
+        nvcuda::wmma::mma_sync(frag_d.correction[d], frag_a.lo2[a],
+                               frag_b.hi[b], frag_d.correction[d]);
+        nvcuda::wmma::mma_sync(frag_d.correction[d], frag_a.hi[a],
+                               frag_b.lo2[b], frag_d.correction[d]);
+        nvcuda::wmma::mma_sync(frag_d.correction[d], frag_a.lo[a],
+                               frag_b.lo[b], frag_d.correction[d]);
+        nvcuda::wmma::mma_sync(frag_d.correction[d], frag_a.lo[a],
+                               frag_b.hi[b], frag_d.correction[d]);
+        nvcuda::wmma::mma_sync(frag_d.correction[d], frag_a.hi[a],
+                               frag_b.lo[b], frag_d.correction[d]);
+        nvcuda::wmma::mma_sync(frag_d.frag[d], frag_a.hi[a], frag_b.hi[b],
+                               frag_d.frag[d]);
+      }
+    }
+  }
+}
+
 } // namespace device
 } // namespace cumpsgemm
 #endif
@@ -1,20 +1,32 @@
 #include "dynamic_launch.hpp"
+#include "utils.hpp"
 #include <cumpsgemm/hijack_control.hpp>
 #include <cutf/memory.hpp>
 
 namespace {
-__global__ void init_flag_buffer(int *const ptr) {
-  ptr[0] = CUMPSGEMM_TF32TCEC;
+// The number of the buffer slots reserved for CUDA Graph capture
+constexpr unsigned num_graph_slots = 1u << 16;
+
+__global__ void init_flag_buffer(int *const ptr, const int fallback_mode) {
+  ptr[0] = fallback_mode;
   ptr[1] = (3u << 5) | CUMPSGEMM_FP16TCEC;
 }
+
+__global__ void set_flag_kernel(int *const ptr, const int flag) { *ptr = flag; }
 } // unnamed namespace
 
 void init_dynamic_launch_flag_buffer(cuMpSGEMM_handle *handle) {
   handle->dynamic_launch_handle =
       new cumpsgemm::dynamic_launch::dynamic_launch_handle;
 
-  handle->dynamic_launch_handle->flag_buffer_length = 10000;
+  handle->dynamic_launch_handle->ring_buffer_length = 10000;
+  handle->dynamic_launch_handle->flag_buffer_length =
+      handle->dynamic_launch_handle->ring_buffer_length + num_graph_slots;
   handle->dynamic_launch_handle->current_buffer_id = 1;
+  handle->dynamic_launch_handle->graph_slots =
+      std::make_shared<cumpsgemm::graph_slot_pool_t>(
+          handle->dynamic_launch_handle->ring_buffer_length,
+          handle->dynamic_launch_handle->flag_buffer_length);
   handle->dynamic_launch_handle->enabled = false;
   handle->dynamic_launch_handle->enabled_id = 0;
 
@@ -25,7 +37,8 @@ void init_dynamic_launch_flag_buffer(cuMpSGEMM_handle *handle) {
       &handle->dynamic_launch_handle->flag_buffer,
       sizeof(int) * handle->dynamic_launch_handle->flag_buffer_length));
   init_flag_buffer<<<1, 1, 0, handle->cuda_stream>>>(
-      handle->dynamic_launch_handle->flag_buffer);
+      handle->dynamic_launch_handle->flag_buffer,
+      handle->dynamic_launch_handle->mode_A);
 }
 
 void destroy_launch_flag_buffer(cuMpSGEMM_handle *handle) {
@@ -33,13 +46,30 @@ void destroy_launch_flag_buffer(cuMpSGEMM_handle *handle) {
   delete handle->dynamic_launch_handle;
 }
 
+// Same as the exp_stats buffer id, the graph slots are used while the stream is
+// captured and are given back when the graph is destroyed
 unsigned cumpsgemm::dynamic_launch::get_next_dynamic_launch_flag_buffer_id(
     cuMpSGEMM_handle *handle) {
-  const auto next = ++(handle->dynamic_launch_handle->current_buffer_id);
-  if (next < handle->dynamic_launch_handle->flag_buffer_length) {
+  auto dynamic_launch_handle = handle->dynamic_launch_handle;
+  if (cumpsgemm::is_capturing(handle)) {
+    const auto graph_slots = dynamic_launch_handle->graph_slots;
+    std::uint32_t id;
+    if (!graph_slots->acquire(id)) {
+      cuMpSGEMM_error(
+          "All dynamic launch slots for CUDA Graph capture are used");
+      return dynamic_launch_handle->current_buffer_id;
+    }
+    cumpsgemm::call_on_graph_destroy(
+        handle->cuda_stream, [graph_slots, id]() { graph_slots->release(id); });
+    dynamic_launch_handle->current_buffer_id = id;
+    return id;
+  }
+
+  const auto next = ++(dynamic_launch_handle->current_buffer_id);
+  if (next < dynamic_launch_handle->ring_buffer_length) {
     return next;
   }
-  handle->dynamic_launch_handle->flag_buffer_length = 2;
+  dynamic_launch_handle->current_buffer_id = 2;
   return 2;
 }
 
@@ -48,6 +78,17 @@ unsigned cumpsgemm::dynamic_launch::get_current_dynamic_launch_flag_buffer_id(
   return handle->dynamic_launch_handle->current_buffer_id;
 }
 
+unsigned
+cumpsgemm::dynamic_launch::get_num_free_graph_slots(cuMpSGEMM_handle *handle) {
+  return handle->dynamic_launch_handle->graph_slots->get_num_free();
+}
+
+void cumpsgemm::dynamic_launch::set_dynamic_launch_flag(
+    cuMpSGEMM_handle *handle, const unsigned buffer_id, const int flag) {
+  set_flag_kernel<<<1, 1, 0, handle->cuda_stream>>>(
+      handle->dynamic_launch_handle->flag_buffer + buffer_id, flag);
+}
+
 int cumpsgemm::dynamic_launch::get_dynamic_launch_buffer(
     cuMpSGEMM_handle *handle, const unsigned buffer_id) {
   int mode;
@@ -68,3 +109,14 @@ void cumpsgemm::dynamic_launch::unset_dynamic_launch_flag_buffer_id(
   handle->dynamic_launch_handle->enabled_id = 0;
   handle->dynamic_launch_handle->enabled = 0;
 }
+
+void cumpsgemm::dynamic_launch::set_fallback_mode(
+    cuMpSGEMM_handle *handle, const cuMpSGEMM_compute_mode_t mode) {
+  if (mode != CUMPSGEMM_TF32TCEC && mode != CUMPSGEMM_BF16TCEC) {
+    cuMpSGEMM_error("The AUTO fallback mode must be TF32TCEC or BF16TCEC");
+    return;
+  }
+  handle->dynamic_launch_handle->mode_A = mode;
+  init_flag_buffer<<<1, 1, 0, handle->cuda_stream>>>(
+      handle->dynamic_launch_handle->flag_buffer, mode);
+}
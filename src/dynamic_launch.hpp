@@ -1,28 +1,41 @@
 #pragma once
+#include "graph_slot_pool.hpp"
 #include "handle.hpp"
 #include <cstdint>
 #include <cumpsgemm/detail/common.h>
+#include <memory>
 
 namespace cumpsgemm {
 namespace dynamic_launch {
 struct dynamic_launch_handle {
+  // [2, ring_buffer_length) is used as a ring buffer and
+  // [ring_buffer_length, flag_buffer_length) is used in CUDA Graph capture
   unsigned flag_buffer_length;
+  unsigned ring_buffer_length;
   unsigned current_buffer_id;
+  // Shared with the graphs, which give their slots back when destroyed
+  std::shared_ptr<cumpsgemm::graph_slot_pool_t> graph_slots;
 
   int *flag_buffer;
 
   bool enabled;
   unsigned enabled_id;
 
+  // mode_A is the fallback of AUTO when FP16TCEC(_SCALING) is not enough
   cuMpSGEMM_compute_mode_t mode_A;
   cuMpSGEMM_compute_mode_t mode_B;
 };
 
 unsigned get_next_dynamic_launch_flag_buffer_id(cuMpSGEMM_handle *handle);
 unsigned get_current_dynamic_launch_flag_buffer_id(cuMpSGEMM_handle *handle);
+unsigned get_num_free_graph_slots(cuMpSGEMM_handle *handle);
+void set_dynamic_launch_flag(cuMpSGEMM_handle *handle, const unsigned buffer_id,
+                             const int flag);
 int get_dynamic_launch_buffer(cuMpSGEMM_handle *handle,
                               const unsigned buffer_id);
 void set_dynamic_launch_flag_buffer_id(cuMpSGEMM_handle *handle, unsigned id);
 void unset_dynamic_launch_flag_buffer_id(cuMpSGEMM_handle *handle);
+void set_fallback_mode(cuMpSGEMM_handle *handle,
+                       const cuMpSGEMM_compute_mode_t mode);
 } // namespace dynamic_launch
 } // namespace cumpsgemm
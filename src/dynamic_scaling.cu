@@ -1,3 +1,4 @@
+#include "device_common.hpp"
 #include "dynamic_launch.hpp"
 #include "dynamic_launch_utils.hpp"
 #include "dynamic_scaling.hpp"
@@ -20,7 +21,10 @@ template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T>
 __device__ void scaling_core(const unsigned m, const unsigned n, T *const ptr,
                              const unsigned ld, const unsigned batch_size,
                              const unsigned stride, const float coef) {
-  const auto ib = blockIdx.y;
+  const auto ib = cumpsgemm::device::get_batch_id();
+  if (ib >= batch_size) {
+    return;
+  }
   auto local_mat_ptr = ptr + ib * stride;
   for (LOOP_T lid = (threadIdx.x + blockIdx.x * blockDim.x) * VEC_LEN;
        lid < m * n; lid += BLOCK_SIZE * gridDim.x * VEC_LEN) {
@@ -158,7 +162,7 @@ void scale_AB(cuMpSGEMM_handle *handle, const unsigned m, const unsigned n,
   constexpr unsigned VEC_LEN = 2;
 
   constexpr auto block_size = 256;
-  const dim3 grid_size(
+  const auto grid_size = cumpsgemm::get_batch_grid_size(
       ((1lu * m * n + block_size - 1) / block_size + VEC_LEN - 1) / VEC_LEN,
       (stride == 0) ? 1 : batch_size);
 
@@ -199,7 +203,7 @@ void reset_scale_AB(cuMpSGEMM_handle *handle, const unsigned m,
   constexpr unsigned VEC_LEN = 2;
 
   constexpr auto block_size = 256;
-  const dim3 grid_size(
+  const auto grid_size = cumpsgemm::get_batch_grid_size(
       ((1lu * m * n + block_size - 1) / block_size + VEC_LEN - 1) / VEC_LEN,
       (stride == 0) ? 1 : batch_size);
 
@@ -271,7 +275,7 @@ void cumpsgemm::dynamic_scaling::scale_C(
   constexpr unsigned VEC_LEN = 2;
 
   constexpr auto block_size = 256;
-  const dim3 grid_size(
+  const auto grid_size = cumpsgemm::get_batch_grid_size(
       ((1lu * m * n + block_size - 1) / block_size + VEC_LEN - 1) / VEC_LEN,
       (stride == 0) ? 1 : batch_size);
 
@@ -364,12 +368,16 @@ namespace {
 __global__ void set_dynamic_launch_flag_by_exp_stats_kernel(
     int *const dynamic_mode_flag_buffer,
     const int *const A_exp_stats_compute_mode,
-    const int *const B_exp_stats_compute_mode) {
+    const int *const B_exp_stats_compute_mode, const bool scaling_enabled,
+    const int fallback_mode) {
   const auto pA = *A_exp_stats_compute_mode;
   const auto pB = *B_exp_stats_compute_mode;
 
-  if (pA == CUMPSGEMM_TF32TCEC || pB == CUMPSGEMM_TF32TCEC) {
-    *dynamic_mode_flag_buffer = CUMPSGEMM_TF32TCEC;
+  // TF32TCEC in the exp_stats buffer means that FP16 is not enough
+  if (pA == CUMPSGEMM_TF32TCEC || pB == CUMPSGEMM_TF32TCEC ||
+      (!scaling_enabled && (pA == CUMPSGEMM_FP16TCEC_SCALING ||
+                            pB == CUMPSGEMM_FP16TCEC_SCALING))) {
+    *dynamic_mode_flag_buffer = fallback_mode;
     return;
   }
 
@@ -387,11 +395,11 @@ __global__ void set_dynamic_launch_flag_by_exp_stats_kernel(
 
 void cumpsgemm::dynamic_scaling::set_dynamic_launch_buffer_by_exp_stats(
     cuMpSGEMM_handle_t handle, const unsigned dynamic_mode_flag_id,
-    const unsigned A_exp_stats_buffer_id,
-    const unsigned B_exp_stats_buffer_id) {
+    const unsigned A_exp_stats_buffer_id, const unsigned B_exp_stats_buffer_id,
+    const bool scaling_enabled) {
   set_dynamic_launch_flag_by_exp_stats_kernel<<<1, 1, 0, handle->cuda_stream>>>(
       handle->dynamic_launch_handle->flag_buffer + dynamic_mode_flag_id,
       handle->exp_stats_handle->dev_compute_mode_buffer + A_exp_stats_buffer_id,
-      handle->exp_stats_handle->dev_compute_mode_buffer +
-          B_exp_stats_buffer_id);
+      handle->exp_stats_handle->dev_compute_mode_buffer + B_exp_stats_buffer_id,
+      scaling_enabled, handle->dynamic_launch_handle->mode_A);
 }
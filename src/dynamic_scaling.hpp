@@ -38,8 +38,11 @@ void reset_scale_B(cuMpSGEMM_handle *handle, const unsigned m, const unsigned n,
                    const unsigned exp_stats_buffer_id,
                    const unsigned dynamic_launch_buffer_id);
 
+// When scaling_enabled is false, TF32TCEC is used instead of FP16TCEC with
+// scaling
 void set_dynamic_launch_buffer_by_exp_stats(
     cuMpSGEMM_handle *handle, const unsigned dynamic_mode_flag_id,
-    const unsigned A_exp_stats_buffer_id, const unsigned B_exp_stats_buffer_id);
+    const unsigned A_exp_stats_buffer_id, const unsigned B_exp_stats_buffer_id,
+    const bool scaling_enabled = true);
 } // namespace dynamic_scaling
 } // namespace cumpsgemm
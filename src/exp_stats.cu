@@ -1,4 +1,6 @@
+#include "device_common.hpp"
 #include "exp_stats.hpp"
+#include "utils.hpp"
 #include <cumpsgemm/cumpsgemm.hpp>
 #include <cutf/experimental/fp.hpp>
 #include <cutf/math.hpp>
@@ -7,16 +9,36 @@
 
 namespace {
 constexpr unsigned warp_size = 32;
-}
+// The number of the buffer slots reserved for CUDA Graph capture
+constexpr std::uint32_t num_graph_slots = 1u << 16;
+} // namespace
 
 // Ring buffer id calculator.
 // 0 and 1 is reserved
-// loop[2, 3, ..., buffer_length-1]
+// loop[2, 3, ..., ring_buffer_length-1]
+// While the stream is captured, each call takes its own graph slot instead so
+// that the replayed graphs do not share the slots with the later calls. The
+// graph slot is given back when the graph is destroyed, since a graph captured
+// earlier may still be replayed.
 std::uint32_t
 cumpsgemm::exp_stats::get_next_exp_stats_buffer_id(cuMpSGEMM_handle *handle) {
+  auto exp_stats_handle = handle->exp_stats_handle;
+  if (cumpsgemm::is_capturing(handle)) {
+    const auto graph_slots = exp_stats_handle->graph_slots;
+    std::uint32_t id;
+    if (!graph_slots->acquire(id)) {
+      cuMpSGEMM_error("All exp_stats slots for CUDA Graph capture are used");
+      return exp_stats_handle->current_buffer_id;
+    }
+    cumpsgemm::call_on_graph_destroy(
+        handle->cuda_stream, [graph_slots, id]() { graph_slots->release(id); });
+    exp_stats_handle->current_buffer_id = id;
+    return id;
+  }
+
   handle->exp_stats_handle->current_buffer_id++;
   const auto next = handle->exp_stats_handle->current_buffer_id;
-  if (next < handle->exp_stats_handle->buffer_length) {
+  if (next < handle->exp_stats_handle->ring_buffer_length) {
     return next;
   }
   handle->exp_stats_handle->current_buffer_id = 2;
@@ -28,6 +50,11 @@ std::uint32_t cumpsgemm::exp_stats::get_current_exp_stats_buffer_id(
   return handle->exp_stats_handle->current_buffer_id;
 }
 
+std::uint32_t
+cumpsgemm::exp_stats::get_num_free_graph_slots(cuMpSGEMM_handle *handle) {
+  return handle->exp_stats_handle->graph_slots->get_num_free();
+}
+
 namespace {
 __device__ float abs_max_float(const float a) { return cutf::math::abs(a); }
 __device__ float abs_max_float(const cuComplex a) {
@@ -37,6 +64,24 @@ __device__ float abs_max_float(const cuComplex a) {
 template <class T> __device__ T make_zero() { return 0; }
 template <> __device__ cuComplex make_zero() { return make_float2(0, 0); }
 
+// Matrix pointer getters of each batch
+template <class T> struct strided_batch_t {
+  const T *const ptr;
+  const unsigned stride;
+
+  __device__ const T *operator()(const unsigned ib) const {
+    return ptr + ib * stride;
+  }
+};
+
+template <class T> struct ptr_list_batch_t {
+  const T *const *const ptr_list;
+
+  __device__ const T *operator()(const unsigned ib) const {
+    return ptr_list[ib];
+  }
+};
+
 __device__ void update_count(const float a, unsigned &local_total_count,
                              unsigned &local_underflow_count,
                              const float ignore_threshold,
@@ -71,15 +116,19 @@ init_exp_stats_buffer(float *const max_exp_buffer,
 }
 
 // Get the largest abs value
-template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T>
+template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T,
+          class BATCH_T>
 __global__ void exp_stats_ext_stage_1_kernel(
     float *const max_exp_buffer, cumpsgemm::counter_t *const total_count_buffer,
     cumpsgemm::counter_t *const underflow_count_buffer,
     const float underflow_threshold, const float ignore_threshold,
-    const unsigned m, const unsigned n, const T *const ptr, const unsigned ld,
-    const unsigned batch_size, const unsigned stride) {
-  const auto ib = blockIdx.y;
-  const auto local_mat_ptr = ptr + ib * stride;
+    const unsigned m, const unsigned n, const BATCH_T batch, const unsigned ld,
+    const unsigned num_batches) {
+  const auto ib = cumpsgemm::device::get_batch_id();
+  if (ib >= num_batches) {
+    return;
+  }
+  const auto local_mat_ptr = batch(ib);
 
   float local_max_abs_value = 0;
   unsigned local_total_count = 0;
@@ -184,23 +233,26 @@ update_dynamic_mode_1_kernel(int *const dynamic_mode,
 }
 
 // exp_stats for cuBLAS original functions
-template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T>
+template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T,
+          class BATCH_T>
 __global__ void exp_stats_ext_stage_2_kernel(
     const int *const dynamic_mode,
     cumpsgemm::counter_t *const total_count_buffer,
     cumpsgemm::counter_t *const underflow_count_buffer,
     const float *const max_exp_buffer, const float underflow_threshold,
     const float ignore_threshold, const unsigned m, const unsigned n,
-    const T *const ptr, const unsigned ld, const unsigned batch_size,
-    const unsigned stride) {
+    const BATCH_T batch, const unsigned ld, const unsigned num_batches) {
   // Launch-and-exit
   if (dynamic_mode == nullptr || *dynamic_mode != CUMPSGEMM_UNDEFINED) {
     return;
   }
   unsigned local_total_count = 0;
   unsigned local_underflow_count = 0;
-  const auto ib = blockIdx.y;
-  const auto local_mat_ptr = ptr + ib * stride;
+  const auto ib = cumpsgemm::device::get_batch_id();
+  if (ib >= num_batches) {
+    return;
+  }
+  const auto local_mat_ptr = batch(ib);
   const auto max_exp_value = *max_exp_buffer;
   const auto abs_ignore_threshold = ignore_threshold * max_exp_value;
   const auto abs_underflow_threshold = underflow_threshold * max_exp_value;
@@ -292,18 +344,18 @@ update_dynamic_mode_2_kernel(int *const dynamic_mode,
   }
 }
 
-template <class T, unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T>
+template <class T, unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T,
+          class BATCH_T>
 void launch_compute_mode_set_kernel(cuMpSGEMM_handle *handle, const unsigned m,
-                                    const unsigned n, const T *const ptr,
+                                    const unsigned n, const BATCH_T batch,
                                     const unsigned ld,
-                                    const unsigned batch_size,
-                                    const unsigned stride,
+                                    const unsigned num_batches,
                                     const unsigned buffer_id) {
-  const dim3 grid_size(
+  const auto grid_size = cumpsgemm::get_batch_grid_size(
       std::min<std::uint64_t>(
           ((1lu * m * n + BLOCK_SIZE - 1) / BLOCK_SIZE + VEC_LEN - 1) / VEC_LEN,
           handle->num_sms * 4),
-      (stride == 0) ? 1 : batch_size);
+      num_batches);
 
   // 0
   if (handle->exp_stats_handle->profiling_enabled) {
@@ -327,8 +379,8 @@ void launch_compute_mode_set_kernel(cuMpSGEMM_handle *handle, const unsigned m,
           handle->exp_stats_handle->dev_total_count_buffer + buffer_id,
           handle->exp_stats_handle->dev_underflow_count_buffer + buffer_id,
           handle->exp_stats_handle->underflow_threshold,
-          handle->exp_stats_handle->ignore_threshold, m, n, ptr, ld, batch_size,
-          stride);
+          handle->exp_stats_handle->ignore_threshold, m, n, batch, ld,
+          num_batches);
   if (handle->exp_stats_handle->profiling_enabled) {
     handle->exp_stats_handle->profiler.stop_timer_sync("exp_stats_1");
   }
@@ -358,8 +410,8 @@ void launch_compute_mode_set_kernel(cuMpSGEMM_handle *handle, const unsigned m,
           handle->exp_stats_handle->dev_underflow_count_buffer + buffer_id,
           handle->exp_stats_handle->dev_max_abs_buffer + buffer_id,
           handle->exp_stats_handle->underflow_threshold / 2,
-          handle->exp_stats_handle->ignore_threshold / 2, m, n, ptr, ld,
-          batch_size, stride);
+          handle->exp_stats_handle->ignore_threshold / 2, m, n, batch, ld,
+          num_batches);
   if (handle->exp_stats_handle->profiling_enabled) {
     handle->exp_stats_handle->profiler.stop_timer_sync("exp_stats_2");
   }
@@ -383,13 +435,16 @@ __global__ void init_exp_max(float *const max_exp_buffer) {
   *max_exp_buffer = 0;
 }
 
-template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T>
+template <unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T, class T,
+          class BATCH_T>
 __global__ void exp_max_kernel(float *const max_exp_buffer, const unsigned m,
-                               const unsigned n, const T *const ptr,
-                               const unsigned ld, const unsigned batch_size,
-                               const unsigned stride) {
-  const auto ib = blockIdx.y;
-  const auto local_mat_ptr = ptr + ib * stride;
+                               const unsigned n, const BATCH_T batch,
+                               const unsigned ld, const unsigned num_batches) {
+  const auto ib = cumpsgemm::device::get_batch_id();
+  if (ib >= num_batches) {
+    return;
+  }
+  const auto local_mat_ptr = batch(ib);
 
   float local_max_abs_value = 0;
 
@@ -458,16 +513,17 @@ __global__ void exp_max_kernel(float *const max_exp_buffer, const unsigned m,
   }
 }
 
-template <class T, unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T>
+template <class T, unsigned BLOCK_SIZE, unsigned VEC_LEN, class LOOP_T,
+          class BATCH_T>
 void launch_max_exp_kernel(cuMpSGEMM_handle *handle, const unsigned m,
-                           const unsigned n, const T *const ptr,
-                           const unsigned ld, const unsigned batch_size,
-                           const unsigned stride, const unsigned buffer_id) {
-  const dim3 grid_size(
+                           const unsigned n, const BATCH_T batch,
+                           const unsigned ld, const unsigned num_batches,
+                           const unsigned buffer_id) {
+  const auto grid_size = cumpsgemm::get_batch_grid_size(
       std::min<std::uint64_t>(
           ((1lu * m * n + BLOCK_SIZE - 1) / BLOCK_SIZE + VEC_LEN - 1) / VEC_LEN,
           handle->num_sms * 4),
-      (stride == 0) ? 1 : batch_size);
+      num_batches);
 
   // 0
   if (handle->exp_stats_handle->profiling_enabled) {
@@ -485,13 +541,37 @@ void launch_max_exp_kernel(cuMpSGEMM_handle *handle, const unsigned m,
   }
   exp_max_kernel<BLOCK_SIZE, VEC_LEN, LOOP_T, T>
       <<<grid_size, BLOCK_SIZE, 0, handle->cuda_stream>>>(
-          handle->exp_stats_handle->dev_max_abs_buffer + buffer_id, m, n, ptr,
-          ld, batch_size, stride);
+          handle->exp_stats_handle->dev_max_abs_buffer + buffer_id, m, n, batch,
+          ld, num_batches);
   if (handle->exp_stats_handle->profiling_enabled) {
     handle->exp_stats_handle->profiler.stop_timer_sync("exp_max");
   }
 }
 
+template <class T, class BATCH_T>
+void exp_stats_ext_core(cuMpSGEMM_handle *handle, const unsigned m,
+                        const unsigned n, const BATCH_T batch,
+                        const unsigned ld, const unsigned num_batches) {
+  const auto buffer_id =
+      cumpsgemm::exp_stats::get_next_exp_stats_buffer_id(handle);
+  using launch_func_t =
+      void (*)(cuMpSGEMM_handle *, const unsigned, const unsigned,
+               const BATCH_T, const unsigned, const unsigned, const unsigned);
+  launch_func_t launch_func;
+  if (static_cast<std::size_t>(m) * n < (1lu << 15)) {
+    launch_func = launch_compute_mode_set_kernel<T, 64, 4, unsigned, BATCH_T>;
+  } else if (static_cast<std::size_t>(m) * n < (1lu << 22)) {
+    launch_func = launch_compute_mode_set_kernel<T, 128, 4, unsigned, BATCH_T>;
+  } else if (static_cast<std::size_t>(m) * n < (1lu << 32)) {
+    launch_func = launch_compute_mode_set_kernel<T, 1024, 4, unsigned, BATCH_T>;
+  } else {
+    launch_func =
+        launch_compute_mode_set_kernel<T, 1024, 4, std::size_t, BATCH_T>;
+  }
+
+  launch_func(handle, m, n, batch, ld, num_batches, buffer_id);
+}
+
 // For init
 __global__ void configure_buffer_kernel(int *const compute_mode_buffer) {
   compute_mode_buffer[0] = CUMPSGEMM_TF32TCEC;
@@ -505,23 +585,8 @@ void cumpsgemm::exp_stats::exp_stats_ext(cuMpSGEMM_handle *handle,
                                          const T *const ptr, const unsigned ld,
                                          const unsigned batch_size,
                                          const unsigned stride) {
-  const auto buffer_id =
-      cumpsgemm::exp_stats::get_next_exp_stats_buffer_id(handle);
-  using launch_func_t = void (*)(
-      cuMpSGEMM_handle *, const unsigned, const unsigned, const T *const,
-      const unsigned, const unsigned, const unsigned, const unsigned);
-  launch_func_t launch_func;
-  if (static_cast<std::size_t>(m) * n < (1lu << 15)) {
-    launch_func = launch_compute_mode_set_kernel<T, 64, 4, unsigned>;
-  } else if (static_cast<std::size_t>(m) * n < (1lu << 22)) {
-    launch_func = launch_compute_mode_set_kernel<T, 128, 4, unsigned>;
-  } else if (static_cast<std::size_t>(m) * n < (1lu << 32)) {
-    launch_func = launch_compute_mode_set_kernel<T, 1024, 4, unsigned>;
-  } else {
-    launch_func = launch_compute_mode_set_kernel<T, 1024, 4, std::size_t>;
-  }
-
-  launch_func(handle, m, n, ptr, ld, batch_size, stride, buffer_id);
+  exp_stats_ext_core<T>(handle, m, n, strided_batch_t<T>{ptr, stride}, ld,
+                        (stride == 0) ? 1 : batch_size);
 }
 
 template void cumpsgemm::exp_stats::exp_stats_ext<float>(
@@ -531,6 +596,23 @@ template void cumpsgemm::exp_stats::exp_stats_ext<cuComplex>(
     cuMpSGEMM_handle *, const unsigned, const unsigned, const cuComplex *const,
     const unsigned, const unsigned, const unsigned);
 
+template <class T>
+void cumpsgemm::exp_stats::exp_stats_ext(cuMpSGEMM_handle *handle,
+                                         const unsigned m, const unsigned n,
+                                         const T *const *const ptr_list,
+                                         const unsigned ld,
+                                         const unsigned batch_size) {
+  exp_stats_ext_core<T>(handle, m, n, ptr_list_batch_t<T>{ptr_list}, ld,
+                        batch_size);
+}
+
+template void cumpsgemm::exp_stats::exp_stats_ext<float>(
+    cuMpSGEMM_handle *, const unsigned, const unsigned,
+    const float *const *const, const unsigned, const unsigned);
+template void cumpsgemm::exp_stats::exp_stats_ext<cuComplex>(
+    cuMpSGEMM_handle *, const unsigned, const unsigned,
+    const cuComplex *const *const, const unsigned, const unsigned);
+
 template <class T>
 void cumpsgemm::exp_stats::exp_max_ext(cuMpSGEMM_handle *handle,
                                        const unsigned m, const unsigned n,
@@ -539,21 +621,23 @@ void cumpsgemm::exp_stats::exp_max_ext(cuMpSGEMM_handle *handle,
                                        const unsigned stride) {
   const auto buffer_id =
       cumpsgemm::exp_stats::get_next_exp_stats_buffer_id(handle);
-  using launch_func_t = void (*)(
-      cuMpSGEMM_handle *, const unsigned, const unsigned, const T *const,
-      const unsigned, const unsigned, const unsigned, const unsigned);
+  using batch_t = strided_batch_t<T>;
+  using launch_func_t =
+      void (*)(cuMpSGEMM_handle *, const unsigned, const unsigned,
+               const batch_t, const unsigned, const unsigned, const unsigned);
   launch_func_t launch_func;
   if (static_cast<std::size_t>(m) * n < (1lu << 15)) {
-    launch_func = launch_max_exp_kernel<T, 64, 4, unsigned>;
+    launch_func = launch_max_exp_kernel<T, 64, 4, unsigned, batch_t>;
   } else if (static_cast<std::size_t>(m) * n < (1lu << 22)) {
-    launch_func = launch_max_exp_kernel<T, 128, 4, unsigned>;
+    launch_func = launch_max_exp_kernel<T, 128, 4, unsigned, batch_t>;
   } else if (static_cast<std::size_t>(m) * n < (1lu << 32)) {
-    launch_func = launch_max_exp_kernel<T, 1024, 4, unsigned>;
+    launch_func = launch_max_exp_kernel<T, 1024, 4, unsigned, batch_t>;
   } else {
-    launch_func = launch_max_exp_kernel<T, 1024, 4, std::size_t>;
+    launch_func = launch_max_exp_kernel<T, 1024, 4, std::size_t, batch_t>;
   }
 
-  launch_func(handle, m, n, ptr, ld, batch_size, stride, buffer_id);
+  launch_func(handle, m, n, batch_t{ptr, stride}, ld,
+              (stride == 0) ? 1 : batch_size, buffer_id);
 }
 
 template void cumpsgemm::exp_stats::exp_max_ext<float>(
@@ -572,7 +656,13 @@ void init_exp_stats_counter_buffer(cuMpSGEMM_handle *handle) {
   cumpsgemm::exp_stats::reset_exp_stats_buffer_id(handle);
 
   handle->exp_stats_handle->enabled = false;
-  handle->exp_stats_handle->buffer_length = 10000;
+  handle->exp_stats_handle->ring_buffer_length = 10000;
+  handle->exp_stats_handle->buffer_length =
+      handle->exp_stats_handle->ring_buffer_length + num_graph_slots;
+  handle->exp_stats_handle->graph_slots =
+      std::make_shared<cumpsgemm::graph_slot_pool_t>(
+          handle->exp_stats_handle->ring_buffer_length,
+          handle->exp_stats_handle->buffer_length);
   handle->exp_stats_handle->ignore_threshold = 0;
   handle->exp_stats_handle->underflow_threshold = 1.f / (1u << 15);
   handle->exp_stats_handle->underflow_tolerance_rate = 0;
@@ -653,7 +743,11 @@ void cumpsgemm::exp_stats::resize_counter(cuMpSGEMM_handle_t handle,
   CUTF_CHECK_ERROR(cudaFree(handle->exp_stats_handle->dev_max_abs_buffer));
   CUTF_CHECK_ERROR(cudaFree(handle->exp_stats_handle->dev_compute_mode_buffer));
 
-  handle->exp_stats_handle->buffer_length = new_length;
+  handle->exp_stats_handle->ring_buffer_length = new_length;
+  handle->exp_stats_handle->buffer_length = new_length + num_graph_slots;
+  handle->exp_stats_handle->graph_slots =
+      std::make_shared<cumpsgemm::graph_slot_pool_t>(
+          new_length, handle->exp_stats_handle->buffer_length);
 
   CUTF_CHECK_ERROR(cudaMalloc(
       &(handle->exp_stats_handle->dev_total_count_buffer),
@@ -1,6 +1,8 @@
 #pragma once
+#include "graph_slot_pool.hpp"
 #include "handle.hpp"
 #include <cutf/debug/time_breakdown.hpp>
+#include <memory>
 
 namespace cumpsgemm {
 namespace exp_stats {
@@ -19,8 +21,13 @@ struct exp_stats_handle {
   float underflow_threshold;
   float underflow_tolerance_rate;
 
+  // [2, ring_buffer_length) is used as a ring buffer and
+  // [ring_buffer_length, buffer_length) is used in CUDA Graph capture
   std::uint32_t buffer_length;
+  std::uint32_t ring_buffer_length;
   std::uint32_t current_buffer_id;
+  // Shared with the graphs, which give their slots back when destroyed
+  std::shared_ptr<cumpsgemm::graph_slot_pool_t> graph_slots;
   bool counter_init_disabled;
 
   // For profiling
@@ -32,6 +39,7 @@ void resize_counter(cuMpSGEMM_handle *handle, const std::size_t new_length);
 void init_counter(cuMpSGEMM_handle *handle, const unsigned buffer_id);
 std::uint32_t get_next_exp_stats_buffer_id(cuMpSGEMM_handle *handle);
 std::uint32_t get_current_exp_stats_buffer_id(cuMpSGEMM_handle *handle);
+std::uint32_t get_num_free_graph_slots(cuMpSGEMM_handle *handle);
 void reset_exp_stats_buffer_id(cuMpSGEMM_handle *handle);
 void download_exp_stats(cuMpSGEMM_handle *handle, const unsigned buffer_id);
 std::pair<std::size_t, std::size_t> get_exp_stats(cuMpSGEMM_handle *handle,
@@ -40,6 +48,11 @@ template <class T>
 void exp_stats_ext(cuMpSGEMM_handle *handle, const unsigned m, const unsigned n,
                    const T *const ptr, const unsigned ld,
                    const unsigned batch_size, const unsigned stride);
+// For the pointer-array batched GEMM
+template <class T>
+void exp_stats_ext(cuMpSGEMM_handle *handle, const unsigned m, const unsigned n,
+                   const T *const *const ptr_list, const unsigned ld,
+                   const unsigned batch_size);
 template <class T>
 void exp_max_ext(cuMpSGEMM_handle *handle, const unsigned m, const unsigned n,
                  const T *const ptr, const unsigned ld,
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace cumpsgemm {
+// The buffer slots [begin, end) reserved for CUDA Graph capture.
+// A slot taken in a capture is given back when the graph and all of its
+// instances are destroyed, so that capturing and destroying graphs repeatedly
+// does not use the slots up. `release` is called from a CUDA internal thread.
+class graph_slot_pool_t {
+  std::mutex mutex;
+  std::uint32_t next_id;
+  const std::uint32_t end_id;
+  std::vector<std::uint32_t> free_ids;
+
+public:
+  graph_slot_pool_t(const std::uint32_t begin, const std::uint32_t end)
+      : next_id(begin), end_id(end) {}
+  graph_slot_pool_t(const graph_slot_pool_t &) = delete;
+
+  // Returns false if all slots are in use
+  bool acquire(std::uint32_t &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!free_ids.empty()) {
+      id = free_ids.back();
+      free_ids.pop_back();
+      return true;
+    }
+    if (next_id == end_id) {
+      return false;
+    }
+    id = next_id++;
+    return true;
+  }
+
+  void release(const std::uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_ids.push_back(id);
+  }
+
+  std::uint32_t get_num_free() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return end_id - next_id + free_ids.size();
+  }
+};
+} // namespace cumpsgemm
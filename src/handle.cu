@@ -1,13 +1,16 @@
 #include "handle.hpp"
+#include "tuning_cache.hpp"
 #include <cstddef>
 #include <cumpsgemm/cumpsgemm.h>
 #include <cutf/device.hpp>
+#include <vector>
 
-extern "C" {
-cublasStatus_t cuMpSGEMM_create(cuMpSGEMM_handle_t *const handle) {
+cublasStatus_t cumpsgemm::create_handle(cuMpSGEMM_handle_t *const handle,
+                                        const cudaStream_t cuda_stream) {
   if ((*handle = new cuMpSGEMM_handle) == nullptr) {
     return CUBLAS_STATUS_INTERNAL_ERROR;
   }
+  (*handle)->cuda_stream = cuda_stream;
 
   int num_sms;
   CUTF_CHECK_ERROR(
@@ -23,13 +26,42 @@ cublasStatus_t cuMpSGEMM_create(cuMpSGEMM_handle_t *const handle) {
   if (cc_major == 8 && cc_minor == 0) {
     cumpsgemm::configure_instance_sm80((*handle)->gemm_module,
                                        (*handle)->gemm_stridedBatch_module,
+                                       (*handle)->gemm_batchPtr_module,
                                        (*handle)->gemm_atomic_module);
   } else {
     cumpsgemm::configure_instance_sm86((*handle)->gemm_module,
                                        (*handle)->gemm_stridedBatch_module,
+                                       (*handle)->gemm_batchPtr_module,
                                        (*handle)->gemm_atomic_module);
   }
 
+  for (unsigned code = 0; code < cumpsgemm::kernel_module_code::max_code;
+       code++) {
+    (*handle)->gemm_module[code].build();
+    (*handle)->gemm_stridedBatch_module[code].build();
+    (*handle)->gemm_batchPtr_module[code].build();
+  }
+
+  if (cumpsgemm::tuning_cache::get() != nullptr) {
+    cudaDeviceProp prop;
+    CUTF_CHECK_ERROR(cudaGetDeviceProperties(&prop, 0));
+    int driver_version;
+    CUTF_CHECK_ERROR(cudaDriverGetVersion(&driver_version));
+    std::vector<cumpsgemm::tuning_cache::module_table_t> table_list;
+    for (unsigned code = 0; code < cumpsgemm::kernel_module_code::max_code;
+         code++) {
+      for (const auto registry : {&(*handle)->gemm_module[code],
+                                  &(*handle)->gemm_stridedBatch_module[code]}) {
+        table_list.push_back({registry->data(), registry->size()});
+      }
+    }
+    table_list.push_back({(*handle)->gemm_atomic_module,
+                          cumpsgemm::kernel_module_code::max_code});
+    (*handle)->tuning_identity = cumpsgemm::tuning_cache::get_identity(
+        prop.name, driver_version,
+        cumpsgemm::tuning_cache::get_build_fingerprint(table_list));
+  }
+
   init_exp_stats_counter_buffer((*handle));
   init_dynamic_launch_flag_buffer((*handle));
   init_temp_working_memory((*handle));
@@ -37,9 +69,58 @@ cublasStatus_t cuMpSGEMM_create(cuMpSGEMM_handle_t *const handle) {
   return CUBLAS_STATUS_SUCCESS;
 }
 
+bool cumpsgemm::call_on_graph_destroy(const cudaStream_t cuda_stream,
+                                      const std::function<void()> func) {
+#if CUDART_VERSION >= 11030
+  cudaStreamCaptureStatus status;
+  cudaGraph_t graph;
+#if CUDART_VERSION >= 12000
+  const auto result =
+      cudaStreamGetCaptureInfo(cuda_stream, &status, nullptr, &graph);
+#else
+  const auto result =
+      cudaStreamGetCaptureInfo_v2(cuda_stream, &status, nullptr, &graph);
+#endif
+  if (result != cudaSuccess || status != cudaStreamCaptureStatusActive) {
+    return false;
+  }
+
+  const auto data = new std::function<void()>(func);
+  const auto destroy = [](void *const ptr) {
+    const auto f = static_cast<std::function<void()> *>(ptr);
+    (*f)();
+    delete f;
+  };
+  cudaUserObject_t object;
+  if (cudaUserObjectCreate(&object, data, destroy, 1,
+                           cudaUserObjectNoDestructorSync) != cudaSuccess) {
+    delete data;
+    return false;
+  }
+  // The reference is moved to the graph
+  if (cudaGraphRetainUserObject(graph, object, 1, cudaGraphUserObjectMove) !=
+      cudaSuccess) {
+    // Not released, since func must not be called while the graph may use
+    // what it gives back
+    return false;
+  }
+  return true;
+#else
+  (void)cuda_stream;
+  (void)func;
+  return false;
+#endif
+}
+
+extern "C" {
+cublasStatus_t cuMpSGEMM_create(cuMpSGEMM_handle_t *const handle) {
+  return cumpsgemm::create_handle(handle, 0);
+}
+
 cublasStatus_t cuMpSGEMM_destroy(cuMpSGEMM_handle_t handle) {
   destroy_exp_stats_counter_buffer(handle);
   destroy_launch_flag_buffer(handle);
+  destroy_temp_working_memory(handle);
 
   delete handle;
   return CUBLAS_STATUS_SUCCESS;
@@ -50,4 +131,22 @@ cublasStatus_t cuMpSGEMM_set_stream(cuMpSGEMM_handle_t handle,
   handle->cuda_stream = cuda_stream;
   return CUBLAS_STATUS_SUCCESS;
 }
+
+cublasStatus_t
+cuMpSGEMM_set_pointer_mode(cuMpSGEMM_handle_t handle,
+                           const cublasPointerMode_t pointer_mode) {
+  if (pointer_mode != CUBLAS_POINTER_MODE_HOST &&
+      pointer_mode != CUBLAS_POINTER_MODE_DEVICE) {
+    return CUBLAS_STATUS_INVALID_VALUE;
+  }
+  handle->pointer_mode = pointer_mode;
+  return CUBLAS_STATUS_SUCCESS;
+}
+
+cublasStatus_t
+cuMpSGEMM_get_pointer_mode(cuMpSGEMM_handle_t handle,
+                           cublasPointerMode_t *const pointer_mode) {
+  *pointer_mode = handle->pointer_mode;
+  return CUBLAS_STATUS_SUCCESS;
+}
 } // extern "C"
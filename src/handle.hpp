@@ -1,23 +1,29 @@
 #pragma once
 #include "instance.hpp"
+#include "kernel_registry.hpp"
 #include <cstdint>
 #include <cuComplex.h>
+#include <functional>
 #include <utility>
 
 struct cuMpSGEMM_handle {
   unsigned num_sms;
 
-  cumpsgemm::gemm_module gemm_module[cumpsgemm::kernel_module_code::max_code]
-                                    [cumpsgemm::num_kernel_candidates];
-  cumpsgemm::gemm_module
-      gemm_stridedBatch_module[cumpsgemm::kernel_module_code::max_code]
-                              [cumpsgemm::num_kernel_candidates];
+  cumpsgemm::kernel_registry::registry_t
+      gemm_module[cumpsgemm::kernel_module_code::max_code];
+  cumpsgemm::kernel_registry::registry_t
+      gemm_stridedBatch_module[cumpsgemm::kernel_module_code::max_code];
+  cumpsgemm::kernel_registry::registry_t
+      gemm_batchPtr_module[cumpsgemm::kernel_module_code::max_code];
   cumpsgemm::gemm_module
       gemm_atomic_module[cumpsgemm::kernel_module_code::max_code];
 
   // cuda stream
   cudaStream_t cuda_stream = 0;
 
+  // alpha/beta pointer mode
+  cublasPointerMode_t pointer_mode = CUBLAS_POINTER_MODE_HOST;
+
   // For exp stats
   cumpsgemm::exp_stats::exp_stats_handle *exp_stats_handle;
 
@@ -26,8 +32,46 @@ struct cuMpSGEMM_handle {
 
   float *temp_working_memory;
   std::size_t temp_working_memory_float_count;
+
+  // The arrival counters of the tiles of the split-K and the stream-K, which
+  // are zero between the launches
+  unsigned *split_k_counter;
+  std::size_t split_k_counter_count;
+
+  // The device and the kernels in the keys of the tuning cache
+  std::uint64_t tuning_identity = 0;
+
+  // The kernels are selected only by the shape and the device, so that the
+  // results are bitwise reproducible
+  bool deterministic = false;
+
+  // The group width of the tile order of the kernels
+  unsigned raster_group_width = cumpsgemm::default_raster_group_width;
 };
 
+namespace cumpsgemm {
+// True while the stream of the handle is captured into a CUDA Graph.
+// The captured kernels are replayed many times, so the buffer slots used by
+// them must not be reused and the device memory must not be read back.
+inline bool is_capturing(const cuMpSGEMM_handle *const handle) {
+  cudaStreamCaptureStatus status;
+  return cudaStreamIsCapturing(handle->cuda_stream, &status) == cudaSuccess &&
+         status == cudaStreamCaptureStatusActive;
+}
+
+// Same as cuMpSGEMM_create, but the buffers are initialized on cuda_stream,
+// which is set to the handle
+cublasStatus_t create_handle(cuMpSGEMM_handle_t *const handle,
+                             const cudaStream_t cuda_stream);
+
+// Calls func when the graph being captured on the stream and all of its
+// instances are destroyed. func is called from a CUDA internal thread and must
+// not call CUDA. Returns false, and func is never called, if it cannot be
+// attached to the graph (CUDA 11.3 or later is required).
+bool call_on_graph_destroy(const cudaStream_t cuda_stream,
+                           const std::function<void()> func);
+} // namespace cumpsgemm
+
 void init_exp_stats_counter_buffer(cuMpSGEMM_handle *handle);
 void destroy_exp_stats_counter_buffer(cuMpSGEMM_handle *handle);
 void init_temp_working_memory(cuMpSGEMM_handle *handle);
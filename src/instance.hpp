@@ -14,35 +14,85 @@ template <> struct element_t_conv<float2> {
 // for exp stats
 using counter_t = unsigned long long int;
 
+// alpha and beta.
+// The value is used when dmem_ptr is nullptr (CUBLAS_POINTER_MODE_HOST), and
+// otherwise the kernels read it from the device memory.
+template <class T> struct scalar_t {
+  T value;
+  const T *dmem_ptr;
+};
+
+// The last argument of the kernels except for batchPtr is the group width of
+// the tile order (See `cumpsgemm::set_raster_group_width`)
 template <class T>
 using gemm_kernel_func_t = void (*)(const int *const dynamic_mode,
                                     const std::uint32_t, const std::uint32_t,
-                                    const std::uint32_t, const T,
+                                    const std::uint32_t, const scalar_t<T>,
                                     const T *const, const std::uint32_t,
                                     const T *const, const std::uint32_t,
-                                    const T, T *const, const std::uint32_t);
+                                    const scalar_t<T>, T *const,
+                                    const std::uint32_t, const std::uint32_t);
+
+template <class T>
+using gemm_stridedBatch_kernel_func_t = void (*)(
+    const int *const dynamic_mode, const std::uint32_t, const std::uint32_t,
+    const std::uint32_t, const scalar_t<T>, const T *const, const std::uint32_t,
+    const std::uint64_t, const T *const, const std::uint32_t,
+    const std::uint64_t, const scalar_t<T>, T *const, const std::uint32_t,
+    const std::uint64_t, const std::uint32_t, const std::uint32_t);
+
+template <class T>
+using gemm_batchPtr_kernel_func_t = void (*)(
+    const int *const dynamic_mode, const std::uint32_t, const std::uint32_t,
+    const std::uint32_t, const scalar_t<T>, const T *const *const,
+    const std::uint32_t, const T *const *const, const std::uint32_t,
+    const scalar_t<T>, T *const *const, const std::uint32_t,
+    const std::uint32_t);
 
+// The split-K kernels additionally take the K of a slice, the workspace of the
+// partial tiles and the counters of the tiles
 template <class T>
-using gemm_stridedBatch_kernel_func_t =
-    void (*)(const int *const dynamic_mode, const std::uint32_t,
-             const std::uint32_t, const std::uint32_t, const T, const T *const,
-             const std::uint32_t, const std::uint64_t, const T *const,
-             const std::uint32_t, const std::uint64_t, const T, T *const,
-             const std::uint32_t, const std::uint64_t, const std::uint32_t);
+using gemm_split_k_kernel_func_t = void (*)(
+    const int *const dynamic_mode, const std::uint32_t, const std::uint32_t,
+    const std::uint32_t, const scalar_t<T>, const T *const, const std::uint32_t,
+    const T *const, const std::uint32_t, const scalar_t<T>, T *const,
+    const std::uint32_t, const std::uint32_t, T *const, std::uint32_t *const,
+    const std::uint32_t);
 
+// The stream-K kernels take the k-steps of a block instead of the K of a slice
+template <class T>
+using gemm_stream_k_kernel_func_t = gemm_split_k_kernel_func_t<T>;
+
+// How the blocks of a kernel are mapped to the tiles of C
+enum class gemm_schedule_t : std::uint8_t {
+  // A block per tile
+  data_parallel = 0,
+  // A wave of persistent blocks sharing the k-steps of all the tiles
+  stream_k = 1,
+};
+
+// The modules of the unsupported codes are left zero
 struct gemm_module {
-  void *kernel_func;
+  void *kernel_func = nullptr;
 
-  unsigned smem_m, smem_n, smem_k;
-  unsigned smem_size;
-  unsigned block_size;
-  unsigned num_active_blocks;
-  unsigned k_per_mn;
+  unsigned smem_m = 0, smem_n = 0, smem_k = 0;
+  unsigned smem_size = 0;
+  unsigned block_size = 0;
+  unsigned num_active_blocks = 0;
+  // Only for the split-K modules. The minimum k of a slice.
+  unsigned k_per_mn = 0;
+  gemm_schedule_t schedule = gemm_schedule_t::data_parallel;
 };
 
-// 0 is for large size matmul and (num_kernel_candidates - 1) is for small.
+// The generic stages of a module code. 0 is for large size matmul and
+// (num_kernel_candidates - 1) is for small. The kernel registry may hold more
+// modules specialized for shape regions.
 static constexpr unsigned num_kernel_candidates = 3;
 
+// The tile rows of a group of the tile order by default. The blocks of a wave
+// cover a near-square part of C on the current GPUs.
+static constexpr unsigned default_raster_group_width = 8;
+
 namespace kernel_module_code {
 using code_t = std::uint32_t;
 constexpr code_t op_a_col_major = 0b0'0'00'00'01;
@@ -54,6 +104,7 @@ constexpr code_t op_b_conjugate = 0b0'0'00'11'00;
 constexpr code_t half = 0b0'0'00'00'00;
 constexpr code_t tf32 = 0b0'0'01'00'00;
 constexpr code_t simt = 0b0'0'10'00'00;
+constexpr code_t bf16 = 0b0'0'11'00'00;
 constexpr code_t with_ec = 0b0'0'00'00'00;
 constexpr code_t without_ec = 0b0'1'00'00'00;
 constexpr code_t s = 0b0'0'00'00'00;
@@ -68,51 +119,150 @@ namespace dynamic_launch {
 struct dynamic_launch_handle;
 } // namespace dynamic_launch
 
+namespace kernel_registry {
+class registry_t;
+} // namespace kernel_registry
+
+// The registries are arrays of `kernel_module_code::max_code`
 void configure_instance_sm80(
-    cumpsgemm::gemm_module gemm_module[cumpsgemm::kernel_module_code::max_code]
-                                      [cumpsgemm::num_kernel_candidates],
-    cumpsgemm::gemm_module
-        gemm_stridedBatch_module[cumpsgemm::kernel_module_code::max_code]
-                                [cumpsgemm::num_kernel_candidates],
+    kernel_registry::registry_t *const gemm_module,
+    kernel_registry::registry_t *const gemm_stridedBatch_module,
+    kernel_registry::registry_t *const gemm_batchPtr_module,
     cumpsgemm::gemm_module
         gemm_atomic_module[cumpsgemm::kernel_module_code::max_code]);
 void configure_instance_sm86(
-    cumpsgemm::gemm_module gemm_module[cumpsgemm::kernel_module_code::max_code]
-                                      [cumpsgemm::num_kernel_candidates],
-    cumpsgemm::gemm_module
-        gemm_stridedBatch_module[cumpsgemm::kernel_module_code::max_code]
-                                [cumpsgemm::num_kernel_candidates],
+    kernel_registry::registry_t *const gemm_module,
+    kernel_registry::registry_t *const gemm_stridedBatch_module,
+    kernel_registry::registry_t *const gemm_batchPtr_module,
     cumpsgemm::gemm_module
         gemm_atomic_module[cumpsgemm::kernel_module_code::max_code]);
 } // namespace cumpsgemm
 
-#define SET_GEMM_KERNEL_MODULE(module_list, io_t, tc_t, ec, op_a, op_b,        \
-                               smem_m, smem_n, smem_k, frag_m, frag_n, frag_k, \
-                               block_size, num_unrollings, num_stages,         \
-                               pipelined, gemm_type, stage)                    \
+// The modules of a stage are candidates for all shapes. The `_IN_REGION`
+// variants register the module only for floor(log2(m)) in
+// [min_log_m, max_log_m] and so on, and `stage` may be larger than
+// `num_kernel_candidates`.
+#define SET_GEMM_KERNEL_MODULE(                                                \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage)                                                          \
+  SET_GEMM_KERNEL_MODULE_IN_REGION(                                            \
+      module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m, \
+      frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,       \
+      gemm_type, stage, 0, cumpsgemm::kernel_registry::max_log, 0,             \
+      cumpsgemm::kernel_registry::max_log, 0,                                  \
+      cumpsgemm::kernel_registry::max_log)
+
+#define SET_GEMM_KERNEL_MODULE_IN_REGION(                                      \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage, min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,   \
+    max_log_k)                                                                 \
   module_list[cumpsgemm::kernel_module_code::tc_t |                            \
               cumpsgemm::kernel_module_code::ec |                              \
               cumpsgemm::kernel_module_code::op_a_##op_a |                     \
               cumpsgemm::kernel_module_code::op_b_##op_b |                     \
-              cumpsgemm::kernel_module_code::gemm_type][stage] =               \
-      cumpsgemm::generate_gemm_module<                                         \
-          io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k, block_size,    \
-          num_unrollings, num_stages, cumpsgemm::op_a, cumpsgemm::op_b, tc_t,  \
-          mtk::wmma::tcec::ec, pipelined>();
+              cumpsgemm::kernel_module_code::gemm_type]                        \
+      .set(stage,                                                              \
+           cumpsgemm::generate_gemm_module<                                    \
+               io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k,           \
+               block_size, num_unrollings, num_stages, cumpsgemm::op_a,        \
+               cumpsgemm::op_b, tc_t, mtk::wmma::tcec::ec, pipelined>(),       \
+           cumpsgemm::kernel_registry::region_t{                               \
+               min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,          \
+               max_log_k});
+
+// The stream-K modules share the registry with the data-parallel modules of
+// the code, so their stages must differ
+#define SET_GEMM_STREAM_K_KERNEL_MODULE(                                       \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage)                                                          \
+  SET_GEMM_STREAM_K_KERNEL_MODULE_IN_REGION(                                   \
+      module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m, \
+      frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,       \
+      gemm_type, stage, 0, cumpsgemm::kernel_registry::max_log, 0,             \
+      cumpsgemm::kernel_registry::max_log, 0,                                  \
+      cumpsgemm::kernel_registry::max_log)
+
+#define SET_GEMM_STREAM_K_KERNEL_MODULE_IN_REGION(                             \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage, min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,   \
+    max_log_k)                                                                 \
+  module_list[cumpsgemm::kernel_module_code::tc_t |                            \
+              cumpsgemm::kernel_module_code::ec |                              \
+              cumpsgemm::kernel_module_code::op_a_##op_a |                     \
+              cumpsgemm::kernel_module_code::op_b_##op_b |                     \
+              cumpsgemm::kernel_module_code::gemm_type]                        \
+      .set(stage,                                                              \
+           cumpsgemm::generate_gemm_stream_k_module<                           \
+               io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k,           \
+               block_size, num_unrollings, num_stages, cumpsgemm::op_a,        \
+               cumpsgemm::op_b, tc_t, mtk::wmma::tcec::ec, pipelined>(),       \
+           cumpsgemm::kernel_registry::region_t{                               \
+               min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,          \
+               max_log_k});
 
 #define SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(                                   \
     module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
     frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
     gemm_type, stage)                                                          \
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE_IN_REGION(                               \
+      module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m, \
+      frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,       \
+      gemm_type, stage, 0, cumpsgemm::kernel_registry::max_log, 0,             \
+      cumpsgemm::kernel_registry::max_log, 0,                                  \
+      cumpsgemm::kernel_registry::max_log)
+
+#define SET_GEMM_STRIDEDBATCH_KERNEL_MODULE_IN_REGION(                         \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage, min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,   \
+    max_log_k)                                                                 \
+  module_list[cumpsgemm::kernel_module_code::tc_t |                            \
+              cumpsgemm::kernel_module_code::ec |                              \
+              cumpsgemm::kernel_module_code::op_a_##op_a |                     \
+              cumpsgemm::kernel_module_code::op_b_##op_b |                     \
+              cumpsgemm::kernel_module_code::gemm_type]                        \
+      .set(stage,                                                              \
+           cumpsgemm::generate_gemm_stridedBatch_module<                       \
+               io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k,           \
+               block_size, num_unrollings, num_stages, cumpsgemm::op_a,        \
+               cumpsgemm::op_b, tc_t, mtk::wmma::tcec::ec, pipelined>(),       \
+           cumpsgemm::kernel_registry::region_t{                               \
+               min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,          \
+               max_log_k});
+
+#define SET_GEMM_BATCHPTR_KERNEL_MODULE(                                       \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage)                                                          \
+  SET_GEMM_BATCHPTR_KERNEL_MODULE_IN_REGION(                                   \
+      module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m, \
+      frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,       \
+      gemm_type, stage, 0, cumpsgemm::kernel_registry::max_log, 0,             \
+      cumpsgemm::kernel_registry::max_log, 0,                                  \
+      cumpsgemm::kernel_registry::max_log)
+
+#define SET_GEMM_BATCHPTR_KERNEL_MODULE_IN_REGION(                             \
+    module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, frag_m,   \
+    frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined,         \
+    gemm_type, stage, min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,   \
+    max_log_k)                                                                 \
   module_list[cumpsgemm::kernel_module_code::tc_t |                            \
               cumpsgemm::kernel_module_code::ec |                              \
               cumpsgemm::kernel_module_code::op_a_##op_a |                     \
               cumpsgemm::kernel_module_code::op_b_##op_b |                     \
-              cumpsgemm::kernel_module_code::gemm_type][stage] =               \
-      cumpsgemm::generate_gemm_stridedBatch_module<                            \
-          io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k, block_size,    \
-          num_unrollings, num_stages, cumpsgemm::op_a, cumpsgemm::op_b, tc_t,  \
-          mtk::wmma::tcec::ec, pipelined>();
+              cumpsgemm::kernel_module_code::gemm_type]                        \
+      .set(stage,                                                              \
+           cumpsgemm::generate_gemm_batchPtr_module<                           \
+               io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k,           \
+               block_size, num_unrollings, num_stages, cumpsgemm::op_a,        \
+               cumpsgemm::op_b, tc_t, mtk::wmma::tcec::ec, pipelined>(),       \
+           cumpsgemm::kernel_registry::region_t{                               \
+               min_log_m, max_log_m, min_log_n, max_log_n, min_log_k,          \
+               max_log_k});
 
 #define SET_GEMM_ATOMIC_KERNEL_MODULE(                                         \
     module_list, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, k_per_mn, \
@@ -132,5 +282,9 @@ void configure_instance_sm86(
 #define COMPILE_CGEMM_KERNEL
 #define COMPILE_SGEMM_STRIDEDBATCH_KERNEL
 #define COMPILE_CGEMM_STRIDEDBATCH_KERNEL
+#define COMPILE_SGEMM_BATCHPTR_KERNEL
+#define COMPILE_CGEMM_BATCHPTR_KERNEL
 #define COMPILE_SGEMM_ATOMIC_KERNEL
 #define COMPILE_CGEMM_ATOMIC_KERNEL
+#define COMPILE_SGEMM_STREAM_K_KERNEL
+#define COMPILE_CGEMM_STREAM_K_KERNEL
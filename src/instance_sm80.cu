@@ -1,16 +1,16 @@
+// Generated by tools/autotune/autotune.py from tools/autotune/sm80.json
 #include "cumpsgemm_kernel.cuh"
 #include "handle.hpp"
 #include "instance.hpp"
 
 void cumpsgemm::configure_instance_sm80(
-    cumpsgemm::gemm_module gemm_module[cumpsgemm::kernel_module_code::max_code]
-                                      [cumpsgemm::num_kernel_candidates],
-    cumpsgemm::gemm_module
-        gemm_stridedBatch_module[cumpsgemm::kernel_module_code::max_code]
-                                [cumpsgemm::num_kernel_candidates],
+    cumpsgemm::kernel_registry::registry_t *const gemm_module,
+    cumpsgemm::kernel_registry::registry_t *const gemm_stridedBatch_module,
+    cumpsgemm::kernel_registry::registry_t *const gemm_batchPtr_module,
     cumpsgemm::gemm_module
         gemm_atomic_module[cumpsgemm::kernel_module_code::max_code]) {
   using tf32 = nvcuda::wmma::precision::tf32;
+  using bf16 = __nv_bfloat16;
 #ifdef COMPILE_SGEMM_KERNEL
   SET_GEMM_KERNEL_MODULE(gemm_module, float, half, with_ec, col_major,
                          col_major, 64, 128, 32, 32, 64, 32, 128, 1, 2, false,
@@ -156,6 +156,43 @@ void cumpsgemm::configure_instance_sm80(
   SET_GEMM_KERNEL_MODULE(gemm_module, float, tf32, without_ec, row_major,
                          row_major, 64, 64, 32, 32, 32, 16, 128, 2, 2, false, s,
                          2); // N=   1024, p= 38.56 [TFlop/s]
+  // BF16TCEC (not tuned yet)
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                         col_major, 128, 64, 32, 32, 32, 16, 128, 1, 2, false,
+                         s, 0);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                         col_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         1);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                         col_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         2);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                         row_major, 128, 64, 32, 32, 32, 16, 128, 1, 2, false,
+                         s, 0);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                         row_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         1);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                         row_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         2);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                         col_major, 128, 64, 32, 32, 32, 16, 128, 1, 2, false,
+                         s, 0);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                         col_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         1);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                         col_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         2);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                         row_major, 128, 64, 32, 32, 32, 16, 128, 1, 2, false,
+                         s, 0);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                         row_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         1);
+  SET_GEMM_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                         row_major, 64, 64, 32, 32, 32, 16, 128, 1, 2, false, s,
+                         2);
 #endif
 #ifdef COMPILE_CGEMM_KERNEL
   SET_GEMM_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec, col_major,
@@ -483,7 +520,6 @@ void cumpsgemm::configure_instance_sm80(
                          conjugate, 32, 32, 32, 16, 16, 16, 128, 1, 2, false, c,
                          2); // N=    512, p= 19.53 [TFlop/s]
 #endif
-
 #ifdef COMPILE_SGEMM_STRIDEDBATCH_KERNEL
   SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, half,
                                       with_ec, col_major, col_major, 128, 64,
@@ -677,6 +713,43 @@ void cumpsgemm::configure_instance_sm80(
                                       without_ec, row_major, row_major, 64, 64,
                                       64, 32, 32, 64, 128, 1, 2, false, s,
                                       2); // N=     64, p=  9.17 [TFlop/s]
+  // BF16TCEC (not tuned yet)
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, col_major, col_major, 128, 64,
+                                      32, 32, 32, 16, 128, 1, 2, false, s, 0);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, col_major, col_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 1);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, col_major, col_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 2);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, col_major, row_major, 128, 64,
+                                      32, 32, 32, 16, 128, 1, 2, false, s, 0);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, col_major, row_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 1);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, col_major, row_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 2);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, row_major, col_major, 128, 64,
+                                      32, 32, 32, 16, 128, 1, 2, false, s, 0);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, row_major, col_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 1);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, row_major, col_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 2);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, row_major, row_major, 128, 64,
+                                      32, 32, 32, 16, 128, 1, 2, false, s, 0);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, row_major, row_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 1);
+  SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, float, bf16,
+                                      with_ec, row_major, row_major, 64, 64, 32,
+                                      32, 32, 16, 128, 1, 2, false, s, 2);
 #endif
 #ifdef COMPILE_CGEMM_STRIDEDBATCH_KERNEL
   SET_GEMM_STRIDEDBATCH_KERNEL_MODULE(gemm_stridedBatch_module, cuComplex, half,
@@ -1111,6 +1184,516 @@ void cumpsgemm::configure_instance_sm80(
                                       without_ec, conjugate, conjugate, 64, 32,
                                       32, 16, 16, 16, 256, 1, 2, false, c,
                                       2); // N=     64, p= 17.48 [TFlop/s]
+#endif
+  // The same configurations as the strided batched GEMM
+#ifdef COMPILE_SGEMM_BATCHPTR_KERNEL
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 64, 32,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 64, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  col_major, col_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  col_major, col_major, 128, 64, 32, 64, 32, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  col_major, col_major, 128, 64, 32, 64, 32, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  col_major, col_major, 64, 64, 64, 32, 32, 32,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  col_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 64, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  col_major, col_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  col_major, col_major, 128, 128, 32, 64, 64,
+                                  16, 128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 64, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  col_major, col_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  col_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  col_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  col_major, row_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  col_major, row_major, 128, 64, 32, 32, 64, 16,
+                                  128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  col_major, row_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  col_major, row_major, 64, 64, 64, 32, 32, 32,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  col_major, row_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  col_major, row_major, 128, 128, 32, 64, 64,
+                                  16, 128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  col_major, row_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  col_major, row_major, 128, 128, 32, 64, 64,
+                                  32, 128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  col_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  col_major, row_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  row_major, col_major, 128, 64, 32, 64, 32, 32,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  row_major, col_major, 128, 64, 32, 64, 32, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  row_major, col_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  row_major, col_major, 64, 64, 64, 32, 32, 32,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  row_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 32, 32,
+                                  256, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  row_major, col_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  row_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  row_major, col_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  row_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  row_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, with_ec,
+                                  row_major, row_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  row_major, row_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  row_major, row_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, with_ec,
+                                  row_major, row_major, 64, 64, 64, 32, 32, 32,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  row_major, row_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  row_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 2, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, half, without_ec,
+                                  row_major, row_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  row_major, row_major, 128, 128, 32, 64, 64,
+                                  16, 128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  row_major, row_major, 128, 64, 32, 32, 64, 32,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, tf32, without_ec,
+                                  row_major, row_major, 64, 64, 64, 32, 32, 64,
+                                  128, 1, 2, false, s, 2);
+  // BF16TCEC (not tuned yet)
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  col_major, col_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  col_major, col_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  col_major, row_major, 128, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  col_major, row_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  col_major, row_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  row_major, col_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  row_major, col_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  row_major, row_major, 128, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  row_major, row_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, float, bf16, with_ec,
+                                  row_major, row_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, s, 2);
+#endif
+#ifdef COMPILE_CGEMM_BATCHPTR_KERNEL
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, col_major, 64, 64, 32, 16,
+                                  64, 32, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, col_major, 64, 64, 32, 16,
+                                  64, 32, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, col_major, 64, 32, 32, 16,
+                                  32, 32, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, col_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, col_major, 64, 32, 32, 16,
+                                  32, 32, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, col_major, 64, 32, 32, 16,
+                                  32, 16, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, col_major, 128, 64, 32,
+                                  32, 64, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, col_major, 128, 64, 32,
+                                  32, 64, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, col_major, 64, 64, 64,
+                                  16, 64, 32, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, col_major, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, col_major, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, col_major, 64, 64, 64,
+                                  32, 16, 32, 256, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, row_major, 64, 64, 64, 32,
+                                  32, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, row_major, 64, 32, 32, 16,
+                                  32, 32, 128, 2, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, row_major, 64, 32, 32, 16,
+                                  32, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, row_major, 128, 64, 32,
+                                  32, 64, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, row_major, 128, 64, 32,
+                                  32, 64, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, row_major, 64, 64, 64,
+                                  32, 32, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, row_major, 64, 64, 32,
+                                  32, 32, 32, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, row_major, 64, 64, 32,
+                                  32, 32, 32, 128, 2, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, row_major, 64, 64, 64,
+                                  32, 16, 32, 256, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, col_major, conjugate, 64, 32, 32, 32,
+                                  16, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, conjugate, 64, 32, 32, 16,
+                                  32, 32, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, conjugate, 64, 32, 32, 16,
+                                  32, 32, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, col_major, conjugate, 64, 64, 64, 16,
+                                  32, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, conjugate, 128, 128,
+                                  32, 32, 64, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, conjugate, 128, 128,
+                                  32, 32, 64, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, col_major, conjugate, 64, 64, 64,
+                                  32, 32, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, conjugate, 64, 64, 32,
+                                  32, 32, 32, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, conjugate, 64, 64, 32,
+                                  32, 16, 16, 256, 2, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, col_major, conjugate, 64, 64, 64,
+                                  32, 16, 32, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, col_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, col_major, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, col_major, 64, 32, 32, 32,
+                                  16, 32, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, col_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, col_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, col_major, 64, 64, 64, 16,
+                                  32, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, col_major, 128, 64, 32,
+                                  64, 32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, col_major, 128, 64, 32,
+                                  32, 64, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, col_major, 64, 64, 64,
+                                  64, 16, 32, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, col_major, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, col_major, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, col_major, 64, 32, 32,
+                                  32, 16, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, row_major, 64, 64, 64, 32,
+                                  32, 16, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, row_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, row_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, row_major, 64, 32, 32, 16,
+                                  32, 16, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, row_major, 128, 64, 32,
+                                  64, 32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, row_major, 128, 64, 32,
+                                  64, 32, 32, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, row_major, 64, 64, 64,
+                                  64, 16, 32, 128, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, row_major, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, row_major, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, row_major, 64, 32, 32,
+                                  32, 16, 16, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, conjugate, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, row_major, conjugate, 64, 32, 32, 32,
+                                  16, 32, 128, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, conjugate, 64, 32, 32, 16,
+                                  32, 32, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, row_major, conjugate, 64, 64, 64, 16,
+                                  32, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, conjugate, 128, 128,
+                                  32, 64, 32, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, conjugate, 128, 64, 32,
+                                  64, 16, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, row_major, conjugate, 64, 64, 64,
+                                  32, 16, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, conjugate, 64, 64, 32,
+                                  32, 32, 32, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, conjugate, 128, 64, 32,
+                                  32, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, row_major, conjugate, 64, 64, 64,
+                                  32, 16, 64, 256, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, col_major, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, col_major, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, col_major, 64, 64, 64, 32,
+                                  16, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, col_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, col_major, 64, 64, 32, 16,
+                                  64, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, col_major, 64, 64, 64, 16,
+                                  32, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, col_major, 128, 128,
+                                  32, 64, 32, 16, 256, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, col_major, 128, 128,
+                                  32, 64, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, col_major, 64, 64, 64,
+                                  32, 16, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, col_major, 64, 64, 32,
+                                  32, 32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, col_major, 64, 64, 32,
+                                  32, 32, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, col_major, 64, 64, 64,
+                                  32, 16, 64, 256, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, row_major, 64, 64, 64, 16,
+                                  32, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, row_major, 64, 64, 32, 32,
+                                  32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, row_major, 32, 32, 32, 16,
+                                  16, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, row_major, 64, 64, 64, 16,
+                                  32, 16, 256, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, row_major, 128, 128,
+                                  32, 64, 32, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, row_major, 128, 128,
+                                  32, 64, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, row_major, 64, 64, 64,
+                                  32, 16, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, row_major, 64, 64, 32,
+                                  32, 32, 32, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, row_major, 64, 64, 32,
+                                  32, 32, 32, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, row_major, 64, 64, 64,
+                                  32, 16, 64, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  with_ec, conjugate, conjugate, 64, 64, 64, 32,
+                                  16, 32, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, conjugate, 64, 64, 32, 32,
+                                  32, 16, 128, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, conjugate, 32, 32, 32, 16,
+                                  16, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  with_ec, conjugate, conjugate, 64, 64, 64, 16,
+                                  32, 16, 256, 1, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, conjugate, 128, 128,
+                                  32, 64, 32, 16, 256, 1, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, conjugate, 128, 128,
+                                  32, 64, 32, 16, 256, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, half,
+                                  without_ec, conjugate, conjugate, 64, 64, 64,
+                                  32, 16, 16, 256, 2, 2, false, c, 2);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, conjugate, 64, 64, 32,
+                                  32, 32, 16, 128, 2, 2, false, c, 0);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, conjugate, 32, 32, 32,
+                                  16, 16, 16, 128, 1, 2, false, c, 1);
+  SET_GEMM_BATCHPTR_KERNEL_MODULE(gemm_batchPtr_module, cuComplex, tf32,
+                                  without_ec, conjugate, conjugate, 64, 32, 32,
+                                  16, 16, 16, 256, 1, 2, false, c, 2);
 #endif
 #ifdef COMPILE_SGEMM_ATOMIC_KERNEL
   SET_GEMM_ATOMIC_KERNEL_MODULE(
@@ -1177,6 +1760,19 @@ void cumpsgemm::configure_instance_sm80(
       gemm_atomic_module, float, tf32, without_ec, row_major, row_major, 64, 64,
       32, 64, 32, 32, 32, 128, 1, 2, false,
       s); // Not optimized but works on any Ampere GPUs
+  // BF16TCEC (not tuned yet)
+  SET_GEMM_ATOMIC_KERNEL_MODULE(gemm_atomic_module, float, bf16, with_ec,
+                                col_major, col_major, 64, 64, 32, 64, 32, 32,
+                                16, 128, 1, 2, false, s);
+  SET_GEMM_ATOMIC_KERNEL_MODULE(gemm_atomic_module, float, bf16, with_ec,
+                                col_major, row_major, 64, 64, 32, 64, 32, 32,
+                                16, 128, 1, 2, false, s);
+  SET_GEMM_ATOMIC_KERNEL_MODULE(gemm_atomic_module, float, bf16, with_ec,
+                                row_major, col_major, 64, 64, 32, 64, 32, 32,
+                                16, 128, 1, 2, false, s);
+  SET_GEMM_ATOMIC_KERNEL_MODULE(gemm_atomic_module, float, bf16, with_ec,
+                                row_major, row_major, 64, 64, 32, 64, 32, 32,
+                                16, 128, 1, 2, false, s);
 #endif
 #ifdef COMPILE_CGEMM_ATOMIC_KERNEL
   SET_GEMM_ATOMIC_KERNEL_MODULE(
@@ -1323,5 +1919,178 @@ void cumpsgemm::configure_instance_sm80(
       gemm_atomic_module, cuComplex, tf32, without_ec, conjugate, conjugate, 64,
       64, 32, 64, 32, 32, 32, 128, 1, 2, false,
       c); // Not optimized but works on any Ampere GPUs
+#endif
+  // Not tuned yet. The configurations of the GEMM stage 1
+#ifdef COMPILE_SGEMM_STREAM_K_KERNEL
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, with_ec, col_major,
+                                  col_major, 64, 128, 32, 32, 64, 32, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, with_ec, col_major,
+                                  col_major, 64, 128, 32, 64, 32, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, without_ec,
+                                  col_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 1, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, without_ec,
+                                  col_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, with_ec, col_major,
+                                  row_major, 128, 64, 32, 64, 32, 32, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, with_ec, col_major,
+                                  row_major, 64, 128, 32, 32, 64, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, without_ec,
+                                  col_major, row_major, 128, 128, 32, 64, 64,
+                                  32, 128, 1, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, without_ec,
+                                  col_major, row_major, 128, 64, 32, 64, 32, 32,
+                                  128, 2, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, with_ec, row_major,
+                                  col_major, 64, 128, 32, 32, 64, 32, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, with_ec, row_major,
+                                  col_major, 64, 128, 32, 64, 32, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, without_ec,
+                                  row_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 1, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, without_ec,
+                                  row_major, col_major, 128, 128, 32, 64, 64,
+                                  32, 128, 2, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, with_ec, row_major,
+                                  row_major, 64, 128, 32, 64, 32, 32, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, with_ec, row_major,
+                                  row_major, 64, 128, 32, 32, 64, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, half, without_ec,
+                                  row_major, row_major, 128, 128, 32, 64, 64,
+                                  32, 128, 1, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, tf32, without_ec,
+                                  row_major, row_major, 64, 128, 32, 32, 64, 32,
+                                  128, 2, 2, false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                                  col_major, 64, 64, 32, 32, 32, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, bf16, with_ec, col_major,
+                                  row_major, 64, 64, 32, 32, 32, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                                  col_major, 64, 64, 32, 32, 32, 16, 128, 1, 2,
+                                  false, s, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, float, bf16, with_ec, row_major,
+                                  row_major, 64, 64, 32, 32, 32, 16, 128, 1, 2,
+                                  false, s, 3);
+#endif
+#ifdef COMPILE_CGEMM_STREAM_K_KERNEL
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  col_major, col_major, 64, 128, 32, 16, 64, 16,
+                                  256, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  col_major, col_major, 64, 64, 32, 16, 64, 16,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  col_major, col_major, 128, 64, 32, 32, 32, 16,
+                                  256, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  col_major, row_major, 64, 64, 32, 16, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  col_major, row_major, 64, 64, 32, 16, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  col_major, row_major, 64, 128, 32, 32, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  col_major, row_major, 128, 64, 32, 32, 32, 16,
+                                  256, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  col_major, conjugate, 64, 64, 32, 32, 32, 16,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  col_major, conjugate, 64, 32, 32, 16, 32, 32,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  col_major, conjugate, 128, 64, 32, 32, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  col_major, conjugate, 64, 64, 32, 32, 32, 32,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 32, 16,
+                                  256, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  row_major, col_major, 64, 64, 32, 16, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  row_major, col_major, 128, 64, 32, 64, 32, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  row_major, col_major, 128, 64, 32, 32, 32, 16,
+                                  256, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  row_major, row_major, 64, 128, 32, 32, 32, 16,
+                                  256, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  row_major, row_major, 64, 64, 32, 16, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  row_major, row_major, 64, 128, 32, 64, 32, 16,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  row_major, row_major, 64, 128, 32, 32, 32, 16,
+                                  256, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  row_major, conjugate, 64, 64, 32, 64, 16, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  row_major, conjugate, 64, 32, 32, 16, 32, 32,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  row_major, conjugate, 128, 64, 32, 64, 16, 16,
+                                  256, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  row_major, conjugate, 64, 64, 32, 32, 32, 32,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  conjugate, col_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  conjugate, col_major, 64, 64, 32, 16, 64, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  conjugate, col_major, 64, 128, 32, 32, 32, 16,
+                                  256, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  conjugate, col_major, 64, 64, 32, 32, 32, 32,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  conjugate, row_major, 64, 64, 32, 64, 16, 16,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  conjugate, row_major, 64, 64, 32, 16, 64, 16,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  conjugate, row_major, 64, 64, 32, 64, 16, 16,
+                                  128, 2, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  conjugate, row_major, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, with_ec,
+                                  conjugate, conjugate, 64, 64, 32, 64, 16, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, with_ec,
+                                  conjugate, conjugate, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, half, without_ec,
+                                  conjugate, conjugate, 64, 64, 32, 64, 16, 32,
+                                  128, 1, 2, false, c, 3);
+  SET_GEMM_STREAM_K_KERNEL_MODULE(gemm_module, cuComplex, tf32, without_ec,
+                                  conjugate, conjugate, 64, 64, 32, 32, 32, 16,
+                                  128, 1, 2, false, c, 3);
 #endif
 }
@@ -0,0 +1,69 @@
+#include "kernel_registry.hpp"
+#include <stdexcept>
+#include <string>
+
+void cumpsgemm::kernel_registry::registry_t::set(
+    const unsigned id, const cumpsgemm::gemm_module &gemm_module,
+    const region_t region) {
+  if (id >= max_num_modules) {
+    throw std::length_error("kernel module id " + std::to_string(id) +
+                            " exceeds the registry size");
+  }
+  if (id >= module_list.size()) {
+    module_list.resize(id + 1);
+    region_list.resize(id + 1);
+  }
+  module_list[id] = gemm_module;
+  region_list[id] = region;
+}
+
+void cumpsgemm::kernel_registry::registry_t::build() {
+  candidate_list_list.clear();
+  cell_list.clear();
+
+  std::uint64_t all_mask = 0;
+  for (std::size_t id = 0; id < module_list.size(); id++) {
+    if (module_list[id].kernel_func != nullptr) {
+      all_mask |= 1lu << id;
+    }
+  }
+  if (all_mask == 0) {
+    return;
+  }
+
+  // The candidate lists are deduplicated by the masks of the module ids
+  std::vector<std::uint64_t> mask_list;
+  cell_list.resize(num_logs * num_logs * num_logs);
+  for (unsigned log_m = 0; log_m < num_logs; log_m++) {
+    for (unsigned log_n = 0; log_n < num_logs; log_n++) {
+      for (unsigned log_k = 0; log_k < num_logs; log_k++) {
+        std::uint64_t mask = 0;
+        for (std::size_t id = 0; id < module_list.size(); id++) {
+          if (((all_mask >> id) & 1) &&
+              region_list[id].contains(log_m, log_n, log_k)) {
+            mask |= 1lu << id;
+          }
+        }
+        if (mask == 0) {
+          mask = all_mask;
+        }
+
+        std::size_t list_id = 0;
+        while (list_id < mask_list.size() && mask_list[list_id] != mask) {
+          list_id++;
+        }
+        if (list_id == mask_list.size()) {
+          mask_list.push_back(mask);
+          std::vector<std::uint16_t> candidate_list;
+          for (std::size_t id = 0; id < module_list.size(); id++) {
+            if ((mask >> id) & 1) {
+              candidate_list.push_back(id);
+            }
+          }
+          candidate_list_list.push_back(candidate_list);
+        }
+        cell_list[get_cell(log_m, log_n, log_k)] = list_id;
+      }
+    }
+  }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "instance.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace cumpsgemm {
+namespace kernel_registry {
+// floor(log2(size)) clamped to [0, max_log]
+constexpr unsigned max_log = 15;
+constexpr unsigned num_logs = max_log + 1;
+// A registry has at most this number of modules
+constexpr unsigned max_num_modules = 64;
+// The id of the split-K module, which is held outside the registry
+constexpr std::uint32_t split_k_module_id = 0xffffu;
+
+inline unsigned get_log(const std::uint64_t size) {
+  if (size < 2) {
+    return 0;
+  }
+  const unsigned log = 63 - __builtin_clzl(size);
+  return log < max_log ? log : max_log;
+}
+
+// The box of (log m, log n, log k) in which a module is a candidate
+struct region_t {
+  std::uint8_t min_log_m = 0, max_log_m = max_log;
+  std::uint8_t min_log_n = 0, max_log_n = max_log;
+  std::uint8_t min_log_k = 0, max_log_k = max_log;
+
+  bool contains(const unsigned log_m, const unsigned log_n,
+                const unsigned log_k) const {
+    return min_log_m <= log_m && log_m <= max_log_m && min_log_n <= log_n &&
+           log_n <= max_log_n && min_log_k <= log_k && log_k <= max_log_k;
+  }
+};
+
+// The kernel modules of a module code and a 3-D bucket index over
+// (log m, log n, log k). The cells covered by the same modules share a
+// candidate list.
+class registry_t {
+  std::vector<cumpsgemm::gemm_module> module_list;
+  std::vector<region_t> region_list;
+
+  std::vector<std::vector<std::uint16_t>> candidate_list_list;
+  // The candidate list of each cell. Empty if no module is set.
+  std::vector<std::uint16_t> cell_list;
+
+  static unsigned get_cell(const unsigned log_m, const unsigned log_n,
+                           const unsigned log_k) {
+    return (log_m * num_logs + log_n) * num_logs + log_k;
+  }
+
+public:
+  // Sets the module of `id` extending the list. The ids without modules are
+  // not candidates. Throws std::length_error if `id >= max_num_modules`.
+  void set(const unsigned id, const cumpsgemm::gemm_module &gemm_module,
+           const region_t region = region_t{});
+
+  // Builds the index. Called after all modules are set.
+  // A cell which no region covers has all the modules as the candidates.
+  void build();
+
+  std::size_t size() const { return module_list.size(); }
+  bool empty() const { return cell_list.empty(); }
+  const cumpsgemm::gemm_module *data() const { return module_list.data(); }
+  const cumpsgemm::gemm_module &operator[](const unsigned id) const {
+    return module_list[id];
+  }
+  const region_t &get_region(const unsigned id) const {
+    return region_list[id];
+  }
+
+  // The ids of the candidates for the shape. Not empty unless `empty()`.
+  const std::vector<std::uint16_t> &
+  get_candidates(const std::uint64_t m, const std::uint64_t n,
+                 const std::uint64_t k) const {
+    return candidate_list_list
+        [cell_list[get_cell(get_log(m), get_log(n), get_log(k))]];
+  }
+};
+} // namespace kernel_registry
+} // namespace cumpsgemm
@@ -0,0 +1,326 @@
+#include "rule_file.hpp"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+const std::map<std::string, cuMpSGEMM_compute_mode_t> compute_mode_list = {
+    {"CUBLAS", CUMPSGEMM_CUBLAS},
+    {"FP16TCEC", CUMPSGEMM_FP16TCEC},
+    {"TF32TCEC", CUMPSGEMM_TF32TCEC},
+    {"FP16TC", CUMPSGEMM_FP16TC},
+    {"TF32TC", CUMPSGEMM_TF32TC},
+    {"CUBLAS_SIMT", CUMPSGEMM_CUBLAS_SIMT},
+    {"CUBLAS_FP16TC", CUMPSGEMM_CUBLAS_FP16TC},
+    {"CUBLAS_TF32TC", CUMPSGEMM_CUBLAS_TF32TC},
+    {"DRY_RUN", CUMPSGEMM_DRY_RUN},
+    {"AUTO", CUMPSGEMM_AUTO},
+    {"FP16TCEC_SCALING", CUMPSGEMM_FP16TCEC_SCALING},
+    {"BF16TCEC", CUMPSGEMM_BF16TCEC},
+};
+
+constexpr std::uint64_t uint64_max = std::numeric_limits<std::uint64_t>::max();
+
+void throw_parse_error(const unsigned line, const std::string message) {
+  throw std::runtime_error("line " + std::to_string(line) + ": " + message);
+}
+
+std::uint64_t parse_uint(const std::string str, const unsigned line) {
+  if (str.empty() ||
+      str.find_first_not_of("0123456789") != std::string::npos) {
+    throw_parse_error(line, "invalid number \"" + str + "\"");
+  }
+  try {
+    return std::stoull(str);
+  } catch (const std::out_of_range &) {
+    throw_parse_error(line, "too large number \"" + str + "\"");
+  }
+  return 0;
+}
+
+// "*", "v", "min:max", "min:" or ":max"
+cumpsgemm::rule_file::range_t parse_range(const std::string str,
+                                          const unsigned line) {
+  if (str == "*") {
+    return {0, uint64_max};
+  }
+  const auto pos = str.find(':');
+  if (pos == std::string::npos) {
+    const auto v = parse_uint(str, line);
+    return {v, v};
+  }
+  const auto min_str = str.substr(0, pos);
+  const auto max_str = str.substr(pos + 1);
+  const cumpsgemm::rule_file::range_t range{
+      min_str.empty() ? 0 : parse_uint(min_str, line),
+      max_str.empty() ? uint64_max : parse_uint(max_str, line)};
+  if (range.min > range.max) {
+    throw_parse_error(line, "empty range \"" + str + "\"");
+  }
+  return range;
+}
+
+int parse_op(const char c, const unsigned line) {
+  switch (c) {
+  case 'N':
+    return CUBLAS_OP_N;
+  case 'T':
+    return CUBLAS_OP_T;
+  case 'C':
+    return CUBLAS_OP_C;
+  case '*':
+    return -1;
+  default:
+    break;
+  }
+  throw_parse_error(line, "invalid op \"" + std::string(1, c) + "\"");
+  return -1;
+}
+
+bool is_op_matched(const int rule_op, const unsigned op) {
+  return rule_op < 0 || static_cast<unsigned>(rule_op) == op;
+}
+
+cumpsgemm::rule_file::range_t
+get_range(const cumpsgemm::rule_file::rule_t &rule, const unsigned level) {
+  switch (level) {
+  case 0:
+    return rule.m;
+  case 1:
+    return rule.n;
+  case 2:
+    return rule.k;
+  default:
+    return rule.batch_count;
+  }
+}
+} // namespace
+
+std::vector<cumpsgemm::rule_file::rule_t>
+cumpsgemm::rule_file::parse(std::istream &is) {
+  std::vector<rule_t> rules;
+  std::string line_str;
+  for (unsigned line = 1; std::getline(is, line_str); line++) {
+    const auto comment_pos = line_str.find('#');
+    if (comment_pos != std::string::npos) {
+      line_str = line_str.substr(0, comment_pos);
+    }
+
+    std::vector<std::string> tokens;
+    std::istringstream iss(line_str);
+    for (std::string token; iss >> token;) {
+      tokens.push_back(token);
+    }
+    if (tokens.empty()) {
+      continue;
+    }
+    if (tokens.size() != 7) {
+      throw_parse_error(line, "7 fields are expected but " +
+                                  std::to_string(tokens.size()) + " given");
+    }
+
+    rule_t rule;
+    rule.line = line;
+    rule.func_name = tokens[0] == "*" ? "" : tokens[0];
+
+    const auto &op_str = tokens[1];
+    if (op_str == "*") {
+      rule.op_A = rule.op_B = -1;
+    } else if (op_str.size() == 2) {
+      rule.op_A = parse_op(op_str[0], line);
+      rule.op_B = parse_op(op_str[1], line);
+    } else {
+      throw_parse_error(line, "invalid op pair \"" + op_str + "\"");
+    }
+
+    rule.m = parse_range(tokens[2], line);
+    rule.n = parse_range(tokens[3], line);
+    rule.k = parse_range(tokens[4], line);
+    rule.batch_count = parse_range(tokens[5], line);
+
+    const auto mode = compute_mode_list.find(tokens[6]);
+    if (mode == compute_mode_list.end()) {
+      throw_parse_error(line, "unknown compute mode \"" + tokens[6] + "\"");
+    }
+    rule.compute_mode = mode->second;
+
+    rules.push_back(rule);
+  }
+  return rules;
+}
+
+namespace cumpsgemm {
+namespace rule_file {
+// Builds the interval tables level by level (m, n, k, batch_count).
+// The subtables are shared among nodes with the same set of active rules.
+class builder_t {
+  const std::vector<rule_t> &rules;
+  decision_table_t &table;
+  std::map<std::pair<unsigned, std::vector<std::uint32_t>>, std::uint32_t>
+      memo;
+
+  bool is_full_range_from(const rule_t &rule, const unsigned level) const {
+    for (unsigned l = level; l < decision_table_t::num_levels; l++) {
+      const auto range = get_range(rule, l);
+      if (range.min != 0 || range.max != uint64_max) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+  builder_t(const std::vector<rule_t> &rules, decision_table_t &table)
+      : rules(rules), table(table) {}
+
+  // Returns a node id, or a compute mode in the last level
+  std::uint32_t build(std::vector<std::uint32_t> rule_ids,
+                      const unsigned level) {
+    if (level == decision_table_t::num_levels) {
+      return rule_ids.empty() ? CUMPSGEMM_UNDEFINED
+                              : rules[rule_ids.front()].compute_mode;
+    }
+
+    // The rules after one that matches all remaining values are unreachable
+    for (std::size_t i = 0; i < rule_ids.size(); i++) {
+      if (is_full_range_from(rules[rule_ids[i]], level)) {
+        rule_ids.resize(i + 1);
+        break;
+      }
+    }
+
+    const auto memo_key = std::make_pair(level, rule_ids);
+    const auto memo_it = memo.find(memo_key);
+    if (memo_it != memo.end()) {
+      return memo_it->second;
+    }
+
+    std::vector<std::uint64_t> bounds = {0};
+    for (const auto id : rule_ids) {
+      const auto range = get_range(rules[id], level);
+      bounds.push_back(range.min);
+      if (range.max != uint64_max) {
+        bounds.push_back(range.max + 1);
+      }
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    std::vector<std::uint64_t> node_bounds;
+    std::vector<std::uint32_t> node_children;
+    for (const auto bound : bounds) {
+      std::vector<std::uint32_t> sub_rule_ids;
+      for (const auto id : rule_ids) {
+        if (get_range(rules[id], level).contains(bound)) {
+          sub_rule_ids.push_back(id);
+        }
+      }
+      const auto child = build(sub_rule_ids, level + 1);
+      // Merge with the previous range if they lead to the same result
+      if (!node_children.empty() && node_children.back() == child) {
+        continue;
+      }
+      node_bounds.push_back(bound);
+      node_children.push_back(child);
+    }
+
+    const decision_table_t::node_t node{
+        static_cast<std::uint32_t>(table.lower_bounds.size()),
+        static_cast<std::uint32_t>(table.lower_bounds.size() +
+                                   node_bounds.size())};
+    table.lower_bounds.insert(table.lower_bounds.end(), node_bounds.begin(),
+                              node_bounds.end());
+    table.children.insert(table.children.end(), node_children.begin(),
+                          node_children.end());
+
+    const auto node_id = static_cast<std::uint32_t>(table.node_list.size());
+    table.node_list.push_back(node);
+    memo.insert(std::make_pair(memo_key, node_id));
+    return node_id;
+  }
+};
+} // namespace rule_file
+} // namespace cumpsgemm
+
+cumpsgemm::rule_file::decision_table_t::decision_table_t(
+    const std::vector<rule_t> &rules) {
+  for (const auto &rule : rules) {
+    if (!rule.func_name.empty()) {
+      func_name_list.push_back(rule.func_name);
+    }
+  }
+  std::sort(func_name_list.begin(), func_name_list.end());
+  func_name_list.erase(
+      std::unique(func_name_list.begin(), func_name_list.end()),
+      func_name_list.end());
+
+  builder_t builder(rules, *this);
+  // The last function name id is for the functions not in the list
+  for (std::size_t func_name_id = 0; func_name_id <= func_name_list.size();
+       func_name_id++) {
+    for (unsigned op_A = 0; op_A < num_ops; op_A++) {
+      for (unsigned op_B = 0; op_B < num_ops; op_B++) {
+        std::vector<std::uint32_t> rule_ids;
+        for (std::uint32_t i = 0; i < rules.size(); i++) {
+          const auto &rule = rules[i];
+          const auto func_name_matched =
+              rule.func_name.empty() ||
+              (func_name_id < func_name_list.size() &&
+               rule.func_name == func_name_list[func_name_id]);
+          if (func_name_matched && is_op_matched(rule.op_A, op_A) &&
+              is_op_matched(rule.op_B, op_B)) {
+            rule_ids.push_back(i);
+          }
+        }
+        root_list.push_back(builder.build(rule_ids, 0));
+      }
+    }
+  }
+}
+
+cuMpSGEMM_compute_mode_t cumpsgemm::rule_file::decision_table_t::lookup(
+    const char *const func_name, const cublasOperation_t op_A,
+    const cublasOperation_t op_B, const std::uint64_t m, const std::uint64_t n,
+    const std::uint64_t k, const std::uint64_t batch_count) const {
+  if (root_list.empty() || static_cast<unsigned>(op_A) >= num_ops ||
+      static_cast<unsigned>(op_B) >= num_ops) {
+    return CUMPSGEMM_UNDEFINED;
+  }
+
+  std::size_t func_name_id = func_name_list.size();
+  const auto func_name_it = std::lower_bound(
+      func_name_list.begin(), func_name_list.end(), func_name,
+      [](const std::string &a, const char *const b) { return a < b; });
+  if (func_name_it != func_name_list.end() && *func_name_it == func_name) {
+    func_name_id = func_name_it - func_name_list.begin();
+  }
+
+  const std::uint64_t values[num_levels] = {m, n, k, batch_count};
+  auto v = root_list[(func_name_id * num_ops + op_A) * num_ops + op_B];
+  for (unsigned level = 0; level < num_levels; level++) {
+    const auto &node = node_list[v];
+    // The first lower bound of a node is always 0
+    const auto it = std::upper_bound(lower_bounds.begin() + node.begin,
+                                     lower_bounds.begin() + node.end,
+                                     values[level]);
+    v = children[(it - lower_bounds.begin()) - 1];
+  }
+  return static_cast<cuMpSGEMM_compute_mode_t>(v);
+}
+
+cumpsgemm::rule_file::decision_table_t
+cumpsgemm::rule_file::load(const std::string file_path) {
+  std::ifstream ifs(file_path);
+  if (!ifs) {
+    throw std::runtime_error("failed to open " + file_path);
+  }
+  try {
+    return decision_table_t(parse(ifs));
+  } catch (const std::runtime_error &e) {
+    throw std::runtime_error(file_path + ": " + e.what());
+  }
+}
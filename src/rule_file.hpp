@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cumpsgemm/cumpsgemm.h>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace cumpsgemm {
+namespace rule_file {
+// Inclusive range
+struct range_t {
+  std::uint64_t min;
+  std::uint64_t max;
+
+  bool contains(const std::uint64_t v) const { return min <= v && v <= max; }
+};
+
+// A match clause of a rule file line.
+//   <func> <op_A op_B> <m> <n> <k> <batch_count> <compute mode>
+// An empty func_name and a negative op match any value.
+struct rule_t {
+  std::string func_name;
+  int op_A;
+  int op_B;
+  range_t m, n, k, batch_count;
+  cuMpSGEMM_compute_mode_t compute_mode;
+  unsigned line;
+};
+
+// Throws std::runtime_error with the line number when the input is invalid
+std::vector<rule_t> parse(std::istream &is);
+
+// The rules compiled into flat interval tables.
+// A lookup is a binary search of the function name followed by a binary search
+// for each of m, n, k and batch_count, and returns the compute mode of the
+// first matching rule or CUMPSGEMM_UNDEFINED if no rule matches.
+class decision_table_t {
+  // The ranges [lower_bounds[i], lower_bounds[i + 1]) for i in [begin, end)
+  struct node_t {
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+
+  std::vector<std::string> func_name_list;
+  // [(func_name_id * num_ops + op_A) * num_ops + op_B]
+  std::vector<std::uint32_t> root_list;
+  std::vector<node_t> node_list;
+  std::vector<std::uint64_t> lower_bounds;
+  // A node id, or a compute mode in the last level
+  std::vector<std::uint32_t> children;
+
+  friend class builder_t;
+
+public:
+  static constexpr unsigned num_ops = 3;
+  static constexpr unsigned num_levels = 4;
+
+  decision_table_t() = default;
+  decision_table_t(const std::vector<rule_t> &rules);
+
+  cuMpSGEMM_compute_mode_t lookup(const char *const func_name,
+                                  const cublasOperation_t op_A,
+                                  const cublasOperation_t op_B,
+                                  const std::uint64_t m, const std::uint64_t n,
+                                  const std::uint64_t k,
+                                  const std::uint64_t batch_count) const;
+
+  bool empty() const { return root_list.empty(); }
+  std::size_t get_num_nodes() const { return node_list.size(); }
+};
+
+// Throws std::runtime_error when the file can not be opened or is invalid
+decision_table_t load(const std::string file_path);
+} // namespace rule_file
+} // namespace cumpsgemm
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace cumpsgemm {
+// An immutable snapshot published by writers and read by the hijacking
+// functions without locking.
+// Each thread keeps a reference to the snapshot it read last, so that a read
+// is a single atomic load unless the snapshot has been replaced. A replaced
+// snapshot is freed when no thread refers to it anymore.
+template <class T> class snapshot_t {
+  // Unique among the snapshots of T, even after one is destroyed
+  const std::uint64_t id;
+  std::shared_ptr<const T> current;
+  std::atomic<std::uint64_t> version;
+  std::mutex mutex;
+
+  static std::uint64_t get_next_id() {
+    static std::atomic<std::uint64_t> next_id(1);
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+public:
+  snapshot_t(std::shared_ptr<const T> initial = nullptr)
+      : id(get_next_id()), current(std::move(initial)), version(0) {}
+  snapshot_t(const snapshot_t &) = delete;
+
+  std::shared_ptr<const T> load() {
+    struct cache_t {
+      std::uint64_t id = 0;
+      std::uint64_t version = 0;
+      std::shared_ptr<const T> ptr;
+    };
+    thread_local cache_t cache;
+    if (cache.id != id ||
+        cache.version != version.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cache.id = id;
+      cache.version = version.load(std::memory_order_relaxed);
+      cache.ptr = current;
+    }
+    return cache.ptr;
+  }
+
+  // Publishes func(current) where current may be nullptr. The updates are
+  // serialized.
+  template <class Func> void update(const Func func) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = std::make_shared<const T>(func(current.get()));
+    version.fetch_add(1, std::memory_order_release);
+  }
+};
+} // namespace cumpsgemm
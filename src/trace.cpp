@@ -0,0 +1,179 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+const std::string trace_env_name = "CUMPSGEMM_TRACE";
+const std::string trace_mmap_env_name = "CUMPSGEMM_TRACE_MMAP";
+const std::string trace_capacity_env_name = "CUMPSGEMM_TRACE_CAPACITY";
+constexpr std::uint64_t default_capacity = 1lu << 16;
+
+struct ring_t {
+  cumpsgemm::trace::ring_header_t *header = nullptr;
+  cumpsgemm::trace::record_t *records = nullptr;
+};
+
+// The rings are never released so that the records of exited threads are
+// dumped on exit.
+class registry_t {
+  std::mutex mutex;
+  std::vector<ring_t> ring_list;
+  std::string path;
+  bool file_backed;
+  std::uint64_t capacity;
+
+public:
+  registry_t() {
+    const auto path_env = getenv(trace_env_name.c_str());
+    path = path_env == nullptr ? "" : path_env;
+
+    const auto mmap_env = getenv(trace_mmap_env_name.c_str());
+    file_backed = mmap_env != nullptr && std::string(mmap_env) != "0";
+
+    capacity = default_capacity;
+    const auto capacity_env = getenv(trace_capacity_env_name.c_str());
+    if (capacity_env != nullptr) {
+      try {
+        capacity = std::max<std::uint64_t>(std::stoull(capacity_env), 1);
+      } catch (const std::exception &) {
+      }
+    }
+  }
+
+  ~registry_t() {
+    if (!file_backed && !ring_list.empty()) {
+      dump(path);
+    }
+  }
+
+  ring_t create_ring() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto ring_id = ring_list.size();
+    const auto size = sizeof(cumpsgemm::trace::ring_header_t) +
+                      sizeof(cumpsgemm::trace::record_t) * capacity;
+
+    void *ptr = MAP_FAILED;
+    if (file_backed) {
+      const auto file_path = path + "." + std::to_string(getpid()) + "." +
+                             std::to_string(ring_id);
+      const auto fd = open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0) {
+        return ring_t();
+      }
+      if (ftruncate(fd, size) == 0) {
+        ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      }
+      close(fd);
+    } else {
+      ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (ptr == MAP_FAILED) {
+      return ring_t();
+    }
+
+    ring_t ring;
+    ring.header = static_cast<cumpsgemm::trace::ring_header_t *>(ptr);
+    ring.records = reinterpret_cast<cumpsgemm::trace::record_t *>(
+        ring.header + 1);
+    *ring.header = cumpsgemm::trace::ring_header_t{};
+    ring.header->magic = cumpsgemm::trace::magic;
+    ring.header->version = cumpsgemm::trace::version;
+    ring.header->record_size = sizeof(cumpsgemm::trace::record_t);
+    ring.header->capacity = capacity;
+    ring.header->pid = getpid();
+    ring.header->ring_id = ring_id;
+    ring_list.push_back(ring);
+    return ring;
+  }
+
+  void dump(const std::string file_path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ofstream ofs(file_path, std::ios::binary);
+    for (const auto &ring : ring_list) {
+      auto header = *ring.header;
+      header.head = __atomic_load_n(&ring.header->head, __ATOMIC_ACQUIRE);
+      ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      ofs.write(reinterpret_cast<const char *>(ring.records),
+                sizeof(cumpsgemm::trace::record_t) * header.capacity);
+    }
+  }
+};
+
+registry_t &get_registry() {
+  static registry_t registry;
+  return registry;
+}
+} // namespace
+
+bool cumpsgemm::trace::is_enabled() {
+  static const bool enabled = getenv(trace_env_name.c_str()) != nullptr;
+  return enabled;
+}
+
+std::uint32_t cumpsgemm::trace::get_func_id(const char *const func_name) {
+  for (std::uint32_t i = 0; i < num_funcs; i++) {
+    if (std::strcmp(func_name, func_name_list[i]) == 0) {
+      return i;
+    }
+  }
+  return num_funcs;
+}
+
+std::uint64_t cumpsgemm::trace::get_timestamp_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000lu + ts.tv_nsec;
+}
+
+void cumpsgemm::trace::write(const record_t &record) {
+  thread_local const ring_t ring = get_registry().create_ring();
+  if (ring.header == nullptr) {
+    return;
+  }
+  const auto head = ring.header->head;
+  ring.records[head % ring.header->capacity] = record;
+  __atomic_store_n(&ring.header->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void cumpsgemm::trace::dump(const std::string file_path) {
+  get_registry().dump(file_path);
+}
+
+std::vector<cumpsgemm::trace::record_t>
+cumpsgemm::trace::load(const std::string file_path) {
+  std::ifstream ifs(file_path, std::ios::binary);
+  if (!ifs) {
+    throw std::runtime_error("failed to open " + file_path);
+  }
+
+  std::vector<record_t> records;
+  ring_header_t header;
+  while (ifs.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    if (header.magic != magic || header.version != version ||
+        header.record_size != sizeof(record_t) || header.capacity == 0) {
+      throw std::runtime_error(file_path + ": invalid trace header");
+    }
+    std::vector<record_t> ring(header.capacity);
+    if (!ifs.read(reinterpret_cast<char *>(ring.data()),
+                  sizeof(record_t) * header.capacity)) {
+      throw std::runtime_error(file_path + ": truncated trace");
+    }
+    const auto begin =
+        header.head > header.capacity ? header.head - header.capacity : 0;
+    for (auto i = begin; i < header.head; i++) {
+      records.push_back(ring[i % header.capacity]);
+    }
+  }
+  if (!ifs.eof() || ifs.gcount() != 0) {
+    throw std::runtime_error(file_path + ": truncated trace");
+  }
+  return records;
+}
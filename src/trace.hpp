@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <cumpsgemm/cumpsgemm.h>
+#include <string>
+#include <vector>
+
+namespace cumpsgemm {
+namespace trace {
+// The traced functions indexed by the function id
+constexpr const char *func_name_list[] = {
+    "cublasSgemm_v2",
+    "cublasCgemm_v2",
+    "cublasGemmEx",
+    "cublasSgemmStridedBatched",
+    "cublasCgemmStridedBatched",
+    "cublasGemmStridedBatchedEx",
+    "cublasSgemmBatched",
+    "cublasCgemmBatched",
+    "cublasGemmBatchedEx",
+    "cublasLtMatmul",
+};
+constexpr std::uint32_t num_funcs =
+    sizeof(func_name_list) / sizeof(func_name_list[0]);
+constexpr std::uint32_t unknown_kernel_module_id = 0xffffffffu;
+
+// A hijacked call
+struct record_t {
+  // CLOCK_MONOTONIC at the call
+  std::uint64_t timestamp_ns;
+  // Host time spent in the hijacking function
+  std::uint64_t duration_ns;
+  std::uint64_t m, n, k;
+  std::uint64_t batch_count;
+  std::uint32_t func_id;
+  std::uint32_t kernel_module_id;
+  std::uint8_t op_A;
+  std::uint8_t op_B;
+  std::uint8_t compute_mode;
+  std::uint8_t reserved[5];
+};
+static_assert(sizeof(record_t) == 64, "The record size must be 64 bytes");
+
+// A ring is stored as a header followed by `capacity` records.
+// The i-th record is at `i % capacity`, and the last `min(head, capacity)`
+// records are valid.
+struct ring_header_t {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t capacity;
+  std::uint64_t pid;
+  std::uint64_t ring_id;
+  // The number of records written, updated only by the owner thread
+  std::uint64_t head;
+  std::uint8_t reserved[16];
+};
+static_assert(sizeof(ring_header_t) == 64, "The header size must be 64 bytes");
+
+constexpr std::uint64_t magic = 0x45434152544d5043lu;
+constexpr std::uint32_t version = 1;
+
+// Enabled by CUMPSGEMM_TRACE=/path/to/output
+bool is_enabled();
+
+std::uint32_t get_func_id(const char *const func_name);
+std::uint64_t get_timestamp_ns();
+
+// Appends a record to the ring of the calling thread without locking
+void write(const record_t &record);
+
+// Writes the rings of all threads to a file.
+// This is done on exit unless the rings are backed by files.
+void dump(const std::string file_path);
+
+// Returns the valid records of all rings in the file.
+// Throws std::runtime_error when the file is invalid.
+std::vector<record_t> load(const std::string file_path);
+
+// Writes the record of a hijacked call on return
+class scoped_record_t {
+  const bool enabled;
+
+public:
+  record_t record;
+
+  scoped_record_t(const char *const func_name, const cublasOperation_t op_A,
+                  const cublasOperation_t op_B, const std::uint64_t m,
+                  const std::uint64_t n, const std::uint64_t k,
+                  const std::uint64_t batch_count)
+      : enabled(is_enabled()), record() {
+    if (!enabled) {
+      return;
+    }
+    record.timestamp_ns = get_timestamp_ns();
+    record.m = m;
+    record.n = n;
+    record.k = k;
+    record.batch_count = batch_count;
+    record.func_id = get_func_id(func_name);
+    record.kernel_module_id = unknown_kernel_module_id;
+    record.op_A = op_A;
+    record.op_B = op_B;
+    record.compute_mode = CUMPSGEMM_UNDEFINED;
+  }
+
+  ~scoped_record_t() {
+    if (enabled) {
+      record.duration_ns = get_timestamp_ns() - record.timestamp_ns;
+      write(record);
+    }
+  }
+};
+} // namespace trace
+} // namespace cumpsgemm
@@ -0,0 +1,283 @@
+#include "tuning_cache.hpp"
+#include "utils.hpp"
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const std::string tuning_cache_env_name = "CUMPSGEMM_TUNING_CACHE";
+
+// FNV-1a
+class hash_t {
+  std::uint64_t hash = 0xcbf29ce484222325lu;
+
+public:
+  void mix(const void *const ptr, const std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+      hash = (hash ^ static_cast<const std::uint8_t *>(ptr)[i]) *
+             0x100000001b3lu;
+    }
+  }
+  template <class T> void mix(const T v) { mix(&v, sizeof(T)); }
+  std::uint64_t get() const { return hash ^ (hash >> 32); }
+};
+
+std::uint64_t get_hash(const cumpsgemm::tuning_cache::key_t &key) {
+  hash_t hash;
+  hash.mix(&key, sizeof(key));
+  return hash.get();
+}
+
+// Held while the file is initialized or an entry is inserted
+class file_lock_t {
+  const int fd;
+
+public:
+  file_lock_t(const int fd) : fd(fd) { flock(fd, LOCK_EX); }
+  ~file_lock_t() { flock(fd, LOCK_UN); }
+};
+bool is_valid(const int fd, cumpsgemm::tuning_cache::header_t &header) {
+  struct stat st;
+  return fstat(fd, &st) == 0 &&
+         pread(fd, &header, sizeof(header), 0) ==
+             static_cast<ssize_t>(sizeof(header)) &&
+         header.magic == cumpsgemm::tuning_cache::magic &&
+         header.version == cumpsgemm::tuning_cache::version &&
+         header.entry_size == sizeof(cumpsgemm::tuning_cache::entry_t) &&
+         header.capacity != 0 &&
+         (header.capacity & (header.capacity - 1)) == 0 &&
+         static_cast<std::uint64_t>(st.st_size) ==
+             sizeof(header) +
+                 sizeof(cumpsgemm::tuning_cache::entry_t) * header.capacity;
+}
+
+// Whether the descriptor is still the file at the path
+bool is_current(const int fd, const std::string path) {
+  struct stat fd_st, path_st;
+  return fstat(fd, &fd_st) == 0 && stat(path.c_str(), &path_st) == 0 &&
+         fd_st.st_dev == path_st.st_dev && fd_st.st_ino == path_st.st_ino;
+}
+
+bool init_file(const std::string path, const std::uint64_t capacity) {
+  const auto tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+  const auto fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  cumpsgemm::tuning_cache::header_t header{};
+  header.magic = cumpsgemm::tuning_cache::magic;
+  header.version = cumpsgemm::tuning_cache::version;
+  header.entry_size = sizeof(cumpsgemm::tuning_cache::entry_t);
+  header.capacity = capacity;
+  const auto result =
+      ftruncate(fd, sizeof(header) + sizeof(cumpsgemm::tuning_cache::entry_t) *
+                                         capacity) == 0 &&
+      pwrite(fd, &header, sizeof(header), 0) ==
+          static_cast<ssize_t>(sizeof(header)) &&
+      rename(tmp_path.c_str(), path.c_str()) == 0;
+  close(fd);
+  if (!result) {
+    unlink(tmp_path.c_str());
+  }
+  return result;
+}
+} // namespace
+
+std::uint8_t cumpsgemm::tuning_cache::get_bucket(const std::uint64_t x) {
+  if (x == 0) {
+    return 0;
+  }
+  const unsigned log = 63 - __builtin_clzl(x);
+  const auto upper_half = log != 0 && ((x >> (log - 1)) & 1);
+  return 2 * log + (upper_half ? 1 : 0);
+}
+
+cumpsgemm::tuning_cache::key_t cumpsgemm::tuning_cache::get_key(
+    const std::uint64_t identity, const kind_t kind,
+    const std::uint32_t module_code, const std::uint64_t m,
+    const std::uint64_t n, const std::uint64_t k,
+    const std::uint64_t batch_count, const bool beta_nonzero) {
+  key_t key{};
+  key.identity = identity;
+  key.module_code = module_code;
+  key.kind = kind;
+  key.m_bucket = get_bucket(m);
+  key.n_bucket = get_bucket(n);
+  key.k_bucket = get_bucket(k);
+  key.batch_bucket = get_bucket(batch_count);
+  key.beta_nonzero = beta_nonzero ? 1 : 0;
+  return key;
+}
+
+std::uint64_t cumpsgemm::tuning_cache::get_identity(
+    const std::string device_name, const int driver_version,
+    const std::uint64_t build_fingerprint) {
+  hash_t hash;
+  hash.mix(device_name.data(), device_name.size());
+  hash.mix(driver_version);
+  hash.mix(build_fingerprint);
+  return hash.get();
+}
+
+std::uint64_t cumpsgemm::tuning_cache::get_build_fingerprint(
+    const std::vector<module_table_t> &table_list) {
+  hash_t hash;
+  hash.mix(version);
+  for (const auto &table : table_list) {
+    for (std::size_t i = 0; i < table.size; i++) {
+      const auto &mod = table.list[i];
+      for (const auto v : {mod.smem_m, mod.smem_n, mod.smem_k, mod.k_per_mn,
+                           mod.block_size, mod.smem_size}) {
+        hash.mix(v);
+      }
+      hash.mix(mod.schedule);
+    }
+  }
+  return hash.get();
+}
+
+cumpsgemm::tuning_cache::cache_t::cache_t(const std::string path,
+                                          const std::uint64_t capacity) {
+  // An invalid file is replaced by renaming a new one while it is locked, since
+  // other processes may still map it. A process which has opened the replaced
+  // file opens the path again.
+  for (unsigned i = 0; i < 8; i++) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return;
+    }
+    flock(fd, LOCK_EX);
+    header_t file_header;
+    if (!is_current(fd, path)) {
+      // Replaced by another process
+    } else if (is_valid(fd, file_header)) {
+      file_size = sizeof(header_t) + sizeof(entry_t) * file_header.capacity;
+      flock(fd, LOCK_UN);
+      break;
+    } else if (!init_file(path, capacity)) {
+      close(fd);
+      fd = -1;
+      return;
+    }
+    // Closing the descriptor releases the lock
+    close(fd);
+    fd = -1;
+  }
+  if (fd < 0) {
+    return;
+  }
+
+  const auto ptr =
+      mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (ptr == MAP_FAILED) {
+    close(fd);
+    fd = -1;
+    return;
+  }
+  header = static_cast<header_t *>(ptr);
+  entries = reinterpret_cast<entry_t *>(header + 1);
+}
+
+cumpsgemm::tuning_cache::cache_t::~cache_t() {
+  if (header != nullptr) {
+    munmap(header, file_size);
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+// The probe is bounded by the capacity, since the file may be modified by
+// other processes and may have no empty entry
+bool cumpsgemm::tuning_cache::cache_t::find_entry(
+    const key_t &key, std::uint32_t &module_id) const {
+  const auto capacity = header->capacity;
+  const auto mask = capacity - 1;
+  auto i = get_hash(key) & mask;
+  for (std::uint64_t n = 0; n < capacity; n++, i = (i + 1) & mask) {
+    const auto &entry = entries[i];
+    if (__atomic_load_n(&entry.valid, __ATOMIC_ACQUIRE) == 0) {
+      return false;
+    }
+    if (entry.key == key) {
+      module_id = entry.module_id;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cumpsgemm::tuning_cache::cache_t::find(const key_t &key,
+                                            std::uint32_t &module_id) const {
+  if (!is_open()) {
+    return false;
+  }
+  return find_entry(key, module_id);
+}
+
+// The load factor is kept at most 1/2, so an empty entry always exists
+bool cumpsgemm::tuning_cache::cache_t::insert(const key_t &key,
+                                              const std::uint32_t module_id) {
+  if (!is_open()) {
+    return false;
+  }
+  // flock does not exclude the threads sharing the descriptor
+  std::lock_guard<std::mutex> guard(mutex);
+  file_lock_t lock(fd);
+
+  std::uint32_t found_module_id;
+  if (find_entry(key, found_module_id)) {
+    // Tuned by another thread or process
+    return true;
+  }
+  if ((header->num_entries + 1) * 2 > header->capacity) {
+    return false;
+  }
+  const auto capacity = header->capacity;
+  const auto mask = capacity - 1;
+  auto i = get_hash(key) & mask;
+  for (std::uint64_t n = 0; n < capacity; n++, i = (i + 1) & mask) {
+    auto &entry = entries[i];
+    if (__atomic_load_n(&entry.valid, __ATOMIC_RELAXED) == 0) {
+      entry.key = key;
+      entry.module_id = module_id;
+      __atomic_store_n(&entry.valid, 1, __ATOMIC_RELEASE);
+      __atomic_store_n(&header->num_entries, header->num_entries + 1,
+                       __ATOMIC_RELAXED);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::uint64_t cumpsgemm::tuning_cache::cache_t::size() const {
+  if (!is_open()) {
+    return 0;
+  }
+  return __atomic_load_n(&header->num_entries, __ATOMIC_RELAXED);
+}
+
+bool cumpsgemm::tuning_cache::cache_t::is_full() const {
+  return !is_open() || (size() + 1) * 2 > header->capacity;
+}
+
+cumpsgemm::tuning_cache::cache_t *cumpsgemm::tuning_cache::get() {
+  static const std::unique_ptr<cache_t> cache = []() {
+    const auto path = getenv(tuning_cache_env_name.c_str());
+    if (path == nullptr) {
+      return std::unique_ptr<cache_t>();
+    }
+    auto cache = std::make_unique<cache_t>(path);
+    if (!cache->is_open()) {
+      cuMpSGEMM_error("failed to open the tuning cache " + std::string(path) +
+                      ". Ignored");
+      return std::unique_ptr<cache_t>();
+    }
+    return cache;
+  }();
+  return cache.get();
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "instance.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cumpsgemm {
+namespace tuning_cache {
+enum kind_t : std::uint8_t {
+  gemm = 0,
+  stridedBatch = 1,
+};
+
+// A shape bucket of a GEMM. The sizes are rounded to half octaves.
+struct key_t {
+  // The device, the driver and the kernel instance tables
+  std::uint64_t identity;
+  std::uint32_t module_code;
+  std::uint8_t kind;
+  std::uint8_t m_bucket, n_bucket, k_bucket;
+  std::uint8_t batch_bucket;
+  std::uint8_t beta_nonzero;
+  std::uint8_t reserved[6];
+
+  bool operator==(const key_t &key) const {
+    return identity == key.identity && module_code == key.module_code &&
+           kind == key.kind && m_bucket == key.m_bucket &&
+           n_bucket == key.n_bucket && k_bucket == key.k_bucket &&
+           batch_bucket == key.batch_bucket &&
+           beta_nonzero == key.beta_nonzero;
+  }
+};
+static_assert(sizeof(key_t) == 24, "The key size must be 24 bytes");
+
+struct entry_t {
+  key_t key;
+  // The id in the kernel registry, or split_k_module_id for the split-K module
+  std::uint32_t module_id;
+  // Set after the other members are written
+  std::uint32_t valid;
+};
+static_assert(sizeof(entry_t) == 32, "The entry size must be 32 bytes");
+
+// The file is a header followed by `capacity` entries of an open addressing
+// hash table
+struct header_t {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t entry_size;
+  std::uint64_t capacity;
+  std::uint64_t num_entries;
+  std::uint8_t reserved[32];
+};
+static_assert(sizeof(header_t) == 64, "The header size must be 64 bytes");
+
+constexpr std::uint64_t magic = 0x454e55544d5043lu;
+constexpr std::uint32_t version = 2;
+constexpr std::uint64_t default_capacity = 1lu << 14;
+
+// 2 * floor(log2(x)) + (1 if x is in the upper half of the octave)
+std::uint8_t get_bucket(const std::uint64_t x);
+
+key_t get_key(const std::uint64_t identity, const kind_t kind,
+              const std::uint32_t module_code, const std::uint64_t m,
+              const std::uint64_t n, const std::uint64_t k,
+              const std::uint64_t batch_count, const bool beta_nonzero);
+
+std::uint64_t get_identity(const std::string device_name,
+                           const int driver_version,
+                           const std::uint64_t build_fingerprint);
+
+struct module_table_t {
+  const cumpsgemm::gemm_module *list;
+  std::size_t size;
+};
+
+// A hash of the kernel configurations, which changes when the instance tables
+// are modified
+std::uint64_t
+get_build_fingerprint(const std::vector<module_table_t> &table_list);
+
+// The winners of the online tuning shared among threads and processes through
+// a memory-mapped file. A lookup does not lock. An insertion locks the file, so
+// the processes can tune concurrently. A file of another version is replaced.
+// `capacity` must be a power of two and is ignored for an existing file.
+class cache_t {
+  int fd = -1;
+  header_t *header = nullptr;
+  entry_t *entries = nullptr;
+  std::size_t file_size = 0;
+  std::mutex mutex;
+
+  bool find_entry(const key_t &key, std::uint32_t &module_id) const;
+
+public:
+  cache_t(const std::string path,
+          const std::uint64_t capacity = default_capacity);
+  ~cache_t();
+
+  bool is_open() const { return header != nullptr; }
+
+  bool find(const key_t &key, std::uint32_t &module_id) const;
+
+  // Returns false if the table is half full
+  bool insert(const key_t &key, const std::uint32_t module_id);
+
+  std::uint64_t size() const;
+  bool is_full() const;
+};
+
+// The cache at CUMPSGEMM_TUNING_CACHE=/path/to/cache, or nullptr if the online
+// tuning is disabled or the file cannot be opened
+cache_t *get();
+} // namespace tuning_cache
+} // namespace cumpsgemm
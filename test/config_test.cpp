@@ -0,0 +1,119 @@
+#include "../src/config.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+const std::string config_file_path = "cumpsgemm_config_test.txt";
+
+void write_config_file(const std::string src) {
+  std::ofstream ofs(config_file_path);
+  ofs << src;
+}
+
+// Waits for the watcher thread to publish a new snapshot
+bool wait_for_reload(const std::uint64_t generation) {
+  for (unsigned i = 0; i < 100; i++) {
+    if (cumpsgemm::config::get()->generation != generation) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return false;
+}
+
+void test_env() {
+  const auto config = cumpsgemm::config::get();
+  check("env:compute_mode", config->compute_mode == CUMPSGEMM_TF32TCEC);
+  check("env:flags", !config->info_enabled && config->error_log_enabled &&
+                         !config->warning_log_enabled &&
+                         !config->culip_profiling_enabled &&
+                         !config->custom_gemm_Mx2x2_enabled &&
+                         !config->deterministic_enabled);
+  check("env:raster_group_width", config->raster_group_width == -1);
+  check("env:rule_file", config->rule_file_path.empty());
+}
+
+void test_config_file() {
+  write_config_file("# comment\n"
+                    "CUMPSGEMM_INFO=1\n"
+                    "CUMPSGEMM_DETERMINISTIC=1\n"
+                    "CUMPSGEMM_RASTER_GROUP_WIDTH=16\n"
+                    "  CUMPSGEMM_COMPUTE_MODE = FP16TC  # override\n"
+                    "CUMPSGEMM_RULE_FILE=/path/to/rule.txt\n");
+  const auto generation = cumpsgemm::config::get()->generation;
+  cumpsgemm::config::reload();
+  const auto config = cumpsgemm::config::get();
+  check("config_file:generation", config->generation == generation + 1);
+  check("config_file:override", config->compute_mode == CUMPSGEMM_FP16TC);
+  check("config_file:flag",
+        config->info_enabled && config->deterministic_enabled);
+  check("config_file:rule_file",
+        config->rule_file_path == "/path/to/rule.txt");
+  check("config_file:raster_group_width", config->raster_group_width == 16);
+
+  write_config_file("CUMPSGEMM_COMPUTE_MODE=FP64\n"
+                    "CUMPSGEMM_RASTER_GROUP_WIDTH=-4\n"
+                    "UNKNOWN_NAME=1\n");
+  cumpsgemm::config::reload();
+  check("config_file:invalid_mode",
+        cumpsgemm::config::get()->compute_mode == CUMPSGEMM_UNDEFINED);
+  check("config_file:invalid_raster_group_width",
+        cumpsgemm::config::get()->raster_group_width == -1);
+
+  // The replaced snapshots are freed
+  const std::weak_ptr<const cumpsgemm::config::config_t> replaced =
+      cumpsgemm::config::get();
+  cumpsgemm::config::reload();
+  cumpsgemm::config::get();
+  check("config_file:reclaim", replaced.expired());
+}
+
+void test_watch() {
+  // The mtime may not be changed within its resolution
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  auto generation = cumpsgemm::config::get()->generation;
+  write_config_file("CUMPSGEMM_ENABLE_CULIP_PROFILING=1\n");
+  check("watch:file", wait_for_reload(generation) &&
+                          cumpsgemm::config::get()->culip_profiling_enabled);
+
+  setenv("CUMPSGEMM_CUSTOM_GEMM_MX2X2", "1", 1);
+  generation = cumpsgemm::config::get()->generation;
+  std::raise(SIGUSR1);
+  check("watch:signal",
+        wait_for_reload(generation) &&
+            cumpsgemm::config::get()->custom_gemm_Mx2x2_enabled);
+}
+} // namespace
+
+int main() {
+  write_config_file("");
+  setenv("CUMPSGEMM_COMPUTE_MODE", "TF32TCEC", 1);
+  setenv("CUMPSGEMM_CONFIG_FILE", config_file_path.c_str(), 1);
+  setenv("CUMPSGEMM_CONFIG_RELOAD_SIGNAL", std::to_string(SIGUSR1).c_str(), 1);
+
+  test_env();
+  test_config_file();
+  test_watch();
+
+  std::remove(config_file_path.c_str());
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
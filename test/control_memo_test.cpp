@@ -0,0 +1,94 @@
+#include "../src/control_memo.hpp"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+// The cublasOperation_t values
+constexpr int op_n = 0;
+constexpr int op_t = 1;
+
+cuMpSGEMM_compute_mode_t control_func(const int op_A, const int op_B,
+                                      const unsigned m, const unsigned n,
+                                      const unsigned k) {
+  if (op_A == op_t && op_B == op_n) {
+    return CUMPSGEMM_CUBLAS;
+  }
+  return (m + n + k) % 2 == 0 ? CUMPSGEMM_FP16TCEC : CUMPSGEMM_TF32TCEC;
+}
+
+bool check_all(cumpsgemm::control_memo::memo_t &memo, const unsigned num) {
+  bool ok = true;
+  for (unsigned i = 0; i < num; i++) {
+    ok &= memo.get(op_n, op_n, i, 64, 32) ==
+          control_func(op_n, op_n, i, 64, 32);
+  }
+  return ok;
+}
+
+void test_hit() {
+  cumpsgemm::control_memo::memo_t memo(control_func);
+  const auto first = memo.get(op_n, op_n, 128, 64, 32);
+  const auto second = memo.get(op_n, op_n, 128, 64, 32);
+  check("hit:mode", first == CUMPSGEMM_FP16TCEC && second == first);
+  check("hit:num_calls", memo.get_num_calls() == 1);
+  check("hit:op", memo.get(op_t, op_n, 128, 64, 32) ==
+                      CUMPSGEMM_CUBLAS);
+  check("hit:op_num_calls", memo.get_num_calls() == 2);
+}
+
+void test_grow() {
+  cumpsgemm::control_memo::memo_t memo(control_func);
+  const auto num = cumpsgemm::control_memo::memo_t::initial_num_entries * 4;
+  check("grow:miss", check_all(memo, num));
+  check("grow:hit", check_all(memo, num));
+  check("grow:num_calls", memo.get_num_calls() == num);
+}
+
+void test_threads() {
+  cumpsgemm::control_memo::memo_t memo(control_func);
+  const unsigned num = 2000;
+  std::vector<std::thread> threads;
+  std::vector<char> results(8);
+  for (unsigned t = 0; t < results.size(); t++) {
+    threads.emplace_back([&, t]() {
+      results[t] = check_all(memo, num) && check_all(memo, num);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bool ok = true;
+  for (const auto r : results) {
+    ok &= r != 0;
+  }
+  check("threads:mode", ok);
+  // Threads missing at the same time may call the function for the same shape
+  check("threads:num_calls", memo.get_num_calls() >= num &&
+                                 memo.get_num_calls() <= num * results.size());
+  const auto num_calls = memo.get_num_calls();
+  check_all(memo, num);
+  check("threads:no_call_after_insert", memo.get_num_calls() == num_calls);
+}
+} // namespace
+
+int main() {
+  test_hit();
+  test_grow();
+  test_threads();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
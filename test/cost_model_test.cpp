@@ -0,0 +1,369 @@
+#include "../src/cost_model.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+cumpsgemm::gemm_module
+make_module(const unsigned smem_m, const unsigned smem_n, const unsigned smem_k,
+            const unsigned block_size, const unsigned num_active_blocks,
+            const unsigned k_per_mn = 0,
+            const cumpsgemm::gemm_schedule_t schedule =
+                cumpsgemm::gemm_schedule_t::data_parallel) {
+  cumpsgemm::gemm_module gemm_module = {};
+  gemm_module.smem_m = smem_m;
+  gemm_module.smem_n = smem_n;
+  gemm_module.smem_k = smem_k;
+  gemm_module.block_size = block_size;
+  gemm_module.num_active_blocks = num_active_blocks;
+  gemm_module.k_per_mn = k_per_mn;
+  gemm_module.schedule = schedule;
+  return gemm_module;
+}
+
+cumpsgemm::cost_model::device_t get_a100() {
+  cumpsgemm::cost_model::device_t device;
+  device.num_sms = 108;
+  return device;
+}
+
+// The working memory and the counters of a handle
+constexpr std::uint64_t workspace_size = 1lu << 22;
+constexpr std::uint64_t max_num_tiles = 1lu << 14;
+
+// Selects among the candidates 0, 1 and 2
+unsigned select(const cumpsgemm::gemm_module *const candidate_list,
+                const cumpsgemm::gemm_module *const split_k_module,
+                const cumpsgemm::cost_model::device_t &device,
+                const std::uint64_t m, const std::uint64_t n,
+                const std::uint64_t k, const std::uint64_t batch_count,
+                const bool is_complex, const bool beta_nonzero) {
+  const std::uint16_t id_list[] = {0, 1, 2};
+  cumpsgemm::cost_model::split_k_plan_t plan;
+  if (split_k_module != nullptr) {
+    plan = cumpsgemm::cost_model::plan_split_k(
+        *split_k_module, device, m, n, k, workspace_size, max_num_tiles);
+  }
+  return cumpsgemm::cost_model::select(
+      candidate_list, id_list, cumpsgemm::num_kernel_candidates,
+      split_k_module, plan, workspace_size, max_num_tiles, device, m, n, k,
+      batch_count, is_complex, beta_nonzero);
+}
+
+void test_waves() {
+  const auto device = get_a100();
+  const auto gemm_module = make_module(128, 128, 32, 128, 2);
+  // 12 x 18 = 216 blocks fill 108 SMs x 2 blocks
+  const auto full =
+      cumpsgemm::cost_model::estimate(gemm_module, device, 128 * 12, 128 * 18,
+                                      1024, 1, false, false);
+  check("waves:full", full.num_blocks == 216 && full.num_waves == 1 &&
+                          full.tail_efficiency == 1.);
+
+  const auto tail =
+      cumpsgemm::cost_model::estimate(gemm_module, device, 128 * 12,
+                                      128 * 18 + 1, 1024, 1, false, false);
+  check("waves:tail", tail.num_blocks == 228 && tail.num_waves == 2 &&
+                          tail.tail_efficiency == 228. / 432);
+  // The 12 blocks in the tail wave run with one block per SM
+  check("waves:tail_cost", tail.cycles > full.cycles * 1.3 &&
+                               tail.cycles < full.cycles * 2);
+
+  const auto batched =
+      cumpsgemm::cost_model::estimate(gemm_module, device, 128 * 12, 128 * 18,
+                                      1024, 4, false, false);
+  check("waves:batch", batched.num_waves == 4 && batched.tail_efficiency == 1.);
+
+  const auto longer_k =
+      cumpsgemm::cost_model::estimate(gemm_module, device, 128 * 12, 128 * 18,
+                                      2048, 1, false, false);
+  check("waves:k", longer_k.cycles > full.cycles * 1.9);
+}
+
+void test_split_k() {
+  const auto device = get_a100();
+  const cumpsgemm::gemm_module candidate_list[] = {
+      make_module(128, 128, 32, 128, 2),
+      make_module(64, 128, 32, 128, 3),
+      make_module(64, 64, 32, 128, 4),
+  };
+  const auto atomic_module = make_module(64, 64, 32, 128, 4, 64);
+  const auto atomic_id = cumpsgemm::num_kernel_candidates;
+
+  // The 4 tiles are split to fill 108 SMs x 4 blocks
+  const auto plan = cumpsgemm::cost_model::plan_split_k(
+      atomic_module, device, 128, 128, 65536, workspace_size, max_num_tiles);
+  const auto estimate = cumpsgemm::cost_model::estimate_split_k(
+      atomic_module, plan, device, 128, 128, false, false);
+  check("split_k:blocks", plan.num_splits == 108 &&
+                              plan.k_per_split == 608 &&
+                              estimate.num_blocks == 2 * 2 * 108 &&
+                              estimate.num_waves == 1);
+
+  check("split_k:small_mn_large_k",
+        select(candidate_list, &atomic_module, device, 128, 128, 65536, 1,
+               false, true) == atomic_id);
+  check("split_k:large",
+        select(candidate_list, &atomic_module, device, 4096, 4096, 4096, 1,
+               false, true) != atomic_id);
+  check("split_k:small_k",
+        select(candidate_list, &atomic_module, device, 128, 128, 64, 1, false,
+               true) != atomic_id);
+  check("split_k:batched",
+        select(candidate_list, &atomic_module, device, 128, 128, 65536, 2,
+               false, true) != atomic_id);
+  check("split_k:not_available",
+        select(candidate_list, nullptr, device, 128, 128, 65536, 1, false,
+               true) != atomic_id);
+  check("split_k:small_tile", select(candidate_list, nullptr, device, 1024,
+                                     1024, 1024, 1, false, true) == 2);
+}
+
+void test_split_k_plan() {
+  const auto device = get_a100();
+  const auto split_k_module = make_module(64, 64, 32, 128, 4, 256);
+  const auto plan = [&](const std::uint64_t m, const std::uint64_t n,
+                        const std::uint64_t k, const std::uint64_t workspace) {
+    return cumpsgemm::cost_model::plan_split_k(
+        split_k_module, device, m, n, k, workspace, max_num_tiles);
+  };
+
+  // A slice has at least k_per_mn
+  const auto short_k = plan(128, 128, 1024, workspace_size);
+  check("split_k_plan:min_k",
+        short_k.num_splits == 4 && short_k.k_per_split == 256);
+  // The partial tiles of 8 slices fit in the workspace
+  const auto small_workspace =
+      plan(128, 128, 65536, 8 * 2 * 2 * 64 * 64 + 100);
+  check("split_k_plan:workspace", small_workspace.num_splits == 8 &&
+                                      small_workspace.k_per_split == 8192);
+  // The slices are rounded to smem_k, and the last one is not empty
+  const auto odd_k = plan(64, 64, 1000, workspace_size);
+  check("split_k_plan:last_slice",
+        odd_k.num_splits == 4 && odd_k.k_per_split == 256 &&
+            odd_k.k_per_split * (odd_k.num_splits - 1) < 1000);
+  // The tiles already fill the waves
+  check("split_k_plan:large_mn",
+        plan(8192, 8192, 8192, 1lu << 30).num_splits == 1);
+  check("split_k_plan:not_available",
+        plan(64 * 129, 64 * 128, 8192, 1lu << 30).num_splits == 0 &&
+            plan(128, 128, 65536, 2 * 2 * 64 * 64 - 1).num_splits == 0 &&
+            cumpsgemm::cost_model::plan_split_k(cumpsgemm::gemm_module{},
+                                                device, 128, 128, 65536,
+                                                workspace_size, max_num_tiles)
+                    .num_splits == 0);
+}
+
+void test_stream_k() {
+  const auto device = get_a100();
+  const cumpsgemm::gemm_module module_list[] = {
+      make_module(128, 128, 32, 128, 2),
+      make_module(128, 128, 32, 128, 2, 0,
+                  cumpsgemm::gemm_schedule_t::stream_k),
+  };
+  const auto &stream_k_module = module_list[1];
+  const auto plan = [&](const std::uint64_t m, const std::uint64_t n,
+                        const std::uint64_t k, const std::uint64_t workspace) {
+    return cumpsgemm::cost_model::plan_stream_k(stream_k_module, device, m, n,
+                                                k, workspace, max_num_tiles);
+  };
+  const auto select = [&](const std::uint64_t m, const std::uint64_t n,
+                          const std::uint64_t k,
+                          const std::uint64_t batch_count,
+                          const std::uint64_t max_num_tiles) {
+    const std::uint16_t id_list[] = {0, 1};
+    return cumpsgemm::cost_model::select(
+        module_list, id_list, 2, nullptr, {}, workspace_size, max_num_tiles,
+        device, m, n, k, batch_count, false, true);
+  };
+
+  // 144 tiles x 48 k-steps. The partial tiles of 2 blocks per SM do not fit
+  // in the workspace.
+  const auto small_workspace = plan(1536, 1536, 1536, workspace_size);
+  check("stream_k:plan", small_workspace.num_blocks == 108 &&
+                             small_workspace.k_steps_per_block == 64);
+  const auto large_workspace = plan(1536, 1536, 1536, 1lu << 30);
+  check("stream_k:plan_occupancy", large_workspace.num_blocks == 216 &&
+                                       large_workspace.k_steps_per_block == 32);
+  // Fewer k-steps than the blocks
+  check("stream_k:plan_small", plan(128, 128, 64, 1lu << 30).num_blocks == 2);
+  check("stream_k:not_available",
+        plan(128 * 129, 128 * 128, 64, 1lu << 30).num_blocks == 0 &&
+            plan(1536, 1536, 1536, 2 * 128 * 128 * 108 - 1).num_blocks == 0 &&
+            cumpsgemm::cost_model::plan_stream_k(module_list[0], device, 1536,
+                                                 1536, 1536, workspace_size,
+                                                 max_num_tiles)
+                    .num_blocks == 0);
+
+  const auto estimate = cumpsgemm::cost_model::estimate_stream_k(
+      stream_k_module, small_workspace, device, 1536, 1536, 1536, false, true);
+  check("stream_k:estimate", estimate.num_blocks == 108 &&
+                                 estimate.num_waves == 1 &&
+                                 estimate.tail_efficiency == 1.);
+
+  // 144 tiles leave a third of the wave idle
+  check("stream_k:quantized", select(1536, 1536, 1536, 1, max_num_tiles) == 1);
+  // 216 tiles fill the wave
+  check("stream_k:full_wave", select(1536, 2304, 1536, 1, max_num_tiles) == 0);
+  check("stream_k:batched", select(1536, 1536, 1536, 2, max_num_tiles) == 0);
+  check("stream_k:skipped", select(1536, 1536, 1536, 1, 100) == 0);
+}
+
+// A group of the kernel modules in instance_sm80.cu. Each candidate is the
+// fastest one for the square GEMM of size N measured on A100 (108 SMs).
+struct record_t {
+  std::string name;
+  struct {
+    unsigned smem_m, smem_n, smem_k, block_size, num_stages, N;
+    bool tuned;
+  } candidate_list[cumpsgemm::num_kernel_candidates];
+};
+
+// Reads the value of `key` in a one-line entry of the autotune database
+std::string get_value(const std::string &line, const std::string &key) {
+  const auto pos = line.find("\"" + key + "\": ");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  auto begin = pos + key.size() + 4;
+  auto end = line.find_first_of(",}", begin);
+  if (line[begin] == '"') {
+    begin++;
+    end = line.find('"', begin);
+  }
+  return line.substr(begin, end - begin);
+}
+
+unsigned get_uint(const std::string &line, const std::string &key) {
+  const auto value = get_value(line, key);
+  return value.empty() ? 0u : std::stoul(value);
+}
+
+// Loads the tuned "gemm" entries of the autotune database, e.g.
+// tools/autotune/sm80.json, grouped by the kernel name such as
+// "S FP16TCEC NN"
+std::vector<record_t> load_records(const char *const db_path) {
+  std::map<std::string, record_t> record_map;
+  std::ifstream ifs(db_path);
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (get_value(line, "kind") != "gemm") {
+      continue;
+    }
+    const auto stage = get_uint(line, "stage");
+    if (stage >= cumpsgemm::num_kernel_candidates) {
+      continue;
+    }
+    const auto tc_t = get_value(line, "tc_t");
+    const std::map<std::string, std::string> op_list = {
+        {"col_major", "N"}, {"row_major", "T"}, {"conjugate", "C"}};
+    const auto name =
+        std::string(get_value(line, "io_t") == "float" ? "S " : "C ") +
+        (tc_t == "half" ? "FP16" : tc_t == "tf32" ? "TF32" : "BF16") + "TC" +
+        (get_value(line, "ec") == "with_ec" ? "EC " : " ") +
+        op_list.at(get_value(line, "op_a")) +
+        op_list.at(get_value(line, "op_b"));
+
+    auto &record = record_map[name];
+    record.name = name;
+    auto &c = record.candidate_list[stage];
+    c.smem_m = get_uint(line, "smem_m");
+    c.smem_n = get_uint(line, "smem_n");
+    c.smem_k = get_uint(line, "smem_k");
+    c.block_size = get_uint(line, "block_size");
+    c.num_stages = get_uint(line, "num_stages");
+    c.N = get_uint(line, "N");
+    c.tuned = c.N != 0;
+  }
+
+  std::vector<record_t> record_list;
+  for (const auto &r : record_map) {
+    const auto &c = r.second.candidate_list;
+    if (std::all_of(c, c + cumpsgemm::num_kernel_candidates,
+                    [](const auto &candidate) { return candidate.tuned; })) {
+      record_list.push_back(r.second);
+    }
+  }
+  return record_list;
+}
+
+// The occupancy of the non-pipelined kernels, assuming 128 registers per
+// thread. A100 has 164 KiB of shared memory and 64 Ki registers per SM.
+unsigned get_num_active_blocks(const record_t &record, const unsigned i) {
+  const auto &c = record.candidate_list[i];
+  const auto element_size = record.name[0] == 'C' ? 8u : 4u;
+  const auto op_A = record.name[record.name.size() - 2];
+  const auto op_B = record.name[record.name.size() - 1];
+  const auto smem_A =
+      op_A == 'N' ? (c.smem_m + 8) * c.smem_k : (c.smem_k + 8) * c.smem_m;
+  const auto smem_B =
+      op_B == 'N' ? (c.smem_k + 8) * c.smem_n : (c.smem_n + 8) * c.smem_k;
+  const auto smem_size =
+      element_size * std::max((c.smem_m + 4) * c.smem_n,
+                              c.num_stages * (smem_A + smem_B));
+  return std::max(1u, std::min({164 * 1024 / (smem_size + 1024),
+                                65536 / (c.block_size * 128),
+                                2048 / c.block_size}));
+}
+
+void test_records(const char *const db_path) {
+  const auto device = get_a100();
+  const auto record_list = load_records(db_path);
+  unsigned num_records = 0;
+  unsigned num_matched = 0;
+  for (const auto &record : record_list) {
+    cumpsgemm::gemm_module candidate_list[cumpsgemm::num_kernel_candidates];
+    for (unsigned i = 0; i < cumpsgemm::num_kernel_candidates; i++) {
+      const auto &c = record.candidate_list[i];
+      candidate_list[i] =
+          make_module(c.smem_m, c.smem_n, c.smem_k, c.block_size,
+                      get_num_active_blocks(record, i));
+    }
+    for (unsigned i = 0; i < cumpsgemm::num_kernel_candidates; i++) {
+      const auto N = record.candidate_list[i].N;
+      const auto &selected =
+          candidate_list[select(candidate_list, nullptr, device, N, N, N, 1,
+                                record.name[0] == 'C', false)];
+      // The candidates with the same tile are not distinguished
+      num_matched += selected.smem_m == candidate_list[i].smem_m &&
+                     selected.smem_n == candidate_list[i].smem_n &&
+                     selected.smem_k == candidate_list[i].smem_k;
+      num_records++;
+    }
+  }
+  std::printf("records: %u / %u matched\n", num_matched, num_records);
+  check("records:sm80",
+        num_records != 0 && num_matched >= num_records * 4 / 5);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s /path/to/tools/autotune/sm80.json\n",
+                 argv[0]);
+    return 1;
+  }
+
+  test_waves();
+  test_split_k();
+  test_split_k_plan();
+  test_stream_k();
+  test_records(argv[1]);
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include "../src/graph_slot_pool.hpp"
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+void test_acquire() {
+  cumpsgemm::graph_slot_pool_t pool(10, 14);
+  std::set<std::uint32_t> ids;
+  bool ok = true;
+  for (unsigned i = 0; i < 4; i++) {
+    std::uint32_t id;
+    ok &= pool.acquire(id) && id >= 10 && id < 14;
+    ids.insert(id);
+  }
+  check("acquire:range", ok && ids.size() == 4);
+  std::uint32_t id;
+  check("acquire:used_up", !pool.acquire(id) && pool.get_num_free() == 0);
+}
+
+// The slots of the destroyed graphs are taken again
+void test_release() {
+  cumpsgemm::graph_slot_pool_t pool(0, 4);
+  bool ok = true;
+  for (unsigned i = 0; i < 100; i++) {
+    std::uint32_t id_a, id_b;
+    ok &= pool.acquire(id_a) && pool.acquire(id_b) && id_a != id_b;
+    pool.release(id_a);
+    pool.release(id_b);
+  }
+  check("release:reuse", ok && pool.get_num_free() == 4);
+}
+
+void test_threads() {
+  cumpsgemm::graph_slot_pool_t pool(0, 64);
+  std::vector<std::thread> threads;
+  std::vector<char> results(8);
+  for (unsigned t = 0; t < results.size(); t++) {
+    threads.emplace_back([&, t]() {
+      bool ok = true;
+      for (unsigned i = 0; i < 10000; i++) {
+        std::uint32_t id;
+        ok &= pool.acquire(id) && id < 64;
+        pool.release(id);
+      }
+      results[t] = ok;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bool ok = true;
+  for (const auto r : results) {
+    ok &= r != 0;
+  }
+  check("threads:acquire", ok && pool.get_num_free() == 64);
+}
+} // namespace
+
+int main() {
+  test_acquire();
+  test_release();
+  test_threads();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
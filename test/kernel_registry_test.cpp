@@ -0,0 +1,120 @@
+#include "../src/kernel_registry.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+int dummy_kernel;
+
+cumpsgemm::gemm_module make_module(const unsigned smem_m) {
+  cumpsgemm::gemm_module mod;
+  mod.kernel_func = &dummy_kernel;
+  mod.smem_m = smem_m;
+  return mod;
+}
+
+using id_list_t = std::vector<std::uint16_t>;
+
+void test_log() {
+  using cumpsgemm::kernel_registry::get_log;
+  check("log:values", get_log(0) == 0 && get_log(1) == 0 && get_log(2) == 1 &&
+                          get_log(3) == 1 && get_log(1024) == 10 &&
+                          get_log(1023) == 9);
+  check("log:clamp", get_log(1lu << 15) == 15 && get_log(1lu << 40) == 15);
+}
+
+void test_default_region() {
+  cumpsgemm::kernel_registry::registry_t registry;
+  check("default_region:empty", registry.empty());
+  for (unsigned i = 0; i < cumpsgemm::num_kernel_candidates; i++) {
+    registry.set(i, make_module(128 >> i));
+  }
+  registry.build();
+  check("default_region:build",
+        !registry.empty() &&
+            registry.size() == cumpsgemm::num_kernel_candidates &&
+            registry[2].smem_m == 32);
+  check("default_region:all_cells",
+        registry.get_candidates(1, 1, 1) == id_list_t{0, 1, 2} &&
+            registry.get_candidates(16384, 8, 1lu << 20) ==
+                id_list_t{0, 1, 2});
+}
+
+void test_specialized_region() {
+  cumpsgemm::kernel_registry::registry_t registry;
+  for (unsigned i = 0; i < cumpsgemm::num_kernel_candidates; i++) {
+    registry.set(i, make_module(128 >> i));
+  }
+  // Small m and n with a large k
+  registry.set(3, make_module(16), {0, 6, 0, 6, 12, 15});
+  // Only a tall-skinny region
+  registry.set(5, make_module(256), {12, 15, 0, 4, 0, 15});
+  registry.build();
+
+  check("specialized:size", registry.size() == 6);
+  check("specialized:in_region",
+        registry.get_candidates(64, 127, 4096) == id_list_t{0, 1, 2, 3});
+  check("specialized:boundary",
+        registry.get_candidates(128, 64, 4096) == id_list_t{0, 1, 2} &&
+            registry.get_candidates(64, 64, 4095) == id_list_t{0, 1, 2});
+  check("specialized:clamped",
+        registry.get_candidates(1lu << 20, 16, 64) == id_list_t{0, 1, 2, 5});
+  // The id 4 is not set
+  check("specialized:hole", registry[4].kernel_func == nullptr &&
+                                registry.get_candidates(1, 1, 1) ==
+                                    id_list_t{0, 1, 2});
+}
+
+void test_uncovered_cell() {
+  cumpsgemm::kernel_registry::registry_t registry;
+  registry.set(0, make_module(128), {10, 15, 0, 15, 0, 15});
+  registry.set(1, make_module(32), {0, 9, 0, 9, 0, 15});
+  registry.build();
+  check("uncovered:covered",
+        registry.get_candidates(2048, 16, 16) == id_list_t{0} &&
+            registry.get_candidates(16, 16, 16) == id_list_t{1});
+  // Falls back to all the modules
+  check("uncovered:fallback",
+        registry.get_candidates(16, 2048, 16) == id_list_t{0, 1});
+}
+
+void test_limit() {
+  cumpsgemm::kernel_registry::registry_t registry;
+  bool thrown = false;
+  try {
+    registry.set(cumpsgemm::kernel_registry::max_num_modules, make_module(64));
+  } catch (const std::length_error &) {
+    thrown = true;
+  }
+  registry.set(cumpsgemm::kernel_registry::max_num_modules - 1,
+               make_module(64));
+  registry.build();
+  check("limit:length_error", thrown);
+  check("limit:last_id",
+        registry.get_candidates(1, 1, 1) ==
+            id_list_t{cumpsgemm::kernel_registry::max_num_modules - 1});
+}
+} // namespace
+
+int main() {
+  test_log();
+  test_default_region();
+  test_specialized_region();
+  test_uncovered_cell();
+  test_limit();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
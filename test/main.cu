@@ -1,13 +1,22 @@
+#include "../src/capture.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <cublasLt.h>
 #include <cumpsgemm/cumpsgemm.hpp>
+#include <cumpsgemm/hijack_control.hpp>
 #include <cutf/cublas.hpp>
 #include <cutf/curand.hpp>
 #include <cutf/debug/time_breakdown.hpp>
 #include <cutf/memory.hpp>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <regex>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 // #define ENABLE_AUTO_MODE_PROFILING
@@ -24,6 +33,7 @@ enum implementation_type {
   FP16TC = CUMPSGEMM_FP16TC,
   FP16TCEC_SCALING = CUMPSGEMM_FP16TCEC_SCALING,
   FP32_SIMT = CUMPSGEMM_FP32_SIMT,
+  BF16TCEC = CUMPSGEMM_BF16TCEC,
 };
 
 cuMpSGEMM_compute_mode_t get_compute_mode(const implementation_type imp) {
@@ -60,6 +70,8 @@ std::string get_implementation_type_name_str(const implementation_type imp) {
     return "TF32TC";
   case FP32_SIMT:
     return "FP32_SIMT";
+  case BF16TCEC:
+    return "BF16TCEC";
   default:
     return "Unknown(" + std::to_string(imp) + ")";
   }
@@ -245,7 +257,7 @@ __global__ void copy_matrix_kernel(T *dst_ptr, const std::size_t ldd,
   const auto mi = tid % m;
   const auto ni = tid / m;
 
-  dst_ptr[mi + mi * ldd] = src_ptr[mi + ni * lds];
+  dst_ptr[mi + ni * ldd] = src_ptr[mi + ni * lds];
 }
 
 template <class T>
@@ -868,6 +880,8 @@ void test_logged_shape(const std::string log_path) {
       compute_mode = CUMPSGEMM_TF32TCEC;
     } else if (mode == "FP32_SIMT") {
       compute_mode = CUMPSGEMM_FP32_SIMT;
+    } else if (mode == "BF16TCEC") {
+      compute_mode = CUMPSGEMM_BF16TCEC;
     } else {
       throw std::runtime_error("Unknown compute mode : " + mode);
     }
@@ -1342,6 +1356,729 @@ void exp_stats_bw_test(const unsigned min_log_N, const unsigned max_log_N,
   }
 }
 
+// Measure the aggregate number of hijacked cublasSgemm calls per second issued
+// from multiple host threads, each of which has its own cuBLAS handle and
+// stream
+void hijack_multithread_bench(const unsigned max_num_threads,
+                              const std::size_t N,
+                              const std::size_t num_calls_per_thread,
+                              const cuMpSGEMM_compute_mode_t compute_mode) {
+  float *a_ptr = cutf::memory::malloc<float>(N * N);
+  float *b_ptr = cutf::memory::malloc<float>(N * N);
+  float *c_ptr = cutf::memory::malloc<float>(N * N * max_num_threads);
+  CUTF_CHECK_ERROR(cudaMemset(a_ptr, 0, sizeof(float) * N * N));
+  CUTF_CHECK_ERROR(cudaMemset(b_ptr, 0, sizeof(float) * N * N));
+
+  cumpsgemm::hijack_control::set_compute_mode(compute_mode);
+
+  std::printf("## %s\n", __func__);
+  std::printf("mode,N,num_threads,num_calls,calls_per_sec\n");
+  for (unsigned num_threads = 1; num_threads <= max_num_threads;
+       num_threads *= 2) {
+    std::vector<cublasHandle_t> cublas_handles(num_threads);
+    std::vector<cudaStream_t> cuda_streams(num_threads);
+    for (unsigned t = 0; t < num_threads; t++) {
+      CUTF_CHECK_ERROR(cublasCreate(&cublas_handles[t]));
+      CUTF_CHECK_ERROR(cudaStreamCreate(&cuda_streams[t]));
+      CUTF_CHECK_ERROR(cublasSetStream(cublas_handles[t], cuda_streams[t]));
+    }
+
+    const float alpha = 1.f, beta = 0.f;
+    const auto gemm_loop = [&](const unsigned t, const std::size_t num_calls) {
+      for (std::size_t i = 0; i < num_calls; i++) {
+        CUTF_CHECK_ERROR(cublasSgemm(cublas_handles[t], CUBLAS_OP_N,
+                                     CUBLAS_OP_N, N, N, N, &alpha, a_ptr, N,
+                                     b_ptr, N, &beta, c_ptr + t * N * N, N));
+      }
+      CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_streams[t]));
+    };
+
+    // Warm up (handle creation etc.)
+    for (unsigned t = 0; t < num_threads; t++) {
+      gemm_loop(t, 1);
+    }
+
+    const auto start_clock = std::chrono::system_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; t++) {
+      threads.push_back(std::thread(gemm_loop, t, num_calls_per_thread));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    const auto end_clock = std::chrono::system_clock::now();
+    const auto elapsed_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(end_clock -
+                                                              start_clock)
+            .count() *
+        1e-6;
+
+    std::printf("%s,%lu,%u,%lu,%e\n",
+                cuMpSGEMM_get_compute_mode_string(compute_mode), N, num_threads,
+                num_calls_per_thread,
+                num_threads * num_calls_per_thread / elapsed_time);
+    std::fflush(stdout);
+
+    for (unsigned t = 0; t < num_threads; t++) {
+      CUTF_CHECK_ERROR(cublasDestroy(cublas_handles[t]));
+      CUTF_CHECK_ERROR(cudaStreamDestroy(cuda_streams[t]));
+    }
+  }
+
+  cumpsgemm::hijack_control::unset_compute_mode();
+
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+}
+
+// Captures hijacked AUTO/FP16TCEC_SCALING GEMMs into a CUDA Graph and replays
+// it with inputs of different magnitudes so that the exp stats captured in the
+// graph are evaluated on every replay.
+void gemm_graph_test(const std::size_t N, const std::size_t num_gemms,
+                     const std::size_t num_replays) {
+  constexpr uint64_t seed = 0;
+  const std::size_t stride = N * N;
+  float *a_ptr = cutf::memory::malloc<float>(stride * num_gemms);
+  float *b_ptr = cutf::memory::malloc<float>(stride * num_gemms);
+  float *c_ptr = cutf::memory::malloc<float>(stride * num_gemms);
+
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), b_ptr,
+                                                 stride * num_gemms, 0, 1));
+
+  cudaStream_t cuda_stream;
+  CUTF_CHECK_ERROR(cudaStreamCreate(&cuda_stream));
+  cublasHandle_t cublas_handle;
+  CUTF_CHECK_ERROR(cublasCreate(&cublas_handle));
+  CUTF_CHECK_ERROR(cublasSetStream(cublas_handle, cuda_stream));
+
+  const float alpha = 1.f, beta = 0.f;
+  const auto gemm_loop = [&]() {
+    for (std::size_t i = 0; i < num_gemms; i++) {
+      CUTF_CHECK_ERROR(cublasSgemm(cublas_handle, CUBLAS_OP_N, CUBLAS_OP_N, N,
+                                   N, N, &alpha, a_ptr + i * stride, N,
+                                   b_ptr + i * stride, N, &beta,
+                                   c_ptr + i * stride, N));
+    }
+  };
+
+  std::printf("## %s\n", __func__);
+  std::printf("mode,N,num_gemms,replay,a_stddev,residual,check\n");
+  unsigned num_tests = 0;
+  unsigned num_passed = 0;
+  const std::vector<cuMpSGEMM_compute_mode_t> mode_list = {
+      CUMPSGEMM_AUTO, CUMPSGEMM_FP16TCEC_SCALING};
+  // Small values underflow in FP16 without scaling
+  const std::vector<float> a_stddev_list = {1, 1e-6f, 1e+3f};
+  for (const auto mode : mode_list) {
+    cumpsgemm::hijack_control::set_compute_mode(mode);
+    // The hijack handle is created outside the capture
+    gemm_loop();
+    CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
+
+    cudaGraph_t graph;
+    cudaGraphExec_t graph_exec;
+    CUTF_CHECK_ERROR(
+        cudaStreamBeginCapture(cuda_stream, cudaStreamCaptureModeGlobal));
+    gemm_loop();
+    CUTF_CHECK_ERROR(cudaStreamEndCapture(cuda_stream, &graph));
+    CUTF_CHECK_ERROR(
+        cudaGraphInstantiate(&graph_exec, graph, nullptr, nullptr, 0));
+
+    for (std::size_t r = 0; r < num_replays; r++) {
+      const auto a_stddev = a_stddev_list[r % a_stddev_list.size()];
+      CUTF_CHECK_ERROR(cutf::curand::generate_normal(
+          *curand_gen.get(), a_ptr, stride * num_gemms, 0, a_stddev));
+      CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+      CUTF_CHECK_ERROR(cudaGraphLaunch(graph_exec, cuda_stream));
+      CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
+
+      double residual = 0;
+      for (std::size_t i = 0; i < num_gemms; i++) {
+        residual += calc_matmul_residual(
+            CUBLAS_OP_N, CUBLAS_OP_N, N, N, N, alpha, a_ptr + i * stride, N,
+            b_ptr + i * stride, N, beta, reinterpret_cast<float *>(0), 0,
+            c_ptr + i * stride, N);
+      }
+      residual /= num_gemms;
+      const auto check = residual < error_threshold(CUMPSGEMM_FP16TCEC, N);
+      std::printf("%s,%lu,%lu,%lu,%e,%e,%s\n",
+                  cuMpSGEMM_get_compute_mode_string(mode), N, num_gemms, r,
+                  a_stddev, residual, (check ? "OK" : "NG"));
+      std::fflush(stdout);
+      num_tests++;
+      if (check) {
+        num_passed++;
+      }
+    }
+
+    // Launch overhead of the eager calls and the graph
+    constexpr unsigned num_timing_loops = 16;
+    auto start_clock = std::chrono::system_clock::now();
+    for (unsigned i = 0; i < num_timing_loops; i++) {
+      gemm_loop();
+    }
+    CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
+    auto end_clock = std::chrono::system_clock::now();
+    const auto eager_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(end_clock -
+                                                              start_clock)
+            .count() *
+        1e-6 / num_timing_loops;
+    start_clock = std::chrono::system_clock::now();
+    for (unsigned i = 0; i < num_timing_loops; i++) {
+      CUTF_CHECK_ERROR(cudaGraphLaunch(graph_exec, cuda_stream));
+    }
+    CUTF_CHECK_ERROR(cudaStreamSynchronize(cuda_stream));
+    end_clock = std::chrono::system_clock::now();
+    const auto graph_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(end_clock -
+                                                              start_clock)
+            .count() *
+        1e-6 / num_timing_loops;
+    std::printf("# %s: eager=%e s, graph=%e s\n",
+                cuMpSGEMM_get_compute_mode_string(mode), eager_time,
+                graph_time);
+    std::fflush(stdout);
+
+    CUTF_CHECK_ERROR(cudaGraphExecDestroy(graph_exec));
+    CUTF_CHECK_ERROR(cudaGraphDestroy(graph));
+  }
+  cumpsgemm::hijack_control::unset_compute_mode();
+
+  std::printf("Result : %u / %u passed\n", num_passed, num_tests);
+
+  CUTF_CHECK_ERROR(cublasDestroy(cublas_handle));
+  CUTF_CHECK_ERROR(cudaStreamDestroy(cuda_stream));
+
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+}
+
+// alpha and beta are given as device pointers (CUBLAS_POINTER_MODE_DEVICE)
+void gemm_pointer_mode_test(const std::size_t min_log_N,
+                            const std::size_t max_log_N,
+                            const std::vector<implementation_type> &imp_list) {
+  constexpr uint64_t seed = 0;
+  const std::size_t max_num_elements = 1lu << (2 * max_log_N);
+  float *a_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *b_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *c_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *r_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *scalar_ptr = cutf::memory::malloc<float>(2);
+
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), a_ptr,
+                                                 max_num_elements, 0, 1));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), b_ptr,
+                                                 max_num_elements, 0, 1));
+
+  std::printf("## %s\n", __func__);
+  std::printf("type,mode,op_A,op_B,m,n,k,alpha,beta,residual,check\n");
+  unsigned num_tests = 0;
+  unsigned num_passed = 0;
+  cumpsgemm::handle_t cuMpSGEMM_handle;
+  cumpsgemm::create(cuMpSGEMM_handle);
+  cumpsgemm::set_pointer_mode(cuMpSGEMM_handle, CUBLAS_POINTER_MODE_DEVICE);
+
+  const std::vector<cublasOperation_t> ops = {CUBLAS_OP_N, CUBLAS_OP_T};
+  const std::vector<std::pair<float, float>> scalar_list = {{1.f, 0.f},
+                                                            {2.f, 0.5f}};
+  for (const auto imp : imp_list) {
+    const auto mode = get_compute_mode(imp);
+    if (mode == CUMPSGEMM_CUBLAS || is_scaling_enabled(imp)) {
+      continue;
+    }
+    for (const auto op_A : ops) {
+      for (const auto op_B : ops) {
+        for (std::size_t log_N = min_log_N; log_N <= max_log_N; log_N++) {
+          const unsigned N = 1u << log_N;
+          for (const auto scalar : scalar_list) {
+            const float scalars[] = {scalar.first, scalar.second};
+            cutf::memory::copy(scalar_ptr, scalars, 2);
+            CUTF_CHECK_ERROR(cutf::curand::generate_normal(
+                *curand_gen.get(), c_ptr, N * N, 0, 1));
+            copy_matrix(r_ptr, N, c_ptr, N, N, N);
+
+            cumpsgemm::gemm(cuMpSGEMM_handle, op_A, op_B, N, N, N,
+                            scalar_ptr, a_ptr, N, b_ptr, N, scalar_ptr + 1,
+                            c_ptr, N, mode);
+            CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+
+            const auto residual = calc_matmul_residual(
+                op_A, op_B, N, N, N, scalar.first, a_ptr, N, b_ptr, N,
+                scalar.second, r_ptr, N, c_ptr, N);
+            const auto check = residual < error_threshold(mode, N);
+            std::printf("sgemm,%s,%s,%s,%u,%u,%u,%e,%e,%e,%s\n",
+                        cuMpSGEMM_get_compute_mode_string(mode),
+                        (op_A == CUBLAS_OP_N) ? "N" : "T",
+                        (op_B == CUBLAS_OP_N) ? "N" : "T", N, N, N,
+                        scalar.first, scalar.second, residual,
+                        (check ? "OK" : "NG"));
+            std::fflush(stdout);
+            num_tests++;
+            if (check) {
+              num_passed++;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::printf("Result : %u / %u passed\n", num_passed, num_tests);
+
+  cumpsgemm::destroy(cuMpSGEMM_handle);
+
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+  cutf::memory::free(r_ptr);
+  cutf::memory::free(scalar_ptr);
+}
+
+// Each shape is run `num_repeats` times and the bit patterns of C are compared
+// with the first run. The throughput is reported for both of the modes.
+void gemm_deterministic_test(const std::size_t num_repeats,
+                             const std::vector<implementation_type> &imp_list) {
+  constexpr uint64_t seed = 0;
+  struct shape_t {
+    const char *name;
+    std::size_t m, n, k, batch_count;
+  };
+  const std::vector<shape_t> shape_list = {
+      {"square", 2048, 2048, 2048, 1},
+      {"tall_skinny", 16384, 64, 1024, 1},
+      // Split-K
+      {"small_mn_large_k", 128, 128, 65536, 1},
+      // Stream-K
+      {"partial_wave", 1536, 1536, 1536, 1},
+      {"strided_batch", 256, 256, 256, 64},
+      // The GEMMs beyond the y limit of the grid
+      {"many_batches", 16, 16, 64, 70000},
+      // m * n > 2^24
+      {"large_strided_batch", 8192, 4096, 256, 2},
+  };
+
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+
+  std::printf("## %s\n", __func__);
+  std::printf("mode,shape,m,n,k,batch_count,deterministic,"
+              "throughput_in_tflops,num_mismatches,check\n");
+  unsigned num_tests = 0;
+  unsigned num_passed = 0;
+  cumpsgemm::handle_t cuMpSGEMM_handle;
+  cumpsgemm::create(cuMpSGEMM_handle);
+
+  const float alpha = 1.f, beta = 0.f;
+  for (const auto imp : imp_list) {
+    const auto mode = get_compute_mode(imp);
+    if (mode == CUMPSGEMM_CUBLAS || is_scaling_enabled(imp)) {
+      continue;
+    }
+    for (const auto &shape : shape_list) {
+      const auto m = shape.m, n = shape.n, k = shape.k;
+      const auto batch_count = shape.batch_count;
+      float *a_ptr = cutf::memory::malloc<float>(m * k * batch_count);
+      float *b_ptr = cutf::memory::malloc<float>(k * n * batch_count);
+      float *c_ptr = cutf::memory::malloc<float>(m * n * batch_count);
+      CUTF_CHECK_ERROR(cutf::curand::generate_normal(
+          *curand_gen.get(), a_ptr, m * k * batch_count, 0, 1));
+      CUTF_CHECK_ERROR(cutf::curand::generate_normal(
+          *curand_gen.get(), b_ptr, k * n * batch_count, 0, 1));
+      std::vector<float> ref(m * n * batch_count), out(m * n * batch_count);
+
+      const auto run = [&]() {
+        if (batch_count == 1) {
+          cumpsgemm::gemm(cuMpSGEMM_handle, CUBLAS_OP_N, CUBLAS_OP_N, m, n, k,
+                          &alpha, a_ptr, m, b_ptr, k, &beta, c_ptr, m, mode);
+        } else {
+          cumpsgemm::gemm_stridedBatch(
+              cuMpSGEMM_handle, CUBLAS_OP_N, CUBLAS_OP_N, m, n, k, &alpha,
+              a_ptr, m, m * k, b_ptr, k, k * n, &beta, c_ptr, m, m * n,
+              batch_count, mode);
+        }
+      };
+
+      for (const auto deterministic : {false, true}) {
+        cumpsgemm::set_deterministic_mode(cuMpSGEMM_handle, deterministic);
+        run();
+        CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+        cutf::memory::copy(ref.data(), c_ptr, ref.size());
+
+        const auto start_clock = std::chrono::system_clock::now();
+        for (std::size_t r = 0; r < num_repeats; r++) {
+          run();
+        }
+        CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+        const auto end_clock = std::chrono::system_clock::now();
+        const auto elapsed_time =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end_clock -
+                                                                 start_clock)
+                .count() *
+            1e-9 / num_repeats;
+
+        unsigned num_mismatches = 0;
+        for (std::size_t r = 0; r < num_repeats; r++) {
+          run();
+          cutf::memory::copy(out.data(), c_ptr, out.size());
+          if (std::memcmp(out.data(), ref.data(),
+                          sizeof(float) * out.size()) != 0) {
+            num_mismatches++;
+          }
+        }
+
+        // Only the deterministic mode is required to be reproducible
+        const auto check = !deterministic || num_mismatches == 0;
+        std::printf("%s,%s,%lu,%lu,%lu,%lu,%d,%e,%u,%s\n",
+                    cuMpSGEMM_get_compute_mode_string(mode), shape.name, m, n,
+                    k, batch_count, deterministic ? 1 : 0,
+                    2. * m * n * k * batch_count / elapsed_time * 1e-12,
+                    num_mismatches, (check ? "OK" : "NG"));
+        std::fflush(stdout);
+        num_tests++;
+        if (check) {
+          num_passed++;
+        }
+      }
+
+      cutf::memory::free(a_ptr);
+      cutf::memory::free(b_ptr);
+      cutf::memory::free(c_ptr);
+    }
+  }
+
+  std::printf("Result : %u / %u passed\n", num_passed, num_tests);
+
+  cumpsgemm::destroy(cuMpSGEMM_handle);
+}
+
+// The throughput of the group widths of the tile order for large GEMMs. The C
+// of every width is compared with the column-major order (width 0) bitwise in
+// the deterministic mode. The L2 hit rate is measured by running this command
+// under `ncu --metrics lts__t_sector_hit_rate.pct`.
+void gemm_raster_test(const std::size_t num_repeats,
+                      const std::vector<implementation_type> &imp_list) {
+  constexpr uint64_t seed = 0;
+  const std::vector<std::size_t> N_list = {8192, 12288, 16384};
+  const std::vector<unsigned> group_width_list = {0, 4, 8, 16};
+  const std::size_t max_num_elements = N_list.back() * N_list.back();
+  float *a_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *b_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *c_ptr = cutf::memory::malloc<float>(max_num_elements);
+
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), a_ptr,
+                                                 max_num_elements, 0, 1));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), b_ptr,
+                                                 max_num_elements, 0, 1));
+
+  std::printf("## %s\n", __func__);
+  std::printf("mode,N,group_width,throughput_in_tflops,speedup,check\n");
+  unsigned num_tests = 0;
+  unsigned num_passed = 0;
+  cumpsgemm::handle_t cuMpSGEMM_handle;
+  cumpsgemm::create(cuMpSGEMM_handle);
+  cumpsgemm::set_deterministic_mode(cuMpSGEMM_handle, true);
+
+  const float alpha = 1.f, beta = 0.f;
+  for (const auto imp : imp_list) {
+    const auto mode = get_compute_mode(imp);
+    if (mode == CUMPSGEMM_CUBLAS || is_scaling_enabled(imp)) {
+      continue;
+    }
+    for (const auto N : N_list) {
+      const auto run = [&]() {
+        cumpsgemm::gemm(cuMpSGEMM_handle, CUBLAS_OP_N, CUBLAS_OP_N, N, N, N,
+                        &alpha, a_ptr, N, b_ptr, N, &beta, c_ptr, N, mode);
+      };
+      std::vector<float> ref(N * N), out(N * N);
+      double base_throughput = 0;
+      for (const auto group_width : group_width_list) {
+        cumpsgemm::set_raster_group_width(cuMpSGEMM_handle, group_width);
+        run();
+        CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+        cutf::memory::copy(out.data(), c_ptr, out.size());
+        if (group_width == 0) {
+          ref = out;
+        }
+
+        const auto start_clock = std::chrono::system_clock::now();
+        for (std::size_t r = 0; r < num_repeats; r++) {
+          run();
+        }
+        CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+        const auto end_clock = std::chrono::system_clock::now();
+        const auto elapsed_time =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end_clock -
+                                                                 start_clock)
+                .count() *
+            1e-9 / num_repeats;
+        const auto throughput = 2. * N * N * N / elapsed_time * 1e-12;
+        if (group_width == 0) {
+          base_throughput = throughput;
+        }
+
+        const auto check = std::memcmp(out.data(), ref.data(),
+                                       sizeof(float) * out.size()) == 0;
+        std::printf("%s,%lu,%u,%e,%e,%s\n",
+                    cuMpSGEMM_get_compute_mode_string(mode), N, group_width,
+                    throughput, throughput / base_throughput,
+                    (check ? "OK" : "NG"));
+        std::fflush(stdout);
+        num_tests++;
+        if (check) {
+          num_passed++;
+        }
+      }
+    }
+  }
+
+  std::printf("Result : %u / %u passed\n", num_passed, num_tests);
+
+  cumpsgemm::destroy(cuMpSGEMM_handle);
+
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+}
+
+// The matrices are used in the reverse order so that the pointer lists are not
+// equivalent to a strided batch
+template <class T>
+void gemm_batched_test_core(const std::size_t min_log_N,
+                            const std::size_t max_log_N,
+                            const std::size_t batch_count,
+                            const std::vector<implementation_type> &imp_list,
+                            const std::vector<cublasOperation_t> &ops,
+                            unsigned &num_tests, unsigned &num_passed) {
+  constexpr uint64_t seed = 0;
+  const std::size_t stride = 1lu << (2 * max_log_N);
+  const std::size_t max_num_elements =
+      stride * batch_count * (std::is_same<T, float>::value ? 1 : 2);
+  float *a_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *b_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *c_ptr = cutf::memory::malloc<float>(max_num_elements);
+
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), a_ptr,
+                                                 max_num_elements, 0, 1));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), b_ptr,
+                                                 max_num_elements, 0, 1));
+
+  const auto a_mat_ptr = reinterpret_cast<T *>(a_ptr);
+  const auto b_mat_ptr = reinterpret_cast<T *>(b_ptr);
+  const auto c_mat_ptr = reinterpret_cast<T *>(c_ptr);
+  std::vector<const T *> a_ptr_list(batch_count), b_ptr_list(batch_count);
+  std::vector<T *> c_ptr_list(batch_count);
+  for (std::size_t i = 0; i < batch_count; i++) {
+    const auto j = batch_count - 1 - i;
+    a_ptr_list[i] = a_mat_ptr + j * stride;
+    b_ptr_list[i] = b_mat_ptr + j * stride;
+    c_ptr_list[i] = c_mat_ptr + j * stride;
+  }
+  auto a_ptr_list_dev = cutf::memory::malloc<const T *>(batch_count);
+  auto b_ptr_list_dev = cutf::memory::malloc<const T *>(batch_count);
+  auto c_ptr_list_dev = cutf::memory::malloc<T *>(batch_count);
+  cutf::memory::copy(a_ptr_list_dev, a_ptr_list.data(), batch_count);
+  cutf::memory::copy(b_ptr_list_dev, b_ptr_list.data(), batch_count);
+  cutf::memory::copy(c_ptr_list_dev, c_ptr_list.data(), batch_count);
+
+  cumpsgemm::handle_t cuMpSGEMM_handle;
+  cumpsgemm::create(cuMpSGEMM_handle);
+
+  const auto alpha = one<T>(), beta = zero<T>();
+  for (const auto imp : imp_list) {
+    const auto mode = get_compute_mode(imp);
+    if (mode == CUMPSGEMM_CUBLAS || is_scaling_enabled(imp)) {
+      continue;
+    }
+    for (const auto op_A : ops) {
+      for (const auto op_B : ops) {
+        for (std::size_t log_N = min_log_N; log_N <= max_log_N; log_N++) {
+          const unsigned N = 1u << log_N;
+          unsigned module_stage = 0;
+          cumpsgemm::gemm_batchPtr(cuMpSGEMM_handle, op_A, op_B, N, N, N,
+                                   &alpha, a_ptr_list_dev, N, b_ptr_list_dev,
+                                   N, &beta, c_ptr_list_dev, N, batch_count,
+                                   mode, &module_stage);
+          CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+
+          double residual = 0;
+          for (std::size_t b = 0; b < batch_count; b++) {
+            residual += calc_matmul_residual(
+                op_A, op_B, N, N, N, alpha, a_ptr_list[b], N, b_ptr_list[b],
+                N, beta, reinterpret_cast<T *>(0), 0, c_ptr_list[b], N);
+          }
+          residual /= batch_count;
+          const auto check = residual < error_threshold(mode, N);
+          std::printf(
+              "%s,%s,%s,%s,%u,%u,%u,%lu,%e,%s,%u\n",
+              (std::is_same<float, T>::value ? "sgemm" : "cgemm"),
+              cuMpSGEMM_get_compute_mode_string(mode),
+              (op_A == CUBLAS_OP_N) ? "N"
+                                    : ((op_A == CUBLAS_OP_T) ? "T" : "C"),
+              (op_B == CUBLAS_OP_N) ? "N"
+                                    : ((op_B == CUBLAS_OP_T) ? "T" : "C"),
+              N, N, N, batch_count, residual, (check ? "OK" : "NG"),
+              module_stage);
+          std::fflush(stdout);
+          num_tests++;
+          if (check) {
+            num_passed++;
+          }
+        }
+      }
+    }
+  }
+
+  cumpsgemm::destroy(cuMpSGEMM_handle);
+
+  cutf::memory::free(a_ptr_list_dev);
+  cutf::memory::free(b_ptr_list_dev);
+  cutf::memory::free(c_ptr_list_dev);
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+}
+
+void gemm_batched_test(const std::size_t min_log_N, const std::size_t max_log_N,
+                       const std::size_t batch_count,
+                       const std::vector<implementation_type> &imp_list,
+                       const gemm_type gemm) {
+  std::printf("## %s\n", __func__);
+  std::printf("type,mode,op_A,op_B,m,n,k,batch_count,residual,check,module_"
+              "stage\n");
+  unsigned num_tests = 0;
+  unsigned num_passed = 0;
+  if (gemm == gemm_type::s) {
+    gemm_batched_test_core<float>(min_log_N, max_log_N, batch_count, imp_list,
+                                  {CUBLAS_OP_N, CUBLAS_OP_T}, num_tests,
+                                  num_passed);
+  } else {
+    gemm_batched_test_core<cuComplex>(
+        min_log_N, max_log_N, batch_count, imp_list,
+        {CUBLAS_OP_N, CUBLAS_OP_T, CUBLAS_OP_C}, num_tests, num_passed);
+  }
+  std::printf("Result : %u / %u passed\n", num_passed, num_tests);
+}
+
+// cublasLtMatmul with strided batched layouts is run by the hijacking library
+void gemm_lt_test(const std::size_t min_log_N, const std::size_t max_log_N,
+                  const std::size_t batch_count,
+                  const std::vector<implementation_type> &imp_list) {
+  constexpr uint64_t seed = 0;
+  const std::size_t stride = 1lu << (2 * max_log_N);
+  const std::size_t max_num_elements = stride * batch_count;
+  float *a_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *b_ptr = cutf::memory::malloc<float>(max_num_elements);
+  float *c_ptr = cutf::memory::malloc<float>(max_num_elements);
+
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), a_ptr,
+                                                 max_num_elements, 0, 1));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(*curand_gen.get(), b_ptr,
+                                                 max_num_elements, 0, 1));
+
+  cublasLtHandle_t lt_handle;
+  CUTF_CHECK_ERROR(cublasLtCreate(&lt_handle));
+
+  std::printf("## %s\n", __func__);
+  std::printf(
+      "type,mode,op_A,op_B,m,n,k,batch_count,residual,check,hijacked\n");
+  unsigned num_tests = 0;
+  unsigned num_passed = 0;
+
+  const float alpha = 1.f, beta = 0.f;
+  const std::vector<cublasOperation_t> ops = {CUBLAS_OP_N, CUBLAS_OP_T};
+  for (const auto imp : imp_list) {
+    const auto mode = static_cast<cuMpSGEMM_compute_mode_t>(imp);
+    cumpsgemm::hijack_control::set_compute_mode(mode);
+    for (const auto op_A : ops) {
+      for (const auto op_B : ops) {
+        for (std::size_t log_N = min_log_N; log_N <= max_log_N; log_N++) {
+          const uint64_t N = 1lu << log_N;
+          const int32_t lt_batch_count = batch_count;
+          const int64_t lt_stride = stride;
+
+          cublasLtMatmulDesc_t matmul_desc;
+          CUTF_CHECK_ERROR(cublasLtMatmulDescCreate(
+              &matmul_desc, CUBLAS_COMPUTE_32F, CUDA_R_32F));
+          CUTF_CHECK_ERROR(cublasLtMatmulDescSetAttribute(
+              matmul_desc, CUBLASLT_MATMUL_DESC_TRANSA, &op_A, sizeof(op_A)));
+          CUTF_CHECK_ERROR(cublasLtMatmulDescSetAttribute(
+              matmul_desc, CUBLASLT_MATMUL_DESC_TRANSB, &op_B, sizeof(op_B)));
+          cublasLtMatrixLayout_t layout;
+          CUTF_CHECK_ERROR(
+              cublasLtMatrixLayoutCreate(&layout, CUDA_R_32F, N, N, N));
+          CUTF_CHECK_ERROR(cublasLtMatrixLayoutSetAttribute(
+              layout, CUBLASLT_MATRIX_LAYOUT_BATCH_COUNT, &lt_batch_count,
+              sizeof(lt_batch_count)));
+          CUTF_CHECK_ERROR(cublasLtMatrixLayoutSetAttribute(
+              layout, CUBLASLT_MATRIX_LAYOUT_STRIDED_BATCH_OFFSET, &lt_stride,
+              sizeof(lt_stride)));
+
+          cumpsgemm::hijack_control::clear_last_called_function_str();
+          CUTF_CHECK_ERROR(cublasLtMatmul(
+              lt_handle, matmul_desc, &alpha, a_ptr, layout, b_ptr, layout,
+              &beta, c_ptr, layout, c_ptr, layout, nullptr, nullptr, 0, 0));
+          CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+          const auto hijacked =
+              cumpsgemm::hijack_control::get_last_called_function_str().find(
+                  "cublasLtMatmul") == 0;
+
+          CUTF_CHECK_ERROR(cublasLtMatrixLayoutDestroy(layout));
+          CUTF_CHECK_ERROR(cublasLtMatmulDescDestroy(matmul_desc));
+
+          double residual = 0;
+          for (std::size_t b = 0; b < batch_count; b++) {
+            residual += calc_matmul_residual(
+                op_A, op_B, N, N, N, alpha, a_ptr + b * stride, N,
+                b_ptr + b * stride, N, beta, reinterpret_cast<float *>(0), 0,
+                c_ptr + b * stride, N);
+          }
+          residual /= batch_count;
+          const auto check =
+              residual < error_threshold(get_compute_mode(imp), N) && hijacked;
+          std::printf("sgemm,%s,%s,%s,%lu,%lu,%lu,%lu,%e,%s,%d\n",
+                      get_implementation_type_name_str(imp).c_str(),
+                      (op_A == CUBLAS_OP_N) ? "N" : "T",
+                      (op_B == CUBLAS_OP_N) ? "N" : "T", N, N, N, batch_count,
+                      residual, (check ? "OK" : "NG"), hijacked);
+          std::fflush(stdout);
+          num_tests++;
+          if (check) {
+            num_passed++;
+          }
+        }
+      }
+    }
+  }
+  cumpsgemm::hijack_control::unset_compute_mode();
+
+  std::printf("Result : %u / %u passed\n", num_passed, num_tests);
+
+  CUTF_CHECK_ERROR(cublasLtDestroy(lt_handle));
+
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+}
+
 void print_usage(const char *program_name) {
   std::fprintf(
       stderr,
@@ -1354,6 +2091,7 @@ void print_usage(const char *program_name) {
       "      : %s cgemm_strided_batch [exp2|seq] [min_N] [max_N] [interval] "
       "[batch_count] [compute mode list...]\n"
       "      : %s log [/path/to/log]\n"
+      "      : %s replay [/path/to/capture] [RULE|compute mode list...]\n"
       "      : %s sgemm_exp_stats [N] [ignore_threshold] "
       "[underflow_threshold]\n"
       "      : %s cgemm_exp_stats [N] [ignore_threshold] "
@@ -1368,11 +2106,26 @@ void print_usage(const char *program_name) {
       "[compute mode list...]\n"
       "      : %s cgemm_tall_skinny [exp2|seq] [MN] [min_K] [max_K] [interval] "
       "[compute mode list...]\n"
+      "      : %s hijack_mt_bench [max_num_threads] [N] [num_calls_per_thread] "
+      "[DRY_RUN|compute mode]\n"
+      "      : %s sgemm_pointer_mode [min_log_N] [max_log_N] [compute mode "
+      "list...]\n"
+      "      : %s sgemm_batched [min_log_N] [max_log_N] [batch_count] "
+      "[compute mode list...]\n"
+      "      : %s cgemm_batched [min_log_N] [max_log_N] [batch_count] "
+      "[compute mode list...]\n"
+      "      : %s sgemm_lt [min_log_N] [max_log_N] [batch_count] [compute "
+      "mode list...]\n"
+      "      : %s sgemm_graph [N] [num_gemms] [num_replays]\n"
+      "      : %s sgemm_deterministic [num_repeats] [compute mode list...]\n"
+      "      : %s sgemm_raster [num_repeats] [compute mode list...]\n"
       "- compute mode : FP16TCEC, TF32TCEC, FP16TC, TF32TC, FP16TCEC_SCALING, "
-      "CUBLAS\n",
+      "BF16TCEC, CUBLAS\n",
+      program_name, program_name, program_name, program_name, program_name,
       program_name, program_name, program_name, program_name, program_name,
       program_name, program_name, program_name, program_name, program_name,
-      program_name, program_name, program_name);
+      program_name, program_name, program_name, program_name, program_name,
+      program_name, program_name);
   std::fflush(stderr);
 }
 
@@ -1394,6 +2147,8 @@ gen_implementation_list(const char *const *argv_implementation_list_start_ptr,
       imp_list.push_back(TF32TC);
     } else if (imp_name_str == "FP16TCEC_SCALING") {
       imp_list.push_back(FP16TCEC_SCALING);
+    } else if (imp_name_str == "BF16TCEC") {
+      imp_list.push_back(BF16TCEC);
     } else {
       std::printf("Unknown compute mode : %s\n", imp_name_str.c_str());
     }
@@ -1411,6 +2166,399 @@ void print_implementation_type_list(
   std::fflush(stdout);
 }
 
+// Workload replay of a file captured by CUMPSGEMM_CAPTURE
+bool is_pointer_array_call(const cumpsgemm::capture::call_t &call) {
+  const std::string func_name =
+      call.func_id < cumpsgemm::trace::num_funcs
+          ? cumpsgemm::trace::func_name_list[call.func_id]
+          : "";
+  return func_name == "cublasSgemmBatched" ||
+         func_name == "cublasCgemmBatched" ||
+         func_name == "cublasGemmBatchedEx";
+}
+
+// The number of floats of a matrix (and its batches) of a captured call.
+// The matrices of a pointer-array batched call are not overlapped.
+std::size_t get_replay_num_elements(const cumpsgemm::capture::call_t &call,
+                                    const std::uint64_t ld,
+                                    const std::uint64_t cols,
+                                    const std::uint64_t stride) {
+  const std::size_t matrix_stride =
+      is_pointer_array_call(call) ? ld * cols : stride;
+  return (call.is_complex ? 2 : 1) *
+         (ld * cols + matrix_stride * (call.batch_count - 1));
+}
+
+// The scalars in the device memory are replayed with the default values
+float get_replay_scalar(const std::uint8_t scalar_class,
+                        const float default_value) {
+  switch (scalar_class) {
+  case cumpsgemm::capture::scalar_zero:
+    return 0;
+  case cumpsgemm::capture::scalar_one:
+    return 1;
+  case cumpsgemm::capture::scalar_other:
+    return 0.5f;
+  default:
+    return default_value;
+  }
+}
+
+// cublasLtMatmul is replayed by cublasGemmEx or cublasGemmStridedBatchedEx
+void replay_call(cublasHandle_t const cublas_handle,
+                 const cumpsgemm::capture::call_t &call,
+                 const float *const a_ptr, const float *const b_ptr,
+                 float *const c_ptr, void *const *const ptr_array) {
+  const std::string func_name =
+      call.func_id < cumpsgemm::trace::num_funcs
+          ? cumpsgemm::trace::func_name_list[call.func_id]
+          : "";
+  const auto op_A = static_cast<cublasOperation_t>(call.op_A);
+  const auto op_B = static_cast<cublasOperation_t>(call.op_B);
+  const auto data_type = call.is_complex ? CUDA_C_32F : CUDA_R_32F;
+  const auto m = call.m, n = call.n, k = call.k;
+  const auto lda = call.lda, ldb = call.ldb, ldc = call.ldc;
+
+  const float alpha_r = get_replay_scalar(call.alpha_class, 1);
+  const float beta_r = get_replay_scalar(call.beta_class, 0);
+  const auto alpha_c = make_cuComplex(alpha_r, 0);
+  const auto beta_c = make_cuComplex(beta_r, 0);
+  const void *const alpha =
+      call.is_complex ? static_cast<const void *>(&alpha_c) : &alpha_r;
+  const void *const beta =
+      call.is_complex ? static_cast<const void *>(&beta_c) : &beta_r;
+
+  const auto a_c_ptr = reinterpret_cast<const cuComplex *>(a_ptr);
+  const auto b_c_ptr = reinterpret_cast<const cuComplex *>(b_ptr);
+  const auto c_c_ptr = reinterpret_cast<cuComplex *>(c_ptr);
+  const auto batch_count = call.batch_count;
+  const auto a_ptr_list = ptr_array;
+  const auto b_ptr_list = ptr_array + batch_count;
+  const auto c_ptr_list = ptr_array + 2 * batch_count;
+
+  if (func_name == "cublasSgemm_v2") {
+    CUTF_CHECK_ERROR(cublasSgemm(cublas_handle, op_A, op_B, m, n, k, &alpha_r,
+                                 a_ptr, lda, b_ptr, ldb, &beta_r, c_ptr, ldc));
+  } else if (func_name == "cublasCgemm_v2") {
+    CUTF_CHECK_ERROR(cublasCgemm(cublas_handle, op_A, op_B, m, n, k, &alpha_c,
+                                 a_c_ptr, lda, b_c_ptr, ldb, &beta_c, c_c_ptr,
+                                 ldc));
+  } else if (func_name == "cublasSgemmStridedBatched") {
+    CUTF_CHECK_ERROR(cublasSgemmStridedBatched(
+        cublas_handle, op_A, op_B, m, n, k, &alpha_r, a_ptr, lda, call.stridea,
+        b_ptr, ldb, call.strideb, &beta_r, c_ptr, ldc, call.stridec,
+        batch_count));
+  } else if (func_name == "cublasCgemmStridedBatched") {
+    CUTF_CHECK_ERROR(cublasCgemmStridedBatched(
+        cublas_handle, op_A, op_B, m, n, k, &alpha_c, a_c_ptr, lda,
+        call.stridea, b_c_ptr, ldb, call.strideb, &beta_c, c_c_ptr, ldc,
+        call.stridec, batch_count));
+  } else if (func_name == "cublasSgemmBatched") {
+    CUTF_CHECK_ERROR(cublasSgemmBatched(
+        cublas_handle, op_A, op_B, m, n, k, &alpha_r,
+        reinterpret_cast<const float *const *>(a_ptr_list), lda,
+        reinterpret_cast<const float *const *>(b_ptr_list), ldb, &beta_r,
+        reinterpret_cast<float *const *>(c_ptr_list), ldc, batch_count));
+  } else if (func_name == "cublasCgemmBatched") {
+    CUTF_CHECK_ERROR(cublasCgemmBatched(
+        cublas_handle, op_A, op_B, m, n, k, &alpha_c,
+        reinterpret_cast<const cuComplex *const *>(a_ptr_list), lda,
+        reinterpret_cast<const cuComplex *const *>(b_ptr_list), ldb, &beta_c,
+        reinterpret_cast<cuComplex *const *>(c_ptr_list), ldc, batch_count));
+  } else if (func_name == "cublasGemmBatchedEx") {
+    CUTF_CHECK_ERROR(cublasGemmBatchedEx(
+        cublas_handle, op_A, op_B, m, n, k, alpha, a_ptr_list, data_type, lda,
+        b_ptr_list, data_type, ldb, beta, c_ptr_list, data_type, ldc,
+        batch_count, CUBLAS_COMPUTE_32F, CUBLAS_GEMM_DEFAULT));
+  } else if (func_name == "cublasGemmStridedBatchedEx" || batch_count > 1) {
+    CUTF_CHECK_ERROR(cublasGemmStridedBatchedEx(
+        cublas_handle, op_A, op_B, m, n, k, alpha, a_ptr, data_type, lda,
+        call.stridea, b_ptr, data_type, ldb, call.strideb, beta, c_ptr,
+        data_type, ldc, call.stridec, batch_count, CUBLAS_COMPUTE_32F,
+        CUBLAS_GEMM_DEFAULT));
+  } else {
+    CUTF_CHECK_ERROR(cublasGemmEx(cublas_handle, op_A, op_B, m, n, k, alpha,
+                                  a_ptr, data_type, lda, b_ptr, data_type, ldb,
+                                  beta, c_ptr, data_type, ldc,
+                                  CUBLAS_COMPUTE_32F, CUBLAS_GEMM_DEFAULT));
+  }
+}
+
+// Replays the captured calls under each compute mode
+//   - seq : all calls on a stream in the captured order
+//   - conc: the calls of each captured thread on a thread with the captured
+//           streams
+// "RULE" replays with the rule of this process instead of a fixed mode.
+void replay_test(const std::string capture_path,
+                 const std::vector<std::string> &mode_name_list) {
+  constexpr uint64_t seed = 0;
+  const auto calls = cumpsgemm::capture::load(capture_path);
+  if (calls.empty()) {
+    std::printf("No calls in %s\n", capture_path.c_str());
+    return;
+  }
+
+  // The calls of each captured thread
+  std::map<std::uint32_t, std::vector<std::size_t>> thread_call_list;
+  std::map<std::uint32_t, cudaStream_t> stream_map;
+  // The pairs of a captured thread and a stream, which run concurrently in the
+  // concurrent replay
+  std::map<std::pair<std::uint32_t, std::uint32_t>, std::size_t> lane_map;
+  std::size_t max_a_size = 0, max_b_size = 0, max_c_size = 0;
+  for (std::size_t i = 0; i < calls.size(); i++) {
+    const auto &call = calls[i];
+    thread_call_list[call.thread_id].push_back(i);
+    stream_map[call.stream_id] = nullptr;
+    lane_map.insert(
+        std::make_pair(std::make_pair(call.thread_id, call.stream_id), 0));
+    const auto a_cols = call.op_A == CUBLAS_OP_N ? call.k : call.m;
+    const auto b_cols = call.op_B == CUBLAS_OP_N ? call.n : call.k;
+    max_a_size =
+        std::max(max_a_size,
+                 get_replay_num_elements(call, call.lda, a_cols, call.stridea));
+    max_b_size =
+        std::max(max_b_size,
+                 get_replay_num_elements(call, call.ldb, b_cols, call.strideb));
+    max_c_size =
+        std::max(max_c_size,
+                 get_replay_num_elements(call, call.ldc, call.n, call.stridec));
+  }
+  const auto num_threads = thread_call_list.size();
+  std::size_t num_lanes = 0;
+  for (auto &lane : lane_map) {
+    lane.second = num_lanes++;
+  }
+
+  // AUTO and FP16TCEC_SCALING scale A and B in place, so each lane has its own
+  // A, B, C and pointer arrays. The pointer arrays are shared among the calls
+  // with the same layout.
+  float *a_ptr = cutf::memory::malloc<float>(max_a_size * num_lanes);
+  float *b_ptr = cutf::memory::malloc<float>(max_b_size * num_lanes);
+  float *c_ptr = cutf::memory::malloc<float>(max_c_size * num_lanes);
+  auto curand_gen =
+      cutf::curand::get_curand_unique_ptr(CURAND_RNG_PSEUDO_PHILOX4_32_10);
+  CUTF_CHECK_ERROR(curandSetPseudoRandomGeneratorSeed(*curand_gen.get(), seed));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(
+      *curand_gen.get(), a_ptr, max_a_size * num_lanes, 0, 1));
+  CUTF_CHECK_ERROR(cutf::curand::generate_normal(
+      *curand_gen.get(), b_ptr, max_b_size * num_lanes, 0, 1));
+  CUTF_CHECK_ERROR(
+      cudaMemset(c_ptr, 0, sizeof(float) * max_c_size * num_lanes));
+
+  std::vector<float *> call_a_ptr(calls.size());
+  std::vector<float *> call_b_ptr(calls.size());
+  std::vector<float *> call_c_ptr(calls.size());
+  std::vector<std::size_t> call_ptr_array_offset(calls.size());
+  std::vector<void *> ptr_array_host;
+  std::map<std::tuple<std::size_t, std::size_t, std::size_t, std::size_t,
+                      std::size_t>,
+           std::size_t>
+      ptr_array_offset_map;
+  for (const auto &thread_calls : thread_call_list) {
+    for (const auto i : thread_calls.second) {
+      const auto &call = calls[i];
+      const auto lane_index =
+          lane_map.at(std::make_pair(call.thread_id, call.stream_id));
+      const auto lane_a_ptr = a_ptr + max_a_size * lane_index;
+      const auto lane_b_ptr = b_ptr + max_b_size * lane_index;
+      const auto lane_c_ptr = c_ptr + max_c_size * lane_index;
+      call_a_ptr[i] = lane_a_ptr;
+      call_b_ptr[i] = lane_b_ptr;
+      call_c_ptr[i] = lane_c_ptr;
+      if (!is_pointer_array_call(call)) {
+        continue;
+      }
+      const std::size_t num_e = call.is_complex ? 2 : 1;
+      const std::size_t a_stride =
+          call.lda * (call.op_A == CUBLAS_OP_N ? call.k : call.m) * num_e;
+      const std::size_t b_stride =
+          call.ldb * (call.op_B == CUBLAS_OP_N ? call.n : call.k) * num_e;
+      const std::size_t c_stride = call.ldc * call.n * num_e;
+      const auto key = std::make_tuple(lane_index, a_stride, b_stride,
+                                       c_stride, call.batch_count);
+      const auto it = ptr_array_offset_map.find(key);
+      if (it != ptr_array_offset_map.end()) {
+        call_ptr_array_offset[i] = it->second;
+        continue;
+      }
+      const auto offset = ptr_array_host.size();
+      for (std::size_t b = 0; b < call.batch_count; b++) {
+        ptr_array_host.push_back(lane_a_ptr + b * a_stride);
+      }
+      for (std::size_t b = 0; b < call.batch_count; b++) {
+        ptr_array_host.push_back(lane_b_ptr + b * b_stride);
+      }
+      for (std::size_t b = 0; b < call.batch_count; b++) {
+        ptr_array_host.push_back(lane_c_ptr + b * c_stride);
+      }
+      ptr_array_offset_map.insert(std::make_pair(key, offset));
+      call_ptr_array_offset[i] = offset;
+    }
+  }
+  ptr_array_host.push_back(nullptr);
+  void **ptr_array = cutf::memory::malloc<void *>(ptr_array_host.size());
+  cutf::memory::copy(ptr_array, ptr_array_host.data(), ptr_array_host.size());
+
+  std::vector<cublasHandle_t> cublas_handles(num_threads + 1);
+  for (auto &cublas_handle : cublas_handles) {
+    CUTF_CHECK_ERROR(cublasCreate(&cublas_handle));
+  }
+  for (auto &stream : stream_map) {
+    CUTF_CHECK_ERROR(cudaStreamCreate(&stream.second));
+  }
+  cudaStream_t seq_stream;
+  CUTF_CHECK_ERROR(cudaStreamCreate(&seq_stream));
+  auto &seq_cublas_handle = cublas_handles[num_threads];
+  CUTF_CHECK_ERROR(cublasSetStream(seq_cublas_handle, seq_stream));
+
+  const auto replay = [&](cublasHandle_t const cublas_handle,
+                          const std::size_t i) {
+    replay_call(cublas_handle, calls[i], call_a_ptr[i], call_b_ptr[i],
+                call_c_ptr[i], ptr_array + call_ptr_array_offset[i]);
+  };
+
+  using shape_t = std::tuple<std::uint32_t, std::uint8_t, std::uint8_t,
+                             std::uint64_t, std::uint64_t, std::uint64_t,
+                             std::uint64_t, std::uint8_t>;
+  const auto get_shape = [&](const cumpsgemm::capture::call_t &call) {
+    return std::make_tuple(call.func_id, call.op_A, call.op_B, call.m, call.n,
+                           call.k, call.batch_count, call.is_complex);
+  };
+  // The first call of each shape for warming up
+  std::map<shape_t, std::size_t> shape_first_call;
+  for (std::size_t i = 0; i < calls.size(); i++) {
+    shape_first_call.insert(std::make_pair(get_shape(calls[i]), i));
+  }
+
+  constexpr std::size_t num_events = 1024;
+  std::vector<cudaEvent_t> events(num_events + 1);
+  for (auto &event : events) {
+    CUTF_CHECK_ERROR(cudaEventCreate(&event));
+  }
+
+  std::printf("## %s\n", __func__);
+  std::printf("# %lu calls, %lu threads, %lu streams, %lu shapes\n",
+              calls.size(), num_threads, stream_map.size(),
+              shape_first_call.size());
+  std::map<std::pair<std::string, shape_t>, std::pair<std::size_t, double>>
+      shape_time;
+  std::printf("mode,replay,num_calls,time[s]\n");
+  for (const auto &mode_name : mode_name_list) {
+    if (mode_name == "RULE") {
+      cumpsgemm::hijack_control::unset_compute_mode();
+    } else {
+      const char *const mode_name_ptr = mode_name.c_str();
+      const auto imp_list = gen_implementation_list(&mode_name_ptr, 1);
+      if (imp_list.size() == 0) {
+        continue;
+      }
+      cumpsgemm::hijack_control::set_compute_mode(
+          get_compute_mode(imp_list[0]));
+    }
+
+    for (const auto &shape : shape_first_call) {
+      replay(seq_cublas_handle, shape.second);
+    }
+    CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+
+    // Sequential replay timed by the events between the calls
+    double seq_time = 0;
+    for (std::size_t i = 0; i < calls.size(); i += num_events) {
+      const auto num_chunk_calls = std::min(num_events, calls.size() - i);
+      CUTF_CHECK_ERROR(cudaEventRecord(events[0], seq_stream));
+      for (std::size_t j = 0; j < num_chunk_calls; j++) {
+        replay(seq_cublas_handle, i + j);
+        CUTF_CHECK_ERROR(cudaEventRecord(events[j + 1], seq_stream));
+      }
+      CUTF_CHECK_ERROR(cudaEventSynchronize(events[num_chunk_calls]));
+      for (std::size_t j = 0; j < num_chunk_calls; j++) {
+        float elapsed_time_ms;
+        CUTF_CHECK_ERROR(
+            cudaEventElapsedTime(&elapsed_time_ms, events[j], events[j + 1]));
+        auto &t = shape_time[std::make_pair(mode_name,
+                                            get_shape(calls[i + j]))];
+        t.first++;
+        t.second += elapsed_time_ms * 1e-3;
+        seq_time += elapsed_time_ms * 1e-3;
+      }
+    }
+    std::printf("%s,seq,%lu,%e\n", mode_name.c_str(), calls.size(), seq_time);
+    std::fflush(stdout);
+
+    // Concurrent replay
+    const auto start_clock = std::chrono::system_clock::now();
+    std::vector<std::thread> threads;
+    std::size_t t = 0;
+    for (const auto &thread_calls : thread_call_list) {
+      threads.push_back(std::thread(
+          [&](cublasHandle_t const cublas_handle,
+              const std::vector<std::size_t> &call_list) {
+            for (const auto i : call_list) {
+              CUTF_CHECK_ERROR(cublasSetStream(
+                  cublas_handle, stream_map.at(calls[i].stream_id)));
+              replay(cublas_handle, i);
+            }
+          },
+          cublas_handles[t++], std::cref(thread_calls.second)));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+    const auto end_clock = std::chrono::system_clock::now();
+    const auto conc_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(end_clock -
+                                                              start_clock)
+            .count() *
+        1e-6;
+    std::printf("%s,conc,%lu,%e\n", mode_name.c_str(), calls.size(),
+                conc_time);
+    std::fflush(stdout);
+  }
+  cumpsgemm::hijack_control::unset_compute_mode();
+
+  // The throughput of each shape in the sequential replay
+  std::printf("mode,func,type,op_A,op_B,m,n,k,batch_count,num_calls,time[s],"
+              "throughput[TFlop/s]\n");
+  for (const auto &st : shape_time) {
+    const auto &shape = st.first.second;
+    const auto func_id = std::get<0>(shape);
+    const auto is_complex = std::get<7>(shape);
+    const double num_flops =
+        (is_complex ? 8. : 2.) * std::get<3>(shape) * std::get<4>(shape) *
+        std::get<5>(shape) * std::get<6>(shape) * st.second.first;
+    const auto get_op_str = [](const std::uint8_t op) {
+      return op == CUBLAS_OP_N ? "N" : (op == CUBLAS_OP_T ? "T" : "C");
+    };
+    std::printf("%s,%s,%s,%s,%s,%lu,%lu,%lu,%lu,%lu,%e,%e\n",
+                st.first.first.c_str(),
+                func_id < cumpsgemm::trace::num_funcs
+                    ? cumpsgemm::trace::func_name_list[func_id]
+                    : "unknown",
+                is_complex ? "C_32F" : "R_32F", get_op_str(std::get<1>(shape)),
+                get_op_str(std::get<2>(shape)), std::get<3>(shape),
+                std::get<4>(shape), std::get<5>(shape), std::get<6>(shape),
+                st.second.first, st.second.second,
+                num_flops / st.second.second * 1e-12);
+  }
+  std::fflush(stdout);
+
+  for (auto &event : events) {
+    CUTF_CHECK_ERROR(cudaEventDestroy(event));
+  }
+  for (auto &cublas_handle : cublas_handles) {
+    CUTF_CHECK_ERROR(cublasDestroy(cublas_handle));
+  }
+  for (auto &stream : stream_map) {
+    CUTF_CHECK_ERROR(cudaStreamDestroy(stream.second));
+  }
+  CUTF_CHECK_ERROR(cudaStreamDestroy(seq_stream));
+  cutf::memory::free(ptr_array);
+  cutf::memory::free(a_ptr);
+  cutf::memory::free(b_ptr);
+  cutf::memory::free(c_ptr);
+}
+
 int main(int argc, char **argv) {
   if (argc < 2) {
     print_usage(argv[0]);
@@ -1426,6 +2574,17 @@ int main(int argc, char **argv) {
     }
     test_logged_shape(argv[2]);
     return 0;
+  } else if (command == "replay") {
+    if (argc < 1 + 1 + 1) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    std::vector<std::string> mode_name_list(argv + 3, argv + argc);
+    if (mode_name_list.empty()) {
+      mode_name_list.push_back("RULE");
+    }
+    replay_test(argv[2], mode_name_list);
+    return 0;
   } else if (command == "sgemm_exp_stats" || command == "cgemm_exp_stats") {
     if (argc < 1 + 1 + 3) {
       print_usage(argv[0]);
@@ -1458,6 +2617,79 @@ int main(int argc, char **argv) {
         (command == "sgemm_exp_stats_bw" ? gemm_type::s : gemm_type::c),
         std::stoi(argv[4]));
     return 0;
+  } else if (command == "hijack_mt_bench") {
+    if (argc < 1 + 1 + 4) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    cuMpSGEMM_compute_mode_t compute_mode = CUMPSGEMM_DRY_RUN;
+    if (std::string(argv[5]) != "DRY_RUN") {
+      const auto imp_list = gen_implementation_list(argv + 5, 1);
+      if (imp_list.size() == 0) {
+        return 1;
+      }
+      compute_mode = get_compute_mode(imp_list[0]);
+    }
+    hijack_multithread_bench(std::stoi(argv[2]), std::stoi(argv[3]),
+                             std::stoi(argv[4]), compute_mode);
+    return 0;
+  } else if (command == "sgemm_pointer_mode") {
+    if (argc < 1 + 1 + 3) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    const auto imp_list = gen_implementation_list(argv + 4, argc - 4);
+    print_implementation_type_list(imp_list);
+    gemm_pointer_mode_test(std::stoi(argv[2]), std::stoi(argv[3]), imp_list);
+    return 0;
+  } else if (command == "sgemm_batched" || command == "cgemm_batched") {
+    if (argc < 1 + 1 + 4) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    const auto imp_list = gen_implementation_list(argv + 5, argc - 5);
+    print_implementation_type_list(imp_list);
+    gemm_batched_test(std::stoi(argv[2]), std::stoi(argv[3]),
+                      std::stoi(argv[4]), imp_list,
+                      (command == "sgemm_batched" ? gemm_type::s
+                                                  : gemm_type::c));
+    return 0;
+  } else if (command == "sgemm_lt") {
+    if (argc < 1 + 1 + 4) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    const auto imp_list = gen_implementation_list(argv + 5, argc - 5);
+    print_implementation_type_list(imp_list);
+    gemm_lt_test(std::stoi(argv[2]), std::stoi(argv[3]), std::stoi(argv[4]),
+                 imp_list);
+    return 0;
+  } else if (command == "sgemm_graph") {
+    if (argc < 1 + 1 + 3) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    gemm_graph_test(std::stoi(argv[2]), std::stoi(argv[3]),
+                    std::stoi(argv[4]));
+    return 0;
+  } else if (command == "sgemm_deterministic") {
+    if (argc < 1 + 1 + 2) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    const auto imp_list = gen_implementation_list(argv + 3, argc - 3);
+    print_implementation_type_list(imp_list);
+    gemm_deterministic_test(std::stoi(argv[2]), imp_list);
+    return 0;
+  } else if (command == "sgemm_raster") {
+    if (argc < 1 + 1 + 2) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    const auto imp_list = gen_implementation_list(argv + 3, argc - 3);
+    print_implementation_type_list(imp_list);
+    gemm_raster_test(std::stoi(argv[2]), imp_list);
+    return 0;
   }
 
   if (argc < 3 ||
@@ -0,0 +1,247 @@
+#include "../src/rule_file.hpp"
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+cumpsgemm::rule_file::decision_table_t compile(const std::string src) {
+  std::istringstream iss(src);
+  return cumpsgemm::rule_file::decision_table_t(
+      cumpsgemm::rule_file::parse(iss));
+}
+
+bool is_rejected(const std::string src, const std::string line_str) {
+  try {
+    compile(src);
+  } catch (const std::runtime_error &e) {
+    return std::string(e.what()).find(line_str) != std::string::npos;
+  }
+  return false;
+}
+
+cuMpSGEMM_compute_mode_t
+lookup(const cumpsgemm::rule_file::decision_table_t &table,
+       const char *const func_name, const cublasOperation_t op_A,
+       const cublasOperation_t op_B, const std::uint64_t m,
+       const std::uint64_t n, const std::uint64_t k,
+       const std::uint64_t batch_count = 1) {
+  return table.lookup(func_name, op_A, op_B, m, n, k, batch_count);
+}
+
+void test_parse() {
+  std::istringstream iss("# comment\n"
+                         "\n"
+                         "cublasSgemm_v2 NT 1:1024 :64 1025: 8 FP16TCEC # c\n"
+                         "* * * * * * CUBLAS\n");
+  const auto rules = cumpsgemm::rule_file::parse(iss);
+  check("parse:num_rules", rules.size() == 2);
+  check("parse:line", rules[0].line == 3 && rules[1].line == 4);
+  check("parse:func_name", rules[0].func_name == "cublasSgemm_v2" &&
+                               rules[1].func_name.empty());
+  check("parse:op", rules[0].op_A == CUBLAS_OP_N &&
+                        rules[0].op_B == CUBLAS_OP_T && rules[1].op_A < 0 &&
+                        rules[1].op_B < 0);
+  check("parse:range", rules[0].m.min == 1 && rules[0].m.max == 1024 &&
+                           rules[0].n.min == 0 && rules[0].n.max == 64 &&
+                           rules[0].k.min == 1025 &&
+                           rules[0].batch_count.min == 8 &&
+                           rules[0].batch_count.max == 8);
+  check("parse:mode", rules[0].compute_mode == CUMPSGEMM_FP16TCEC &&
+                          rules[1].compute_mode == CUMPSGEMM_CUBLAS);
+}
+
+void test_parse_error() {
+  check("parse_error:num_fields", is_rejected("* * * * * CUBLAS\n", "line 1"));
+  check("parse_error:op", is_rejected("\n* NX * * * * CUBLAS\n", "line 2"));
+  check("parse_error:op_pair", is_rejected("* NTN * * * * CUBLAS\n", "line 1"));
+  check("parse_error:number", is_rejected("* * 1a * * * CUBLAS\n", "line 1"));
+  check("parse_error:empty_range",
+        is_rejected("* * 10:1 * * * CUBLAS\n", "line 1"));
+  check("parse_error:mode", is_rejected("* * * * * * FP64\n", "line 1"));
+}
+
+void test_first_match() {
+  const auto table = compile("* * :1024 * * * CUBLAS_SIMT\n"
+                             "* * * :1024 * * CUBLAS_SIMT\n"
+                             "* * * * :1024 * CUBLAS_SIMT\n"
+                             "* * * * * * FP16TCEC\n");
+  check("first_match:small_m", lookup(table, "cublasSgemm", CUBLAS_OP_N,
+                                      CUBLAS_OP_N, 1024, 4096,
+                                      4096) == CUMPSGEMM_CUBLAS_SIMT);
+  check("first_match:small_k", lookup(table, "cublasSgemm", CUBLAS_OP_N,
+                                      CUBLAS_OP_N, 4096, 4096,
+                                      1) == CUMPSGEMM_CUBLAS_SIMT);
+  check("first_match:large", lookup(table, "cublasSgemm", CUBLAS_OP_N,
+                                    CUBLAS_OP_N, 1025, 1025,
+                                    1025) == CUMPSGEMM_FP16TCEC);
+
+  // An earlier rule has priority over a later overlapping one
+  const auto table_overlap = compile("* * 100:200 * * * TF32TCEC\n"
+                                     "* * 150:300 * * * FP16TCEC\n");
+  check("first_match:overlap", lookup(table_overlap, "f", CUBLAS_OP_N,
+                                      CUBLAS_OP_N, 150, 1,
+                                      1) == CUMPSGEMM_TF32TCEC);
+  check("first_match:overlap_tail", lookup(table_overlap, "f", CUBLAS_OP_N,
+                                           CUBLAS_OP_N, 201, 1,
+                                           1) == CUMPSGEMM_FP16TCEC);
+}
+
+void test_no_match() {
+  const auto table = compile("cublasSgemm * 100:200 * * * TF32TCEC\n");
+  check("no_match:below", lookup(table, "cublasSgemm", CUBLAS_OP_N,
+                                 CUBLAS_OP_N, 99, 1,
+                                 1) == CUMPSGEMM_UNDEFINED);
+  check("no_match:above", lookup(table, "cublasSgemm", CUBLAS_OP_N,
+                                 CUBLAS_OP_N, 201, 1,
+                                 1) == CUMPSGEMM_UNDEFINED);
+  check("no_match:func_name", lookup(table, "cublasCgemm", CUBLAS_OP_N,
+                                     CUBLAS_OP_N, 150, 1,
+                                     1) == CUMPSGEMM_UNDEFINED);
+  check("no_match:invalid_op",
+        lookup(table, "cublasSgemm", static_cast<cublasOperation_t>(3),
+               CUBLAS_OP_N, 150, 1, 1) == CUMPSGEMM_UNDEFINED);
+  check("no_match:empty_table",
+        compile("# empty\n").lookup("cublasSgemm", CUBLAS_OP_N, CUBLAS_OP_N, 1,
+                                    1, 1, 1) == CUMPSGEMM_UNDEFINED);
+}
+
+void test_func_name_and_op() {
+  const auto table = compile("cublasSgemm_v2 NT * * * * FP16TCEC\n"
+                             "cublasSgemm_v2 *N * * * * TF32TCEC\n"
+                             "cublasCgemm_v2 * * * * * FP16TC\n"
+                             "* C* * * * * CUBLAS_TF32TC\n"
+                             "* * * * * * CUBLAS\n");
+  check("func_name_op:exact", lookup(table, "cublasSgemm_v2", CUBLAS_OP_N,
+                                     CUBLAS_OP_T, 1, 1,
+                                     1) == CUMPSGEMM_FP16TCEC);
+  check("func_name_op:wildcard_op_A",
+        lookup(table, "cublasSgemm_v2", CUBLAS_OP_C, CUBLAS_OP_N, 1, 1, 1) ==
+            CUMPSGEMM_TF32TCEC);
+  check("func_name_op:other_op", lookup(table, "cublasSgemm_v2", CUBLAS_OP_T,
+                                        CUBLAS_OP_T, 1, 1,
+                                        1) == CUMPSGEMM_CUBLAS);
+  check("func_name_op:other_func", lookup(table, "cublasCgemm_v2", CUBLAS_OP_T,
+                                          CUBLAS_OP_T, 1, 1,
+                                          1) == CUMPSGEMM_FP16TC);
+  check("func_name_op:unlisted_func",
+        lookup(table, "cublasGemmEx", CUBLAS_OP_C, CUBLAS_OP_T, 1, 1, 1) ==
+            CUMPSGEMM_CUBLAS_TF32TC);
+  check("func_name_op:prefix_is_not_matched",
+        lookup(table, "cublasSgemm", CUBLAS_OP_N, CUBLAS_OP_T, 1, 1, 1) ==
+            CUMPSGEMM_CUBLAS);
+}
+
+void test_range_bounds() {
+  const auto table = compile("* * 16 * * * FP16TC\n"
+                             "* * * * * 2:4 TF32TC\n"
+                             "* * * * * 18446744073709551615 DRY_RUN\n"
+                             "* * * * * * CUBLAS\n");
+  check("range:exact", lookup(table, "f", CUBLAS_OP_N, CUBLAS_OP_N, 16, 1, 1,
+                              8) == CUMPSGEMM_FP16TC);
+  check("range:exact_next", lookup(table, "f", CUBLAS_OP_N, CUBLAS_OP_N, 17,
+                                   1, 1, 8) == CUMPSGEMM_CUBLAS);
+  check("range:batch_min", lookup(table, "f", CUBLAS_OP_N, CUBLAS_OP_N, 1, 1,
+                                  1, 2) == CUMPSGEMM_TF32TC);
+  check("range:batch_max", lookup(table, "f", CUBLAS_OP_N, CUBLAS_OP_N, 1, 1,
+                                  1, 4) == CUMPSGEMM_TF32TC);
+  check("range:batch_out", lookup(table, "f", CUBLAS_OP_N, CUBLAS_OP_N, 1, 1,
+                                  1, 5) == CUMPSGEMM_CUBLAS);
+  check("range:uint64_max",
+        lookup(table, "f", CUBLAS_OP_N, CUBLAS_OP_N, 1, 1, 1,
+               18446744073709551615lu) == CUMPSGEMM_DRY_RUN);
+}
+
+// Compare the compiled table with a linear scan of the rules
+void test_random_rules() {
+  std::uint64_t seed = 1;
+  const auto rand = [&](const std::uint64_t max) {
+    seed = seed * 6364136223846793005lu + 1442695040888963407lu;
+    return (seed >> 33) % (max + 1);
+  };
+  const char *const func_names[] = {"cublasSgemm", "cublasCgemm",
+                                    "cublasGemmEx"};
+  const char *const modes[] = {"CUBLAS", "FP16TCEC", "TF32TCEC", "FP16TC"};
+  const char ops[] = {'N', 'T', 'C', '*'};
+
+  const auto range_str = [&]() -> std::string {
+    switch (rand(3)) {
+    case 0:
+      return "*";
+    case 1:
+      return std::to_string(rand(64));
+    case 2:
+      return std::to_string(rand(64)) + ":";
+    default:
+      const auto a = rand(64);
+      return std::to_string(a) + ":" + std::to_string(a + rand(64));
+    }
+  };
+
+  bool result = true;
+  std::size_t num_nodes = 0;
+  for (unsigned t = 0; t < 32; t++) {
+    std::string src;
+    for (unsigned i = 0; i < 24; i++) {
+      src += rand(3) == 0 ? "*" : func_names[rand(2)];
+      src += " ";
+      src += ops[rand(3)];
+      src += ops[rand(3)];
+      for (unsigned j = 0; j < 4; j++) {
+        src += " " + range_str();
+      }
+      src += std::string(" ") + modes[rand(3)] + "\n";
+    }
+    std::istringstream iss(src);
+    const auto rules = cumpsgemm::rule_file::parse(iss);
+    const cumpsgemm::rule_file::decision_table_t table(rules);
+    num_nodes += table.get_num_nodes();
+
+    for (unsigned i = 0; i < 2000; i++) {
+      const auto func_name = func_names[rand(2)];
+      const auto op_A = static_cast<cublasOperation_t>(rand(2));
+      const auto op_B = static_cast<cublasOperation_t>(rand(2));
+      const auto m = rand(140), n = rand(140), k = rand(140), b = rand(140);
+
+      auto expected = CUMPSGEMM_UNDEFINED;
+      for (const auto &rule : rules) {
+        if ((rule.func_name.empty() || rule.func_name == func_name) &&
+            (rule.op_A < 0 || rule.op_A == op_A) &&
+            (rule.op_B < 0 || rule.op_B == op_B) && rule.m.contains(m) &&
+            rule.n.contains(n) && rule.k.contains(k) &&
+            rule.batch_count.contains(b)) {
+          expected = rule.compute_mode;
+          break;
+        }
+      }
+      result &= table.lookup(func_name, op_A, op_B, m, n, k, b) == expected;
+    }
+  }
+  check("random_rules:linear_scan", result);
+  std::printf("# average num nodes = %lu\n", num_nodes / 32);
+}
+} // namespace
+
+int main() {
+  test_parse();
+  test_parse_error();
+  test_first_match();
+  test_no_match();
+  test_func_name_and_op();
+  test_range_bounds();
+  test_random_rules();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "../src/snapshot.hpp"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+struct value_t {
+  unsigned generation;
+};
+
+value_t next(const value_t *const current) {
+  return value_t{current == nullptr ? 0 : current->generation + 1};
+}
+
+void test_update() {
+  cumpsgemm::snapshot_t<value_t> snapshot;
+  check("update:empty", snapshot.load() == nullptr);
+  snapshot.update(next);
+  check("update:first", snapshot.load()->generation == 0);
+  snapshot.update(next);
+  check("update:second", snapshot.load()->generation == 1);
+}
+
+void test_reclaim() {
+  cumpsgemm::snapshot_t<value_t> snapshot(
+      std::make_shared<value_t>(value_t{0}));
+  std::weak_ptr<const value_t> first = snapshot.load();
+  const auto held = snapshot.load();
+  for (unsigned i = 0; i < 1000; i++) {
+    snapshot.update(next);
+  }
+  check("reclaim:held", !first.expired() && held->generation == 0);
+  check("reclaim:latest", snapshot.load()->generation == 1000);
+
+  // The snapshots are freed once no thread refers to them
+  std::weak_ptr<const value_t> replaced = snapshot.load();
+  snapshot.update(next);
+  snapshot.load();
+  check("reclaim:replaced", replaced.expired());
+}
+
+// A snapshot at the address of a destroyed one is not confused with it
+void test_reuse() {
+  bool ok = true;
+  for (unsigned i = 0; i < 100; i++) {
+    cumpsgemm::snapshot_t<value_t> snapshot(
+        std::make_shared<value_t>(value_t{i}));
+    ok &= snapshot.load()->generation == i;
+  }
+  check("reuse:value", ok);
+}
+
+void test_threads() {
+  cumpsgemm::snapshot_t<value_t> snapshot(
+      std::make_shared<value_t>(value_t{0}));
+  const unsigned num_updates = 2000;
+  std::vector<std::thread> threads;
+  std::vector<char> results(8);
+  for (unsigned t = 0; t < results.size(); t++) {
+    threads.emplace_back([&, t]() {
+      bool ok = true;
+      unsigned last = 0;
+      do {
+        const auto generation = snapshot.load()->generation;
+        ok &= generation >= last;
+        last = generation;
+      } while (last < num_updates);
+      results[t] = ok;
+    });
+  }
+  for (unsigned i = 0; i < num_updates; i++) {
+    snapshot.update(next);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bool ok = true;
+  for (const auto r : results) {
+    ok &= r != 0;
+  }
+  check("threads:monotonic", ok);
+}
+} // namespace
+
+int main() {
+  test_update();
+  test_reclaim();
+  test_reuse();
+  test_threads();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include "../src/trace.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+constexpr std::uint64_t capacity = 8;
+const std::string dump_path = "cumpsgemm_trace_test.trace";
+
+cumpsgemm::trace::record_t make_record(const std::uint64_t id) {
+  cumpsgemm::trace::record_t record{};
+  record.timestamp_ns = id;
+  record.m = id;
+  record.func_id = id % cumpsgemm::trace::num_funcs;
+  record.compute_mode = CUMPSGEMM_FP16TCEC;
+  return record;
+}
+
+std::vector<cumpsgemm::trace::record_t> dump_and_load() {
+  cumpsgemm::trace::dump(dump_path);
+  return cumpsgemm::trace::load(dump_path);
+}
+
+void test_func_id() {
+  check("func_id:known",
+        cumpsgemm::trace::get_func_id("cublasLtMatmul") == 9 &&
+            cumpsgemm::trace::get_func_id("cublasSgemm_v2") == 0);
+  check("func_id:unknown", cumpsgemm::trace::get_func_id("cublasSgemm") ==
+                               cumpsgemm::trace::num_funcs);
+}
+
+void test_round_trip() {
+  for (std::uint64_t i = 0; i < 5; i++) {
+    cumpsgemm::trace::write(make_record(i));
+  }
+  const auto records = dump_and_load();
+  bool result = records.size() == 5;
+  for (std::size_t i = 0; result && i < records.size(); i++) {
+    result &= records[i].m == i && records[i].func_id == i &&
+              records[i].compute_mode == CUMPSGEMM_FP16TCEC;
+  }
+  check("round_trip", result);
+}
+
+void test_wrap_around() {
+  // 5 records have been written in test_round_trip
+  for (std::uint64_t i = 5; i < 15; i++) {
+    cumpsgemm::trace::write(make_record(i));
+  }
+  const auto records = dump_and_load();
+  bool result = records.size() == capacity;
+  for (std::size_t i = 0; result && i < records.size(); i++) {
+    result &= records[i].m == 15 - capacity + i;
+  }
+  check("wrap_around:last_records", result);
+}
+
+void test_multithread() {
+  std::thread thread([]() {
+    for (std::uint64_t i = 0; i < 3; i++) {
+      cumpsgemm::trace::write(make_record(100 + i));
+    }
+  });
+  thread.join();
+  const auto records = dump_and_load();
+  std::size_t num_thread_records = 0;
+  for (const auto &record : records) {
+    num_thread_records += record.m >= 100;
+  }
+  check("multithread:rings", records.size() == capacity + 3 &&
+                                 num_thread_records == 3);
+}
+
+void test_scoped_record() {
+  const auto num_records = dump_and_load().size();
+  {
+    cumpsgemm::trace::scoped_record_t trace_record(
+        "cublasGemmEx", CUBLAS_OP_T, CUBLAS_OP_C, 1, 2, 3, 4);
+    trace_record.record.compute_mode = CUMPSGEMM_TF32TCEC;
+  }
+  const auto records = dump_and_load();
+  const auto &record = records[capacity - 1];
+  check("scoped_record:written", records.size() == num_records);
+  check("scoped_record:fields",
+        record.func_id == 2 && record.op_A == CUBLAS_OP_T &&
+            record.op_B == CUBLAS_OP_C && record.m == 1 && record.n == 2 &&
+            record.k == 3 && record.batch_count == 4 &&
+            record.compute_mode == CUMPSGEMM_TF32TCEC &&
+            record.kernel_module_id ==
+                cumpsgemm::trace::unknown_kernel_module_id);
+}
+
+void test_invalid_file() {
+  const std::string path = "cumpsgemm_trace_test.invalid";
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << "not a trace file, but long enough to be read as a header......";
+  }
+  bool rejected = false;
+  try {
+    cumpsgemm::trace::load(path);
+  } catch (const std::runtime_error &) {
+    rejected = true;
+  }
+  check("invalid_file:rejected", rejected);
+  std::remove(path.c_str());
+}
+} // namespace
+
+int main() {
+  setenv("CUMPSGEMM_TRACE", dump_path.c_str(), 1);
+  setenv("CUMPSGEMM_TRACE_CAPACITY", std::to_string(capacity).c_str(), 1);
+
+  test_func_id();
+  test_round_trip();
+  test_wrap_around();
+  test_multithread();
+  test_scoped_record();
+  test_invalid_file();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
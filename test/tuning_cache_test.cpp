@@ -0,0 +1,211 @@
+#include "../src/tuning_cache.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+unsigned num_tests = 0;
+unsigned num_failed = 0;
+
+void check(const std::string name, const bool result) {
+  num_tests++;
+  if (!result) {
+    num_failed++;
+  }
+  std::printf("%-48s: %s\n", name.c_str(), (result ? "OK" : "NG"));
+}
+
+const std::string cache_path = "cumpsgemm_tuning_cache_test.cache";
+constexpr std::uint64_t identity = 0x1234;
+
+cumpsgemm::tuning_cache::key_t make_key(const std::uint64_t m,
+                                        const std::uint64_t identity) {
+  return cumpsgemm::tuning_cache::get_key(identity,
+                                          cumpsgemm::tuning_cache::gemm, 0b101,
+                                          m, 96, 12288, 1, false);
+}
+
+void test_bucket() {
+  using cumpsgemm::tuning_cache::get_bucket;
+  check("bucket:values", get_bucket(1) == 0 && get_bucket(2) == 2 &&
+                             get_bucket(3) == 3 && get_bucket(4) == 4 &&
+                             get_bucket(5) == 4 && get_bucket(6) == 5 &&
+                             get_bucket(7) == 5 && get_bucket(8) == 6);
+  check("bucket:monotonic", [] {
+    for (std::uint64_t x = 1; x < 100000; x++) {
+      if (get_bucket(x + 1) < get_bucket(x)) {
+        return false;
+      }
+    }
+    return true;
+  }());
+  check("bucket:key",
+        make_key(4000, identity) == make_key(3100, identity) &&
+            !(make_key(4096, identity) == make_key(4000, identity)));
+}
+
+void test_persistence() {
+  std::remove(cache_path.c_str());
+  {
+    cumpsgemm::tuning_cache::cache_t cache(cache_path);
+    std::uint32_t module_id;
+    check("persistence:open", cache.is_open() && cache.size() == 0);
+    check("persistence:miss", !cache.find(make_key(4096, identity), module_id));
+    check("persistence:insert", cache.insert(make_key(4096, identity), 3));
+    check("persistence:hit", cache.find(make_key(4096, identity), module_id) &&
+                                 module_id == 3);
+    // The first winner is kept
+    check("persistence:insert_again",
+          cache.insert(make_key(4096, identity), 1) &&
+              cache.find(make_key(4096, identity), module_id) &&
+              module_id == 3 && cache.size() == 1);
+  }
+  cumpsgemm::tuning_cache::cache_t cache(cache_path, 1024);
+  std::uint32_t module_id;
+  check("persistence:reopen", cache.find(make_key(4096, identity), module_id) &&
+                                  module_id == 3 && cache.size() == 1);
+  check("persistence:identity",
+        !cache.find(make_key(4096, identity + 1), module_id));
+}
+
+void test_invalid_file() {
+  {
+    std::ofstream ofs(cache_path, std::ios::binary);
+    ofs << "not a tuning cache, but long enough to be read as a header.....";
+  }
+  cumpsgemm::tuning_cache::cache_t cache(cache_path);
+  std::uint32_t module_id;
+  check("invalid_file:replaced",
+        cache.is_open() && cache.size() == 0 &&
+            !cache.find(make_key(4096, identity), module_id));
+}
+
+void test_full() {
+  std::remove(cache_path.c_str());
+  cumpsgemm::tuning_cache::cache_t cache(cache_path, 8);
+  bool result = true;
+  for (std::uint64_t i = 0; i < 4; i++) {
+    result &= cache.insert(make_key(1lu << i, identity), i);
+  }
+  check("full:insert", result && cache.is_full());
+  check("full:rejected", !cache.insert(make_key(1lu << 10, identity), 0));
+  std::uint32_t module_id;
+  check("full:hit", cache.find(make_key(1lu << 3, identity), module_id) &&
+                        module_id == 3);
+}
+
+// A file whose entries are all in use, which is not written by this library
+void test_no_empty_entry() {
+  std::remove(cache_path.c_str());
+  constexpr std::uint64_t capacity = 8;
+  {
+    cumpsgemm::tuning_cache::cache_t cache(cache_path, capacity);
+  }
+  {
+    std::fstream fs(cache_path,
+                    std::ios::binary | std::ios::in | std::ios::out);
+    for (std::uint64_t i = 0; i < capacity; i++) {
+      cumpsgemm::tuning_cache::entry_t entry{};
+      entry.key = make_key(1lu << (i + 20), identity);
+      entry.valid = 1;
+      fs.seekp(sizeof(cumpsgemm::tuning_cache::header_t) + sizeof(entry) * i);
+      fs.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    }
+  }
+  cumpsgemm::tuning_cache::cache_t cache(cache_path, capacity);
+  std::uint32_t module_id;
+  check("no_empty_entry:miss",
+        cache.is_open() && !cache.find(make_key(4096, identity), module_id));
+  check("no_empty_entry:insert", !cache.insert(make_key(4096, identity), 0));
+}
+
+// Inserts the keys of the half-octave buckets of [2^begin, 2^end)
+bool insert_all(cumpsgemm::tuning_cache::cache_t &cache,
+                const std::uint64_t begin, const std::uint64_t end,
+                const std::uint64_t identity) {
+  bool result = true;
+  for (auto i = begin; i < end; i++) {
+    for (const auto m : {1lu << i, 3lu << (i - 1)}) {
+      result &= cache.insert(make_key(m, identity), i % 3);
+    }
+  }
+  return result;
+}
+
+bool find_all(const cumpsgemm::tuning_cache::cache_t &cache,
+              const std::uint64_t begin, const std::uint64_t end,
+              const std::uint64_t identity) {
+  bool result = true;
+  for (auto i = begin; i < end; i++) {
+    for (const auto m : {1lu << i, 3lu << (i - 1)}) {
+      std::uint32_t module_id = ~0u;
+      result &= cache.find(make_key(m, identity), module_id) &&
+                module_id == i % 3;
+    }
+  }
+  return result;
+}
+
+void test_threads() {
+  std::remove(cache_path.c_str());
+  cumpsgemm::tuning_cache::cache_t cache(cache_path);
+  std::vector<std::thread> threads;
+  std::vector<int> results(8);
+  for (unsigned t = 0; t < results.size(); t++) {
+    threads.emplace_back([&, t]() {
+      // Two threads share each identity
+      results[t] =
+          insert_all(cache, 1, 40, t / 2) && find_all(cache, 1, 40, t / 2);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bool result = true;
+  for (const auto r : results) {
+    result &= r != 0;
+  }
+  check("threads:hit", result);
+  check("threads:size", cache.size() == 4 * 2 * 39);
+}
+
+void test_processes() {
+  std::remove(cache_path.c_str());
+  const auto pid = fork();
+  if (pid == 0) {
+    cumpsgemm::tuning_cache::cache_t cache(cache_path);
+    std::_Exit(insert_all(cache, 1, 40, 100) ? 0 : 1);
+  }
+  cumpsgemm::tuning_cache::cache_t cache(cache_path);
+  const auto result = insert_all(cache, 1, 40, 200);
+  int status;
+  waitpid(pid, &status, 0);
+  check("processes:insert",
+        result && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  cumpsgemm::tuning_cache::cache_t reopened_cache(cache_path);
+  check("processes:hit", find_all(cache, 1, 40, 100) &&
+                             find_all(reopened_cache, 1, 40, 100) &&
+                             find_all(reopened_cache, 1, 40, 200) &&
+                             reopened_cache.size() == 2 * 2 * 39);
+  std::remove(cache_path.c_str());
+}
+} // namespace
+
+int main() {
+  test_bucket();
+  test_persistence();
+  test_invalid_file();
+  test_full();
+  test_no_empty_entry();
+  test_threads();
+  test_processes();
+
+  std::printf("%u / %u passed\n", num_tests - num_failed, num_tests);
+  return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,484 @@
+#!/usr/bin/env python3
+# Offline autotuner for the kernel instance tables (src/instance_sm*.cu)
+#
+#   import   : src/instance_smXX.cu -> tuning database (JSON)
+#   tune     : measure the candidates in the parameter space on the current GPU
+#              and keep the fastest one for each entry of the database
+#   generate : tuning database -> src/instance_smXX.cu
+#
+# Usage:
+#   ./autotune.py tune --db sm80.json --arch sm80 --filter "gemm float half"
+#   ./autotune.py generate --db sm80.json -o ../../src/instance_sm80.cu
+import argparse
+import concurrent.futures
+import datetime
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+# kind -> (macro, module list, section suffix)
+KINDS = {
+    "gemm": ("SET_GEMM_KERNEL_MODULE", "gemm_module", "GEMM_KERNEL"),
+    "stridedBatch": ("SET_GEMM_STRIDEDBATCH_KERNEL_MODULE", "gemm_stridedBatch_module", "GEMM_STRIDEDBATCH_KERNEL"),
+    "batchPtr": ("SET_GEMM_BATCHPTR_KERNEL_MODULE", "gemm_batchPtr_module", "GEMM_BATCHPTR_KERNEL"),
+    "atomic": ("SET_GEMM_ATOMIC_KERNEL_MODULE", "gemm_atomic_module", "GEMM_ATOMIC_KERNEL"),
+    # The stages follow those of "gemm" in the same registry
+    "stream_k": ("SET_GEMM_STREAM_K_KERNEL_MODULE", "gemm_module", "GEMM_STREAM_K_KERNEL"),
+}
+IO_TYPES = {"float": "S", "cuComplex": "C"}
+GEMM_TYPES = {"float": "s", "cuComplex": "c"}
+
+# Comments placed before a section
+SECTION_COMMENTS = {
+    ("batchPtr", "float"): "The same configurations as the strided batched GEMM",
+    ("stream_k", "float"): "Not tuned yet. The configurations of the GEMM stage 1",
+}
+
+KEY_NAMES = ["kind", "io_t", "tc_t", "ec", "op_a", "op_b"]
+PARAM_NAMES = ["smem_m", "smem_n", "smem_k", "k_per_mn", "frag_m", "frag_n", "frag_k",
+               "block_size", "num_unrollings", "num_stages", "pipelined"]
+
+# The problem sizes of the stages (0 is for large matrices). The batched GEMMs
+# are measured with `batch_count` matrices. An entry with a "region"
+# ([min_log_m, max_log_m, min_log_n, max_log_n, min_log_k, max_log_k]) is a
+# candidate only for the shapes in it and is measured at its center instead.
+DEFAULT_SIZE_CLASSES = {
+    "gemm": {"float": [16384, 4096, 1024], "cuComplex": [8192, 2048, 512]},
+    "stridedBatch": {"float": [1024, 256, 64], "cuComplex": [1024, 256, 64]},
+    "batch_count": 256,
+    # The split-K kernel: m = n = N, k = N * N
+    "atomic": {"float": [128], "cuComplex": [128]},
+    # The stream-K kernel: a size with a partial last wave
+    "stream_k": {"float": [3072], "cuComplex": [1536]},
+}
+
+# The shared memory per block available on each architecture
+MAX_SMEM_SIZE = {
+    "sm80": 163 * 1024,
+    "sm86": 99 * 1024,
+}
+
+REGION_SUFFIX = "_IN_REGION"
+
+RESULT_RE = re.compile(r"N=\s*(\d+), p=\s*([\d.]+) \[TFlop/s\]")
+
+
+# ------------------------------------------------------------------
+# Database
+# ------------------------------------------------------------------
+# An entry per line to keep the diffs of the tuning results readable
+def save_db(db, path):
+    lines = ["{"]
+    for key, value in db.items():
+        if key == "entries":
+            continue
+        lines.append(" {}: {},".format(json.dumps(key), json.dumps(value)))
+    lines.append(' "entries": [')
+    lines.append(",\n".join("  " + json.dumps(e) for e in db["entries"]))
+    lines.append(" ]")
+    lines.append("}")
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def load_db(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+# ------------------------------------------------------------------
+# Instance source files
+# ------------------------------------------------------------------
+def get_params(kind, args):
+    values = [int(v) if v.isdigit() else v for v in args]
+    names = [n for n in PARAM_NAMES if kind == "atomic" or n != "k_per_mn"]
+    params = dict(zip(names, values))
+    params["pipelined"] = params["pipelined"] == "true"
+    return params
+
+
+def parse_instance_file(path):
+    with open(path) as f:
+        src = f.read()
+    db = {"arch": re.search(r"configure_instance_(sm\d+)", src).group(1),
+          "size_classes": DEFAULT_SIZE_CLASSES, "entries": []}
+
+    section = None
+    num_sections = 0
+    note = None
+    # A macro call may span lines
+    statement = ""
+    for line in src.splitlines():
+        stripped = line.strip()
+        m = re.match(r"#ifdef COMPILE_([SC])(\w+)", stripped)
+        if m:
+            io_t = {"S": "float", "C": "cuComplex"}[m.group(1)]
+            kind = [k for k, v in KINDS.items() if v[2] == m.group(2)][0]
+            section = (kind, io_t)
+            num_sections += 1
+            continue
+        if stripped == "#endif":
+            section = None
+            continue
+        if statement == "" and stripped.startswith("//"):
+            comment = stripped[2:].strip()
+            if section is not None:
+                note = comment
+            elif num_sections == 0 and not comment.startswith("Generated by"):
+                db["description"] = comment
+            continue
+        if section is None or (statement == "" and not stripped.startswith("SET_")):
+            continue
+
+        statement += " " + stripped
+        if ";" not in stripped:
+            continue
+        call, _, comment = statement.partition(";")
+        statement = ""
+        macro, _, args = call.strip().partition("(")
+        args = [a.strip() for a in args.rstrip(") ").split(",")]
+        region = None
+        if macro.endswith(REGION_SUFFIX):
+            macro = macro[:-len(REGION_SUFFIX)]
+            region = [int(a) for a in args[-6:]]
+            args = args[:-6]
+        kind = [k for k, v in KINDS.items() if v[0] == macro][0]
+
+        entry = dict(zip(KEY_NAMES, [kind, args[1], args[2], args[3], args[4], args[5]]))
+        if kind == "atomic":
+            entry.update(get_params(kind, args[6:-1]))
+        else:
+            entry.update(get_params(kind, args[6:-2]))
+            entry["stage"] = int(args[-1])
+        if region is not None:
+            entry["region"] = region
+        comment = comment.strip().lstrip("/").strip()
+        result = RESULT_RE.fullmatch(comment)
+        if result:
+            entry["result"] = {"N": int(result.group(1)), "tflops": float(result.group(2))}
+        elif comment:
+            entry["comment"] = comment
+        if note is not None:
+            entry["note"] = note
+            note = None
+        db["entries"].append(entry)
+    return db
+
+
+# Lays out a macro call in the same way as clang-format (LLVM style)
+def format_call(name, args, comment, column_limit=80):
+    tokens = [a + "," for a in args[:-1]] + [args[-1] + ");"]
+    trailer = "" if comment is None else " // " + comment
+
+    def pack(first, indent):
+        lines = []
+        line = first
+        for i, token in enumerate(tokens):
+            width = len(token) + (len(trailer) if i == len(tokens) - 1 else 0)
+            if i == 0:
+                line += token
+            elif len(line) + 1 + width <= column_limit:
+                line += " " + token
+            else:
+                lines.append(line)
+                line = " " * indent + token
+        lines.append(line + trailer)
+        return lines
+
+    prefix = "  " + name + "("
+    lines = pack(prefix, len(prefix))
+    if all(len(l) <= column_limit for l in lines):
+        return lines
+    return [prefix] + pack(" " * 6, 6)
+
+
+def format_entry(entry):
+    macro, module_list, _ = KINDS[entry["kind"]]
+    args = [module_list] + [entry[k] for k in KEY_NAMES[1:]]
+    for name in PARAM_NAMES:
+        if name == "k_per_mn" and entry["kind"] != "atomic":
+            continue
+        value = entry[name]
+        args.append(("true" if value else "false") if isinstance(value, bool) else str(value))
+    args.append(GEMM_TYPES[entry["io_t"]])
+    if entry["kind"] != "atomic":
+        args.append(str(entry["stage"]))
+    if "region" in entry:
+        macro += REGION_SUFFIX
+        args += [str(v) for v in entry["region"]]
+
+    comment = entry.get("comment")
+    if "result" in entry:
+        comment = "N={:7d}, p={:6.2f} [TFlop/s]".format(entry["result"]["N"], entry["result"]["tflops"])
+
+    lines = []
+    if "note" in entry:
+        lines.append("  // " + entry["note"])
+    lines += format_call(macro, args, comment)
+    return lines
+
+
+def generate_instance_file(db):
+    arch = db["arch"]
+    lines = [
+        "// Generated by tools/autotune/autotune.py from tools/autotune/{}.json".format(arch),
+        '#include "cumpsgemm_kernel.cuh"',
+        '#include "handle.hpp"',
+        '#include "instance.hpp"',
+        "",
+        "void cumpsgemm::configure_instance_{}(".format(arch),
+        "    cumpsgemm::kernel_registry::registry_t *const gemm_module,",
+        "    cumpsgemm::kernel_registry::registry_t *const gemm_stridedBatch_module,",
+        "    cumpsgemm::kernel_registry::registry_t *const gemm_batchPtr_module,",
+        "    cumpsgemm::gemm_module",
+        "        gemm_atomic_module[cumpsgemm::kernel_module_code::max_code]) {",
+        "  using tf32 = nvcuda::wmma::precision::tf32;",
+        "  using bf16 = __nv_bfloat16;",
+    ]
+    if "description" in db:
+        lines.append("  // " + db["description"])
+    for kind in KINDS:
+        for io_t, prefix in IO_TYPES.items():
+            if (kind, io_t) in SECTION_COMMENTS:
+                lines.append("  // " + SECTION_COMMENTS[(kind, io_t)])
+            lines.append("#ifdef COMPILE_{}{}".format(prefix, KINDS[kind][2]))
+            for entry in db["entries"]:
+                if entry["kind"] == kind and entry["io_t"] == io_t:
+                    lines += format_entry(entry)
+            lines.append("#endif")
+    lines.append("}")
+    return "\n".join(lines) + "\n"
+
+
+# ------------------------------------------------------------------
+# Parameter space
+# ------------------------------------------------------------------
+def get_smem_size(entry, params):
+    element_size = 4 if entry["io_t"] == "float" else 8
+    skew_ab, skew_c = 8, 4
+    m, n, k = params["smem_m"], params["smem_n"], params["smem_k"]
+    a = (m + skew_ab) * k if entry["op_a"] == "col_major" else (k + skew_ab) * m
+    b = (k + skew_ab) * n if entry["op_b"] == "col_major" else (n + skew_ab) * k
+    return element_size * max((m + skew_c) * n, params["num_stages"] * (a + b))
+
+
+def is_valid(entry, params, max_smem_size):
+    num_warps = params["block_size"] // 32
+    num_frags = (params["smem_m"] // params["frag_m"]) * (params["smem_n"] // params["frag_n"])
+    frag_k_unit = 8 if entry["tc_t"] == "tf32" else 16
+    return (params["smem_m"] % params["frag_m"] == 0 and
+            params["smem_n"] % params["frag_n"] == 0 and
+            params["smem_k"] % params["frag_k"] == 0 and
+            params["frag_k"] % frag_k_unit == 0 and
+            num_frags % num_warps == 0 and
+            params["smem_m"] * params["smem_k"] % params["block_size"] == 0 and
+            params["smem_k"] * params["smem_n"] % params["block_size"] == 0 and
+            (params["pipelined"] or params["num_stages"] == 2) and
+            (entry["kind"] != "atomic" or params["k_per_mn"] % params["smem_k"] == 0) and
+            get_smem_size(entry, params) <= max_smem_size)
+
+
+def enumerate_candidates(entry, space, max_smem_size):
+    names = [n for n in PARAM_NAMES if entry["kind"] == "atomic" or n != "k_per_mn"]
+    for values in itertools.product(*[space[n] for n in names]):
+        params = dict(zip(names, values))
+        if is_valid(entry, params, max_smem_size):
+            yield params
+
+
+SPACES = {
+    "small": {
+        "smem_m": [32, 64, 128], "smem_n": [32, 64, 128], "smem_k": [32],
+        "k_per_mn": [64, 128],
+        "frag_m": [32, 64], "frag_n": [32, 64], "frag_k": [16, 32],
+        "block_size": [128, 256], "num_unrollings": [1, 2],
+        "num_stages": [2], "pipelined": [False],
+    },
+    "full": {
+        "smem_m": [32, 64, 128], "smem_n": [32, 64, 128], "smem_k": [32, 64],
+        "k_per_mn": [64, 128, 256],
+        "frag_m": [16, 32, 64], "frag_n": [16, 32, 64], "frag_k": [8, 16, 32],
+        "block_size": [64, 128, 256], "num_unrollings": [1, 2, 4],
+        "num_stages": [2, 3, 4], "pipelined": [False, True],
+    },
+}
+
+
+# ------------------------------------------------------------------
+# Measurement
+# ------------------------------------------------------------------
+def get_candidate_line(candidate_id, entry, params):
+    values = [params[n] for n in PARAM_NAMES if entry["kind"] == "atomic" or n != "k_per_mn"]
+    if entry["kind"] != "atomic":
+        values.insert(3, 0)
+    values = ["true" if v is True else "false" if v is False else str(v) for v in values]
+    return "CUMPSGEMM_AUTOTUNE_CANDIDATE({}, {}, {}, {}, {}, {}, {}, {})".format(
+        candidate_id, entry["kind"], entry["io_t"], entry["tc_t"], entry["ec"],
+        entry["op_a"], entry["op_b"], ", ".join(values))
+
+
+def build_and_run(args, group, candidates, sizes, work_dir):
+    name = "_".join(group)
+    candidates_path = os.path.join(work_dir, name + ".hpp")
+    with open(candidates_path, "w") as f:
+        for i, params in enumerate(candidates):
+            f.write(get_candidate_line(i, dict(zip(KEY_NAMES, group)), params) + "\n")
+    binary_path = os.path.join(work_dir, name)
+    command = [args.nvcc, "-std=c++17", "-O3", "-arch=" + args.arch.replace("sm", "sm_"),
+               "--expt-relaxed-constexpr",
+               "-I" + os.path.join(ROOT_DIR, "include"),
+               "-I" + os.path.join(ROOT_DIR, "src"),
+               "-I" + os.path.join(ROOT_DIR, "submodules", "cutf", "include"),
+               "-I" + os.path.join(ROOT_DIR, "submodules", "wmma_extension", "include"),
+               "-DCUMPSGEMM_AUTOTUNE_CANDIDATES=\"{}\"".format(candidates_path),
+               os.path.join(os.path.dirname(os.path.abspath(__file__)), "bench.cu"),
+               os.path.join(ROOT_DIR, "src", "cost_model.cpp"),
+               "-o", binary_path]
+    subprocess.run(command, check=True)
+
+    # The binaries are run one by one so that they do not share the GPU
+    return binary_path, [str(s) for s in sizes]
+
+
+# The matrix size N at which an entry is measured
+def get_size(entry, size_classes):
+    if entry["kind"] == "atomic":
+        return size_classes["atomic"][entry["io_t"]][0]
+    if "region" in entry:
+        # The geometric center of the region rounded to a power of two
+        return 1 << (sum(entry["region"]) // 6)
+    if entry["kind"] == "stream_k":
+        return size_classes["stream_k"][entry["io_t"]][0]
+    return size_classes[entry["kind"]][entry["io_t"]][entry["stage"]]
+
+
+def tune(args):
+    db = load_db(args.db)
+    size_classes = db.setdefault("size_classes", DEFAULT_SIZE_CLASSES)
+    space = SPACES[args.space]
+    max_smem_size = MAX_SMEM_SIZE.get(db["arch"], 99 * 1024)
+
+    # The entries sharing a key are measured by a binary
+    groups = {}
+    for entry in db["entries"]:
+        key = tuple(entry[k] for k in KEY_NAMES)
+        if args.filter and not all(f in key for f in args.filter.split()):
+            continue
+        # batchPtr uses the configurations of stridedBatch
+        if entry["kind"] == "batchPtr":
+            continue
+        groups.setdefault(key, []).append(entry)
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        jobs = {}
+        with concurrent.futures.ThreadPoolExecutor(args.jobs) as executor:
+            for key, entries in groups.items():
+                candidates = list(enumerate_candidates(dict(zip(KEY_NAMES, key)), space, max_smem_size))
+                if args.max_candidates:
+                    candidates = candidates[:args.max_candidates]
+                # The current configurations are always measured so that a
+                # tuning never makes an entry slower
+                for entry in entries:
+                    params = {n: entry[n] for n in PARAM_NAMES if n in entry}
+                    if params not in candidates:
+                        candidates.append(params)
+                sizes = sorted(set(get_size(e, size_classes) for e in entries), reverse=True)
+                print("{}: {} candidates".format(" ".join(key), len(candidates)), file=sys.stderr)
+                jobs[key] = (candidates, executor.submit(build_and_run, args, key, candidates, sizes, work_dir))
+
+        for key, (candidates, job) in jobs.items():
+            binary_path, sizes = job.result()
+            batch_count = str(size_classes["batch_count"]) if key[0] == "stridedBatch" else "1"
+            output = subprocess.run([binary_path, batch_count] + sizes, check=True,
+                                    capture_output=True, text=True).stdout
+            # "<candidate id> <N> <TFlop/s>"
+            best = {}
+            for line in output.splitlines():
+                candidate_id, N, tflops = line.split()
+                N, tflops = int(N), float(tflops)
+                if N not in best or tflops > best[N][1]:
+                    best[N] = (int(candidate_id), tflops)
+            for entry in groups[key]:
+                N = get_size(entry, size_classes)
+                if N not in best:
+                    continue
+                entry.update(candidates[best[N][0]])
+                entry.pop("comment", None)
+                entry.pop("note", None)
+                if key[0] == "atomic":
+                    entry["comment"] = "N={:7d}, k=N*N, p={:6.2f} [TFlop/s]".format(N, best[N][1])
+                else:
+                    entry["result"] = {"N": N, "tflops": round(best[N][1], 2)}
+                print("{} stage {}: {}".format(" ".join(key), entry.get("stage", "-"),
+                                               entry.get("result", entry.get("comment"))), file=sys.stderr)
+
+    # The pointer-array batched GEMM uses the configurations of the strided one
+    strided = {tuple(e[k] for k in KEY_NAMES[1:]) + (e["stage"],): e
+               for e in db["entries"] if e["kind"] == "stridedBatch"}
+    for entry in db["entries"]:
+        if entry["kind"] == "batchPtr":
+            source = strided.get(tuple(entry[k] for k in KEY_NAMES[1:]) + (entry["stage"],))
+            if source is not None and (not args.filter or all(f in source.values() for f in args.filter.split())):
+                entry.update({n: source[n] for n in PARAM_NAMES if n in source})
+
+    db["tuned"] = {
+        "date": datetime.date.today().isoformat(),
+        "device": subprocess.run(["nvidia-smi", "--query-gpu=name", "--format=csv,noheader", "-i", "0"],
+                                 capture_output=True, text=True).stdout.strip(),
+        "nvcc": subprocess.run([args.nvcc, "--version"], capture_output=True,
+                               text=True).stdout.strip().splitlines()[-1],
+    }
+    save_db(db, args.db)
+
+
+# ------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(description="Offline autotuner for the kernel instance tables")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    p = subparsers.add_parser("import", help="instance source file -> database")
+    p.add_argument("instance_file")
+    p.add_argument("-o", "--db", required=True)
+
+    p = subparsers.add_parser("generate", help="database -> instance source file")
+    p.add_argument("--db", required=True)
+    p.add_argument("-o", "--output", help="stdout if not given")
+    p.add_argument("--check", action="store_true",
+                   help="exit with 1 if the output file is not up to date")
+
+    p = subparsers.add_parser("tune", help="measure the candidates and update the database")
+    p.add_argument("--db", required=True)
+    p.add_argument("--arch", default="sm80", help="e.g. sm80, sm86")
+    p.add_argument("--nvcc", default="nvcc")
+    p.add_argument("--space", default="small", choices=SPACES.keys())
+    p.add_argument("--filter", help='e.g. "gemm float half with_ec"')
+    p.add_argument("--max-candidates", type=int, default=0)
+    p.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+
+    args = parser.parse_args()
+    if args.command == "import":
+        save_db(parse_instance_file(args.instance_file), args.db)
+    elif args.command == "generate":
+        src = generate_instance_file(load_db(args.db))
+        if args.check:
+            with open(args.output) as f:
+                if f.read() != src:
+                    print("{} is not generated from {}".format(args.output, args.db), file=sys.stderr)
+                    sys.exit(1)
+        elif args.output:
+            with open(args.output, "w") as f:
+                f.write(src)
+        else:
+            sys.stdout.write(src)
+    elif args.command == "tune":
+        tune(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,260 @@
+// The benchmark of the candidate kernel modules generated by autotune.py
+//
+// Usage: ./bench <batch_count> <N> [N ...]
+// Output: "<candidate id> <N> <TFlop/s>" for each candidate and N
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cutf/memory.hpp>
+#include <iostream>
+#include <vector>
+
+#include "cost_model.hpp"
+#include "cumpsgemm_kernel.cuh"
+
+#ifndef CUMPSGEMM_AUTOTUNE_CANDIDATES
+#error "CUMPSGEMM_AUTOTUNE_CANDIDATES must be the path of the candidate list"
+#endif
+
+namespace {
+using tf32 = nvcuda::wmma::precision::tf32;
+using bf16 = __nv_bfloat16;
+
+constexpr unsigned num_warmups = 3;
+constexpr unsigned num_measurements = 10;
+// The same as the working memory and the counters of a handle
+constexpr std::size_t split_k_workspace_float_count = 1lu << 22;
+constexpr std::size_t split_k_counter_count = 1lu << 14;
+
+enum kind_t { gemm, stridedBatch, batchPtr, atomic, stream_k };
+
+struct candidate_t {
+  unsigned id;
+  kind_t kind;
+  cumpsgemm::gemm_module gemm_module;
+  // The leading dimensions of the (N x N^2) matrices of the atomic modules
+  bool is_a_col_major, is_b_col_major;
+};
+
+// The workspace of the split-K (atomic) and the stream-K modules
+struct split_k_workspace_t {
+  cumpsgemm::cost_model::device_t device;
+  void *ptr;
+  unsigned *counter_ptr;
+};
+
+template <class T> T one() { return 1; }
+template <> cuComplex one<cuComplex>() { return make_float2(1, 0); }
+
+template <class T>
+void launch(const candidate_t &candidate, const std::size_t N,
+            const std::size_t batch_count, const T *const a_ptr,
+            const T *const b_ptr, T *const c_ptr, const T *const *const a_list,
+            const T *const *const b_list, T *const *const c_list,
+            const split_k_workspace_t &workspace) {
+  const auto &mod = candidate.gemm_module;
+  const cumpsgemm::scalar_t<T> alpha{one<T>(), nullptr};
+  const cumpsgemm::scalar_t<T> beta{one<T>(), nullptr};
+  const auto num_blocks_per_gemm =
+      ((N + mod.smem_m - 1) / mod.smem_m) * ((N + mod.smem_n - 1) / mod.smem_n);
+  const auto group_width = cumpsgemm::default_raster_group_width;
+
+  switch (candidate.kind) {
+  case gemm:
+    reinterpret_cast<cumpsgemm::gemm_kernel_func_t<T>>(mod.kernel_func)
+        <<<num_blocks_per_gemm, mod.block_size, mod.smem_size>>>(
+            nullptr, N, N, N, alpha, a_ptr, N, b_ptr, N, beta, c_ptr, N,
+            group_width);
+    break;
+  case atomic: {
+    // m = n = N, k = N * N, split as the library does
+    const auto plan = cumpsgemm::cost_model::plan_split_k(
+        mod, workspace.device, N, N, N * N,
+        split_k_workspace_float_count * sizeof(float) / sizeof(T),
+        split_k_counter_count);
+    if (plan.num_splits == 0) {
+      break;
+    }
+    reinterpret_cast<cumpsgemm::gemm_split_k_kernel_func_t<T>>(mod.kernel_func)
+        <<<num_blocks_per_gemm * plan.num_splits, mod.block_size,
+           mod.smem_size>>>(nullptr, N, N, N * N, alpha, a_ptr,
+                            candidate.is_a_col_major ? N : N * N, b_ptr,
+                            candidate.is_b_col_major ? N * N : N, beta, c_ptr,
+                            N, plan.k_per_split,
+                            reinterpret_cast<T *>(workspace.ptr),
+                            workspace.counter_ptr, group_width);
+  } break;
+  case stream_k: {
+    const auto plan = cumpsgemm::cost_model::plan_stream_k(
+        mod, workspace.device, N, N, N,
+        split_k_workspace_float_count * sizeof(float) / sizeof(T),
+        split_k_counter_count);
+    if (plan.num_blocks == 0) {
+      break;
+    }
+    reinterpret_cast<cumpsgemm::gemm_stream_k_kernel_func_t<T>>(
+        mod.kernel_func)<<<plan.num_blocks, mod.block_size, mod.smem_size>>>(
+        nullptr, N, N, N, alpha, a_ptr, N, b_ptr, N, beta, c_ptr, N,
+        plan.k_steps_per_block, reinterpret_cast<T *>(workspace.ptr),
+        workspace.counter_ptr, group_width);
+  } break;
+  case stridedBatch:
+    reinterpret_cast<cumpsgemm::gemm_stridedBatch_kernel_func_t<T>>(
+        mod.kernel_func)<<<cumpsgemm::get_batch_grid_size(num_blocks_per_gemm,
+                                                          batch_count),
+                           mod.block_size, mod.smem_size>>>(
+        nullptr, N, N, N, alpha, a_ptr, N, N * N, b_ptr, N, N * N, beta, c_ptr,
+        N, N * N, batch_count, group_width);
+    break;
+  case batchPtr:
+    reinterpret_cast<cumpsgemm::gemm_batchPtr_kernel_func_t<T>>(
+        mod.kernel_func)<<<cumpsgemm::get_batch_grid_size(num_blocks_per_gemm,
+                                                          batch_count),
+                           mod.block_size, mod.smem_size>>>(
+        nullptr, N, N, N, alpha, a_list, N, b_list, N, beta, c_list, N,
+        batch_count);
+    break;
+  }
+}
+
+template <class T>
+void run(const std::vector<candidate_t> &candidate_list,
+         const std::size_t batch_count,
+         const std::vector<std::size_t> &N_list) {
+  split_k_workspace_t workspace;
+  int num_sms;
+  CUTF_CHECK_ERROR(
+      cudaDeviceGetAttribute(&num_sms, cudaDevAttrMultiProcessorCount, 0));
+  workspace.device.num_sms = num_sms;
+  auto workspace_uptr =
+      cutf::memory::get_device_unique_ptr<float>(split_k_workspace_float_count);
+  auto counter_uptr =
+      cutf::memory::get_device_unique_ptr<unsigned>(split_k_counter_count);
+  CUTF_CHECK_ERROR(cudaMemset(counter_uptr.get(), 0,
+                              sizeof(unsigned) * split_k_counter_count));
+  workspace.ptr = workspace_uptr.get();
+  workspace.counter_ptr = counter_uptr.get();
+
+  for (const auto N : N_list) {
+    const auto is_atomic = candidate_list[0].kind == atomic;
+    // A and B are (N x N^2) for the atomic modules
+    const auto ab_size = N * N * (is_atomic ? N : batch_count);
+    const auto c_size = N * N * batch_count;
+    auto a_uptr = cutf::memory::get_device_unique_ptr<T>(ab_size);
+    auto b_uptr = cutf::memory::get_device_unique_ptr<T>(ab_size);
+    auto c_uptr = cutf::memory::get_device_unique_ptr<T>(c_size);
+    CUTF_CHECK_ERROR(cudaMemset(a_uptr.get(), 0, sizeof(T) * ab_size));
+    CUTF_CHECK_ERROR(cudaMemset(b_uptr.get(), 0, sizeof(T) * ab_size));
+
+    std::vector<T *> ptr_list(3 * batch_count);
+    for (std::size_t i = 0; i < batch_count; i++) {
+      ptr_list[i] = a_uptr.get() + i * N * N;
+      ptr_list[i + batch_count] = b_uptr.get() + i * N * N;
+      ptr_list[i + 2 * batch_count] = c_uptr.get() + i * N * N;
+    }
+    auto ptr_list_uptr =
+        cutf::memory::get_device_unique_ptr<T *>(ptr_list.size());
+    cutf::memory::copy(ptr_list_uptr.get(), ptr_list.data(), ptr_list.size());
+    const auto a_list = ptr_list_uptr.get();
+    const auto b_list = a_list + batch_count;
+    const auto c_list = b_list + batch_count;
+
+    const double num_flops = 2. * N * N * (is_atomic ? N * N : N) *
+                             (is_atomic ? 1 : batch_count) *
+                             (std::is_same<T, cuComplex>::value ? 4 : 1);
+    for (const auto &candidate : candidate_list) {
+      for (unsigned i = 0; i < num_warmups; i++) {
+        launch<T>(candidate, N, batch_count, a_uptr.get(), b_uptr.get(),
+                  c_uptr.get(), a_list, b_list, c_list, workspace);
+      }
+      CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+      const auto start_clock = std::chrono::system_clock::now();
+      for (unsigned i = 0; i < num_measurements; i++) {
+        launch<T>(candidate, N, batch_count, a_uptr.get(), b_uptr.get(),
+                  c_uptr.get(), a_list, b_list, c_list, workspace);
+      }
+      CUTF_CHECK_ERROR(cudaDeviceSynchronize());
+      const auto end_clock = std::chrono::system_clock::now();
+      const auto elapsed_time =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end_clock -
+                                                               start_clock)
+              .count() *
+          1e-9 / num_measurements;
+      std::cout << candidate.id << " " << N << " "
+                << num_flops / elapsed_time * 1e-12 << std::endl;
+    }
+  }
+}
+} // namespace
+
+#define CUMPSGEMM_AUTOTUNE_GENERATE_gemm generate_gemm_module
+#define CUMPSGEMM_AUTOTUNE_GENERATE_stridedBatch                               \
+  generate_gemm_stridedBatch_module
+#define CUMPSGEMM_AUTOTUNE_GENERATE_batchPtr generate_gemm_batchPtr_module
+#define CUMPSGEMM_AUTOTUNE_GENERATE_stream_k generate_gemm_stream_k_module
+
+// k_per_mn is 0 for the non-atomic modules
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE(                                          \
+    id, kind, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, k_per_mn,    \
+    frag_m, frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined) \
+  CUMPSGEMM_AUTOTUNE_CANDIDATE_##kind(                                         \
+      id, kind, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, k_per_mn,  \
+      frag_m, frag_n, frag_k, block_size, num_unrollings, num_stages,          \
+      pipelined)
+
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE_NON_ATOMIC(                               \
+    id, kind, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, k_per_mn,    \
+    frag_m, frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined) \
+  is_complex = std::is_same<io_t, cuComplex>::value;                           \
+  candidate_list.push_back(                                                    \
+      {id, kind,                                                               \
+       cumpsgemm::CUMPSGEMM_AUTOTUNE_GENERATE_##kind<                          \
+           io_t, smem_m, smem_n, smem_k, frag_m, frag_n, frag_k, block_size,   \
+           num_unrollings, num_stages, cumpsgemm::op_a, cumpsgemm::op_b, tc_t, \
+           mtk::wmma::tcec::ec, pipelined>(),                                  \
+       true, true});
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE_gemm                                      \
+  CUMPSGEMM_AUTOTUNE_CANDIDATE_NON_ATOMIC
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE_stridedBatch                              \
+  CUMPSGEMM_AUTOTUNE_CANDIDATE_NON_ATOMIC
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE_batchPtr                                  \
+  CUMPSGEMM_AUTOTUNE_CANDIDATE_NON_ATOMIC
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE_stream_k                                  \
+  CUMPSGEMM_AUTOTUNE_CANDIDATE_NON_ATOMIC
+#define CUMPSGEMM_AUTOTUNE_CANDIDATE_atomic(                                   \
+    id, kind, io_t, tc_t, ec, op_a, op_b, smem_m, smem_n, smem_k, k_per_mn,    \
+    frag_m, frag_n, frag_k, block_size, num_unrollings, num_stages, pipelined) \
+  is_complex = std::is_same<io_t, cuComplex>::value;                           \
+  candidate_list.push_back(                                                    \
+      {id, kind,                                                               \
+       cumpsgemm::generate_gemm_atomic_module<                                 \
+           io_t, smem_m, smem_n, smem_k, k_per_mn, frag_m, frag_n, frag_k,     \
+           block_size, num_unrollings, num_stages, cumpsgemm::op_a,            \
+           cumpsgemm::op_b, tc_t, mtk::wmma::tcec::ec, pipelined>(),           \
+       std::is_same<cumpsgemm::op_a, cumpsgemm::col_major>::value,             \
+       std::is_same<cumpsgemm::op_b, cumpsgemm::col_major>::value});
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "Usage: %s <batch_count> <N> [N ...]\n", argv[0]);
+    return 1;
+  }
+  const std::size_t batch_count = std::atoi(argv[1]);
+  std::vector<std::size_t> N_list;
+  for (int i = 2; i < argc; i++) {
+    N_list.push_back(std::atoi(argv[i]));
+  }
+
+  std::vector<candidate_t> candidate_list;
+  bool is_complex = false;
+#include CUMPSGEMM_AUTOTUNE_CANDIDATES
+  if (candidate_list.size() == 0) {
+    return 0;
+  }
+
+  if (is_complex) {
+    run<cuComplex>(candidate_list, batch_count, N_list);
+  } else {
+    run<float>(candidate_list, batch_count, N_list);
+  }
+}
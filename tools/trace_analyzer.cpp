@@ -0,0 +1,157 @@
+#include "../src/trace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+// Aggregates the trace files written by CUMPSGEMM_TRACE into per-shape and
+// per-mode tables
+namespace {
+struct stat_t {
+  std::uint64_t count = 0;
+  std::uint64_t total_ns = 0;
+  std::uint64_t min_ns = ~0lu;
+  std::uint64_t max_ns = 0;
+
+  void add(const std::uint64_t duration_ns) {
+    count++;
+    total_ns += duration_ns;
+    min_ns = std::min(min_ns, duration_ns);
+    max_ns = std::max(max_ns, duration_ns);
+  }
+};
+
+const char *get_func_name(const std::uint32_t func_id) {
+  if (func_id < cumpsgemm::trace::num_funcs) {
+    return cumpsgemm::trace::func_name_list[func_id];
+  }
+  return "unknown";
+}
+
+const char *get_op_str(const std::uint8_t op) {
+  switch (op) {
+  case CUBLAS_OP_N:
+    return "N";
+  case CUBLAS_OP_T:
+    return "T";
+  case CUBLAS_OP_C:
+    return "C";
+  default:
+    return "Unknown";
+  }
+}
+
+const char *get_compute_mode_str(const std::uint8_t mode) {
+  switch (mode) {
+  case CUMPSGEMM_CUBLAS:
+    return "CUBLAS";
+  case CUMPSGEMM_FP16TCEC:
+    return "FP16TCEC";
+  case CUMPSGEMM_TF32TCEC:
+    return "TF32TCEC";
+  case CUMPSGEMM_FP16TC:
+    return "FP16TC";
+  case CUMPSGEMM_TF32TC:
+    return "TF32TC";
+  case CUMPSGEMM_CUBLAS_SIMT:
+    return "CUBLAS_SIMT";
+  case CUMPSGEMM_CUBLAS_FP16TC:
+    return "CUBLAS_FP16TC";
+  case CUMPSGEMM_CUBLAS_TF32TC:
+    return "CUBLAS_TF32TC";
+  case CUMPSGEMM_DRY_RUN:
+    return "DRY_RUN";
+  case CUMPSGEMM_AUTO:
+    return "AUTO";
+  case CUMPSGEMM_FP16TCEC_SCALING:
+    return "FP16TCEC_SCALING";
+  case CUMPSGEMM_FP32_SIMT:
+    return "FP32_SIMT";
+  case CUMPSGEMM_BF16TCEC:
+    return "BF16TCEC";
+  default:
+    return "UNDEFINED";
+  }
+}
+
+std::string get_kernel_module_str(const std::uint32_t kernel_module_id) {
+  if (kernel_module_id == cumpsgemm::trace::unknown_kernel_module_id) {
+    return "-";
+  }
+  return std::to_string(kernel_module_id);
+}
+
+void print_stat(const stat_t &stat) {
+  std::printf("%lu,%.3f,%.3f,%.3f,%.3f\n", stat.count, stat.total_ns * 1e-3,
+              static_cast<double>(stat.total_ns) / stat.count * 1e-3,
+              stat.min_ns * 1e-3, stat.max_ns * 1e-3);
+}
+
+void print_usage(const char *program_name) {
+  std::fprintf(stderr, "Usage : %s [/path/to/trace...]\n", program_name);
+  std::fflush(stderr);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  using shape_key_t =
+      std::tuple<std::uint32_t, std::uint8_t, std::uint8_t, std::uint64_t,
+                 std::uint64_t, std::uint64_t, std::uint64_t, std::uint8_t,
+                 std::uint32_t>;
+  std::map<shape_key_t, stat_t> shape_stats;
+  std::map<std::uint8_t, stat_t> mode_stats;
+  std::uint64_t num_records = 0;
+  std::uint64_t begin_ns = ~0lu, end_ns = 0;
+
+  for (int i = 1; i < argc; i++) {
+    std::vector<cumpsgemm::trace::record_t> records;
+    try {
+      records = cumpsgemm::trace::load(argv[i]);
+    } catch (const std::runtime_error &e) {
+      std::fprintf(stderr, "[cuMpSGEMM trace] %s\n", e.what());
+      return 1;
+    }
+    for (const auto &record : records) {
+      shape_stats[shape_key_t{record.func_id, record.op_A, record.op_B,
+                              record.m, record.n, record.k,
+                              record.batch_count, record.compute_mode,
+                              record.kernel_module_id}]
+          .add(record.duration_ns);
+      mode_stats[record.compute_mode].add(record.duration_ns);
+      begin_ns = std::min(begin_ns, record.timestamp_ns);
+      end_ns = std::max(end_ns, record.timestamp_ns + record.duration_ns);
+      num_records++;
+    }
+  }
+
+  std::printf("# num_records = %lu, span = %.3fus\n", num_records,
+              num_records == 0 ? 0. : (end_ns - begin_ns) * 1e-3);
+
+  std::printf("## shape\n");
+  std::printf("func,op_A,op_B,m,n,k,batch_count,mode,kernel_module,count,"
+              "total_us,mean_us,min_us,max_us\n");
+  for (const auto &shape_stat : shape_stats) {
+    const auto &key = shape_stat.first;
+    std::printf("%s,%s,%s,%lu,%lu,%lu,%lu,%s,%s,",
+                get_func_name(std::get<0>(key)), get_op_str(std::get<1>(key)),
+                get_op_str(std::get<2>(key)), std::get<3>(key),
+                std::get<4>(key), std::get<5>(key), std::get<6>(key),
+                get_compute_mode_str(std::get<7>(key)),
+                get_kernel_module_str(std::get<8>(key)).c_str());
+    print_stat(shape_stat.second);
+  }
+
+  std::printf("## mode\n");
+  std::printf("mode,count,total_us,mean_us,min_us,max_us\n");
+  for (const auto &mode_stat : mode_stats) {
+    std::printf("%s,", get_compute_mode_str(mode_stat.first));
+    print_stat(mode_stat.second);
+  }
+}